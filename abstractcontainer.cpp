@@ -30,7 +30,8 @@ AbstractContainer::AbstractContainer(iostream &stream, uint64 startOffset) :
     m_startOffset(startOffset),
     m_stream(&stream),
     m_reader(BinaryReader(m_stream)),
-    m_writer(BinaryWriter(m_stream))
+    m_writer(BinaryWriter(m_stream)),
+    m_copyEngine(nullptr)
 {}
 
 /*!
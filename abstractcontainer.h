@@ -23,6 +23,7 @@ class Tag;
 class AbstractTrack;
 class AbstractChapter;
 class AbstractAttachment;
+class CopyEngine;
 
 enum class ElementPosition
 {
@@ -41,6 +42,8 @@ public:
     uint64 startOffset() const;
     IoUtilities::BinaryReader &reader();
     IoUtilities::BinaryWriter &writer();
+    CopyEngine *copyEngine() const;
+    void setCopyEngine(CopyEngine *copyEngine);
 
     void parseHeader();
     void parseTags();
@@ -125,6 +128,7 @@ private:
     std::iostream *m_stream;
     IoUtilities::BinaryReader m_reader;
     IoUtilities::BinaryWriter m_writer;
+    CopyEngine *m_copyEngine;
 };
 
 /*!
@@ -145,6 +149,31 @@ inline void AbstractContainer::setStream(std::iostream &stream)
     m_writer.setStream(m_stream);
 }
 
+/*!
+ * \brief Returns the copy engine used to copy elements when making the file or nullptr if none has been assigned.
+ *
+ * If no copy engine is assigned, elements are copied using a buffer in user space. The container
+ * implementations assign a FileCopyEngine while rewriting the file (unless a copy engine has been
+ * assigned explicitly).
+ *
+ * \sa setCopyEngine()
+ */
+inline CopyEngine *AbstractContainer::copyEngine() const
+{
+    return m_copyEngine;
+}
+
+/*!
+ * \brief Assigns the copy engine used to copy elements.
+ * \remarks The container does not take ownership. The engine must be able to handle stream()
+ *          as input and the output stream used when making the file.
+ * \sa copyEngine()
+ */
+inline void AbstractContainer::setCopyEngine(CopyEngine *copyEngine)
+{
+    m_copyEngine = copyEngine;
+}
+
 /*!
  * \brief Returns the start offset in the related stream.
  */
@@ -65,7 +65,8 @@ AbstractTrack::AbstractTrack(istream &inputStream, ostream &outputStream, uint64
     m_encrypted(false),
     m_usedInPresentation(true),
     m_usedWhenPreviewing(true),
-    m_colorSpace(0)
+    m_colorSpace(0),
+    m_frameScanning(false)
 {}
 
 /*!
@@ -15,6 +15,7 @@
 
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 namespace Media {
 
@@ -107,6 +108,9 @@ public:
     uint32 colorSpace() const;
     const Margin &cropping() const;
     std::string label() const;
+    bool isFrameScanningEnabled() const;
+    void setFrameScanningEnabled(bool enabled);
+    const std::vector<uint64> &frameOffsets() const;
 
     void parseHeader();
     bool isHeaderValid() const;
@@ -166,6 +170,8 @@ protected:
     bool m_usedWhenPreviewing;
     uint32 m_colorSpace;
     Margin m_cropping;
+    bool m_frameScanning;
+    std::vector<uint64> m_frameOffsets;
 };
 
 /*!
@@ -675,6 +681,41 @@ inline const Margin &AbstractTrack::cropping() const
     return m_cropping;
 }
 
+/*!
+ * \brief Returns whether all frames are walked through when parsing the header.
+ *
+ * This allows determining the exact duration and bitrate of raw frame streams
+ * (eg. MPEG audio frames) and building a seek table (see frameOffsets()) at the
+ * cost of reading the whole stream.
+ *
+ * \remarks Only supported by raw frame streams. Disabled by default. ADTS streams are
+ *          always walked through because there is no other way to determine the duration;
+ *          this setting only controls whether the seek table is built.
+ */
+inline bool AbstractTrack::isFrameScanningEnabled() const
+{
+    return m_frameScanning;
+}
+
+/*!
+ * \brief Sets whether all frames are walked through when parsing the header.
+ * \remarks Must be set before calling parseHeader() to take effect.
+ * \sa isFrameScanningEnabled()
+ */
+inline void AbstractTrack::setFrameScanningEnabled(bool enabled)
+{
+    m_frameScanning = enabled;
+}
+
+/*!
+ * \brief Returns the offsets of the frames in the associated stream (the frame index is used as index).
+ * \remarks Only populated when frame scanning is enabled (see isFrameScanningEnabled()).
+ */
+inline const std::vector<uint64> &AbstractTrack::frameOffsets() const
+{
+    return m_frameOffsets;
+}
+
 /*!
  * \brief Returns an indication whether the track header is valid.
  */
@@ -2,10 +2,12 @@
 
 #include "../exceptions.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/io/binaryreader.h>
 
 using namespace std;
 using namespace IoUtilities;
+using namespace ConversionUtilities;
 
 namespace Media {
 
@@ -33,5 +35,21 @@ void AdtsFrame::parseHeader(IoUtilities::BinaryReader &reader)
     }
 }
 
+/*!
+ * \brief Parses the header from the specified \a buffer.
+ *
+ * In contrast to the overload reading from a stream no exception is thrown if the
+ * header is invalid. Use isValid() to check whether a valid header has been parsed.
+ *
+ * \remarks The \a buffer must contain at least 7 bytes; if a CRC is present (see hasCrc()) 9 bytes.
+ */
+void AdtsFrame::parseHeader(const char *buffer)
+{
+    m_header1 = BE::toUInt16(buffer);
+    m_header2 = hasCrc()
+            ? ((static_cast<uint64>(BE::toUInt32(buffer + 2)) << 0x18) | BE::toUInt24(buffer + 6))
+            : ((static_cast<uint64>(BE::toUInt32(buffer + 2)) << 0x18) | (static_cast<uint64>(static_cast<byte>(buffer[6])) << 0x10));
+}
+
 } // namespace Media
 
@@ -17,6 +17,7 @@ public:
     AdtsFrame();
 
     void parseHeader(IoUtilities::BinaryReader &reader);
+    void parseHeader(const char *buffer);
 
     bool isValid() const;
     bool isMpeg4() const;
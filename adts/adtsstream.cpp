@@ -3,10 +3,12 @@
 #include "../mp4/mp4ids.h"
 
 #include "../exceptions.h"
+#include "../framescanner.h"
 
 #include <string>
 
 using namespace std;
+using namespace ChronoUtilities;
 
 namespace Media {
 
@@ -17,7 +19,6 @@ namespace Media {
 
 void AdtsStream::internalParseHeader()
 {
-    //static const string context("parsing ADTS frame header");
     if(!m_istream) {
         throw NoDataFoundException();
     }
@@ -28,6 +29,7 @@ void AdtsStream::internalParseHeader()
     } else {
         m_size = static_cast<uint64>(m_istream->tellg()) + 125u - m_startOffset;
     }
+    const uint64 endOffset = m_startOffset + m_size;
     m_istream->seekg(m_startOffset, ios_base::beg);
     // parse frame header
     m_firstFrame.parseHeader(m_reader);
@@ -35,6 +37,70 @@ void AdtsStream::internalParseHeader()
     m_channelCount = Mpeg4ChannelConfigs::channelCount(m_channelConfig = m_firstFrame.mpeg4ChannelConfig());
     byte sampleRateIndex = m_firstFrame.mpeg4SamplingFrequencyIndex();
     m_samplingFrequency = sampleRateIndex < sizeof(mpeg4SamplingFrequencyTable) ? mpeg4SamplingFrequencyTable[sampleRateIndex] : 0;
+    // walk through all frames to determine duration and bitrate (ADTS streams provide no other way)
+    scanFrames(endOffset);
+}
+
+/*!
+ * \brief Walks through the headers of all frames until the specified \a endOffset is reached.
+ *
+ * Determines the sample count, duration, bitrate and max. bitrate. The offsets of the frames
+ * are only recorded if frame scanning is enabled (see isFrameScanningEnabled()).
+ */
+void AdtsStream::scanFrames(uint64 endOffset)
+{
+    static const string context("scanning ADTS frames");
+    m_frameOffsets.clear();
+    if(m_frameScanning && m_firstFrame.totalSize()) {
+        m_frameOffsets.reserve(static_cast<size_t>((endOffset - m_startOffset) / m_firstFrame.totalSize() + 1));
+    }
+    FrameScanner scanner(*m_istream, m_startOffset, endOffset, 0xF0);
+    AdtsFrame frame;
+    uint64 sampleCount = 0, totalSize = 0;
+    double maxBitrate = 0.0;
+    bool syncLost = false;
+    while(const char *header = scanner.header(7)) {
+        // the header is 2 bytes longer if the "protection absent" bit is not set
+        if(!(header[1] & 0x1) && !(header = scanner.header(9))) {
+            break;
+        }
+        frame.parseHeader(header);
+        // treat frames not matching the first frame as garbage
+        if(!frame.isValid() || frame.mpeg4SamplingFrequencyIndex() != m_firstFrame.mpeg4SamplingFrequencyIndex()) {
+            syncLost = true;
+            if(!scanner.resync()) {
+                break;
+            }
+            continue;
+        }
+        if(m_frameScanning) {
+            m_frameOffsets.push_back(scanner.offset());
+        }
+        // each raw data block contains 1024 samples
+        const uint32 frameSampleCount = frame.frameCount() * 1024u;
+        sampleCount += frameSampleCount;
+        totalSize += frame.totalSize();
+        if(m_samplingFrequency) {
+            const double frameBitrate = frame.totalSize() * 8.0 * m_samplingFrequency / frameSampleCount / 1000.0;
+            if(frameBitrate > maxBitrate) {
+                maxBitrate = frameBitrate;
+            }
+        }
+        scanner.advance(frame.totalSize());
+    }
+    if(syncLost) {
+        addNotification(NotificationType::Warning, "Data between ADTS frames has been skipped.", context);
+    }
+    if(!sampleCount || !m_samplingFrequency) {
+        addNotification(NotificationType::Critical, "Unable to determine duration and bitrate.", context);
+        return;
+    }
+    const double seconds = static_cast<double>(sampleCount) / m_samplingFrequency;
+    m_sampleCount = sampleCount;
+    m_duration = TimeSpan::fromSeconds(seconds);
+    m_bitrate = static_cast<double>(totalSize) * 8.0 / seconds / 1000.0;
+    m_maxBitrate = maxBitrate;
+    m_bytesPerSecond = static_cast<uint32>(static_cast<double>(totalSize) / seconds);
 }
 
 } // namespace Media
@@ -19,6 +19,8 @@ protected:
     void internalParseHeader();
 
 private:
+    void scanFrames(uint64 endOffset);
+
     AdtsFrame m_firstFrame;
 };
 
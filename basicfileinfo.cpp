@@ -1,5 +1,12 @@
 #include "./basicfileinfo.h"
 
+#ifdef PLATFORM_UNIX
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
 using namespace std;
 
 /*!
@@ -23,7 +30,10 @@ namespace Media {
 BasicFileInfo::BasicFileInfo(const std::string &path) :
     m_path(path),
     m_size(0),
-    m_readOnly(false)
+    m_mappedData(nullptr),
+    m_mappedSize(0),
+    m_readOnly(false),
+    m_memoryMappingEnabled(false)
 {
     m_file.exceptions(ios_base::failbit | ios_base::badbit);
 }
@@ -63,6 +73,9 @@ void BasicFileInfo::reopen(bool readOnly)
     m_file.seekg(0, ios_base::end);
     m_size = m_file.tellg();
     m_file.seekg(0, ios_base::beg);
+    if(m_memoryMappingEnabled) {
+        mapFile();
+    }
 }
 
 /*!
@@ -70,12 +83,63 @@ void BasicFileInfo::reopen(bool readOnly)
  */
 void BasicFileInfo::close()
 {
+    unmapFile();
     if(isOpen()) {
         m_file.close();
     }
     m_file.clear();
 }
 
+/*!
+ * \brief Maps the current file read-only into memory. Does nothing if the file is already mapped.
+ *
+ * Mapping is only an optimization: If it is not supported by the platform or fails for
+ * another reason, the file is just not mapped and all parsers keep using stream().
+ *
+ * \remarks
+ * - The file must be opened before (see open()).
+ * - The mapping is released when the file is closed (see close()) or unmapFile() is called.
+ * - Changes applied via stream() are visible through the mapping unless the file is truncated. The
+ *   mapping should be released before modifying the file structure (MediaFileInfo::applyChanges()
+ *   takes care of this).
+ */
+void BasicFileInfo::mapFile()
+{
+    if(m_mappedData || !isOpen()) {
+        return;
+    }
+#ifdef PLATFORM_UNIX
+    const int fd = ::open(m_path.c_str(), O_RDONLY);
+    if(fd == -1) {
+        return;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+        void *const data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if(data != MAP_FAILED) {
+            m_mappedData = reinterpret_cast<const char *>(data);
+            m_mappedSize = static_cast<uint64>(fileStat.st_size);
+        }
+    }
+    ::close(fd); // the mapping stays valid after closing the descriptor
+#endif
+}
+
+/*!
+ * \brief Releases the memory mapping created via mapFile(). Does nothing if the file is not mapped.
+ */
+void BasicFileInfo::unmapFile()
+{
+    if(!m_mappedData) {
+        return;
+    }
+#ifdef PLATFORM_UNIX
+    munmap(const_cast<char *>(m_mappedData), static_cast<size_t>(m_mappedSize));
+#endif
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
+}
+
 /*!
  * \brief Invalidates the file info manually.
  */
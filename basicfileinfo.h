@@ -29,6 +29,16 @@ public:
     IoUtilities::NativeFileStream &stream();
     const IoUtilities::NativeFileStream &stream() const;
 
+    // methods to control memory mapping of the associated file
+    bool isMemoryMappingEnabled() const;
+    void setMemoryMappingEnabled(bool enabled);
+    bool isMapped() const;
+    void mapFile();
+    void unmapFile();
+    const char *mappedData() const;
+    uint64 mappedSize() const;
+    const char *mappedRange(uint64 offset, uint64 size) const;
+
     // methods to get, set path (components)
     const std::string &path() const;
     void setPath(const std::string &path);
@@ -53,7 +63,10 @@ private:
     std::string m_path;
     IoUtilities::NativeFileStream m_file;
     uint64 m_size;
+    const char *m_mappedData;
+    uint64 m_mappedSize;
     bool m_readOnly;
+    bool m_memoryMappingEnabled;
 };
 
 /*!
@@ -90,6 +103,68 @@ inline const IoUtilities::NativeFileStream &BasicFileInfo::stream() const
     return m_file;
 }
 
+/*!
+ * \brief Returns whether the file is mapped into memory when opened.
+ * \sa setMemoryMappingEnabled()
+ */
+inline bool BasicFileInfo::isMemoryMappingEnabled() const
+{
+    return m_memoryMappingEnabled;
+}
+
+/*!
+ * \brief Sets whether the file should be mapped into memory when opened.
+ *
+ * If enabled, parsers decode element headers directly from the mapped memory instead
+ * of going through stream(). The stream is still used as fallback, eg. when mapping
+ * is not supported by the platform or fails.
+ *
+ * \remarks Takes effect when the file is (re)opened the next time. Call mapFile() to
+ *          map an already opened file.
+ */
+inline void BasicFileInfo::setMemoryMappingEnabled(bool enabled)
+{
+    m_memoryMappingEnabled = enabled;
+}
+
+/*!
+ * \brief Returns whether the file is currently mapped into memory.
+ * \sa mapFile(), mappedData()
+ */
+inline bool BasicFileInfo::isMapped() const
+{
+    return m_mappedData != nullptr;
+}
+
+/*!
+ * \brief Returns the mapped file contents or nullptr if the file is not mapped.
+ * \remarks The returned memory is invalidated when the file is closed or unmapped.
+ */
+inline const char *BasicFileInfo::mappedData() const
+{
+    return m_mappedData;
+}
+
+/*!
+ * \brief Returns the number of mapped bytes (zero if the file is not mapped).
+ */
+inline uint64 BasicFileInfo::mappedSize() const
+{
+    return m_mappedSize;
+}
+
+/*!
+ * \brief Returns a pointer to the \a size bytes at the specified \a offset if these bytes
+ *        are mapped; otherwise returns nullptr.
+ *
+ * Parsers use this to decode headers directly from memory and fall back to stream()
+ * if nullptr is returned.
+ */
+inline const char *BasicFileInfo::mappedRange(uint64 offset, uint64 size) const
+{
+    return (m_mappedData && offset <= m_mappedSize && size <= m_mappedSize - offset) ? m_mappedData + offset : nullptr;
+}
+
 /*!
  * \brief Returns the path of the current file.
  *
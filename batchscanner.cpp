@@ -0,0 +1,259 @@
+#include "./batchscanner.h"
+#include "./mediafileinfo.h"
+#include "./exceptions.h"
+
+#include <c++utilities/io/catchiofailure.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+using namespace std;
+using namespace IoUtilities;
+
+namespace Media {
+
+/*!
+ * \class Media::BatchScanner
+ * \brief The BatchScanner class parses many files concurrently using a pool of worker threads.
+ *
+ * Each file is parsed by its own MediaFileInfo instance which lives on the worker thread processing
+ * the file. So MediaFileInfo and all objects it owns (containers, tracks, tags, ...) are never shared
+ * between threads. The files are distributed over the workers in contiguous ranges; workers which
+ * finished their range steal the upper half of the remaining range of another worker.
+ *
+ * Each worker keeps at most one file open. Hence the number of workers is the minimum of threadCount()
+ * and maxOpenFiles().
+ *
+ * The results are passed to the callback specified when calling scan() as soon as a file has been
+ * processed. So the order of the results is not the order of the specified paths; use
+ * BatchScanResult::index to map results back.
+ *
+ * \remarks
+ * Concurrent parsing relies on the following shared state of the library:
+ * - Function-local static objects (eg. the parsing context strings, the genre names of Id3Genres and the
+ *   field maps of VorbisComment and MatroskaTag) are initialized thread-safe (as guaranteed by C++11)
+ *   and are never modified afterwards.
+ * - Global settings like BackupHelper::backupDirectory(), EbmlElement::bytesToBeSkipped and
+ *   MatroskaContainer::setMaxFullParseSize() are read without synchronization. They must not be
+ *   modified while a scan is running.
+ */
+
+/*!
+ * \brief The WorkRange class holds a range of file indices which can be taken by its owner and stolen by other workers.
+ *
+ * The begin and the end of the range are packed into a single atomic 64-bit value so the owner can take
+ * from the front and thieves can take from the back without locking.
+ */
+class BatchScanner::WorkRange
+{
+public:
+    WorkRange();
+    WorkRange(const WorkRange &other);
+
+    void assign(uint32 begin, uint32 end);
+    bool take(std::size_t &index);
+    bool stealHalf(uint32 &begin, uint32 &end);
+
+private:
+    static constexpr uint64 pack(uint32 begin, uint32 end);
+
+    std::atomic<uint64> m_range;
+};
+
+BatchScanner::WorkRange::WorkRange() :
+    m_range(0)
+{}
+
+BatchScanner::WorkRange::WorkRange(const WorkRange &other) :
+    m_range(other.m_range.load())
+{}
+
+constexpr uint64 BatchScanner::WorkRange::pack(uint32 begin, uint32 end)
+{
+    return (static_cast<uint64>(begin) << 32) | end;
+}
+
+/*!
+ * \brief Assigns the specified range.
+ * \remarks Must only be called by the owner when its range is empty.
+ */
+void BatchScanner::WorkRange::assign(uint32 begin, uint32 end)
+{
+    m_range.store(pack(begin, end));
+}
+
+/*!
+ * \brief Takes the first index of the range.
+ * \returns Returns whether an index could be taken.
+ */
+bool BatchScanner::WorkRange::take(std::size_t &index)
+{
+    for(uint64 range = m_range.load();;) {
+        const auto begin = static_cast<uint32>(range >> 32), end = static_cast<uint32>(range);
+        if(begin >= end) {
+            return false;
+        }
+        if(m_range.compare_exchange_weak(range, pack(begin + 1, end))) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+/*!
+ * \brief Removes the upper half of the range and assigns it to \a begin and \a end.
+ * \returns Returns whether something could be stolen.
+ */
+bool BatchScanner::WorkRange::stealHalf(uint32 &begin, uint32 &end)
+{
+    for(uint64 range = m_range.load();;) {
+        const auto currentBegin = static_cast<uint32>(range >> 32), currentEnd = static_cast<uint32>(range);
+        if(currentBegin >= currentEnd) {
+            return false;
+        }
+        const uint32 newEnd = currentEnd - (currentEnd - currentBegin + 1) / 2;
+        if(m_range.compare_exchange_weak(range, pack(currentBegin, newEnd))) {
+            begin = newEnd;
+            end = currentEnd;
+            return true;
+        }
+    }
+}
+
+/*!
+ * \brief Constructs a new batch scanner.
+ */
+BatchScanner::BatchScanner() :
+    m_stages(ParsingStages::Everything),
+    m_threadCount(0),
+    m_maxOpenFiles(64),
+    m_callbacksSerialized(true),
+    m_aborted(false)
+{}
+
+/*!
+ * \brief Parses the files with the specified \a paths and invokes \a callback for each of them.
+ *
+ * Returns when all files have been processed or the scan has been aborted (see abort()).
+ *
+ * IO errors and parsing failures are reported via the BatchScanResult passed to \a callback and
+ * do not abort the scan.
+ *
+ * \throws Rethrows the first exception thrown by \a callback or the setup callback (remaining files
+ *         are skipped in this case).
+ * \throws Throws std::length_error if more than 2^32 - 1 paths are specified.
+ */
+void BatchScanner::scan(const std::vector<string> &paths, const ResultCallback &callback)
+{
+    if(paths.size() >= numeric_limits<uint32>::max()) {
+        throw length_error("too many paths for a single batch scan");
+    }
+    m_aborted.store(false);
+    m_exception = nullptr;
+
+    // determine number of workers
+    unsigned int workerCount = m_threadCount ? m_threadCount : thread::hardware_concurrency();
+    workerCount = max(1u, min(workerCount, m_maxOpenFiles));
+    if(workerCount > paths.size()) {
+        workerCount = max<unsigned int>(1u, static_cast<unsigned int>(paths.size()));
+    }
+
+    // split paths into contiguous ranges (one per worker)
+    vector<WorkRange> ranges(workerCount);
+    const auto fileCount = static_cast<uint32>(paths.size());
+    for(unsigned int i = 0; i != workerCount; ++i) {
+        ranges[i].assign(static_cast<uint32>(static_cast<uint64>(fileCount) * i / workerCount), static_cast<uint32>(static_cast<uint64>(fileCount) * (i + 1) / workerCount));
+    }
+
+    // run workers; the current thread is used as the first worker
+    vector<thread> threads;
+    threads.reserve(workerCount - 1);
+    for(unsigned int i = 1; i < workerCount; ++i) {
+        threads.emplace_back(&BatchScanner::work, this, ref(ranges), i, cref(paths), cref(callback));
+    }
+    work(ranges, 0, paths, callback);
+    for(auto &thread : threads) {
+        thread.join();
+    }
+
+    if(m_exception) {
+        rethrow_exception(m_exception);
+    }
+}
+
+/*!
+ * \brief Processes the files of the range with the index \a ownRange and steals from other ranges when done.
+ * \remarks This is the main function of a worker thread.
+ */
+void BatchScanner::work(std::vector<WorkRange> &ranges, std::size_t ownRange, const std::vector<string> &paths, const ResultCallback &callback)
+{
+    try {
+        for(size_t index; !isAborted();) {
+            if(ranges[ownRange].take(index)) {
+                scanFile(index, paths[index], callback);
+                continue;
+            }
+            // own range is exhausted -> steal from other workers
+            bool stolen = false;
+            for(size_t i = 1; i < ranges.size() && !stolen; ++i) {
+                uint32 begin, end;
+                if((stolen = ranges[(ownRange + i) % ranges.size()].stealHalf(begin, end))) {
+                    ranges[ownRange].assign(begin, end);
+                }
+            }
+            if(!stolen) {
+                return; // all ranges are exhausted
+            }
+        }
+    } catch(...) {
+        lock_guard<mutex> lock(m_mutex);
+        if(!m_exception) {
+            m_exception = current_exception();
+        }
+        abort();
+    }
+}
+
+/*!
+ * \brief Opens and parses the file with the specified \a index and \a path and invokes \a callback.
+ */
+void BatchScanner::scanFile(std::size_t index, const string &path, const ResultCallback &callback)
+{
+    MediaFileInfo fileInfo(path);
+    if(m_setupCallback) {
+        m_setupCallback(fileInfo);
+    }
+    BatchScanResult result(index, path, fileInfo);
+    try {
+        fileInfo.open(true);
+        if(m_stages != ParsingStages::None) {
+            fileInfo.parseContainerFormat();
+        }
+        if(m_stages & ParsingStages::Tracks) {
+            fileInfo.parseTracks();
+        }
+        if(m_stages & ParsingStages::Tags) {
+            fileInfo.parseTags();
+        }
+        if(m_stages & ParsingStages::Chapters) {
+            fileInfo.parseChapters();
+        }
+        if(m_stages & ParsingStages::Attachments) {
+            fileInfo.parseAttachments();
+        }
+    } catch(const Failure &) {
+        result.parsingFailed = true;
+    } catch(...) {
+        result.ioError = catchIoFailure();
+    }
+    fileInfo.gatherRelatedNotifications(result.notifications);
+    if(m_callbacksSerialized) {
+        lock_guard<mutex> lock(m_mutex);
+        callback(result);
+    } else {
+        callback(result);
+    }
+}
+
+}
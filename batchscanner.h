@@ -0,0 +1,212 @@
+#ifndef MEDIA_BATCHSCANNER_H
+#define MEDIA_BATCHSCANNER_H
+
+#include "./notification.h"
+
+#include <c++utilities/conversion/types.h>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Media {
+
+class MediaFileInfo;
+
+/*!
+ * \brief The ParsingStages enum specifies which parse methods of MediaFileInfo are invoked by the BatchScanner.
+ */
+enum class ParsingStages : byte
+{
+    None = 0x0, /**< only opens the file */
+    ContainerFormat = 0x1, /**< MediaFileInfo::parseContainerFormat() */
+    Tracks = 0x2, /**< MediaFileInfo::parseTracks() */
+    Tags = 0x4, /**< MediaFileInfo::parseTags() */
+    Chapters = 0x8, /**< MediaFileInfo::parseChapters() */
+    Attachments = 0x10, /**< MediaFileInfo::parseAttachments() */
+    Everything = 0x1F /**< all of the above (like MediaFileInfo::parseEverything()) */
+};
+
+inline bool operator &(ParsingStages lhs, ParsingStages rhs)
+{
+    return static_cast<byte>(lhs) & static_cast<byte>(rhs);
+}
+
+inline ParsingStages operator |(ParsingStages lhs, ParsingStages rhs)
+{
+    return static_cast<ParsingStages>(static_cast<byte>(lhs) | static_cast<byte>(rhs));
+}
+
+/*!
+ * \brief The BatchScanResult struct holds the result for a single file scanned by the BatchScanner.
+ */
+struct TAG_PARSER_EXPORT BatchScanResult
+{
+    BatchScanResult(std::size_t fileIndex, const std::string &filePath, MediaFileInfo &parsedFileInfo);
+
+    /// \brief The index of the file within the paths passed to BatchScanner::scan().
+    std::size_t index;
+    /// \brief The path of the file.
+    const std::string &path;
+    /// \brief The parsed file; only valid within the result callback.
+    MediaFileInfo &fileInfo;
+    /// \brief The notifications of the file and all related objects.
+    NotificationList notifications;
+    /// \brief Whether a parsing stage failed with a Media::Failure.
+    bool parsingFailed;
+    /// \brief The IO error which occured when reading the file; empty if no IO error occured.
+    std::string ioError;
+};
+
+inline BatchScanResult::BatchScanResult(std::size_t fileIndex, const std::string &filePath, MediaFileInfo &parsedFileInfo) :
+    index(fileIndex),
+    path(filePath),
+    fileInfo(parsedFileInfo),
+    parsingFailed(false)
+{}
+
+class TAG_PARSER_EXPORT BatchScanner
+{
+public:
+    typedef std::function<void (BatchScanResult &result)> ResultCallback;
+    typedef std::function<void (MediaFileInfo &fileInfo)> SetupCallback;
+
+    BatchScanner();
+
+    ParsingStages stages() const;
+    void setStages(ParsingStages stages);
+    unsigned int threadCount() const;
+    void setThreadCount(unsigned int threadCount);
+    unsigned int maxOpenFiles() const;
+    void setMaxOpenFiles(unsigned int maxOpenFiles);
+    bool areCallbacksSerialized() const;
+    void setCallbacksSerialized(bool callbacksSerialized);
+    void setSetupCallback(const SetupCallback &setupCallback);
+
+    void scan(const std::vector<std::string> &paths, const ResultCallback &callback);
+    void abort();
+    bool isAborted() const;
+
+private:
+    class WorkRange;
+    void scanFile(std::size_t index, const std::string &path, const ResultCallback &callback);
+    void work(std::vector<WorkRange> &ranges, std::size_t ownRange, const std::vector<std::string> &paths, const ResultCallback &callback);
+
+    ParsingStages m_stages;
+    unsigned int m_threadCount;
+    unsigned int m_maxOpenFiles;
+    bool m_callbacksSerialized;
+    SetupCallback m_setupCallback;
+    std::atomic<bool> m_aborted;
+    std::exception_ptr m_exception;
+    std::mutex m_mutex;
+};
+
+/*!
+ * \brief Returns the parsing stages to be performed for each file.
+ *
+ * Default is ParsingStages::Everything.
+ */
+inline ParsingStages BatchScanner::stages() const
+{
+    return m_stages;
+}
+
+/*!
+ * \brief Sets the parsing stages to be performed for each file.
+ * \remarks Stages are always run in the order of the ParsingStages enum. Stages other than
+ *          ParsingStages::ContainerFormat imply parsing the container format.
+ */
+inline void BatchScanner::setStages(ParsingStages stages)
+{
+    m_stages = stages;
+}
+
+/*!
+ * \brief Returns the number of worker threads.
+ *
+ * Default is the number of hardware threads. The effective number of threads is limited
+ * by maxOpenFiles() because each worker keeps at most one file open.
+ */
+inline unsigned int BatchScanner::threadCount() const
+{
+    return m_threadCount;
+}
+
+/*!
+ * \brief Sets the number of worker threads. Zero means the number of hardware threads.
+ */
+inline void BatchScanner::setThreadCount(unsigned int threadCount)
+{
+    m_threadCount = threadCount;
+}
+
+/*!
+ * \brief Returns the maximum number of files opened at the same time.
+ */
+inline unsigned int BatchScanner::maxOpenFiles() const
+{
+    return m_maxOpenFiles;
+}
+
+/*!
+ * \brief Sets the maximum number of files opened at the same time.
+ */
+inline void BatchScanner::setMaxOpenFiles(unsigned int maxOpenFiles)
+{
+    m_maxOpenFiles = maxOpenFiles ? maxOpenFiles : 1;
+}
+
+/*!
+ * \brief Returns whether the result callback is never invoked concurrently.
+ *
+ * This is the default. If disabled, the callback is invoked concurrently from the worker
+ * threads and must synchronize access to shared state itself.
+ */
+inline bool BatchScanner::areCallbacksSerialized() const
+{
+    return m_callbacksSerialized;
+}
+
+/*!
+ * \brief Sets whether the result callback is never invoked concurrently.
+ * \sa areCallbacksSerialized()
+ */
+inline void BatchScanner::setCallbacksSerialized(bool callbacksSerialized)
+{
+    m_callbacksSerialized = callbacksSerialized;
+}
+
+/*!
+ * \brief Sets a callback to configure each MediaFileInfo before it is opened and parsed.
+ *
+ * Use this to set eg. MediaFileInfo::setForceFullParse() or BasicFileInfo::setMemoryMappingEnabled().
+ * The callback is invoked concurrently from the worker threads.
+ */
+inline void BatchScanner::setSetupCallback(const SetupCallback &setupCallback)
+{
+    m_setupCallback = setupCallback;
+}
+
+/*!
+ * \brief Aborts a running scan. Files which are currently parsed are finished; remaining files are skipped.
+ */
+inline void BatchScanner::abort()
+{
+    m_aborted.store(true, std::memory_order_relaxed);
+}
+
+/*!
+ * \brief Returns whether the current/last scan has been aborted.
+ */
+inline bool BatchScanner::isAborted() const
+{
+    return m_aborted.load(std::memory_order_relaxed);
+}
+
+}
+
+#endif // MEDIA_BATCHSCANNER_H
@@ -0,0 +1,555 @@
+#include "./generators.h"
+
+#include "../matroska/ebmlid.h"
+#include "../matroska/matroskaid.h"
+#include "../ogg/oggpage.h"
+
+#include <c++utilities/conversion/binaryconversion.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+using namespace ConversionUtilities;
+using namespace Media;
+
+namespace Generators {
+
+namespace {
+
+/*!
+ * \brief The Random class provides deterministic pseudo-random numbers (linear congruential generator).
+ */
+class Random
+{
+public:
+    uint32 next();
+    uint32 next(uint32 min, uint32 max);
+
+private:
+    uint32 m_state = 0x5EED;
+};
+
+inline uint32 Random::next()
+{
+    return (m_state = m_state * 1103515245u + 12345u) >> 8;
+}
+
+/*!
+ * \brief Returns a number within [\a min, \a max].
+ */
+inline uint32 Random::next(uint32 min, uint32 max)
+{
+    return min + next() % (max - min + 1);
+}
+
+void appendBE(string &buffer, uint64 value, unsigned int size)
+{
+    while(size) {
+        buffer += static_cast<char>((value >> (--size * 8)) & 0xFF);
+    }
+}
+
+void appendLE(string &buffer, uint64 value, unsigned int size)
+{
+    for(; size; --size, value >>= 8) {
+        buffer += static_cast<char>(value & 0xFF);
+    }
+}
+
+void appendPayload(string &buffer, size_t size, Random &random)
+{
+    for(; size; --size) {
+        buffer += static_cast<char>(random.next());
+    }
+}
+
+void openOutput(ofstream &output, const string &path)
+{
+    output.exceptions(ios_base::badbit | ios_base::failbit);
+    output.open(path, ios_base::out | ios_base::binary | ios_base::trunc);
+}
+
+// EBML helper
+
+string ebmlElement(uint32 id, const string &data)
+{
+    string element;
+    appendBE(element, id, id > 0xFFFFFF ? 4 : (id > 0xFFFF ? 3 : (id > 0xFF ? 2 : 1)));
+    // always use 8 byte size denotations to keep the generator simple
+    element += '\x01';
+    appendBE(element, data.size(), 7);
+    return element += data;
+}
+
+string ebmlUInt(uint32 id, uint64 value)
+{
+    string data;
+    appendBE(data, value, 8);
+    return ebmlElement(id, data);
+}
+
+string ebmlFloat(uint32 id, double value)
+{
+    uint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return ebmlUInt(id, bits);
+}
+
+// MP4 helper
+
+string mp4Atom(const char *type, const string &data)
+{
+    string atom;
+    appendBE(atom, data.size() + 8, 4);
+    atom.append(type, 4);
+    return atom += data;
+}
+
+string mp4FullAtom(const char *type, uint32 versionAndFlags, const string &data)
+{
+    string fullData;
+    appendBE(fullData, versionAndFlags, 4);
+    return mp4Atom(type, fullData += data);
+}
+
+string mp4Matrix()
+{
+    string matrix;
+    for(uint32 value : {0x10000u, 0u, 0u, 0u, 0x10000u, 0u, 0u, 0u, 0x40000000u}) {
+        appendBE(matrix, value, 4);
+    }
+    return matrix;
+}
+
+/*!
+ * \brief Returns a "moov"-atom with a single audio track using the specified sample table atoms.
+ * \param extension Specifies additional children of the "moov"-atom (eg. "mvex" or "udta").
+ */
+string mp4MovieAtom(uint32 duration, const string &sampleTables, const string &extension)
+{
+    constexpr uint32 timeScale = 44100;
+    string mvhd, tkhd, mdhd, hdlr, stsd;
+    appendBE(mvhd, 0, 8); // creation and modification time
+    appendBE(mvhd, timeScale, 4);
+    appendBE(mvhd, duration, 4);
+    appendBE(mvhd, 0x10000, 4); // rate
+    appendBE(mvhd, 0x100, 2); // volume
+    appendBE(mvhd, 0, 10);
+    mvhd += mp4Matrix();
+    appendBE(mvhd, 0, 24);
+    appendBE(mvhd, 2, 4); // next track ID
+    appendBE(tkhd, 0, 8); // creation and modification time
+    appendBE(tkhd, 1, 4); // track ID
+    appendBE(tkhd, 0, 4);
+    appendBE(tkhd, duration, 4);
+    appendBE(tkhd, 0, 8);
+    appendBE(tkhd, 0, 4); // layer and alternate group
+    appendBE(tkhd, 0x100, 2); // volume
+    appendBE(tkhd, 0, 2);
+    tkhd += mp4Matrix();
+    appendBE(tkhd, 0, 8); // width and height
+    appendBE(mdhd, 0, 8); // creation and modification time
+    appendBE(mdhd, timeScale, 4);
+    appendBE(mdhd, duration, 4);
+    appendBE(mdhd, 0x55C4, 2); // language "und"
+    appendBE(mdhd, 0, 2);
+    appendBE(hdlr, 0, 4);
+    hdlr += "soun";
+    appendBE(hdlr, 0, 12);
+    hdlr += '\0';
+    // sample entry without decoder specific info
+    string mp4a;
+    appendBE(mp4a, 0, 6);
+    appendBE(mp4a, 1, 2); // data reference index
+    appendBE(mp4a, 0, 8);
+    appendBE(mp4a, 2, 2); // channel count
+    appendBE(mp4a, 16, 2); // sample size
+    appendBE(mp4a, 0, 4);
+    appendBE(mp4a, timeScale << 16, 4);
+    appendBE(stsd, 1, 4);
+    stsd += mp4Atom("mp4a", mp4a);
+    string dref;
+    appendBE(dref, 1, 4);
+    dref += mp4FullAtom("url ", 1, string());
+    string smhd;
+    appendBE(smhd, 0, 4);
+    return mp4Atom("moov",
+                   mp4FullAtom("mvhd", 0, mvhd)
+                   + mp4Atom("trak",
+                             mp4FullAtom("tkhd", 0x7, tkhd)
+                             + mp4Atom("mdia",
+                                       mp4FullAtom("mdhd", 0, mdhd)
+                                       + mp4FullAtom("hdlr", 0, hdlr)
+                                       + mp4Atom("minf",
+                                                 mp4FullAtom("smhd", 0, smhd)
+                                                 + mp4Atom("dinf", mp4FullAtom("dref", 0, dref))
+                                                 + mp4Atom("stbl", mp4FullAtom("stsd", 0, stsd) + sampleTables))))
+                   + extension);
+}
+
+string mp4FileTypeAtom()
+{
+    string ftyp("M4A ");
+    appendBE(ftyp, 0x200, 4);
+    ftyp += "M4A mp42isom";
+    return mp4Atom("ftyp", ftyp);
+}
+
+string mp4TagAtom()
+{
+    string hdlr;
+    appendBE(hdlr, 0, 4);
+    hdlr += "mdirappl";
+    appendBE(hdlr, 0, 9);
+    string data;
+    appendBE(data, 0, 4); // locale
+    data += "Synthetic benchmark file";
+    return mp4Atom("udta", mp4FullAtom("meta", 0, mp4FullAtom("hdlr", 0, hdlr) + mp4Atom("ilst", mp4Atom("\xA9nam", mp4FullAtom("data", 1, data)))));
+}
+
+// Ogg helper
+
+/*!
+ * \brief Writes a page containing the specified complete \a packets.
+ * \remarks The packets must fit into a single page (255 segments).
+ */
+void writeOggPage(ostream &output, byte flags, uint64 granulePosition, uint32 sequenceNumber, const vector<string> &packets)
+{
+    string page("OggS");
+    page += '\0';
+    page += static_cast<char>(flags);
+    appendLE(page, granulePosition, 8);
+    appendLE(page, 0x1234, 4); // stream serial number
+    appendLE(page, sequenceNumber, 4);
+    appendLE(page, 0, 4); // checksum (computed later)
+    string segmentTable, data;
+    for(const string &packet : packets) {
+        segmentTable.append(packet.size() / 255, '\xFF');
+        segmentTable += static_cast<char>(packet.size() % 255);
+        data += packet;
+    }
+    page += static_cast<char>(segmentTable.size());
+    page += segmentTable;
+    page += data;
+    LE::getBytes(OggPage::computeChecksum(page.data(), static_cast<uint32>(page.size())), &page[22]);
+    output.write(page.data(), static_cast<streamsize>(page.size()));
+}
+
+}
+
+/*!
+ * \brief Creates a Matroska file with a single audio track, the specified number of clusters and a "Cues"-element
+ *        referring to each cluster.
+ */
+void makeMatroskaFile(const string &path, uint32 clusterCount)
+{
+    constexpr uint32 blocksPerCluster = 8, blockSize = 256;
+    Random random;
+    const string header = ebmlElement(EbmlIds::Header,
+                                      ebmlUInt(EbmlIds::Version, 1) + ebmlUInt(EbmlIds::ReadVersion, 1)
+                                      + ebmlUInt(EbmlIds::MaxIdLength, 4) + ebmlUInt(EbmlIds::MaxSizeLength, 8)
+                                      + ebmlElement(EbmlIds::DocType, "matroska")
+                                      + ebmlUInt(EbmlIds::DocTypeVersion, 4) + ebmlUInt(EbmlIds::DocTypeReadVersion, 2));
+    const string info = ebmlElement(MatroskaIds::SegmentInfo,
+                                    ebmlUInt(MatroskaIds::TimeCodeScale, 1000000)
+                                    + ebmlFloat(MatroskaIds::Duration, clusterCount * 1000.0)
+                                    + ebmlElement(MatroskaIds::MuxingApp, "tagparser_bench")
+                                    + ebmlElement(MatroskaIds::WrittingApp, "tagparser_bench"));
+    const string tracks = ebmlElement(MatroskaIds::Tracks, ebmlElement(MatroskaIds::TrackEntry,
+                                      ebmlUInt(MatroskaIds::TrackNumber, 1) + ebmlUInt(MatroskaIds::TrackUID, 0x1234)
+                                      + ebmlUInt(MatroskaIds::TrackType, 2) + ebmlElement(MatroskaIds::CodecID, "A_PCM/INT/LIT")
+                                      + ebmlElement(MatroskaIds::TrackAudio, ebmlFloat(MatroskaIds::SamplingFrequency, 48000.0) + ebmlUInt(MatroskaIds::Channels, 2))));
+    const string tags = ebmlElement(MatroskaIds::Tags, ebmlElement(MatroskaIds::Tag,
+                                    ebmlElement(MatroskaIds::Targets, ebmlUInt(MatroskaIds::TargetTypeValue, 50))
+                                    + ebmlElement(MatroskaIds::SimpleTag, ebmlElement(MatroskaIds::TagName, "TITLE") + ebmlElement(MatroskaIds::TagString, "Synthetic benchmark file"))));
+    // padding allows applying changes in-place
+    const string padding = ebmlElement(EbmlIds::Void, string(0x1000, '\0'));
+
+    // all clusters have the same size so the size of the segment is known in advance
+    const auto makeCluster = [&random] (uint32 index) {
+        string data = ebmlUInt(MatroskaIds::Timecode, index * 1000ul);
+        for(uint32 blockIndex = 0; blockIndex != blocksPerCluster; ++blockIndex) {
+            string block("\x81", 1); // track number
+            appendBE(block, blockIndex * (1000 / blocksPerCluster), 2); // relative timecode
+            block += '\x80'; // flags (keyframe)
+            appendPayload(block, blockSize, random);
+            data += ebmlElement(MatroskaIds::SimpleBlock, block);
+        }
+        return ebmlElement(MatroskaIds::Cluster, data);
+    };
+    const uint64 clusterSize = makeCluster(0).size();
+    const uint64 firstClusterPosition = info.size() + tracks.size() + tags.size() + padding.size();
+    string cuePoints;
+    for(uint32 index = 0; index != clusterCount; ++index) {
+        cuePoints += ebmlElement(MatroskaIds::CuePoint,
+                                 ebmlUInt(MatroskaIds::CueTime, index * 1000ul)
+                                 + ebmlElement(MatroskaIds::CueTrackPositions, ebmlUInt(MatroskaIds::CueTrack, 1)
+                                               + ebmlUInt(MatroskaIds::CueClusterPosition, firstClusterPosition + index * clusterSize)));
+    }
+    const string cues = ebmlElement(MatroskaIds::Cues, cuePoints);
+
+    ofstream output;
+    openOutput(output, path);
+    output << header;
+    string segmentHeader;
+    appendBE(segmentHeader, MatroskaIds::Segment, 4);
+    segmentHeader += '\x01';
+    appendBE(segmentHeader, firstClusterPosition + clusterCount * clusterSize + cues.size(), 7);
+    output << segmentHeader << info << tracks << tags << padding;
+    for(uint32 index = 0; index != clusterCount; ++index) {
+        output << makeCluster(index);
+    }
+    output << cues;
+}
+
+/*!
+ * \brief Creates an MP4 file with a single audio track consisting of (at least) the specified number of
+ *        samples of variable size.
+ */
+void makeMp4File(const string &path, uint32 sampleCount)
+{
+    constexpr uint32 samplesPerChunk = 16, sampleDuration = 1024;
+    Random random;
+    const uint32 chunkCount = (sampleCount + samplesPerChunk - 1) / samplesPerChunk;
+    sampleCount = chunkCount * samplesPerChunk;
+    vector<uint32> sampleSizes(sampleCount);
+    for(uint32 &sampleSize : sampleSizes) {
+        sampleSize = random.next(200, 700);
+    }
+
+    // make sample tables; the chunk offsets depend on the size of the "moov"-atom
+    string stts, stsc, stsz;
+    appendBE(stts, 1, 4);
+    appendBE(stts, sampleCount, 4);
+    appendBE(stts, sampleDuration, 4);
+    appendBE(stsc, 1, 4);
+    appendBE(stsc, 1, 4); // first chunk
+    appendBE(stsc, samplesPerChunk, 4);
+    appendBE(stsc, 1, 4); // sample description index
+    appendBE(stsz, 0, 4); // no constant sample size
+    appendBE(stsz, sampleCount, 4);
+    for(uint32 sampleSize : sampleSizes) {
+        appendBE(stsz, sampleSize, 4);
+    }
+    const auto makeMovieAtom = [&] (uint64 mediaDataOffset) {
+        string stco;
+        appendBE(stco, chunkCount, 4);
+        for(uint32 chunkIndex = 0; chunkIndex != chunkCount; ++chunkIndex) {
+            appendBE(stco, mediaDataOffset, 4);
+            for(uint32 sampleIndex = 0; sampleIndex != samplesPerChunk; ++sampleIndex) {
+                mediaDataOffset += sampleSizes[chunkIndex * samplesPerChunk + sampleIndex];
+            }
+        }
+        const string sampleTables = mp4FullAtom("stts", 0, stts) + mp4FullAtom("stsc", 0, stsc) + mp4FullAtom("stsz", 0, stsz) + mp4FullAtom("stco", 0, stco);
+        return mp4MovieAtom(sampleCount * sampleDuration, sampleTables, mp4TagAtom());
+    };
+    const string ftyp = mp4FileTypeAtom();
+    // padding allows applying changes in-place
+    const string padding = mp4Atom("free", string(0x1000, '\0'));
+    const uint64 moovSize = makeMovieAtom(0).size();
+    uint64 mediaDataSize = 0;
+    for(uint32 sampleSize : sampleSizes) {
+        mediaDataSize += sampleSize;
+    }
+
+    ofstream output;
+    openOutput(output, path);
+    output << ftyp << makeMovieAtom(ftyp.size() + moovSize + padding.size() + 8) << padding;
+    string mdatHeader;
+    appendBE(mdatHeader, mediaDataSize + 8, 4);
+    mdatHeader += "mdat";
+    output << mdatHeader;
+    string sample;
+    for(uint32 sampleSize : sampleSizes) {
+        sample.clear();
+        appendPayload(sample, sampleSize, random);
+        output << sample;
+    }
+}
+
+/*!
+ * \brief Creates a fragmented MP4 file with a single audio track and the specified number of movie fragments.
+ */
+void makeFragmentedMp4File(const string &path, uint32 fragmentCount)
+{
+    constexpr uint32 samplesPerFragment = 32, sampleSize = 512, sampleDuration = 1024;
+    Random random;
+    string emptyTable;
+    appendBE(emptyTable, 0, 4);
+    string emptySizeTable;
+    appendBE(emptySizeTable, 0, 8);
+    const string sampleTables = mp4FullAtom("stts", 0, emptyTable) + mp4FullAtom("stsc", 0, emptyTable)
+            + mp4FullAtom("stsz", 0, emptySizeTable) + mp4FullAtom("stco", 0, emptyTable);
+    string trex;
+    appendBE(trex, 1, 4); // track ID
+    appendBE(trex, 1, 4); // sample description index
+    appendBE(trex, sampleDuration, 4);
+    appendBE(trex, sampleSize, 4);
+    appendBE(trex, 0, 4); // sample flags
+
+    ofstream output;
+    openOutput(output, path);
+    output << mp4FileTypeAtom() << mp4MovieAtom(0, sampleTables, mp4Atom("mvex", mp4FullAtom("trex", 0, trex)) + mp4TagAtom());
+    for(uint32 fragmentIndex = 0; fragmentIndex != fragmentCount; ++fragmentIndex) {
+        string mfhd, tfhd;
+        appendBE(mfhd, fragmentIndex + 1, 4);
+        appendBE(tfhd, 1, 4); // track ID
+        appendBE(tfhd, sampleDuration, 4);
+        appendBE(tfhd, sampleSize, 4);
+        // the data offset of the run depends on the size of the "moof"-atom which has a constant size
+        const auto makeMovieFragment = [&] (uint32 dataOffset) {
+            string trun;
+            appendBE(trun, samplesPerFragment, 4);
+            appendBE(trun, dataOffset, 4);
+            return mp4Atom("moof", mp4FullAtom("mfhd", 0, mfhd) + mp4Atom("traf", mp4FullAtom("tfhd", 0x18, tfhd) + mp4FullAtom("trun", 0x1, trun)));
+        };
+        string mdat;
+        appendPayload(mdat, samplesPerFragment * sampleSize, random);
+        output << makeMovieFragment(static_cast<uint32>(makeMovieFragment(0).size() + 8)) << mp4Atom("mdat", mdat);
+    }
+}
+
+/*!
+ * \brief Creates an Ogg Vorbis file consisting of the header pages and the specified number of audio pages.
+ */
+void makeOggFile(const string &path, uint32 pageCount)
+{
+    constexpr uint32 packetsPerPage = 4, samplesPerPacket = 1024;
+    Random random;
+    string identification("\x01vorbis", 7);
+    appendLE(identification, 0, 4); // version
+    identification += '\x02'; // channels
+    appendLE(identification, 44100, 4);
+    appendLE(identification, 0, 4); // max. bitrate
+    appendLE(identification, 128000, 4); // nominal bitrate
+    appendLE(identification, 0, 4); // min. bitrate
+    identification += "\xB8\x01";
+    static const char vendor[] = "tagparser_bench", title[] = "TITLE=Synthetic benchmark file";
+    string comment("\x03vorbis", 7);
+    appendLE(comment, sizeof(vendor) - 1, 4);
+    comment += vendor;
+    appendLE(comment, 1, 4);
+    appendLE(comment, sizeof(title) - 1, 4);
+    comment += title;
+    comment += '\x01'; // framing
+    string setup("\x05vorbis", 7);
+    setup.append(32, '\0');
+
+    ofstream output;
+    openOutput(output, path);
+    uint32 sequenceNumber = 0;
+    writeOggPage(output, 0x02, 0, sequenceNumber++, {identification});
+    writeOggPage(output, 0x00, 0, sequenceNumber++, {comment, setup});
+    vector<string> packets(packetsPerPage);
+    for(uint32 pageIndex = 0; pageIndex != pageCount; ++pageIndex) {
+        for(string &packet : packets) {
+            packet.clear();
+            appendPayload(packet, random.next(100, 1000), random);
+        }
+        writeOggPage(output, pageIndex + 1 == pageCount ? 0x04 : 0x00, static_cast<uint64>(pageIndex + 1) * packetsPerPage * samplesPerPacket, sequenceNumber++, packets);
+    }
+}
+
+/*!
+ * \brief Creates a variable bitrate MP3 file with the specified number of frames and ID3v1 and ID3v2 tags.
+ * \param xingHeader Specifies whether the first frame is a Xing frame denoting the frame count and size.
+ */
+void makeMp3File(const string &path, uint32 frameCount, bool xingHeader)
+{
+    // MPEG-1 layer 3, 44.1 kHz, joint stereo
+    constexpr uint32 baseHeader = 0xFFFB0040u;
+    static const uint32 bitrates[] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+    const auto frameSize = [] (uint32 bitrateIndex) {
+        return 144000u * bitrates[bitrateIndex] / 44100u;
+    };
+    Random random;
+    vector<byte> bitrateIndices(frameCount);
+    uint64 audioSize = 0;
+    for(byte &bitrateIndex : bitrateIndices) {
+        audioSize += frameSize(bitrateIndex = static_cast<byte>(random.next(9, 14)));
+    }
+
+    ofstream output;
+    openOutput(output, path);
+    // ID3v2 tag with padding which allows applying changes in-place
+    static const char title[] = "Synthetic benchmark file";
+    string id3v2Frames("TIT2");
+    appendBE(id3v2Frames, sizeof(title), 4);
+    appendBE(id3v2Frames, 0, 2); // flags
+    id3v2Frames += '\0'; // encoding
+    id3v2Frames += title;
+    id3v2Frames.append(0x1000, '\0');
+    string id3v2Header("ID3\x03\x00\x00", 6);
+    // synchsafe size
+    const auto id3v2Size = static_cast<uint32>(id3v2Frames.size());
+    for(int shift = 21; shift >= 0; shift -= 7) {
+        id3v2Header += static_cast<char>((id3v2Size >> shift) & 0x7F);
+    }
+    output << id3v2Header << id3v2Frames;
+    // frames
+    string frame;
+    if(xingHeader) {
+        appendBE(frame, baseHeader | (9u << 12), 4);
+        frame.append(32, '\0'); // side information
+        frame += "Xing";
+        appendBE(frame, 0x3, 4); // frames and bytes field present
+        appendBE(frame, frameCount, 4);
+        appendBE(frame, audioSize + frameSize(9), 4);
+        frame.resize(frameSize(9), '\0');
+        output << frame;
+    }
+    for(byte bitrateIndex : bitrateIndices) {
+        frame.clear();
+        appendBE(frame, baseHeader | (static_cast<uint32>(bitrateIndex) << 12), 4);
+        appendPayload(frame, frameSize(bitrateIndex) - 4, random);
+        output << frame;
+    }
+    // ID3v1 tag
+    string id3v1("TAG");
+    id3v1 += title;
+    id3v1.resize(128, '\0');
+    output << id3v1;
+}
+
+/*!
+ * \brief Creates a FLAC file with a Vorbis comment, padding and the specified number of (meaningless) frames.
+ */
+void makeFlacFile(const string &path, uint32 frameCount)
+{
+    constexpr uint32 blockSize = 4096;
+    Random random;
+    string streamInfo;
+    appendBE(streamInfo, blockSize, 2); // min. block size
+    appendBE(streamInfo, blockSize, 2); // max. block size
+    appendBE(streamInfo, 0, 6); // min./max. frame size (unknown)
+    // sampling frequency (20 bit), channels - 1 (3 bit), bits per sample - 1 (5 bit), total samples (36 bit)
+    appendBE(streamInfo, (44100ull << 44) | (1ull << 41) | (15ull << 36) | (static_cast<uint64>(frameCount) * blockSize), 8);
+    streamInfo.append(16, '\0'); // MD5 sum
+    static const char vendor[] = "tagparser_bench", title[] = "TITLE=Synthetic benchmark file";
+    string vorbisComment;
+    appendLE(vorbisComment, sizeof(vendor) - 1, 4);
+    vorbisComment += vendor;
+    appendLE(vorbisComment, 1, 4);
+    appendLE(vorbisComment, sizeof(title) - 1, 4);
+    vorbisComment += title;
+
+    ofstream output;
+    openOutput(output, path);
+    string metadata("fLaC");
+    for(const auto &block : {make_pair(0x00, streamInfo), make_pair(0x04, vorbisComment), make_pair(0x81, string(0x1000, '\0'))}) {
+        metadata += static_cast<char>(block.first);
+        appendBE(metadata, block.second.size(), 3);
+        metadata += block.second;
+    }
+    output << metadata;
+    string frame;
+    for(uint32 frameIndex = 0; frameIndex != frameCount; ++frameIndex) {
+        frame.assign("\xFF\xF8", 2);
+        appendPayload(frame, random.next(1000, 3000), random);
+        output << frame;
+    }
+}
+
+}
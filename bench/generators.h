@@ -0,0 +1,25 @@
+#ifndef TAGPARSER_BENCH_GENERATORS_H
+#define TAGPARSER_BENCH_GENERATORS_H
+
+#include <c++utilities/conversion/types.h>
+
+#include <string>
+
+/*!
+ * \brief Contains functions to create synthetic media files for benchmarking.
+ *
+ * The files are generated deterministically so results of different runs are comparable. The
+ * media data itself is meaningless; only the structures relevant for the parser are valid.
+ */
+namespace Generators {
+
+void makeMatroskaFile(const std::string &path, uint32 clusterCount);
+void makeMp4File(const std::string &path, uint32 sampleCount);
+void makeFragmentedMp4File(const std::string &path, uint32 fragmentCount);
+void makeOggFile(const std::string &path, uint32 pageCount);
+void makeMp3File(const std::string &path, uint32 frameCount, bool xingHeader);
+void makeFlacFile(const std::string &path, uint32 frameCount);
+
+}
+
+#endif // TAGPARSER_BENCH_GENERATORS_H
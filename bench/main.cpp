@@ -0,0 +1,306 @@
+#include "./generators.h"
+
+#include "../copyengine.h"
+#include "../mediafileinfo.h"
+#include "../tag.h"
+#include "../tagvalue.h"
+#include "../ogg/oggpage.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using namespace Media;
+
+/*!
+ * \file bench/main.cpp
+ * \brief Runs microbenchmarks against synthetic files and prints one JSON object per result line.
+ *
+ * Usage: tagparser_bench [--dir <directory>] [--scale <factor>] [--iterations <count>] [--filter <substring>] [--keep]
+ */
+
+namespace {
+
+atomic<uint64> allocationCount(0);
+
+struct Options
+{
+    string directory = ".";
+    uint32 scale = 1;
+    unsigned int iterations = 5;
+    string filter;
+    bool keepFiles = false;
+    bool help = false;
+};
+
+struct TestFile
+{
+    string subject;
+    string path;
+    uint64 size;
+};
+
+string escapeJson(const string &value)
+{
+    string escaped;
+    for(char c : value) {
+        switch(c) {
+        case '"': escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+uint64 fileSize(const string &path)
+{
+    ifstream file(path, ios_base::in | ios_base::binary | ios_base::ate);
+    return static_cast<uint64>(file.tellg());
+}
+
+void copyFile(const string &from, const string &to)
+{
+    ifstream input(from, ios_base::in | ios_base::binary);
+    ofstream output(to, ios_base::out | ios_base::binary | ios_base::trunc);
+    output << input.rdbuf();
+}
+
+/*!
+ * \brief Runs \a run options.iterations times (calling \a prepare before each iteration without
+ *        measuring it) and prints the results.
+ * \param bytes Specifies the number of bytes processed per iteration to compute the throughput.
+ */
+template<typename Prepare, typename Run>
+void measure(const Options &options, const char *benchmark, const string &subject, uint64 bytes, Prepare prepare, Run run)
+{
+    if(!options.filter.empty() && (benchmark + ('/' + subject)).find(options.filter) == string::npos) {
+        return;
+    }
+    cout << "{\"benchmark\":\"" << benchmark << "\",\"subject\":\"" << escapeJson(subject) << '"';
+    double seconds = 0.0;
+    uint64 allocations = 0;
+    try {
+        for(unsigned int iteration = 0; iteration != options.iterations; ++iteration) {
+            prepare();
+            const uint64 allocationsBefore = allocationCount.load(memory_order_relaxed);
+            const auto start = steady_clock::now();
+            run();
+            seconds += duration<double>(steady_clock::now() - start).count();
+            allocations += allocationCount.load(memory_order_relaxed) - allocationsBefore;
+        }
+    } catch(const exception &e) {
+        cout << ",\"error\":\"" << escapeJson(e.what()) << "\"}" << endl;
+        return;
+    } catch(...) {
+        cout << ",\"error\":\"unknown\"}" << endl;
+        return;
+    }
+    const double secondsPerIteration = seconds / options.iterations;
+    cout << ",\"iterations\":" << options.iterations
+         << ",\"seconds_per_iteration\":" << secondsPerIteration
+         << ",\"bytes_per_iteration\":" << bytes
+         << ",\"mib_per_second\":" << (secondsPerIteration > 0.0 ? bytes / secondsPerIteration / 0x100000 : 0.0)
+         << ",\"allocations_per_iteration\":" << allocations / options.iterations
+         << '}' << endl;
+}
+
+void applyChanges(const string &path, bool forceRewrite)
+{
+    MediaFileInfo file(path);
+    file.open();
+    file.setForceRewrite(forceRewrite);
+    file.setMaxPadding(0x10000);
+    file.setPreferredPadding(0x1000);
+    file.parseEverything();
+    file.createAppropriateTags();
+    for(Tag *tag : file.tags()) {
+        tag->setValue(KnownField::Title, TagValue(string("Changed title"), TagTextEncoding::Utf8));
+    }
+    file.applyChanges();
+}
+
+void runParserBenchmarks(const Options &options, const TestFile &testFile)
+{
+    const auto nothing = [] {};
+    measure(options, "parseContainerFormat", testFile.subject, testFile.size, nothing, [&testFile] {
+        MediaFileInfo file(testFile.path);
+        file.open(true);
+        file.parseContainerFormat();
+    });
+    measure(options, "parseEverything", testFile.subject, testFile.size, nothing, [&testFile] {
+        MediaFileInfo file(testFile.path);
+        file.open(true);
+        file.parseEverything();
+    });
+    const string workingCopy = testFile.path + ".work";
+    const auto makeWorkingCopy = [&testFile, &workingCopy] {
+        copyFile(testFile.path, workingCopy);
+    };
+    measure(options, "applyChangesInPlace", testFile.subject, testFile.size, makeWorkingCopy, [&workingCopy] {
+        applyChanges(workingCopy, false);
+    });
+    measure(options, "applyChangesRewrite", testFile.subject, testFile.size, makeWorkingCopy, [&workingCopy] {
+        applyChanges(workingCopy, true);
+    });
+    remove(workingCopy.c_str());
+    remove((workingCopy + ".bak").c_str());
+}
+
+void runKernelBenchmarks(const Options &options, const TestFile &biggestFile)
+{
+    // checksum of Ogg pages
+    vector<char> buffer(0x1000000);
+    uint32 state = 0x5EED;
+    for(char &c : buffer) {
+        c = static_cast<char>((state = state * 1103515245u + 12345u) >> 24);
+    }
+    volatile uint32 checksum = 0;
+    measure(options, "oggChecksum", "16 MiB buffer", buffer.size(), [] {}, [&buffer, &checksum] {
+        checksum = OggPage::computeChecksum(buffer.data(), static_cast<uint32>(buffer.size()));
+    });
+
+    // copying media data when rewriting files
+    const string copyPath = biggestFile.path + ".copy";
+    measure(options, "copyStreams", biggestFile.subject, biggestFile.size, [] {}, [&biggestFile, &copyPath] {
+        ifstream input(biggestFile.path, ios_base::in | ios_base::binary);
+        ofstream output(copyPath, ios_base::out | ios_base::binary | ios_base::trunc);
+        CopyEngine().copy(input, output, biggestFile.size);
+    });
+    measure(options, "copyFiles", biggestFile.subject, biggestFile.size, [] {}, [&biggestFile, &copyPath] {
+        ifstream input(biggestFile.path, ios_base::in | ios_base::binary);
+        ofstream output(copyPath, ios_base::out | ios_base::binary | ios_base::trunc);
+        FileCopyEngine(biggestFile.path, copyPath).copy(input, output, biggestFile.size);
+    });
+    remove(copyPath.c_str());
+}
+
+bool parseArgs(int argc, char *argv[], Options &options)
+{
+    for(int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if(!strcmp(argv[i], "--dir") && hasValue) {
+            options.directory = argv[++i];
+        } else if(!strcmp(argv[i], "--scale") && hasValue) {
+            options.scale = static_cast<uint32>(strtoul(argv[++i], nullptr, 10));
+        } else if(!strcmp(argv[i], "--iterations") && hasValue) {
+            options.iterations = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if(!strcmp(argv[i], "--filter") && hasValue) {
+            options.filter = argv[++i];
+        } else if(!strcmp(argv[i], "--keep")) {
+            options.keepFiles = true;
+        } else if(!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            options.help = true;
+        } else {
+            return false;
+        }
+    }
+    return options.scale && options.iterations;
+}
+
+void printUsage(ostream &stream, const char *appName)
+{
+    stream << "Usage: " << appName << " [--dir <directory>] [--scale <factor>] [--iterations <count>] [--filter <substring>] [--keep] [--help]" << endl;
+}
+
+}
+
+// count allocations of the whole process (including the library)
+
+void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if(void *pointer = malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if(!parseArgs(argc, argv, options)) {
+        printUsage(cerr, argv[0]);
+        return 1;
+    }
+    if(options.help) {
+        printUsage(cout, argv[0]);
+        return 0;
+    }
+
+    // generate test files
+    vector<TestFile> testFiles;
+    const auto generate = [&options, &testFiles] (const char *subject, const char *fileName, const function<void(const string &)> &generator) {
+        const string path = options.directory + '/' + fileName;
+        cerr << "Generating " << path << " ..." << endl;
+        generator(path);
+        testFiles.emplace_back(TestFile{subject, path, fileSize(path)});
+    };
+    const uint32 scale = options.scale;
+    try {
+        generate("mkv", "bench-clusters.mkv", [scale] (const string &path) { Generators::makeMatroskaFile(path, scale * 4000); });
+        generate("mp4", "bench-tables.mp4", [scale] (const string &path) { Generators::makeMp4File(path, scale * 100000); });
+        generate("mp4 fragmented", "bench-fragmented.mp4", [scale] (const string &path) { Generators::makeFragmentedMp4File(path, scale * 2000); });
+        generate("ogg", "bench-pages.ogg", [scale] (const string &path) { Generators::makeOggFile(path, scale * 20000); });
+        generate("mp3 vbr", "bench-vbr.mp3", [scale] (const string &path) { Generators::makeMp3File(path, scale * 20000, false); });
+        generate("mp3 vbr xing", "bench-xing.mp3", [scale] (const string &path) { Generators::makeMp3File(path, scale * 20000, true); });
+        generate("flac", "bench-frames.flac", [scale] (const string &path) { Generators::makeFlacFile(path, scale * 5000); });
+    } catch(const exception &e) {
+        cerr << "Unable to generate test files: " << e.what() << endl;
+        return 2;
+    }
+
+    // run benchmarks
+    const TestFile *biggestFile = &testFiles.front();
+    for(const TestFile &testFile : testFiles) {
+        runParserBenchmarks(options, testFile);
+        if(testFile.size > biggestFile->size) {
+            biggestFile = &testFile;
+        }
+    }
+    runKernelBenchmarks(options, *biggestFile);
+
+    if(!options.keepFiles) {
+        for(const TestFile &testFile : testFiles) {
+            remove(testFile.path.c_str());
+        }
+    }
+    return 0;
+}
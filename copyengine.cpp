@@ -0,0 +1,196 @@
+#include "./copyengine.h"
+
+#include <c++utilities/io/catchiofailure.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#ifdef PLATFORM_UNIX
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+#ifdef PLATFORM_LINUX
+# include <cerrno>
+# include <sys/sendfile.h>
+#endif
+
+using namespace std;
+using namespace IoUtilities;
+
+namespace Media {
+
+/*!
+ * \class Media::CopyEngine
+ * \brief The CopyEngine class copies data between streams when writing files.
+ *
+ * The default implementation copies the data using a buffer in user space. Subclasses might
+ * implement more efficient ways to copy the data. A copy engine can be assigned to a container
+ * using AbstractContainer::setCopyEngine() to be used by GenericFileElement::copyEntirely() and
+ * similar methods. The container implementations assign a FileCopyEngine when rewriting a file.
+ */
+
+/*!
+ * \brief Constructs a new copy engine.
+ */
+CopyEngine::CopyEngine()
+{}
+
+/*!
+ * \brief Destroys the copy engine.
+ */
+CopyEngine::~CopyEngine()
+{}
+
+/*!
+ * \brief Copies \a count bytes from the current position of \a input to the current position of \a output.
+ *
+ * The copying is aborted when \a isAborted returns true (the stream positions are undefined in this case).
+ * The progress (a value between 0 and 1) is reported via \a progress.
+ *
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void CopyEngine::copy(istream &input, ostream &output, uint64 count, const AbortCallback &isAborted, const ProgressCallback &progress)
+{
+    const auto bufferSize = static_cast<size_t>(min<uint64>(count, 0x100000));
+    const auto buffer = make_unique<char[]>(bufferSize);
+    for(uint64 remaining = count; remaining; ) {
+        if(isAborted && isAborted()) {
+            return;
+        }
+        const auto chunkSize = static_cast<streamsize>(min<uint64>(remaining, bufferSize));
+        input.read(buffer.get(), chunkSize);
+        output.write(buffer.get(), chunkSize);
+        remaining -= static_cast<uint64>(chunkSize);
+        if(progress) {
+            progress(static_cast<double>(count - remaining) / count);
+        }
+    }
+}
+
+/*!
+ * \class Media::FileCopyEngine
+ * \brief The FileCopyEngine class copies data between two files within the kernel.
+ *
+ * The files are opened (again) using the specified paths. Under Linux, copy_file_range() is used
+ * which allows the file system to share the data (reflinks) or to copy it on the server side.
+ * If copy_file_range() is not supported for the files or not provided by the C library (checked
+ * when configuring the build, see HAVE_COPY_FILE_RANGE), sendfile() is used. On other platforms
+ * or if neither is supported, the data is copied using a buffer in user space (see CopyEngine).
+ *
+ * \remarks
+ * - The streams passed to copy() must refer to the files specified when constructing the engine.
+ * - The output stream is flushed before copying and the positions of both streams are updated
+ *   after copying so mixing the engine with regular stream IO is fine.
+ * - Copies smaller than minKernelCopySize are done in user space because the additional flushing
+ *   and system calls would outweigh the benefit.
+ */
+
+/*!
+ * \brief Constructs a new engine for copying data from the file at \a inputPath to the file at \a outputPath.
+ * \remarks The output file must already exist. If a file can not be opened, the engine falls back to copying in user space.
+ */
+FileCopyEngine::FileCopyEngine(const string &inputPath, const string &outputPath) :
+    m_inputFd(-1),
+    m_outputFd(-1),
+    m_copyFileRangeSupported(false),
+    m_sendfileSupported(false)
+{
+#ifdef PLATFORM_LINUX
+    if((m_inputFd = open(inputPath.data(), O_RDONLY | O_CLOEXEC)) >= 0
+            && (m_outputFd = open(outputPath.data(), O_WRONLY | O_CLOEXEC)) >= 0) {
+#ifdef HAVE_COPY_FILE_RANGE
+        m_copyFileRangeSupported = true;
+#endif
+        m_sendfileSupported = true;
+    }
+#else
+    VAR_UNUSED(inputPath)
+    VAR_UNUSED(outputPath)
+#endif
+}
+
+/*!
+ * \brief Closes the files opened by the engine.
+ */
+FileCopyEngine::~FileCopyEngine()
+{
+#ifdef PLATFORM_UNIX
+    if(m_inputFd >= 0) {
+        close(m_inputFd);
+    }
+    if(m_outputFd >= 0) {
+        close(m_outputFd);
+    }
+#endif
+}
+
+/*!
+ * \brief Copies \a count bytes from the current position of \a input to the current position of \a output.
+ * \sa CopyEngine::copy()
+ */
+void FileCopyEngine::copy(istream &input, ostream &output, uint64 count, const AbortCallback &isAborted, const ProgressCallback &progress)
+{
+    if(count < minKernelCopySize || !isKernelCopyAvailable()) {
+        CopyEngine::copy(input, output, count, isAborted, progress);
+        return;
+    }
+#ifdef PLATFORM_LINUX
+    // write pending data so the file descriptor sees the same contents as the stream
+    output.flush();
+    loff_t inputOffset = static_cast<loff_t>(input.tellg());
+    loff_t outputOffset = static_cast<loff_t>(output.tellp());
+    for(uint64 remaining = count; remaining; ) {
+        if(isAborted && isAborted()) {
+            return;
+        }
+        const auto chunkSize = static_cast<size_t>(min<uint64>(remaining, 0x4000000));
+        ssize_t copied;
+#ifdef HAVE_COPY_FILE_RANGE
+        if(m_copyFileRangeSupported) {
+            if((copied = copy_file_range(m_inputFd, &inputOffset, m_outputFd, &outputOffset, chunkSize, 0)) < 0) {
+                if(errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP) {
+                    // not supported for these files -> try next method
+                    m_copyFileRangeSupported = false;
+                    continue;
+                }
+                throwIoFailure("copy_file_range() failed");
+            }
+        } else
+#endif
+        if(m_sendfileSupported) {
+            if(lseek(m_outputFd, outputOffset, SEEK_SET) < 0) {
+                throwIoFailure("lseek() failed");
+            }
+            if((copied = sendfile(m_outputFd, m_inputFd, &inputOffset, chunkSize)) < 0) {
+                if(errno == ENOSYS || errno == EINVAL) {
+                    // not supported for these files -> copy remaining data in user space
+                    m_sendfileSupported = false;
+                    continue;
+                }
+                throwIoFailure("sendfile() failed");
+            }
+            outputOffset += copied;
+        } else {
+            input.seekg(inputOffset);
+            output.seekp(outputOffset);
+            CopyEngine::copy(input, output, remaining, isAborted, progress ? [&progress, count, remaining] (double percentage) {
+                progress(static_cast<double>(count - remaining + percentage * remaining) / count);
+            } : ProgressCallback());
+            return;
+        }
+        if(!copied) {
+            throwIoFailure("unexpected end of file");
+        }
+        remaining -= static_cast<uint64>(copied);
+        if(progress) {
+            progress(static_cast<double>(count - remaining) / count);
+        }
+    }
+    // update stream positions (also discards data read ahead by the stream buffers)
+    input.seekg(inputOffset);
+    output.seekp(outputOffset);
+#endif
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef MEDIA_COPYENGINE_H
+#define MEDIA_COPYENGINE_H
+
+#include "./global.h"
+
+#include <c++utilities/conversion/types.h>
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+namespace Media {
+
+class TAG_PARSER_EXPORT CopyEngine
+{
+public:
+    typedef std::function<bool (void)> AbortCallback;
+    typedef std::function<void (double percentage)> ProgressCallback;
+
+    CopyEngine();
+    virtual ~CopyEngine();
+
+    virtual void copy(std::istream &input, std::ostream &output, uint64 count, const AbortCallback &isAborted = AbortCallback(), const ProgressCallback &progress = ProgressCallback());
+};
+
+class TAG_PARSER_EXPORT FileCopyEngine : public CopyEngine
+{
+public:
+    FileCopyEngine(const std::string &inputPath, const std::string &outputPath);
+    ~FileCopyEngine();
+
+    bool isKernelCopyAvailable() const;
+    void copy(std::istream &input, std::ostream &output, uint64 count, const AbortCallback &isAborted = AbortCallback(), const ProgressCallback &progress = ProgressCallback());
+
+    static constexpr uint64 minKernelCopySize = 0x10000;
+
+private:
+    int m_inputFd;
+    int m_outputFd;
+    bool m_copyFileRangeSupported;
+    bool m_sendfileSupported;
+};
+
+/*!
+ * \brief Returns whether the data can be copied within the kernel (as opposed to
+ *        using a buffer in user space).
+ */
+inline bool FileCopyEngine::isKernelCopyAvailable() const
+{
+    return m_inputFd >= 0 && m_outputFd >= 0 && (m_copyFileRangeSupported || m_sendfileSupported);
+}
+
+}
+
+#endif // MEDIA_COPYENGINE_H
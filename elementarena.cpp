@@ -0,0 +1,114 @@
+#include "./elementarena.h"
+#include "./metrics.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace Media {
+
+/*!
+ * \class Media::ElementArena
+ * \brief The ElementArena class provides pooled memory for the elements of a container.
+ *
+ * Memory is taken from blocks of blockSize bytes using a simple bump pointer. Deallocated
+ * memory is kept in a free list per slot size and reused by subsequent allocations of the
+ * same size. The blocks themselves are only given back by release() which frees everything
+ * at once.
+ *
+ * This avoids a separate heap allocation for each element when parsing files with a lot of
+ * elements (eg. Matroska files with many clusters or MP4 files with many atoms).
+ *
+ * \remarks The arena is not thread-safe.
+ */
+
+/*!
+ * \brief Returns the size of the slot used for allocations of the specified \a size.
+ */
+size_t ElementArena::slotSize(size_t size)
+{
+    static constexpr size_t alignment = alignof(max_align_t);
+    size = max(size, sizeof(void *));
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/*!
+ * \brief Allocates \a size bytes.
+ * \remarks The memory must be given back using deallocate() with the same \a size.
+ * \throws Throws std::bad_alloc if no memory could be allocated.
+ */
+void *ElementArena::allocate(size_t size)
+{
+    size = slotSize(size);
+    // reuse previously deallocated slot
+    for(FreeList &freeList : m_freeLists) {
+        if(freeList.size == size) {
+            if(void *slot = freeList.head) {
+                freeList.head = *reinterpret_cast<void **>(slot);
+                ++m_liveCount;
+                return slot;
+            }
+            break;
+        }
+    }
+    // take slot from the current block or a new block
+    if(size > m_remaining) {
+        const size_t newBlockSize = size > blockSize ? size : blockSize;
+        m_blocks.emplace_back(new char[newBlockSize]);
+        IoCounters::countAllocation();
+        m_reservedSize += newBlockSize;
+        if(size == newBlockSize) {
+            // don't discard the rest of the current block for oversized allocations
+            ++m_liveCount;
+            return m_blocks.back().get();
+        }
+        m_current = m_blocks.back().get();
+        m_remaining = newBlockSize;
+    }
+    void *slot = m_current;
+    m_current += size;
+    m_remaining -= size;
+    ++m_liveCount;
+    return slot;
+}
+
+/*!
+ * \brief Gives back the memory at \a pointer which has been allocated using allocate() with the specified \a size.
+ * \remarks The memory is not freed before release() is called but reused by subsequent allocations.
+ */
+void ElementArena::deallocate(void *pointer, size_t size)
+{
+    if(!pointer) {
+        return;
+    }
+    size = slotSize(size);
+    auto freeList = find_if(m_freeLists.begin(), m_freeLists.end(), [size] (const FreeList &candidate) {
+        return candidate.size == size;
+    });
+    if(freeList == m_freeLists.end()) {
+        m_freeLists.emplace_back(FreeList{size, nullptr});
+        freeList = m_freeLists.end() - 1;
+    }
+    *reinterpret_cast<void **>(pointer) = freeList->head;
+    freeList->head = pointer;
+    --m_liveCount;
+}
+
+/*!
+ * \brief Frees all memory reserved by the arena at once.
+ * \returns Returns whether the memory has been freed. This is only the case if there are no live allocations.
+ */
+bool ElementArena::release()
+{
+    if(m_liveCount) {
+        return false;
+    }
+    m_blocks.clear();
+    m_freeLists.clear();
+    m_current = nullptr;
+    m_remaining = 0;
+    m_reservedSize = 0;
+    return true;
+}
+
+}
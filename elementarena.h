@@ -0,0 +1,103 @@
+#ifndef MEDIA_ELEMENTARENA_H
+#define MEDIA_ELEMENTARENA_H
+
+#include "./global.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Media {
+
+class TAG_PARSER_EXPORT ElementArena
+{
+public:
+    ElementArena();
+    ElementArena(const ElementArena &) = delete;
+    ElementArena &operator=(const ElementArena &) = delete;
+
+    void *allocate(std::size_t size);
+    void deallocate(void *pointer, std::size_t size);
+    template<typename ObjectType, typename... Args> ObjectType *create(Args &&... args);
+    template<typename ObjectType> void destroy(ObjectType *object);
+    std::size_t liveCount() const;
+    std::size_t reservedSize() const;
+    bool release();
+
+    static constexpr std::size_t blockSize = 0x10000;
+
+private:
+    struct FreeList
+    {
+        std::size_t size;
+        void *head;
+    };
+
+    static std::size_t slotSize(std::size_t size);
+
+    std::vector<std::unique_ptr<char[]> > m_blocks;
+    std::vector<FreeList> m_freeLists;
+    char *m_current;
+    std::size_t m_remaining;
+    std::size_t m_reservedSize;
+    std::size_t m_liveCount;
+};
+
+/*!
+ * \brief Constructs an empty arena.
+ * \remarks No memory is reserved until the first allocation.
+ */
+inline ElementArena::ElementArena() :
+    m_current(nullptr),
+    m_remaining(0),
+    m_reservedSize(0),
+    m_liveCount(0)
+{}
+
+/*!
+ * \brief Allocates memory for an \a ObjectType and constructs it using the specified \a args.
+ * \remarks The object must be destroyed using destroy().
+ */
+template<typename ObjectType, typename... Args>
+ObjectType *ElementArena::create(Args &&... args)
+{
+    void *memory = allocate(sizeof(ObjectType));
+    try {
+        return new(memory) ObjectType(std::forward<Args>(args)...);
+    } catch(...) {
+        deallocate(memory, sizeof(ObjectType));
+        throw;
+    }
+}
+
+/*!
+ * \brief Destroys the specified \a object which must have been created using create().
+ */
+template<typename ObjectType>
+void ElementArena::destroy(ObjectType *object)
+{
+    object->~ObjectType();
+    deallocate(object, sizeof(ObjectType));
+}
+
+/*!
+ * \brief Returns the number of allocations which have not been deallocated yet.
+ */
+inline std::size_t ElementArena::liveCount() const
+{
+    return m_liveCount;
+}
+
+/*!
+ * \brief Returns the number of bytes currently reserved by the arena.
+ */
+inline std::size_t ElementArena::reservedSize() const
+{
+    return m_reservedSize;
+}
+
+}
+
+#endif // MEDIA_ELEMENTARENA_H
@@ -2,16 +2,37 @@
 #define FIELDBASEDTAG_H
 
 #include "./tag.h"
+#include "./flatmultimap.h"
 
+#include <algorithm>
 #include <map>
 #include <functional>
+#include <vector>
 
 namespace Media {
 
+/*!
+ * \brief The FlatFieldStorage struct specifies that FieldMapBasedTag stores its fields using FlatMultiMap.
+ */
+struct FlatFieldStorage
+{
+    template <class Key, class Value, class Compare>
+    using type = FlatMultiMap<Key, Value, Compare>;
+};
+
+/*!
+ * \brief The MultiMapFieldStorage struct specifies that FieldMapBasedTag stores its fields using std::multimap.
+ */
+struct MultiMapFieldStorage
+{
+    template <class Key, class Value, class Compare>
+    using type = std::multimap<Key, Value, Compare>;
+};
+
 /*!
  * \class Media::FieldMapBasedTag
  * \brief The FieldMapBasedTag provides a generic implementation of Tag which stores
- *        the tag fields using std::multimap.
+ *        the tag fields in a sorted multimap.
  *
  * The FieldMapBasedTag class only provides the interface and common functionality.
  * It is meant to be subclassed.
@@ -20,11 +41,17 @@ namespace Media {
  *                   of TagField.
  *
  * \tparam Compare Specifies the key comparsion function. Default is std::less.
+ *
+ * \tparam Storage Specifies how the fields are stored. Default is FlatFieldStorage which stores the fields
+ *                 contiguously (see FlatMultiMap). MultiMapFieldStorage uses std::multimap instead which keeps
+ *                 iterators and references to fields valid when inserting other fields.
  */
-template <class FieldType, class Compare = std::less<typename FieldType::identifierType> >
+template <class FieldType, class Compare = std::less<typename FieldType::identifierType>, class Storage = FlatFieldStorage>
 class FieldMapBasedTag : public Tag
 {
 public:
+    typedef typename Storage::template type<typename FieldType::identifierType, FieldType, Compare> FieldMap;
+
     FieldMapBasedTag();
 
     virtual const TagValue &value(const typename FieldType::identifierType &id) const; // FIXME: use static polymorphism
@@ -38,21 +65,24 @@ public:
     bool hasField(KnownField field) const;
     virtual bool hasField(const typename FieldType::identifierType &id) const; // FIXME: use static polymorphism
     void removeAllFields();
-    const std::multimap<typename FieldType::identifierType, FieldType, Compare> &fields() const;
-    std::multimap<typename FieldType::identifierType, FieldType, Compare> &fields();
+    const FieldMap &fields() const;
+    FieldMap &fields();
     unsigned int fieldCount() const;
     virtual typename FieldType::identifierType fieldId(KnownField value) const = 0; // FIXME: use static polymorphism
     virtual KnownField knownField(const typename FieldType::identifierType &id) const = 0; // FIXME: use static polymorphism
     bool supportsField(KnownField field) const;
     using Tag::proposedDataType;
     virtual TagDataType proposedDataType(const typename FieldType::identifierType &id) const; // FIXME: use static polymorphism
-    int insertFields(const FieldMapBasedTag<FieldType, Compare> &from, bool overwrite);
+    int insertFields(const FieldMapBasedTag<FieldType, Compare, Storage> &from, bool overwrite);
     unsigned int insertValues(const Tag &from, bool overwrite);
     void ensureTextValuesAreProperlyEncoded();
     typedef FieldType fieldType;
 
+protected:
+    void insertSkippedFields(std::vector<FieldType> &skippedFields);
+
 private:
-    std::multimap<typename FieldType::identifierType, FieldType, Compare> m_fields;
+    FieldMap m_fields;
 };
 
 /*!
@@ -72,23 +102,23 @@ private:
 /*!
  * \brief Constructs a new FieldMapBasedTag.
  */
-template <class FieldType, class Compare>
-FieldMapBasedTag<FieldType, Compare>::FieldMapBasedTag()
+template <class FieldType, class Compare, class Storage>
+FieldMapBasedTag<FieldType, Compare, Storage>::FieldMapBasedTag()
 {}
 
 /*!
  * \brief Returns the value of the field with the specified \a id.
  * \sa Tag::value()
  */
-template <class FieldType, class Compare>
-inline const TagValue &FieldMapBasedTag<FieldType, Compare>::value(const typename FieldType::identifierType &id) const
+template <class FieldType, class Compare, class Storage>
+inline const TagValue &FieldMapBasedTag<FieldType, Compare, Storage>::value(const typename FieldType::identifierType &id) const
 {
     auto i = m_fields.find(id);
     return i != m_fields.end() ? i->second.value() : TagValue::empty();
 }
 
-template <class FieldType, class Compare>
-inline const TagValue &FieldMapBasedTag<FieldType, Compare>::value(KnownField field) const
+template <class FieldType, class Compare, class Storage>
+inline const TagValue &FieldMapBasedTag<FieldType, Compare, Storage>::value(KnownField field) const
 {
     return value(fieldId(field));
 }
@@ -97,8 +127,8 @@ inline const TagValue &FieldMapBasedTag<FieldType, Compare>::value(KnownField fi
  * \brief Returns the values of the field with the specified \a id.
  * \sa Tag::values()
  */
-template <class FieldType, class Compare>
-inline std::vector<const TagValue *> FieldMapBasedTag<FieldType, Compare>::values(const typename FieldType::identifierType &id) const
+template <class FieldType, class Compare, class Storage>
+inline std::vector<const TagValue *> FieldMapBasedTag<FieldType, Compare, Storage>::values(const typename FieldType::identifierType &id) const
 {
     auto range = m_fields.equal_range(id);
     std::vector<const TagValue *> values;
@@ -110,14 +140,14 @@ inline std::vector<const TagValue *> FieldMapBasedTag<FieldType, Compare>::value
     return values;
 }
 
-template <class FieldType, class Compare>
-inline std::vector<const TagValue *> FieldMapBasedTag<FieldType, Compare>::values(KnownField field) const
+template <class FieldType, class Compare, class Storage>
+inline std::vector<const TagValue *> FieldMapBasedTag<FieldType, Compare, Storage>::values(KnownField field) const
 {
     return values(fieldId(field));
 }
 
-template <class FieldType, class Compare>
-inline bool FieldMapBasedTag<FieldType, Compare>::setValue(KnownField field, const TagValue &value)
+template <class FieldType, class Compare, class Storage>
+inline bool FieldMapBasedTag<FieldType, Compare, Storage>::setValue(KnownField field, const TagValue &value)
 {
     return setValue(fieldId(field), value);
 }
@@ -126,8 +156,8 @@ inline bool FieldMapBasedTag<FieldType, Compare>::setValue(KnownField field, con
  * \brief Assigns the given \a value to the field with the specified \a id.
  * \sa Tag::setValue()
  */
-template <class FieldType, class Compare>
-bool FieldMapBasedTag<FieldType, Compare>::setValue(const typename FieldType::identifierType &id, const Media::TagValue &value)
+template <class FieldType, class Compare, class Storage>
+bool FieldMapBasedTag<FieldType, Compare, Storage>::setValue(const typename FieldType::identifierType &id, const Media::TagValue &value)
 {
     auto i = m_fields.find(id);
     if(i != m_fields.end()) { // field already exists -> set its value
@@ -146,8 +176,8 @@ bool FieldMapBasedTag<FieldType, Compare>::setValue(const typename FieldType::id
  *          method will replace all currently assigned values with the specified \a values.
  * \sa Tag::setValues()
  */
-template <class FieldType, class Compare>
-bool FieldMapBasedTag<FieldType, Compare>::setValues(const typename FieldType::identifierType &id, const std::vector<TagValue> &values)
+template <class FieldType, class Compare, class Storage>
+bool FieldMapBasedTag<FieldType, Compare, Storage>::setValues(const typename FieldType::identifierType &id, const std::vector<TagValue> &values)
 {
     auto valuesIterator = values.cbegin();
     auto range = m_fields.equal_range(id);
@@ -159,14 +189,15 @@ bool FieldMapBasedTag<FieldType, Compare>::setValues(const typename FieldType::i
             ++range.first;
         }
     }
-    // add remaining specified values (there are more specified values than existing ones)
-    for(; valuesIterator != values.cend(); ++valuesIterator) {
-        m_fields.insert(std::make_pair(id, FieldType(id, *valuesIterator)));
-    }
     // remove remaining existing values (there are more existing values than specified ones)
     for(; range.first != range.second; ++range.first) {
         range.first->second.setValue(TagValue());
     }
+    // add remaining specified values (there are more specified values than existing ones)
+    // note: inserting might invalidate the iterators of range
+    for(; valuesIterator != values.cend(); ++valuesIterator) {
+        m_fields.insert(std::make_pair(id, FieldType(id, *valuesIterator)));
+    }
     return true;
 }
 
@@ -176,14 +207,14 @@ bool FieldMapBasedTag<FieldType, Compare>::setValues(const typename FieldType::i
  *          method will replace all currently assigned values with the specified \a values.
  * \sa Tag::setValues()
  */
-template <class FieldType, class Compare>
-bool FieldMapBasedTag<FieldType, Compare>::setValues(KnownField field, const std::vector<TagValue> &values)
+template <class FieldType, class Compare, class Storage>
+bool FieldMapBasedTag<FieldType, Compare, Storage>::setValues(KnownField field, const std::vector<TagValue> &values)
 {
     return setValues(fieldId(field), values);
 }
 
-template <class FieldType, class Compare>
-inline bool FieldMapBasedTag<FieldType, Compare>::hasField(KnownField field) const
+template <class FieldType, class Compare, class Storage>
+inline bool FieldMapBasedTag<FieldType, Compare, Storage>::hasField(KnownField field) const
 {
     return hasField(fieldId(field));
 }
@@ -191,8 +222,8 @@ inline bool FieldMapBasedTag<FieldType, Compare>::hasField(KnownField field) con
 /*!
  * \brief Returns an indication whether the field with the specified \a id is present.
  */
-template <class FieldType, class Compare>
-inline bool FieldMapBasedTag<FieldType, Compare>::hasField(const typename FieldType::identifierType &id) const
+template <class FieldType, class Compare, class Storage>
+inline bool FieldMapBasedTag<FieldType, Compare, Storage>::hasField(const typename FieldType::identifierType &id) const
 {
     for (auto range = m_fields.equal_range(id); range.first != range.second; ++range.first) {
         if(!range.first->second.value().isEmpty()) {
@@ -202,8 +233,8 @@ inline bool FieldMapBasedTag<FieldType, Compare>::hasField(const typename FieldT
     return false;
 }
 
-template <class FieldType, class Compare>
-inline void FieldMapBasedTag<FieldType, Compare>::removeAllFields()
+template <class FieldType, class Compare, class Storage>
+inline void FieldMapBasedTag<FieldType, Compare, Storage>::removeAllFields()
 {
     m_fields.clear();
 }
@@ -211,8 +242,8 @@ inline void FieldMapBasedTag<FieldType, Compare>::removeAllFields()
 /*!
  * \brief Returns the fields of the tag by providing direct access to the field map of the tag.
  */
-template <class FieldType, class Compare>
-inline const std::multimap<typename FieldType::identifierType, FieldType, Compare> &FieldMapBasedTag<FieldType, Compare>::fields() const
+template <class FieldType, class Compare, class Storage>
+inline const typename FieldMapBasedTag<FieldType, Compare, Storage>::FieldMap &FieldMapBasedTag<FieldType, Compare, Storage>::fields() const
 {
     return m_fields;
 }
@@ -220,14 +251,14 @@ inline const std::multimap<typename FieldType::identifierType, FieldType, Compar
 /*!
  * \brief Returns the fields of the tag by providing direct access to the field map of the tag.
  */
-template <class FieldType, class Compare>
-inline std::multimap<typename FieldType::identifierType, FieldType, Compare> &FieldMapBasedTag<FieldType, Compare>::fields()
+template <class FieldType, class Compare, class Storage>
+inline typename FieldMapBasedTag<FieldType, Compare, Storage>::FieldMap &FieldMapBasedTag<FieldType, Compare, Storage>::fields()
 {
     return m_fields;
 }
 
-template <class FieldType, class Compare>
-unsigned int FieldMapBasedTag<FieldType, Compare>::fieldCount() const
+template <class FieldType, class Compare, class Storage>
+unsigned int FieldMapBasedTag<FieldType, Compare, Storage>::fieldCount() const
 {
     unsigned int count = 0;
     for(const auto &field : m_fields) {
@@ -238,8 +269,8 @@ unsigned int FieldMapBasedTag<FieldType, Compare>::fieldCount() const
     return count;
 }
 
-template <class FieldType, class Compare>
-inline bool FieldMapBasedTag<FieldType, Compare>::supportsField(KnownField field) const
+template <class FieldType, class Compare, class Storage>
+inline bool FieldMapBasedTag<FieldType, Compare, Storage>::supportsField(KnownField field) const
 {
     static typename FieldType::identifierType def;
     return fieldId(field) != def;
@@ -248,8 +279,8 @@ inline bool FieldMapBasedTag<FieldType, Compare>::supportsField(KnownField field
 /*!
  * \brief Returns the proposed data type for the field with the specified \a id.
  */
-template <class FieldType, class Compare>
-inline TagDataType FieldMapBasedTag<FieldType, Compare>::proposedDataType(const typename FieldType::identifierType &id) const
+template <class FieldType, class Compare, class Storage>
+inline TagDataType FieldMapBasedTag<FieldType, Compare, Storage>::proposedDataType(const typename FieldType::identifierType &id) const
 {
     return Tag::proposedDataType(knownField(id));
 }
@@ -260,8 +291,8 @@ inline TagDataType FieldMapBasedTag<FieldType, Compare>::proposedDataType(const
  * \param overwrite Indicates whether existing fields should be overwritten.
  * \return Returns the number of fields that have been inserted.
  */
-template <class FieldType, class Compare>
-int FieldMapBasedTag<FieldType, Compare>::insertFields(const FieldMapBasedTag<FieldType, Compare> &from, bool overwrite)
+template <class FieldType, class Compare, class Storage>
+int FieldMapBasedTag<FieldType, Compare, Storage>::insertFields(const FieldMapBasedTag<FieldType, Compare, Storage> &from, bool overwrite)
 {
     int fieldsInserted = 0;
     for(const auto &pair : from.fields()) {
@@ -291,19 +322,37 @@ int FieldMapBasedTag<FieldType, Compare>::insertFields(const FieldMapBasedTag<Fi
     return fieldsInserted;
 }
 
-template <class FieldType, class Compare>
-unsigned int FieldMapBasedTag<FieldType, Compare>::insertValues(const Tag &from, bool overwrite)
+/*!
+ * \brief Inserts the specified \a skippedFields which have been parsed after skipping them when parsing the tag.
+ *
+ * Fields with an ID the tag already has fields for are not inserted so fields assigned after parsing the
+ * tag are preserved. Meant to be used when implementing Tag::parseSkippedFields().
+ */
+template <class FieldType, class Compare, class Storage>
+void FieldMapBasedTag<FieldType, Compare, Storage>::insertSkippedFields(std::vector<FieldType> &skippedFields)
+{
+    // check for existing fields before inserting any skipped field because there might be multiple skipped fields with the same ID
+    skippedFields.erase(std::remove_if(skippedFields.begin(), skippedFields.end(), [this] (const FieldType &field) {
+        return fields().find(field.id()) != fields().end();
+    }), skippedFields.end());
+    for(FieldType &field : skippedFields) {
+        fields().insert(std::make_pair(field.id(), std::move(field)));
+    }
+}
+
+template <class FieldType, class Compare, class Storage>
+unsigned int FieldMapBasedTag<FieldType, Compare, Storage>::insertValues(const Tag &from, bool overwrite)
 {
     if(type() == from.type()) {
         // the tags are of the same type, we can insert the fields directly
-        return insertFields(static_cast<const FieldMapBasedTag<FieldType, Compare> &>(from), overwrite);
+        return insertFields(static_cast<const FieldMapBasedTag<FieldType, Compare, Storage> &>(from), overwrite);
     } else {
         return Tag::insertValues(from, overwrite);
     }
 }
 
-template <class FieldType, class Compare>
-void FieldMapBasedTag<FieldType, Compare>::ensureTextValuesAreProperlyEncoded()
+template <class FieldType, class Compare, class Storage>
+void FieldMapBasedTag<FieldType, Compare, Storage>::ensureTextValuesAreProperlyEncoded()
 {
     for(auto &field : fields()) {
         field.second.value().convertDataEncodingForTag(this);
@@ -80,8 +80,11 @@ void FlacMetaDataBlockStreamInfo::parse(const char *buffer)
  * \brief Parses the FLAC "METADATA_BLOCK_PICTURE".
  *
  * \a maxSize specifies the maximum size of the structure.
+ *
+ * If \a lazyLoading is true, the picture data is not read; the value references it within
+ * \a inputStream instead (see TagValue::assignDataFromStream()).
  */
-void FlacMetaDataBlockPicture::parse(istream &inputStream, uint32 maxSize)
+void FlacMetaDataBlockPicture::parse(istream &inputStream, uint32 maxSize, bool lazyLoading)
 {
     CHECK_MAX_SIZE(32);
     BinaryReader reader(&inputStream);
@@ -96,7 +99,12 @@ void FlacMetaDataBlockPicture::parse(istream &inputStream, uint32 maxSize)
     inputStream.seekg(4 * 4, ios_base::cur);
     size = reader.readUInt32BE();
     CHECK_MAX_SIZE(size);
-    if(size) {
+    if(size && lazyLoading) {
+        istream *const stream = &inputStream;
+        m_value.assignDataFromStream([stream] () -> istream & {
+            return *stream;
+        }, static_cast<uint64>(inputStream.tellg()), size, TagDataType::Picture);
+    } else if(size) {
         auto data = make_unique<char[]>(size);
         inputStream.read(data.get(), size);
         m_value.assignData(move(data), size, TagDataType::Picture);
@@ -130,7 +138,7 @@ void FlacMetaDataBlockPicture::make(ostream &outputStream)
     writer.writeUInt32BE(0); // skip color depth
     writer.writeUInt32BE(0); // skip number of colors used
     writer.writeUInt32BE(m_value.dataSize());
-    writer.write(value().dataPointer(), m_value.dataSize());
+    m_value.copyDataTo(outputStream);
 }
 
 
@@ -260,7 +260,7 @@ class TAG_PARSER_EXPORT FlacMetaDataBlockPicture
 public:
     FlacMetaDataBlockPicture(TagValue &tagValue);
 
-    void parse(std::istream &inputStream, uint32 maxSize);
+    void parse(std::istream &inputStream, uint32 maxSize, bool lazyLoading = false);
     uint32 requiredSize() const;
     void make(std::ostream &outputStream);
 
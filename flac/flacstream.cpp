@@ -112,7 +112,7 @@ void FlacStream::internalParseHeader()
                     m_vorbisComment = make_unique<VorbisComment>();
                 }
                 try {
-                    m_vorbisComment->parse(*m_istream, header.dataSize(), VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+                    m_vorbisComment->parse(*m_istream, header.dataSize(), VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte, m_mediaFileInfo.tagFieldProjection());
                 } catch(const Failure &) {
                     // error is logged via notifications, just continue with the next metadata block
                 }
@@ -124,7 +124,7 @@ void FlacStream::internalParseHeader()
                     VorbisCommentField coverField;
                     coverField.setId(m_vorbisComment->fieldId(KnownField::Cover));
                     FlacMetaDataBlockPicture picture(coverField.value());
-                    picture.parse(*m_istream, header.dataSize());
+                    picture.parse(*m_istream, header.dataSize(), m_mediaFileInfo.isLazyPictureLoadingEnabled());
                     coverField.setTypeInfo(picture.pictureType());
 
                     if(coverField.value().isEmpty()) {
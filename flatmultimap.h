@@ -0,0 +1,390 @@
+#ifndef MEDIA_FLATMULTIMAP_H
+#define MEDIA_FLATMULTIMAP_H
+
+#include "./caseinsensitivecomparer.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Media {
+
+/*!
+ * \brief The FlatMultiMapKeys class provides the keys used by FlatMultiMap for binary search.
+ *
+ * The generic implementation compares the keys of the entries directly using \a Compare and
+ * stores nothing additionally.
+ */
+template <class Key, class Compare>
+class FlatMultiMapKeys
+{
+public:
+    typedef const Key &PreparedKey;
+    static const Key &prepare(const Key &key)
+    {
+        return key;
+    }
+    template <class Entries>
+    bool less(const Entries &entries, std::size_t index, const Key &key) const
+    {
+        return Compare()(entries[index].first, key);
+    }
+    template <class Entries>
+    bool greater(const Entries &entries, std::size_t index, const Key &key) const
+    {
+        return Compare()(key, entries[index].first);
+    }
+    void insert(std::size_t, const Key &)
+    {}
+    void erase(std::size_t, std::size_t)
+    {}
+    void clear()
+    {}
+    void reserve(std::size_t)
+    {}
+};
+
+/*!
+ * \brief The FlatMultiMapKeys class stores case-folded copies of the keys for case-insensitive string keys.
+ *
+ * So the binary search compares plain strings (memcmp()) instead of folding each character of both
+ * keys on every comparison. The lookup key is folded only once per lookup.
+ */
+template <>
+class FlatMultiMapKeys<std::string, CaseInsensitiveStringComparer>
+{
+public:
+    typedef std::string PreparedKey;
+    static std::string prepare(const std::string &key)
+    {
+        std::string folded(key);
+        for(char &c : folded) {
+            c = static_cast<char>(CaseInsensitiveCharComparer::toLower(static_cast<unsigned char>(c)));
+        }
+        return folded;
+    }
+    template <class Entries>
+    bool less(const Entries &, std::size_t index, const std::string &foldedKey) const
+    {
+        return m_foldedKeys[index] < foldedKey;
+    }
+    template <class Entries>
+    bool greater(const Entries &, std::size_t index, const std::string &foldedKey) const
+    {
+        return foldedKey < m_foldedKeys[index];
+    }
+    void insert(std::size_t index, const std::string &key)
+    {
+        m_foldedKeys.insert(m_foldedKeys.begin() + static_cast<std::ptrdiff_t>(index), prepare(key));
+    }
+    void erase(std::size_t first, std::size_t last)
+    {
+        m_foldedKeys.erase(m_foldedKeys.begin() + static_cast<std::ptrdiff_t>(first), m_foldedKeys.begin() + static_cast<std::ptrdiff_t>(last));
+    }
+    void clear()
+    {
+        m_foldedKeys.clear();
+    }
+    void reserve(std::size_t size)
+    {
+        m_foldedKeys.reserve(size);
+    }
+
+private:
+    std::vector<std::string> m_foldedKeys;
+};
+
+/*!
+ * \class Media::FlatMultiMap
+ * \brief The FlatMultiMap class is a sorted multimap which stores its entries contiguously.
+ *
+ * It provides the subset of the std::multimap interface used by FieldMapBasedTag and the tag
+ * implementations. Like std::multimap, the entries are sorted by their keys using \a Compare and
+ * entries with equal keys keep their insertion order.
+ *
+ * Compared to std::multimap there are no allocations per entry and lookups do not chase pointers
+ * which is faster for the typical number of fields of a tag (up to a few hundred).
+ *
+ * \remarks
+ * - In contrast to std::multimap, inserting and erasing entries invalidates iterators and
+ *   references to other entries.
+ * - The key of an entry must not be modified via an iterator.
+ */
+template <class Key, class Value, class Compare = std::less<Key> >
+class FlatMultiMap
+{
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+    typedef std::pair<Key, Value> value_type;
+    typedef Compare key_compare;
+    typedef typename std::vector<value_type>::size_type size_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    iterator begin();
+    const_iterator begin() const;
+    const_iterator cbegin() const;
+    iterator end();
+    const_iterator end() const;
+    const_iterator cend() const;
+    bool empty() const;
+    size_type size() const;
+    void reserve(size_type size);
+    void clear();
+
+    iterator find(const Key &key);
+    const_iterator find(const Key &key) const;
+    size_type count(const Key &key) const;
+    iterator lower_bound(const Key &key);
+    const_iterator lower_bound(const Key &key) const;
+    iterator upper_bound(const Key &key);
+    const_iterator upper_bound(const Key &key) const;
+    std::pair<iterator, iterator> equal_range(const Key &key);
+    std::pair<const_iterator, const_iterator> equal_range(const Key &key) const;
+
+    iterator insert(const value_type &value);
+    iterator insert(value_type &&value);
+    size_type erase(const Key &key);
+    iterator erase(const_iterator position);
+
+private:
+    std::size_t lowerIndex(typename FlatMultiMapKeys<Key, Compare>::PreparedKey key) const;
+    std::size_t upperIndex(typename FlatMultiMapKeys<Key, Compare>::PreparedKey key, std::size_t begin = 0) const;
+
+    std::vector<value_type> m_entries;
+    FlatMultiMapKeys<Key, Compare> m_keys;
+};
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::begin()
+{
+    return m_entries.begin();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::begin() const
+{
+    return m_entries.begin();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::cbegin() const
+{
+    return m_entries.cbegin();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::end()
+{
+    return m_entries.end();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::end() const
+{
+    return m_entries.end();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::cend() const
+{
+    return m_entries.cend();
+}
+
+template <class Key, class Value, class Compare>
+inline bool FlatMultiMap<Key, Value, Compare>::empty() const
+{
+    return m_entries.empty();
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::size_type FlatMultiMap<Key, Value, Compare>::size() const
+{
+    return m_entries.size();
+}
+
+/*!
+ * \brief Reserves space for the specified number of entries.
+ */
+template <class Key, class Value, class Compare>
+inline void FlatMultiMap<Key, Value, Compare>::reserve(size_type size)
+{
+    m_entries.reserve(size);
+    m_keys.reserve(size);
+}
+
+template <class Key, class Value, class Compare>
+inline void FlatMultiMap<Key, Value, Compare>::clear()
+{
+    m_entries.clear();
+    m_keys.clear();
+}
+
+/*!
+ * \brief Returns the index of the first entry which is not less than the specified (prepared) \a key.
+ */
+template <class Key, class Value, class Compare>
+std::size_t FlatMultiMap<Key, Value, Compare>::lowerIndex(typename FlatMultiMapKeys<Key, Compare>::PreparedKey key) const
+{
+    std::size_t begin = 0, end = m_entries.size();
+    while(begin < end) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        if(m_keys.less(m_entries, middle, key)) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+/*!
+ * \brief Returns the index of the first entry (starting at \a begin) which is greater than the specified (prepared) \a key.
+ */
+template <class Key, class Value, class Compare>
+std::size_t FlatMultiMap<Key, Value, Compare>::upperIndex(typename FlatMultiMapKeys<Key, Compare>::PreparedKey key, std::size_t begin) const
+{
+    std::size_t end = m_entries.size();
+    while(begin < end) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        if(m_keys.greater(m_entries, middle, key)) {
+            end = middle;
+        } else {
+            begin = middle + 1;
+        }
+    }
+    return begin;
+}
+
+/*!
+ * \brief Returns the first entry with the specified \a key or end() if there is no such entry.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::find(const Key &key)
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t index = lowerIndex(preparedKey);
+    return index != m_entries.size() && !m_keys.greater(m_entries, index, preparedKey) ? m_entries.begin() + static_cast<std::ptrdiff_t>(index) : m_entries.end();
+}
+
+/*!
+ * \brief Returns the first entry with the specified \a key or end() if there is no such entry.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::find(const Key &key) const
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t index = lowerIndex(preparedKey);
+    return index != m_entries.size() && !m_keys.greater(m_entries, index, preparedKey) ? m_entries.cbegin() + static_cast<std::ptrdiff_t>(index) : m_entries.cend();
+}
+
+/*!
+ * \brief Returns the number of entries with the specified \a key.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::size_type FlatMultiMap<Key, Value, Compare>::count(const Key &key) const
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t lower = lowerIndex(preparedKey);
+    return upperIndex(preparedKey, lower) - lower;
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::lower_bound(const Key &key)
+{
+    return m_entries.begin() + static_cast<std::ptrdiff_t>(lowerIndex(m_keys.prepare(key)));
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::lower_bound(const Key &key) const
+{
+    return m_entries.cbegin() + static_cast<std::ptrdiff_t>(lowerIndex(m_keys.prepare(key)));
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::upper_bound(const Key &key)
+{
+    return m_entries.begin() + static_cast<std::ptrdiff_t>(upperIndex(m_keys.prepare(key)));
+}
+
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::const_iterator FlatMultiMap<Key, Value, Compare>::upper_bound(const Key &key) const
+{
+    return m_entries.cbegin() + static_cast<std::ptrdiff_t>(upperIndex(m_keys.prepare(key)));
+}
+
+/*!
+ * \brief Returns the range of entries with the specified \a key.
+ */
+template <class Key, class Value, class Compare>
+std::pair<typename FlatMultiMap<Key, Value, Compare>::iterator, typename FlatMultiMap<Key, Value, Compare>::iterator> FlatMultiMap<Key, Value, Compare>::equal_range(const Key &key)
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t lower = lowerIndex(preparedKey);
+    return std::make_pair(m_entries.begin() + static_cast<std::ptrdiff_t>(lower), m_entries.begin() + static_cast<std::ptrdiff_t>(upperIndex(preparedKey, lower)));
+}
+
+/*!
+ * \brief Returns the range of entries with the specified \a key.
+ */
+template <class Key, class Value, class Compare>
+std::pair<typename FlatMultiMap<Key, Value, Compare>::const_iterator, typename FlatMultiMap<Key, Value, Compare>::const_iterator> FlatMultiMap<Key, Value, Compare>::equal_range(const Key &key) const
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t lower = lowerIndex(preparedKey);
+    return std::make_pair(m_entries.cbegin() + static_cast<std::ptrdiff_t>(lower), m_entries.cbegin() + static_cast<std::ptrdiff_t>(upperIndex(preparedKey, lower)));
+}
+
+/*!
+ * \brief Inserts the specified \a value after all entries with an equal key.
+ * \returns Returns an iterator to the inserted entry.
+ */
+template <class Key, class Value, class Compare>
+inline typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::insert(const value_type &value)
+{
+    return insert(value_type(value));
+}
+
+/*!
+ * \brief Inserts the specified \a value after all entries with an equal key.
+ * \returns Returns an iterator to the inserted entry.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::insert(value_type &&value)
+{
+    const std::size_t index = upperIndex(m_keys.prepare(value.first));
+    m_keys.insert(index, value.first);
+    return m_entries.insert(m_entries.begin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+}
+
+/*!
+ * \brief Removes all entries with the specified \a key.
+ * \returns Returns the number of removed entries.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::size_type FlatMultiMap<Key, Value, Compare>::erase(const Key &key)
+{
+    typename FlatMultiMapKeys<Key, Compare>::PreparedKey preparedKey = m_keys.prepare(key);
+    const std::size_t lower = lowerIndex(preparedKey), upper = upperIndex(preparedKey, lower);
+    m_keys.erase(lower, upper);
+    m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(lower), m_entries.begin() + static_cast<std::ptrdiff_t>(upper));
+    return upper - lower;
+}
+
+/*!
+ * \brief Removes the entry at the specified \a position.
+ * \returns Returns an iterator to the entry following the removed entry.
+ */
+template <class Key, class Value, class Compare>
+typename FlatMultiMap<Key, Value, Compare>::iterator FlatMultiMap<Key, Value, Compare>::erase(const_iterator position)
+{
+    const std::size_t index = static_cast<std::size_t>(position - m_entries.cbegin());
+    m_keys.erase(index, index + 1);
+    return m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+}
+
+#endif // MEDIA_FLATMULTIMAP_H
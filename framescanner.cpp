@@ -0,0 +1,129 @@
+#include "./framescanner.h"
+#include "./metrics.h"
+
+#include <algorithm>
+#include <istream>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace Media {
+
+/*!
+ * \brief Returns the first sync word within [\a begin, \a end) or \a end if there is none.
+ *
+ * A sync word is a 0xFF byte followed by a byte having all bits of \a secondByteMask set
+ * (eg. 0xE0 for MPEG audio frames and 0xF0 for ADTS frames).
+ *
+ * \remarks Uses SSE2 to check 16 bytes at once if available.
+ */
+const char *findSyncWord(const char *begin, const char *end, byte secondByteMask)
+{
+    if(end - begin < 2) {
+        return end;
+    }
+    // the second byte must be within the range as well
+    const char *const last = end - 1;
+    const char *i = begin;
+#ifdef __SSE2__
+    const __m128i syncByte = _mm_set1_epi8(static_cast<char>(0xFF));
+    for(; i + 16 <= last; i += 16) {
+        for(int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(i)), syncByte)); mask; mask &= mask - 1) {
+            const int index = __builtin_ctz(static_cast<unsigned int>(mask));
+            if((static_cast<byte>(i[index + 1]) & secondByteMask) == secondByteMask) {
+                return i + index;
+            }
+        }
+    }
+#endif
+    for(; i < last; ++i) {
+        if(static_cast<byte>(*i) == 0xFF && (static_cast<byte>(i[1]) & secondByteMask) == secondByteMask) {
+            return i;
+        }
+    }
+    return end;
+}
+
+/*!
+ * \class Media::FrameScanner
+ * \brief The FrameScanner class helps walking through all frame headers of a raw stream
+ *        of frames (eg. MPEG audio frames or ADTS frames).
+ *
+ * The stream is read in blocks of blockSize bytes so walking through the frames only causes
+ * sequential reads of big blocks. Only the headers are accessed via header(); the caller
+ * determines the frame size from the header and moves to the next frame using advance().
+ * If no valid header is found, resync() can be used to skip to the next sync word.
+ */
+
+constexpr std::size_t FrameScanner::blockSize;
+
+/*!
+ * \brief Constructs a new scanner for the frames of the specified \a stream within [\a startOffset, \a endOffset).
+ * \param syncMask Specifies the bits which must be set in the second byte of a sync word.
+ */
+FrameScanner::FrameScanner(istream &stream, uint64 startOffset, uint64 endOffset, byte syncMask) :
+    m_stream(&stream),
+    m_offset(startOffset),
+    m_endOffset(endOffset),
+    m_syncMask(syncMask),
+    m_blockOffset(0),
+    m_blockSize(0)
+{}
+
+/*!
+ * \brief Returns the first \a size bytes of the current frame or nullptr if the end has been reached.
+ * \remarks The returned pointer is invalidated when calling header() or resync() again.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+const char *FrameScanner::header(size_t size)
+{
+    return fill(size) ? m_block.data() + (m_offset - m_blockOffset) : nullptr;
+}
+
+/*!
+ * \brief Skips to the next sync word after the current offset.
+ * \returns Returns whether a sync word has been found.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+bool FrameScanner::resync()
+{
+    for(++m_offset; fill(2); ) {
+        const char *const begin = m_block.data() + (m_offset - m_blockOffset);
+        const char *const end = m_block.data() + m_blockSize;
+        const char *const syncWord = findSyncWord(begin, end, m_syncMask);
+        if(syncWord != end) {
+            m_offset += static_cast<uint64>(syncWord - begin);
+            return true;
+        }
+        // continue with the last byte of the block which might be the first byte of a sync word
+        m_offset = m_blockOffset + m_blockSize - 1;
+    }
+    return false;
+}
+
+/*!
+ * \brief Ensures the block contains at least \a size bytes from the current offset.
+ * \returns Returns false if the end has been reached.
+ */
+bool FrameScanner::fill(size_t size)
+{
+    if(m_offset + size > m_endOffset) {
+        return false;
+    }
+    if(m_offset >= m_blockOffset && m_offset + size <= m_blockOffset + m_blockSize) {
+        return true;
+    }
+    m_blockOffset = m_offset;
+    m_blockSize = static_cast<size_t>(min<uint64>(size > blockSize ? size : blockSize, m_endOffset - m_offset));
+    m_block.resize(m_blockSize);
+    m_stream->seekg(static_cast<streamoff>(m_blockOffset));
+    m_stream->read(m_block.data(), static_cast<streamsize>(m_blockSize));
+    IoCounters::countSeek();
+    IoCounters::countRead(m_blockSize);
+    return true;
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef MEDIA_FRAMESCANNER_H
+#define MEDIA_FRAMESCANNER_H
+
+#include "./global.h"
+
+#include <c++utilities/conversion/types.h>
+
+#include <iosfwd>
+#include <vector>
+
+namespace Media {
+
+TAG_PARSER_EXPORT const char *findSyncWord(const char *begin, const char *end, byte secondByteMask);
+
+class TAG_PARSER_EXPORT FrameScanner
+{
+public:
+    FrameScanner(std::istream &stream, uint64 startOffset, uint64 endOffset, byte syncMask);
+
+    uint64 offset() const;
+    const char *header(std::size_t size);
+    void advance(uint64 size);
+    bool resync();
+
+    static constexpr std::size_t blockSize = 0x100000;
+
+private:
+    bool fill(std::size_t size);
+
+    std::istream *m_stream;
+    uint64 m_offset;
+    uint64 m_endOffset;
+    byte m_syncMask;
+    std::vector<char> m_block;
+    uint64 m_blockOffset;
+    std::size_t m_blockSize;
+};
+
+/*!
+ * \brief Returns the offset of the current frame.
+ */
+inline uint64 FrameScanner::offset() const
+{
+    return m_offset;
+}
+
+/*!
+ * \brief Moves to the frame following the current frame which has the specified \a size.
+ */
+inline void FrameScanner::advance(uint64 size)
+{
+    m_offset += size;
+}
+
+}
+
+#endif // MEDIA_FRAMESCANNER_H
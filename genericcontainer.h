@@ -2,6 +2,7 @@
 #define MEDIA_GENERICCONTAINER_H
 
 #include "./abstractcontainer.h"
+#include "./elementarena.h"
 
 #include <algorithm>
 #include <memory>
@@ -34,6 +35,7 @@ public:
     ElementType *firstElement() const;
     const std::vector<std::unique_ptr<ElementType> > &additionalElements() const;
     std::vector<std::unique_ptr<ElementType> > &additionalElements();
+    ElementArena &elementArena();
     TagType *tag(std::size_t index);
     std::size_t tagCount() const;
     TrackType *track(std::size_t index);
@@ -58,6 +60,7 @@ public:
     typedef ElementType elementType;
 
 protected:
+    ElementArena m_elementArena;
     std::unique_ptr<ElementType> m_firstElement;
     std::vector<std::unique_ptr<ElementType> > m_additionalElements;
     std::vector<std::unique_ptr<TagType> > m_tags;
@@ -160,6 +163,17 @@ inline std::vector<std::unique_ptr<ElementType> > &GenericContainer<FileInfoType
     return m_additionalElements;
 }
 
+/*!
+ * \brief Returns the arena used to allocate the child and sibling elements of the element trees.
+ *
+ * The memory is freed at once when the container is reset or destroyed.
+ */
+template <class FileInfoType, class TagType, class TrackType, class ElementType>
+inline ElementArena &GenericContainer<FileInfoType, TagType, TrackType, ElementType>::elementArena()
+{
+    return m_elementArena;
+}
+
 template <class FileInfoType, class TagType, class TrackType, class ElementType>
 inline TagType *GenericContainer<FileInfoType, TagType, TrackType, ElementType>::tag(std::size_t index)
 {
@@ -372,6 +386,7 @@ void GenericContainer<FileInfoType, TagType, TrackType, ElementType>::reset()
     m_additionalElements.clear();
     m_tracks.clear();
     m_tags.clear();
+    m_elementArena.release();
 }
 
 } // namespace Media
@@ -4,6 +4,9 @@
 #include "./notification.h"
 #include "./exceptions.h"
 #include "./statusprovider.h"
+#include "./copyengine.h"
+#include "./elementarena.h"
+#include "./metrics.h"
 
 #include <c++utilities/conversion/types.h>
 #include <c++utilities/io/copy.h>
@@ -104,6 +107,26 @@ template<typename ImplementationType>
 class FileElementTraits
 {};
 
+/*!
+ * \class Media::FileElementDeleter
+ * \brief The FileElementDeleter class destroys elements which have been allocated using the
+ *        element arena of their container.
+ */
+template<typename ImplementationType>
+struct FileElementDeleter
+{
+    void operator()(ImplementationType *element) const;
+};
+
+/*!
+ * \brief Destroys the specified \a element and gives its memory back to the arena of its container.
+ */
+template<typename ImplementationType>
+void FileElementDeleter<ImplementationType>::operator()(ImplementationType *element) const
+{
+    element->container().elementArena().destroy(element);
+}
+
 /*!
  * \class Media::GenericFileElement
  * \brief The GenericFileElement class helps to parse binary files which consist
@@ -143,12 +166,14 @@ public:
     GenericFileElement(const GenericFileElement& other) = delete;
     GenericFileElement(GenericFileElement& other) = delete;
     GenericFileElement& operator =(const GenericFileElement& other) = delete;
+    ~GenericFileElement();
 
     containerType& container();
     const containerType& container() const;
     std::iostream &stream();
     IoUtilities::BinaryReader &reader();
     IoUtilities::BinaryWriter &writer();
+    const char *mappedData(uint64 offset, uint64 size) const;
     uint64 startOffset() const;
     uint64 relativeStartOffset() const;
     const identifierType &id() const;
@@ -190,6 +215,7 @@ public:
     void copyWithoutChilds(std::ostream &targetStream);
     void copyEntirely(std::ostream &targetStream);
     void makeBuffer();
+    void makeBuffer(std::istream &stream);
     void discardBuffer();
     void copyBuffer(std::ostream &targetStream);
     void copyPreferablyFromBuffer(std::ostream &targetStream);
@@ -197,6 +223,13 @@ public:
     implementationType *denoteFirstChild(uint32 offset);
 
 protected:
+    /*!
+     * \brief Specifies the type of the pointers owning child and sibling elements.
+     */
+    typedef std::unique_ptr<implementationType, FileElementDeleter<implementationType> > elementPointerType;
+
+    template<typename... Args> elementPointerType createElement(Args &&... args);
+
     identifierType m_id;
     uint64 m_startOffset;
     uint64 m_maxSize;
@@ -204,8 +237,8 @@ protected:
     dataSizeType m_dataSize;
     uint32 m_sizeLength;
     implementationType* m_parent;
-    std::unique_ptr<implementationType> m_nextSibling;
-    std::unique_ptr<implementationType> m_firstChild;
+    elementPointerType m_nextSibling;
+    elementPointerType m_firstChild;
     std::unique_ptr<char[]> m_buffer;
 
 private:
@@ -272,6 +305,43 @@ GenericFileElement<ImplementationType>::GenericFileElement(GenericFileElement<Im
     m_parsed(false)
 {}
 
+/*!
+ * \brief Destroys the element.
+ *
+ * Siblings are destroyed iteratively rather than recursively so destroying a top level element
+ * followed by a lot of siblings (eg. the clusters of a Matroska file) does not result in a deep
+ * chain of destructor calls. The recursion depth is limited to the nesting level of the elements.
+ */
+template <class ImplementationType>
+GenericFileElement<ImplementationType>::~GenericFileElement()
+{
+    for(elementPointerType sibling = std::move(m_nextSibling); sibling; ) {
+        elementPointerType next = std::move(sibling->m_nextSibling);
+        sibling = std::move(next);
+    }
+}
+
+/*!
+ * \brief Creates a new element of the implementation type using the element arena of the container.
+ *
+ * The specified \a args are forwarded to the constructor of the implementation type. The returned
+ * pointer is meant to be assigned to m_firstChild or m_nextSibling.
+ */
+template <class ImplementationType>
+template <typename... Args>
+inline typename GenericFileElement<ImplementationType>::elementPointerType GenericFileElement<ImplementationType>::createElement(Args &&... args)
+{
+    // not using ElementArena::create() here because the constructors used for child and sibling elements are protected
+    ElementArena &arena = container().elementArena();
+    void *memory = arena.allocate(sizeof(implementationType));
+    try {
+        return elementPointerType(new(memory) implementationType(std::forward<Args>(args)...));
+    } catch(...) {
+        arena.deallocate(memory, sizeof(implementationType));
+        throw;
+    }
+}
+
 /*!
  * \brief Returns the related container.
  */
@@ -317,6 +387,21 @@ inline IoUtilities::BinaryWriter &GenericFileElement<ImplementationType>::writer
     return m_container->writer();
 }
 
+/*!
+ * \brief Returns a pointer to the \a size bytes at the specified \a offset if the related file
+ *        is mapped into memory; otherwise returns nullptr.
+ *
+ * Implementations should decode headers directly from the returned memory and fall back to
+ * reading from stream() if nullptr is returned.
+ *
+ * \sa BasicFileInfo::mapFile()
+ */
+template <class ImplementationType>
+inline const char *GenericFileElement<ImplementationType>::mappedData(uint64 offset, uint64 size) const
+{
+    return m_container->fileInfo().mappedRange(offset, size);
+}
+
 /*!
  * \brief Returns the start offset in the related stream.
  */
@@ -725,6 +810,9 @@ void GenericFileElement<ImplementationType>::parse()
     if(!m_parsed) {
         static_cast<ImplementationType *>(this)->internalParse();
         m_parsed = true;
+        // note: the implementations count the I/O themselves because the header might have been decoded from
+        //       mapped memory or a read-ahead buffer
+        IoCounters::countElement();
     }
 }
 
@@ -821,10 +909,26 @@ void GenericFileElement<ImplementationType>::copyEntirely(std::ostream &targetSt
  */
 template <class ImplementationType>
 void GenericFileElement<ImplementationType>::makeBuffer()
+{
+    makeBuffer(container().stream());
+}
+
+/*!
+ * \brief Buffers the element (header and data) reading from the specified \a stream instead of the stream of the container.
+ * \remarks
+ *  - The element must have been parsed.
+ *  - The \a stream must provide the same data as the stream of the container. This allows buffering
+ *    elements concurrently using an independent stream per thread.
+ */
+template <class ImplementationType>
+void GenericFileElement<ImplementationType>::makeBuffer(std::istream &stream)
 {
     m_buffer = std::make_unique<char[]>(totalSize());
-    container().stream().seekg(startOffset());
-    container().stream().read(m_buffer.get(), totalSize());
+    stream.seekg(startOffset());
+    stream.read(m_buffer.get(), totalSize());
+    IoCounters::countAllocation();
+    IoCounters::countSeek();
+    IoCounters::countRead(totalSize());
 }
 
 /*!
@@ -844,6 +948,7 @@ template <class ImplementationType>
 inline void GenericFileElement<ImplementationType>::copyBuffer(std::ostream &targetStream)
 {
     targetStream.write(m_buffer.get(), totalSize());
+    IoCounters::countWrite(totalSize());
 }
 
 /*!
@@ -885,8 +990,15 @@ void GenericFileElement<ImplementationType>::copyInternal(std::ostream &targetSt
     }
     auto &stream = container().stream();
     stream.seekg(startOffset); // seek to start offset
-    IoUtilities::CopyHelper<0x2000> copyHelper;
-    copyHelper.callbackCopy(stream, targetStream, bytesToCopy, std::bind(&GenericFileElement<ImplementationType>::isAborted, this), std::bind(&GenericFileElement<ImplementationType>::updatePercentage, this, std::placeholders::_1));
+    if(CopyEngine *const copyEngine = container().copyEngine()) {
+        copyEngine->copy(stream, targetStream, bytesToCopy, std::bind(&GenericFileElement<ImplementationType>::isAborted, this), std::bind(&GenericFileElement<ImplementationType>::updatePercentage, this, std::placeholders::_1));
+    } else {
+        IoUtilities::CopyHelper<0x2000> copyHelper;
+        copyHelper.callbackCopy(stream, targetStream, bytesToCopy, std::bind(&GenericFileElement<ImplementationType>::isAborted, this), std::bind(&GenericFileElement<ImplementationType>::updatePercentage, this, std::placeholders::_1));
+    }
+    IoCounters::countSeek();
+    IoCounters::countRead(bytesToCopy);
+    IoCounters::countWrite(bytesToCopy);
     if(isAborted()) {
         throw OperationAbortedException();
     }
@@ -900,7 +1012,7 @@ template <class ImplementationType>
 typename GenericFileElement<ImplementationType>::implementationType *GenericFileElement<ImplementationType>::denoteFirstChild(uint32 relativeFirstChildOffset)
 {
     if(relativeFirstChildOffset + minimumElementSize() <= totalSize()) {
-        m_firstChild.reset(new implementationType(static_cast<implementationType &>(*this), startOffset() + relativeFirstChildOffset));
+        m_firstChild = createElement(static_cast<implementationType &>(*this), startOffset() + relativeFirstChildOffset);
     } else {
         m_firstChild.reset();
     }
@@ -39,8 +39,13 @@ public:
 
     TagField();
     TagField(const identifierType &id, const TagValue &value);
+    TagField(const TagField &other) = default;
+    TagField(TagField &&other) = default;
     ~TagField();
 
+    TagField &operator=(const TagField &other) = default;
+    TagField &operator=(TagField &&other) = default;
+
     const identifierType &id() const;
     std::string idToString() const;
     void setId(const identifierType &id);
@@ -49,6 +54,7 @@ public:
     TagValue &value();
     const TagValue &value() const;
     void setValue(const TagValue &value);
+    void setValue(TagValue &&value);
     void clearValue();
 
     const typeInfoType &typeInfo() const;
@@ -170,6 +176,15 @@ inline void TagField<ImplementationType>::setValue(const TagValue &value)
     m_value = value;
 }
 
+/*!
+ * \brief Sets the value of the current TagField by moving the specified \a value.
+ */
+template <class ImplementationType>
+inline void TagField<ImplementationType>::setValue(TagValue &&value)
+{
+    m_value = std::move(value);
+}
+
 /*!
  * \brief Clears the value of the current TagField.
  */
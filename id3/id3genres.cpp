@@ -1,5 +1,7 @@
 #include "./id3genres.h"
 
+#include "../lookuptable.h"
+
 using namespace std;
 
 namespace Media {
@@ -9,12 +11,12 @@ namespace Media {
  * \brief The Id3Genres class converts pre-defined ID3 genres to strings and vise versa.
  */
 
+namespace {
+
 /*!
- * \brief Returns all known genre names.
+ * \brief Holds all known genre names.
  */
-const char **Id3Genres::genreNames()
-{
-    static const char *names[] = {
+constexpr const char *genreNameTable[] = {
         "Blues", "Classic Rock", "Country", "Dance", "Disco", "Funk", "Grunge",
         "Hip-Hop", "Jazz", "Metal", "New Age", "Oldies", "Other", "Pop",
         "R&B", "Rap", "Reggae", "Rock", "Techno", "Industrial", "Alternative",
@@ -43,7 +45,43 @@ const char **Id3Genres::genreNames()
         "Trop Rock", "World Music", "Neoclassical", "Audiobook", "Audio Theatre", "Neue Deutsche Welle", "Podcast",
         "Indie Rock", "G-Funk", "Dubstep", "Garage Rock", "Psybient"
     };
-    return names;
+
+/*!
+ * \brief The GenreIndex struct holds the genre indexes sorted by their names.
+ */
+struct GenreIndex
+{
+    byte indexes[sizeof(genreNameTable) / sizeof(genreNameTable[0])];
+};
+
+/*!
+ * \brief Sorts the genre indexes by their names at compile-time (using insertion sort).
+ */
+constexpr GenreIndex makeGenreIndex()
+{
+    GenreIndex index{};
+    constexpr std::size_t count = sizeof(index.indexes);
+    for(std::size_t i = 0; i != count; ++i) {
+        std::size_t j = i;
+        for(; j && compareLookupKeys(genreNameTable[index.indexes[j - 1]], genreNameTable[i], lookupKeyLength(genreNameTable[i]), false) > 0; --j) {
+            index.indexes[j] = index.indexes[j - 1];
+        }
+        index.indexes[j] = static_cast<byte>(i);
+    }
+    return index;
+}
+
+constexpr GenreIndex genreIndex = makeGenreIndex();
+
+}
+
+/*!
+ * \brief Returns all known genre names.
+ */
+const char *const *Id3Genres::genreNames()
+{
+    static_assert(sizeof(genreNameTable) / sizeof(genreNameTable[0]) == static_cast<std::size_t>(genreCount()), "genre count must match the number of genre names");
+    return genreNameTable;
 }
 
 /*!
@@ -51,10 +89,18 @@ const char **Id3Genres::genreNames()
  */
 int Id3Genres::indexFromString(const string &genre)
 {
-    const char **ptr = genreNames();
-    for(int index = 0; index < genreCount(); ++ptr, ++index) {
-        if(genre == *ptr) {
+    // binary search on the indexes sorted by name
+    std::size_t begin = 0, end = sizeof(genreIndex.indexes);
+    while(begin < end) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        const byte index = genreIndex.indexes[middle];
+        const int comparison = compareLookupKeys(genreNameTable[index], genre.data(), genre.size(), false);
+        if(!comparison) {
             return index;
+        } else if(comparison < 0) {
+            begin = middle + 1;
+        } else {
+            end = middle;
         }
     }
     return -1;
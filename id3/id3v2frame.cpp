@@ -30,6 +30,42 @@ enum Id3v2TextEncodingByte : byte
 };
 }
 
+namespace {
+
+/*!
+ * \brief Specifies the number of bytes read to parse the header of a picture frame when loading pictures lazily.
+ */
+constexpr uint32 lazyPictureHeaderBufferSize = 0x400;
+
+/*!
+ * \brief Returns the size of the header (text encoding, MIME type, picture type and description) of the
+ *        picture frame stored in the specified \a buffer or zero if \a buffer does not contain the whole
+ *        header followed by at least one byte of picture data.
+ */
+size_t pictureHeaderSize(const char *buffer, size_t bufferSize)
+{
+    const char *const end = buffer + bufferSize;
+    // MIME type is always Latin-1
+    const char *pos = bufferSize > 1 ? static_cast<const char *>(memchr(buffer + 1, 0x00, bufferSize - 1)) : nullptr;
+    // skip termination and picture type
+    if(!pos || (pos += 2) >= end) {
+        return 0;
+    }
+    // description is terminated by two null-bytes if encoded using UTF-16 (with or without BOM)
+    if(*buffer == Id3v2TextEncodingBytes::Utf16WithBom || *buffer == Id3v2TextEncodingBytes::Utf16BigEndianWithoutBom) {
+        for(; pos + 1 < end; pos += 2) {
+            if(!pos[0] && !pos[1]) {
+                return pos + 2 < end ? static_cast<size_t>(pos + 2 - buffer) : 0;
+            }
+        }
+        return 0;
+    }
+    pos = static_cast<const char *>(memchr(pos, 0x00, static_cast<size_t>(end - pos)));
+    return pos && pos + 1 < end ? static_cast<size_t>(pos + 1 - buffer) : 0;
+}
+
+}
+
 /*!
  * \class Media::Id3v2Frame
  * \brief The Id3v2Frame class is used by Id3v2Tag to store the fields.
@@ -109,11 +145,14 @@ int parseGenreIndex(const stringtype &denotation)
  * The position of the current character in the input stream is expected to be
  * at the beginning of the frame to be parsed.
  *
+ * If \a lazyPictureLoading is true, only the header of (uncompressed) picture frames is read; the
+ * value references the picture data within the stream instead (see TagValue::assignDataFromStream()).
+ *
  * \throws Throws std::ios_base::failure when an IO error occurs.
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void Id3v2Frame::parse(BinaryReader &reader, const uint32 version, const uint32 maximalSize)
+void Id3v2Frame::parse(BinaryReader &reader, const uint32 version, const uint32 maximalSize, bool lazyPictureLoading)
 {
     invalidateStatus();
     clear();
@@ -221,6 +260,27 @@ void Id3v2Frame::parse(BinaryReader &reader, const uint32 version, const uint32
             throw InvalidDataException();
         }
         m_dataSize = decompressedSize;
+    } else if(lazyPictureLoading && version >= 3 && id() == Id3v2FrameIds::lCover && m_dataSize > lazyPictureHeaderBufferSize) {
+        // read only the header of the picture frame
+        istream *const stream = reader.stream();
+        const auto dataOffset = static_cast<uint64>(stream->tellg());
+        buffer = make_unique<char[]>(lazyPictureHeaderBufferSize + 2); // parseSubstring() might read the 2 zero-initialized bytes after the end
+        reader.read(buffer.get(), lazyPictureHeaderBufferSize);
+        if(const auto headerSize = pictureHeaderSize(buffer.get(), lazyPictureHeaderBufferSize)) {
+            // parse the header and let the value reference the picture data
+            byte type;
+            parsePicture(buffer.get(), lazyPictureHeaderBufferSize, value(), type);
+            setTypeInfo(type);
+            value().assignDataFromStream([stream] () -> istream & {
+                return *stream;
+            }, dataOffset + headerSize, m_dataSize - headerSize, TagDataType::Picture, value().dataEncoding());
+            return;
+        }
+        // the header is bigger than expected -> read the remaining data as well
+        auto completeBuffer = make_unique<char[]>(m_dataSize);
+        copy(buffer.get(), buffer.get() + lazyPictureHeaderBufferSize, completeBuffer.get());
+        reader.read(completeBuffer.get() + lazyPictureHeaderBufferSize, m_dataSize - lazyPictureHeaderBufferSize);
+        buffer = move(completeBuffer);
     } else {
         buffer = make_unique<char[]>(m_dataSize);
         reader.read(buffer.get(), m_dataSize);
@@ -106,7 +106,7 @@ public:
     Id3v2Frame(const identifierType &id, const TagValue &value, const byte group = 0, const int16 flag = 0);
 
     // parsing/making
-    void parse(IoUtilities::BinaryReader &reader, const uint32 version, const uint32 maximalSize = 0);
+    void parse(IoUtilities::BinaryReader &reader, const uint32 version, const uint32 maximalSize = 0, bool lazyPictureLoading = false);
     Id3v2FrameMaker prepareMaking(const uint32 version);
     void make(IoUtilities::BinaryWriter &writer, const uint32 version);
 
@@ -2,6 +2,7 @@
 #include "./id3v2frameids.h"
 
 #include "../exceptions.h"
+#include "../tagfieldprojection.h"
 
 #include <c++utilities/conversion/stringconversion.h>
 #include <c++utilities/conversion/stringbuilder.h>
@@ -160,14 +161,22 @@ bool Id3v2Tag::setValue(const typename Id3v2Frame::identifierType &id, const Tag
 /*!
  * \brief Parses tag information from the specified \a stream.
  *
+ * If \a lazyPictureLoading is true, the data of pictures is not read; the picture values reference
+ * it within \a stream instead (see TagValue::assignDataFromStream()).
+ *
+ * If a \a projection is specified, frames not included in it are skipped by size. Their offsets
+ * are remembered so they can be parsed later using parseSkippedFields() while \a stream is still open.
+ *
  * \throws Throws std::ios_base::failure when an IO error occurs.
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void Id3v2Tag::parse(istream &stream, const uint64 maximalSize)
+void Id3v2Tag::parse(istream &stream, const uint64 maximalSize, bool lazyPictureLoading, const TagFieldProjection *projection)
 {
     // prepare parsing
     invalidateStatus();
+    m_skippedFramesStream = &stream;
+    m_skippedFrames.clear();
     static const string context("parsing ID3v2 tag");
     BinaryReader reader(&stream);
     uint64 startOffset = stream.tellg();
@@ -220,18 +229,34 @@ void Id3v2Tag::parse(istream &stream, const uint64 maximalSize)
             // read frames
             auto pos = stream.tellg();
             Id3v2Frame frame;
+            const uint32 frameHeaderSize = majorVersion < 3 ? 6 : 10;
             while(bytesRemaining) {
                 // seek to next frame
                 stream.seekg(pos);
+                // skip frame by size if not included in the projection (padding and truncated frames are handled when parsing)
+                if(projection && bytesRemaining >= frameHeaderSize) {
+                    const uint32 frameId = majorVersion < 3 ? reader.readUInt24BE() : reader.readUInt32BE();
+                    const uint32 frameSize = frameHeaderSize + (majorVersion < 3 ? reader.readUInt24BE() : (majorVersion >= 4 ? reader.readSynchsafeUInt32BE() : reader.readUInt32BE()));
+                    if((majorVersion < 3 ? (frameId & 0xFFFF0000u) : (frameId & 0xFF000000u))
+                            && frameSize <= bytesRemaining && !projection->includes(*this, frameId)) {
+                        m_skippedFrames.emplace_back(static_cast<uint64>(pos), frameSize);
+                        pos += frameSize;
+                        bytesRemaining -= frameSize;
+                        continue;
+                    }
+                    stream.seekg(pos);
+                }
                 // parse frame
                 try {
-                    frame.parse(reader, majorVersion, bytesRemaining);
+                    frame.parse(reader, majorVersion, bytesRemaining, lazyPictureLoading);
                     if(frame.id()) {
                         // add frame if parsing was successfull
                         if(Id3v2FrameIds::isTextFrame(frame.id()) && fields().count(frame.id()) == 1) {
                             addNotification(NotificationType::Warning, "The text frame " % frame.frameIdString() + " exists more than once.", context);
                         }
-                        fields().insert(make_pair(frame.id(), frame));
+                        // move the value because copying it would load lazily loaded pictures
+                        TagValue value(move(frame.value()));
+                        fields().insert(make_pair(frame.id(), frame))->second.value() = move(value);
                     }
                 } catch(const NoDataFoundException &) {
                     if(frame.hasPaddingReached()) {
@@ -278,6 +303,36 @@ void Id3v2Tag::parse(istream &stream, const uint64 maximalSize)
     }
 }
 
+/*!
+ * \brief Parses the frames skipped when parsing the tag because they were not included in the projection.
+ * \remarks Frames with an ID the tag has already fields for are not added again (see Tag::parseSkippedFields()).
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void Id3v2Tag::parseSkippedFields()
+{
+    if(m_skippedFrames.empty()) {
+        return;
+    }
+    static const string context("parsing skipped ID3v2 frames");
+    BinaryReader reader(m_skippedFramesStream);
+    vector<Id3v2Frame> frames;
+    frames.reserve(m_skippedFrames.size());
+    Id3v2Frame frame;
+    for(const auto &skippedFrame : m_skippedFrames) {
+        m_skippedFramesStream->seekg(static_cast<streamoff>(skippedFrame.first));
+        try {
+            frame.parse(reader, m_majorVersion, skippedFrame.second);
+            frames.emplace_back(frame);
+        } catch(const Failure &) {
+            // nothing to do here since notifications will be added anyways
+        }
+        addNotifications(context, frame);
+        frame.invalidateNotifications();
+    }
+    m_skippedFrames.clear();
+    insertSkippedFields(frames);
+}
+
 /*!
  * \brief Prepares making.
  * \returns Returns a Id3v2TagMaker object which can be used to actually make the tag.
@@ -6,11 +6,13 @@
 #include "../fieldbasedtag.h"
 
 #include <map>
+#include <vector>
 
 namespace Media
 {
 
 class Id3v2Tag;
+class TagFieldProjection;
 
 struct TAG_PARSER_EXPORT FrameComparer
 {
@@ -72,7 +74,11 @@ public:
     bool supportsDescription(KnownField field) const;
     bool supportsMimeType(KnownField field) const;
 
-    void parse(std::istream &sourceStream, const uint64 maximalSize = 0);
+    void removeAllFields();
+    bool hasSkippedFields() const;
+    void parseSkippedFields();
+
+    void parse(std::istream &sourceStream, const uint64 maximalSize = 0, bool lazyPictureLoading = false, const TagFieldProjection *projection = nullptr);
     Id3v2TagMaker prepareMaking();
     void make(std::ostream &targetStream, uint32 padding);
 
@@ -95,6 +101,8 @@ private:
     uint32 m_sizeExcludingHeader;
     uint32 m_extendedHeaderSize;
     uint32 m_paddingSize;
+    std::istream *m_skippedFramesStream;
+    std::vector<std::pair<uint64, uint32> > m_skippedFrames;
 };
 
 /*!
@@ -106,9 +114,27 @@ inline Id3v2Tag::Id3v2Tag() :
     m_flags(0),
     m_sizeExcludingHeader(0),
     m_extendedHeaderSize(0),
-    m_paddingSize(0)
+    m_paddingSize(0),
+    m_skippedFramesStream(nullptr)
 {}
 
+/*!
+ * \brief Removes all fields including the frames skipped when parsing the tag.
+ */
+inline void Id3v2Tag::removeAllFields()
+{
+    FieldMapBasedTag<Id3v2Frame, FrameComparer>::removeAllFields();
+    m_skippedFrames.clear();
+}
+
+/*!
+ * \brief Returns whether frames have been skipped when parsing the tag.
+ */
+inline bool Id3v2Tag::hasSkippedFields() const
+{
+    return !m_skippedFrames.empty();
+}
+
 inline TagType Id3v2Tag::type() const
 {
     return TagType::Id3v2Tag;
@@ -0,0 +1,87 @@
+#ifndef MEDIA_LOOKUPTABLE_H
+#define MEDIA_LOOKUPTABLE_H
+
+#include "./caseinsensitivecomparer.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Media {
+
+/*!
+ * \brief The LookupEntry struct is an entry of a lookup table (see findInLookupTable()).
+ */
+template<typename Value>
+struct LookupEntry
+{
+    const char *key;
+    Value value;
+};
+
+/*!
+ * \brief Compares the null-terminated \a lhs with the first \a rhsSize characters of \a rhs.
+ * \returns Returns a negative value if \a lhs is less, zero if both are equal and a positive value otherwise.
+ */
+constexpr int compareLookupKeys(const char *lhs, const char *rhs, std::size_t rhsSize, bool caseInsensitive)
+{
+    for(; *lhs && rhsSize; ++lhs, ++rhs, --rhsSize) {
+        const unsigned char l = caseInsensitive ? CaseInsensitiveCharComparer::toLower(static_cast<unsigned char>(*lhs)) : static_cast<unsigned char>(*lhs);
+        const unsigned char r = caseInsensitive ? CaseInsensitiveCharComparer::toLower(static_cast<unsigned char>(*rhs)) : static_cast<unsigned char>(*rhs);
+        if(l != r) {
+            return l < r ? -1 : 1;
+        }
+    }
+    return *lhs ? 1 : (rhsSize ? -1 : 0);
+}
+
+/*!
+ * \brief Returns the length of the specified null-terminated \a str.
+ */
+constexpr std::size_t lookupKeyLength(const char *str)
+{
+    std::size_t length = 0;
+    for(; *str; ++str, ++length);
+    return length;
+}
+
+/*!
+ * \brief Returns whether the keys of the specified lookup table are sorted and unique.
+ * \remarks Intended to be used with static_assert() to ensure findInLookupTable() works.
+ */
+template<typename Value, std::size_t size>
+constexpr bool isLookupTableSorted(const LookupEntry<Value> (&table)[size], bool caseInsensitive)
+{
+    for(std::size_t index = 1; index < size; ++index) {
+        if(compareLookupKeys(table[index - 1].key, table[index].key, lookupKeyLength(table[index].key), caseInsensitive) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Looks up the specified \a key in the specified sorted lookup \a table using binary search.
+ * \returns Returns the value for \a key or \a defaultValue if the table does not contain \a key.
+ * \remarks The table must be sorted by its keys (see isLookupTableSorted()).
+ */
+template<typename Value, std::size_t size>
+Value findInLookupTable(const LookupEntry<Value> (&table)[size], const std::string &key, bool caseInsensitive, Value defaultValue)
+{
+    std::size_t begin = 0, end = size;
+    while(begin < end) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        const int comparison = compareLookupKeys(table[middle].key, key.data(), key.size(), caseInsensitive);
+        if(!comparison) {
+            return table[middle].value;
+        } else if(comparison < 0) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return defaultValue;
+}
+
+}
+
+#endif // MEDIA_LOOKUPTABLE_H
@@ -3,6 +3,7 @@
 #include "./matroskacontainer.h"
 #include "./matroskaid.h"
 
+#include "../mediafileinfo.h"
 #include "../exceptions.h"
 
 #include <c++utilities/conversion/types.h>
@@ -22,6 +23,21 @@ using namespace ConversionUtilities;
 
 namespace Media {
 
+/*!
+ * \brief Returns the length of the variable size integer (VINT) starting with the specified \a firstByte.
+ * \remarks Returns 9 if \a firstByte is zero (which is invalid because VINTs are at most 8 bytes long).
+ */
+inline byte vintLength(byte firstByte)
+{
+#ifdef __GNUC__
+    return firstByte ? static_cast<byte>(__builtin_clz(firstByte) - (sizeof(unsigned int) * 8 - 9)) : 9;
+#else
+    byte length = 1;
+    for(byte mask = 0x80; length < 9 && !(firstByte & mask); ++length, mask >>= 1);
+    return length;
+#endif
+}
+
 /*!
  * \class Media::EbmlElement
  * \brief The EbmlElement class helps to parse EBML files such as Matroska files.
@@ -75,15 +91,16 @@ void EbmlElement::internalParse()
             addNotification(NotificationType::Critical, argsToString("The EBML element at ", startOffset(), " is truncated or does not exist."), context);
             throw TruncatedDataException();
         }
-        stream().seekg(startOffset());
-        // read ID
-        char buf[maximumIdLengthSupported() > maximumSizeLengthSupported() ? maximumIdLengthSupported() : maximumSizeLengthSupported()] = {0};
-        byte beg = stream().peek(), mask = 0x80;
-        m_idLength = 1;
-        while(m_idLength <= GenericFileElement<implementationType>::maximumIdLengthSupported() && (beg & mask) == 0) {
-            ++m_idLength;
-            mask >>= 1;
+        // decode header directly from memory if the file is mapped; otherwise use the read-ahead window of the container
+        size_t available = maximumIdLengthSupported() + maximumSizeLengthSupported();
+        const char *header = mappedData(startOffset(), available);
+        if(!header && !(header = container().readAhead(startOffset(), available))) {
+            addNotification(NotificationType::Critical, argsToString("The EBML element at ", startOffset(), " is truncated or does not exist."), context);
+            throw TruncatedDataException();
         }
+
+        // read ID
+        m_idLength = vintLength(static_cast<byte>(header[0]));
         if(m_idLength > GenericFileElement<implementationType>::maximumIdLengthSupported()) {
             if(!skipped) {
                 addNotification(NotificationType::Critical, "EBML ID length is not supported, trying to skip.", context);
@@ -96,21 +113,26 @@ void EbmlElement::internalParse()
             }
             continue; // try again
         }
-        reader().read(buf + (GenericFileElement<implementationType>::maximumIdLengthSupported() - m_idLength), m_idLength);
-        m_id = BE::toUInt32(buf);
+        if(m_idLength >= available) {
+            if(!skipped) {
+                addNotification(NotificationType::Critical, "EBML header seems to be truncated.", context);
+            }
+            continue; // try again
+        }
+        m_id = 0;
+        for(const char *idByte = header, *idEnd = header + m_idLength; idByte != idEnd; ++idByte) {
+            m_id = (m_id << 8) | static_cast<byte>(*idByte);
+        }
 
         // read size
-        beg = stream().peek(), mask = 0x80;
+        const byte beg = static_cast<byte>(header[m_idLength]);
         m_sizeLength = 1;
         if(beg == 0xFF) {
             // this indicates that the element size is unknown
             // -> just assume the element takes the maximum available size
             m_dataSize = maxTotalSize() - headerSize();
         } else {
-           while(m_sizeLength <= GenericFileElement<implementationType>::maximumSizeLengthSupported() && (beg & mask) == 0) {
-                ++m_sizeLength;
-                mask >>= 1;
-            }
+            m_sizeLength = vintLength(beg);
             if(m_sizeLength > GenericFileElement<implementationType>::maximumSizeLengthSupported()) {
                 if(!skipped) {
                     addNotification(NotificationType::Critical, "EBML size length is not supported.", parsingContext());
@@ -123,11 +145,17 @@ void EbmlElement::internalParse()
                 }
                 continue; // try again
             }
-            // read size into buffer
-            memset(buf, 0, sizeof(dataSizeType)); // reset buffer
-            reader().read(buf + (GenericFileElement<implementationType>::maximumSizeLengthSupported() - m_sizeLength), m_sizeLength);
-            *(buf + (GenericFileElement<implementationType>::maximumSizeLengthSupported() - m_sizeLength)) ^= mask; // xor the first byte in buffer which has been read from the file with mask
-            m_dataSize = ConversionUtilities::BE::toUInt64(buf);
+            if(m_idLength + m_sizeLength > available) {
+                if(!skipped) {
+                    addNotification(NotificationType::Critical, "EBML header seems to be truncated.", parsingContext());
+                }
+                continue; // try again
+            }
+            // the length marker is removed from the first byte
+            m_dataSize = beg & (0xFF >> m_sizeLength);
+            for(const char *sizeByte = header + m_idLength + 1, *sizeEnd = header + m_idLength + m_sizeLength; sizeByte != sizeEnd; ++sizeByte) {
+                m_dataSize = (m_dataSize << 8) | static_cast<byte>(*sizeByte);
+            }
             // check if element is truncated
             if(totalSize() > maxTotalSize()) {
                 if(m_idLength + m_sizeLength > maxTotalSize()) { // header truncated
@@ -145,7 +173,7 @@ void EbmlElement::internalParse()
         // check if there's a first child
         const uint64 firstChildOffset = this->firstChildOffset();
         if(firstChildOffset && firstChildOffset < totalSize()) {
-            m_firstChild.reset(new EbmlElement(static_cast<EbmlElement &>(*this), startOffset() + firstChildOffset));
+            m_firstChild = createElement(static_cast<EbmlElement &>(*this), startOffset() + firstChildOffset);
         } else {
             m_firstChild.reset();
         }
@@ -153,9 +181,9 @@ void EbmlElement::internalParse()
         // check if there's a sibling
         if(totalSize() < maxTotalSize()) {
             if(parent()) {
-                m_nextSibling.reset(new EbmlElement(*(parent()), startOffset() + totalSize()));
+                m_nextSibling = createElement(*(parent()), startOffset() + totalSize());
             } else {
-                m_nextSibling.reset(new EbmlElement(container(), startOffset() + totalSize(), maxTotalSize() - totalSize()));
+                m_nextSibling = createElement(container(), startOffset() + totalSize(), maxTotalSize() - totalSize());
             }
         } else {
             m_nextSibling.reset();
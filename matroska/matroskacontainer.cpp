@@ -8,9 +8,12 @@
 #include "../mediafileinfo.h"
 #include "../exceptions.h"
 #include "../backuphelper.h"
+#include "../copyengine.h"
+#include "../parallelfor.h"
 
 #include "resources/config.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/conversion/stringconversion.h>
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/catchiofailure.h>
@@ -40,6 +43,7 @@ constexpr uint64 appInfoElementTotalSize = 2 + 1 + appInfoElementDataSize;
  */
 
 uint64 MatroskaContainer::m_maxFullParseSize = 0x3200000;
+uint64 MatroskaContainer::m_tailProbeSize = 0x40000;
 
 /*!
  * \brief Constructs a new container for the specified \a fileInfo at the specified \a startOffset.
@@ -48,7 +52,10 @@ MatroskaContainer::MatroskaContainer(MediaFileInfo &fileInfo, uint64 startOffset
     GenericContainer<MediaFileInfo, MatroskaTag, MatroskaTrack, EbmlElement>(fileInfo, startOffset),
     m_maxIdLength(4),
     m_maxSizeLength(8),
-    m_segmentCount(0)
+    m_segmentCount(0),
+    m_readAheadStream(nullptr),
+    m_readAheadOffset(0),
+    m_readAheadSize(0)
 {
     m_version = 1;
     m_readVersion = 1;
@@ -65,6 +72,7 @@ void MatroskaContainer::reset()
     GenericContainer<MediaFileInfo, MatroskaTag, MatroskaTrack, EbmlElement>::reset();
     m_maxIdLength = 4;
     m_maxSizeLength = 8;
+    invalidateReadAhead();
     m_version = 1;
     m_readVersion = 1;
     m_doctype = "matroska";
@@ -374,6 +382,7 @@ void MatroskaContainer::internalParseHeader()
 {
     static const string context("parsing header of Matroska container");
     // reset old results
+    invalidateReadAhead();
     m_firstElement = make_unique<EbmlElement>(*this, startOffset());
     m_additionalElements.clear();
     m_tracksElements.clear();
@@ -383,6 +392,7 @@ void MatroskaContainer::internalParseHeader()
     m_segmentCount = 0;
     uint64 currentOffset = 0;
     vector<MatroskaSeekInfo>::size_type seekInfosIndex = 0;
+    bool segmentTailProbed = false;
     // loop through all top level elements
     for(EbmlElement *topLevelElement = m_firstElement.get(); topLevelElement; topLevelElement = topLevelElement->nextSibling()) {
         try {
@@ -437,6 +447,7 @@ void MatroskaContainer::internalParseHeader()
                 break;
             case MatroskaIds::Segment:
                 ++m_segmentCount;
+                segmentTailProbed = false;
                 for(EbmlElement *subElement = topLevelElement->firstChild(); subElement; subElement = subElement->nextSibling()) {
                     try {
                         subElement->parse();
@@ -473,7 +484,7 @@ void MatroskaContainer::internalParseHeader()
                             break;
                         case MatroskaIds::Cluster:
                             // cluster reached
-                            // stop here if all relevant information has been gathered
+                            // -> gather elements referenced by "SeekHead"-elements
                             for(auto i = m_seekInfos.cbegin() + seekInfosIndex, end = m_seekInfos.cend(); i != end; ++i, ++seekInfosIndex) {
                                 for(const auto &infoPair : (*i)->info()) {
                                     uint64 offset = currentOffset + topLevelElement->dataOffset() + infoPair.second;
@@ -526,9 +537,16 @@ void MatroskaContainer::internalParseHeader()
                                     }
                                 }
                             }
-                            // not checking if m_tagsElements is empty avoids long parsing times when loading big files
-                            // but also has the disadvantage that the parser relies on the presence of a SeekHead element
-                            // (which is not mandatory) to detect tags at the end of the segment
+                            // probe the end of the segment for elements not referenced by a "SeekHead"-element
+                            // (so the parser does not rely on the presence of a SeekHead element to detect tags
+                            // at the end of the segment and does not need to walk through all clusters)
+                            if(!segmentTailProbed) {
+                                probeSegmentTail(*topLevelElement);
+                                segmentTailProbed = true;
+                            }
+                            // stop here if all relevant information has been gathered
+                            // (if no tags have been found so far, walk through all clusters unless the file is too big because
+                            // tags might still be located between clusters or before the probed range)
                             if(((!m_tracksElements.empty() && !m_tagsElements.empty()) || fileInfo().size() > m_maxFullParseSize) && !m_segmentInfoElements.empty()) {
                                 goto finish;
                             }
@@ -562,6 +580,174 @@ finish:
     }
 }
 
+/*!
+ * \brief Returns a pointer to the data at the specified \a offset of the stream().
+ *
+ * The data is read into a buffer of readAheadWindowSize bytes which is only refilled when data
+ * outside the buffered range is requested. This allows EbmlElement to decode the headers of
+ * subsequent elements without reading from the stream for every element. When the requested data
+ * is far away from the buffered range, only a small part is read because the access is likely not
+ * sequential.
+ *
+ * \param offset Specifies the offset of the requested data.
+ * \param size Specifies the number of requested bytes; is set to the number of available bytes
+ *             which is less than requested at the end of the file.
+ * \returns Returns a pointer to the data which is valid until the next call or nullptr if no data
+ *          is available.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ * \sa invalidateReadAhead()
+ */
+const char *MatroskaContainer::readAhead(uint64 offset, size_t &size)
+{
+    const uint64 bufferEnd = m_readAheadOffset + m_readAheadSize;
+    if(m_readAheadStream != &stream() || offset < m_readAheadOffset || offset + size > bufferEnd) {
+        const uint64 fileSize = fileInfo().size();
+        if(offset >= fileSize) {
+            size = 0;
+            return nullptr;
+        }
+        if(!m_readAheadBuffer) {
+            m_readAheadBuffer = make_unique<char[]>(readAheadWindowSize);
+        }
+        const bool sequential = m_readAheadStream == &stream() && offset >= m_readAheadOffset && offset < bufferEnd + readAheadWindowSize;
+        m_readAheadStream = nullptr;
+        m_readAheadSize = static_cast<size_t>(min<uint64>(max<uint64>(sequential ? readAheadWindowSize : 0x1000, size), fileSize - offset));
+        stream().seekg(static_cast<istream::off_type>(offset));
+        stream().read(m_readAheadBuffer.get(), static_cast<streamsize>(m_readAheadSize));
+        IoCounters::countSeek();
+        IoCounters::countRead(m_readAheadSize);
+        m_readAheadStream = &stream();
+        m_readAheadOffset = offset;
+    }
+    size = static_cast<size_t>(min<uint64>(size, m_readAheadOffset + m_readAheadSize - offset));
+    return m_readAheadBuffer.get() + (offset - m_readAheadOffset);
+}
+
+/*!
+ * \brief Probes the end of the specified \a segmentElement for "Tags"-, "Chapters"- and "Attachments"-elements.
+ *
+ * This private method is called when parsing the header to find trailing elements which are not
+ * referenced by a "SeekHead"-element without walking through all clusters. Only the last tailProbeSize()
+ * bytes of the segment are read (using a single read operation) and scanned backwards for the IDs of
+ * the mentioned elements (and "Cues"-elements which are commonly in between). A candidate is only
+ * accepted if
+ *  - its size is valid and the element does not exceed the segment,
+ *  - its first child has an ID expected within such an element (or is a "Void"/"CRC-32"-element) and
+ *  - it is followed by the end of the segment, another accepted candidate or a "Cluster"-/"Void"-element.
+ *
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void MatroskaContainer::probeSegmentTail(EbmlElement &segmentElement)
+{
+    static const string context("probing end of Matroska segment");
+    const uint64 segmentEnd = min(segmentElement.startOffset() + segmentElement.totalSize(), fileInfo().size());
+    if(segmentEnd <= segmentElement.dataOffset()) {
+        return;
+    }
+    const uint64 probeOffset = segmentEnd - min(m_tailProbeSize, segmentEnd - segmentElement.dataOffset());
+    const auto probeSize = static_cast<size_t>(segmentEnd - probeOffset);
+    if(probeSize < 5) {
+        return;
+    }
+    auto buffer = make_unique<byte[]>(probeSize);
+    stream().seekg(static_cast<istream::off_type>(probeOffset));
+    stream().read(reinterpret_cast<char *>(buffer.get()), static_cast<streamsize>(probeSize));
+
+    // scan backwards so elements at the end are accepted first (required to validate the preceding ones)
+    vector<uint64> acceptedOffsets;
+    for(size_t index = probeSize - 4; index-- > 0; ) {
+        // check whether the ID is one of the relevant top-level IDs
+        const uint32 id = BE::toUInt32(reinterpret_cast<const char *>(buffer.get() + index));
+        uint16 expectedChildId;
+        switch(id) {
+        case MatroskaIds::Tags:
+            expectedChildId = MatroskaIds::Tag;
+            break;
+        case MatroskaIds::Chapters:
+            expectedChildId = MatroskaIds::EditionEntry;
+            break;
+        case MatroskaIds::Attachments:
+            expectedChildId = MatroskaIds::AttachedFile;
+            break;
+        case MatroskaIds::Cues:
+            expectedChildId = MatroskaIds::CuePoint;
+            break;
+        default:
+            continue;
+        }
+
+        // validate the size denotation
+        const byte *const sizeDenotation = buffer.get() + index + 4;
+        byte sizeLength = 1, mask = 0x80;
+        while(sizeLength <= maxSizeLength() && !(*sizeDenotation & mask)) {
+            ++sizeLength;
+            mask >>= 1;
+        }
+        if(sizeLength > maxSizeLength() || index + 4 + sizeLength > probeSize) {
+            continue;
+        }
+        uint64 dataSize = *sizeDenotation & (mask - 1);
+        for(byte i = 1; i < sizeLength; ++i) {
+            dataSize = (dataSize << 8) | sizeDenotation[i];
+        }
+        const uint64 elementOffset = probeOffset + index;
+        const uint64 dataOffset = elementOffset + 4 + sizeLength;
+        if(dataSize > segmentEnd - dataOffset) {
+            continue;
+        }
+        const uint64 elementEnd = dataOffset + dataSize;
+
+        // validate the ID of the first child
+        const size_t dataIndex = index + 4 + sizeLength;
+        if(dataSize && dataIndex < probeSize) {
+            const byte firstByte = buffer[dataIndex];
+            const uint16 childId = expectedChildId > 0xFF && dataIndex + 1 < probeSize
+                    ? static_cast<uint16>((firstByte << 8) | buffer[dataIndex + 1])
+                    : firstByte;
+            if(childId != expectedChildId && firstByte != EbmlIds::Void && firstByte != EbmlIds::Crc32) {
+                continue;
+            }
+        }
+
+        // validate what follows the element
+        if(elementEnd != segmentEnd && find(acceptedOffsets.cbegin(), acceptedOffsets.cend(), elementEnd) == acceptedOffsets.cend()) {
+            const size_t endIndex = static_cast<size_t>(elementEnd - probeOffset);
+            if(!(buffer[endIndex] == EbmlIds::Void
+                 || (endIndex + 4 <= probeSize && BE::toUInt32(reinterpret_cast<const char *>(buffer.get() + endIndex)) == MatroskaIds::Cluster))) {
+                continue;
+            }
+        }
+        acceptedOffsets.push_back(elementOffset);
+
+        // add the element
+        vector<EbmlElement *> *elements;
+        switch(id) {
+        case MatroskaIds::Tags:
+            elements = &m_tagsElements;
+            break;
+        case MatroskaIds::Chapters:
+            elements = &m_chaptersElements;
+            break;
+        case MatroskaIds::Attachments:
+            elements = &m_attachmentsElements;
+            break;
+        default:
+            // "Cues"-elements are only accepted to validate preceding elements
+            continue;
+        }
+        if(excludesOffset(*elements, elementOffset)) {
+            auto element = make_unique<EbmlElement>(*this, elementOffset);
+            try {
+                element->parse();
+                m_additionalElements.emplace_back(move(element));
+                elements->emplace_back(m_additionalElements.back().get());
+            } catch(const Failure &) {
+                addNotification(NotificationType::Warning, argsToString("Can not parse element at ", elementOffset, " found at the end of the segment."), context);
+            }
+        }
+    }
+}
+
 /*!
  * \brief Parses the (segment) "Info"-element.
  *
@@ -622,7 +808,7 @@ void MatroskaContainer::internalParseTags()
                 case MatroskaIds::Tag:
                     m_tags.emplace_back(make_unique<MatroskaTag>());
                     try {
-                    m_tags.back()->parse(*subElement);
+                    m_tags.back()->parse(*subElement, fileInfo().tagFieldProjection());
                 } catch(NoDataFoundException &) {
                         m_tags.pop_back();
                     } catch(const Failure &) {
@@ -799,6 +985,7 @@ void MatroskaContainer::internalMakeFile()
     invalidateStatus();
     static const string context("making Matroska container");
     updateStatus("Calculating element sizes ...");
+    invalidateReadAhead();
 
     // basic validation of original file
     if(!isHeaderParsed()) {
@@ -863,6 +1050,7 @@ void MatroskaContainer::internalMakeFile()
     bool rewriteRequired = fileInfo().isForcingRewrite() || !fileInfo().saveFilePath().empty();
 
     // calculate EBML header size
+    MetricsScope preparingScope(fileInfo().metrics(), ProcessingPhase::PreparingMaking);
     // -> sub element ID sizes
     uint64 ebmlHeaderDataSize = 2 * 7;
     // -> content and size denotation length of numeric sub elements
@@ -876,54 +1064,78 @@ void MatroskaContainer::internalMakeFile()
     uint64 ebmlHeaderSize = 4 + EbmlElement::calculateSizeDenotationLength(ebmlHeaderDataSize) + ebmlHeaderDataSize;
 
     try {
-        // calculate size of "Tags"-element
-        for(auto &tag : tags()) {
-            tag->invalidateNotifications();
-            try {
-                tagMaker.emplace_back(tag->prepareMaking());
-                if(tagMaker.back().requiredSize() > 3) {
-                    // a tag of 3 bytes size is empty and can be skipped
-                    tagElementsSize += tagMaker.back().requiredSize();
+        // calculate sizes of "Tags"-, "Attachments"- and "Tracks"-element concurrently
+        // -> the makers only read the already parsed element tree
+        // -> elements of the track headers which need to be copied are read using an independent stream
+        // -> notifications are added afterwards because the notification list of the container is not thread-safe
+        parallelFor(3, [&] (size_t job) {
+            switch(job) {
+            case 0:
+                for(auto &tag : tags()) {
+                    tag->invalidateNotifications();
+                    try {
+                        tagMaker.emplace_back(tag->prepareMaking());
+                        if(tagMaker.back().requiredSize() > 3) {
+                            // a tag of 3 bytes size is empty and can be skipped
+                            tagElementsSize += tagMaker.back().requiredSize();
+                        }
+                    } catch(const Failure &) {
+                        // nothing to do because notifications will be added anyways
+                    }
                 }
-            } catch(const Failure &) {
-                // nothing to do because notifications will be added anyways
+                break;
+            case 1:
+                for(auto &attachment : m_attachments) {
+                    if(!attachment->isIgnored()) {
+                        attachment->invalidateNotifications();
+                        try {
+                            attachmentMaker.emplace_back(attachment->prepareMaking());
+                            if(attachmentMaker.back().requiredSize() > 3) {
+                                // an attachment of 3 bytes size is empty and can be skipped
+                                attachedFileElementsSize += attachmentMaker.back().requiredSize();
+                            }
+                        } catch(const Failure &) {
+                            // nothing to do because notifications will be added anyways
+                        }
+                    }
+                }
+                break;
+            case 2: {
+                if(tracks().empty()) {
+                    break;
+                }
+                NativeFileStream trackStream;
+                trackStream.exceptions(ios_base::badbit | ios_base::failbit);
+                trackStream.open(fileInfo().path(), ios_base::in | ios_base::binary);
+                for(auto &track : tracks()) {
+                    track->invalidateNotifications();
+                    try {
+                        trackHeaderMaker.emplace_back(track->prepareMakingHeader(trackStream));
+                        if(trackHeaderMaker.back().requiredSize() > 3) {
+                            // a track header of 3 bytes size is empty and can be skipped
+                            trackHeaderElementsSize += trackHeaderMaker.back().requiredSize();
+                        }
+                    } catch(const Failure &) {
+                        // nothing to do because notifications will be added anyways
+                    }
+                }
+                break;
+            }
             }
+        });
+        for(auto &tag : tags()) {
             addNotifications(*tag);
         }
-        tagsSize = tagElementsSize ? 4 + EbmlElement::calculateSizeDenotationLength(tagElementsSize) + tagElementsSize : 0;
-
-        // calculate size of "Attachments"-element
         for(auto &attachment : m_attachments) {
             if(!attachment->isIgnored()) {
-                attachment->invalidateNotifications();
-                try {
-                    attachmentMaker.emplace_back(attachment->prepareMaking());
-                    if(attachmentMaker.back().requiredSize() > 3) {
-                        // an attachment of 3 bytes size is empty and can be skipped
-                        attachedFileElementsSize += attachmentMaker.back().requiredSize();
-                    }
-                } catch(const Failure &) {
-                    // nothing to do because notifications will be added anyways
-                }
                 addNotifications(*attachment);
             }
         }
-        attachmentsSize = attachedFileElementsSize ? 4 + EbmlElement::calculateSizeDenotationLength(attachedFileElementsSize) + attachedFileElementsSize : 0;
-
-        // calculate size of "Tracks"-element
         for(auto &track : tracks()) {
-            track->invalidateNotifications();
-            try {
-                trackHeaderMaker.emplace_back(track->prepareMakingHeader());
-                if(trackHeaderMaker.back().requiredSize() > 3) {
-                    // a track header of 3 bytes size is empty and can be skipped
-                    trackHeaderElementsSize += trackHeaderMaker.back().requiredSize();
-                }
-            } catch(const Failure &) {
-                // nothing to do because notifications will be added anyways
-            }
             addNotifications(*track);
         }
+        tagsSize = tagElementsSize ? 4 + EbmlElement::calculateSizeDenotationLength(tagElementsSize) + tagElementsSize : 0;
+        attachmentsSize = attachedFileElementsSize ? 4 + EbmlElement::calculateSizeDenotationLength(attachedFileElementsSize) + attachedFileElementsSize : 0;
         trackHeaderSize = trackHeaderElementsSize ? 4 + EbmlElement::calculateSizeDenotationLength(trackHeaderElementsSize) + trackHeaderElementsSize : 0;
 
 
@@ -1398,6 +1610,8 @@ nonRewriteCalculations:
         throwIoFailure(what);
     }
 
+    preparingScope.stop();
+
     if(isAborted()) {
         throw OperationAbortedException();
     }
@@ -1410,6 +1624,8 @@ nonRewriteCalculations:
     string backupPath;
     NativeFileStream &outputStream = fileInfo().stream();
     NativeFileStream backupStream; // create a stream to open the backup/original file for the case rewriting the file is required
+    CopyEngine *const assignedCopyEngine = copyEngine();
+    unique_ptr<FileCopyEngine> fileCopyEngine;
     BinaryWriter outputWriter(&outputStream);
     char buff[8]; // buffer used to make size denotations
 
@@ -1442,6 +1658,12 @@ nonRewriteCalculations:
         // set backup stream as associated input stream since we need the original elements to write the new file
         setStream(backupStream);
 
+        // copy media data from the backup/original file to the new file within the kernel where possible
+        if(!copyEngine()) {
+            fileCopyEngine = make_unique<FileCopyEngine>(backupPath.empty() ? fileInfo().path() : backupPath, fileInfo().saveFilePath().empty() ? fileInfo().path() : fileInfo().saveFilePath());
+            setCopyEngine(fileCopyEngine.get());
+        }
+
         // TODO: reduce code duplication
 
     } else { // !rewriteRequired
@@ -1622,6 +1844,7 @@ nonRewriteCalculations:
                 // write media data / "Cluster"-elements
                 level1Element = level0Element->childById(MatroskaIds::Cluster);
                 if(rewriteRequired) {
+                    MetricsScope writingScope(fileInfo().metrics(), ProcessingPhase::WritingMediaData);
                     // update status, check whether the operation has been aborted
                     if(isAborted()) {
                         throw OperationAbortedException();
@@ -1733,6 +1956,9 @@ nonRewriteCalculations:
             }
         }
 
+        // the file copy engine is only valid for the backup/original file
+        setCopyEngine(assignedCopyEngine);
+
         // reparse what is written so far
         updateStatus("Reparsing output file ...");
         if(rewriteRequired) {
@@ -1793,6 +2019,7 @@ nonRewriteCalculations:
 
         // handle errors (which might have been occured after renaming/creating backup file)
     } catch(...) {
+        setCopyEngine(assignedCopyEngine);
         BackupHelper::handleFailureAfterFileModified(fileInfo(), backupPath, outputStream, backupStream, context);
     }
 }
@@ -35,6 +35,8 @@ public:
 
     static uint64 maxFullParseSize();
     void setMaxFullParseSize(uint64 maxFullParseSize);
+    static uint64 tailProbeSize();
+    static void setTailProbeSize(uint64 tailProbeSize);
     const std::vector<std::unique_ptr<MatroskaEditionEntry> > &editionEntires() const;
     MatroskaChapter *chapter(std::size_t index);
     std::size_t chapterCount() const;
@@ -44,12 +46,16 @@ public:
     ElementPosition determineElementPosition(uint64 elementId) const;
     ElementPosition determineTagPosition() const;
     ElementPosition determineIndexPosition() const;
+    const char *readAhead(uint64 offset, std::size_t &size);
+    void invalidateReadAhead();
 
     virtual bool supportsTitle() const;
     virtual std::size_t segmentCount() const;
 
     void reset();
 
+    static constexpr std::size_t readAheadWindowSize = 0x10000;
+
 protected:
     void internalParseHeader();
     void internalParseTags();
@@ -61,6 +67,7 @@ protected:
 private:
     void parseSegmentInfo();
     void fetchEditionEntryElements();
+    void probeSegmentTail(EbmlElement &segmentElement);
 
     uint64 m_maxIdLength;
     uint64 m_maxSizeLength;
@@ -74,7 +81,12 @@ private:
     std::vector<std::unique_ptr<MatroskaEditionEntry> > m_editionEntries;
     std::vector<std::unique_ptr<MatroskaAttachment> > m_attachments;
     std::size_t m_segmentCount;
+    std::unique_ptr<char[]> m_readAheadBuffer;
+    std::iostream *m_readAheadStream;
+    uint64 m_readAheadOffset;
+    std::size_t m_readAheadSize;
     static uint64 m_maxFullParseSize;
+    static uint64 m_tailProbeSize;
 };
 
 /*!
@@ -104,11 +116,13 @@ inline const std::vector<std::unique_ptr<MatroskaSeekInfo> > &MatroskaContainer:
 /*!
  * \brief Returns the maximal file size for a "full parse" in byte.
  *
- * The "Tags" element (which holds the tag information) is commonly at the end of a Matroska file. Hence the
- * parser needs to walk through the entire file to find the tag information if no "SeekHead" element is present
- * which might causes long loading times. To avoid this a maximal file size for a "full parse" can be specified.
- * The disadvantage is that the parser relies on the presence of a SeekHead element on larger files to retrieve
- * tag information.
+ * The parser stops at the first "Cluster"-element if the "Tracks"-, "Tags"- and "Info"-elements have been found.
+ * Otherwise it walks through the clusters to find them which might causes long loading times. To avoid this a maximal
+ * file size for a "full parse" can be specified.
+ *
+ * Trailing "Tags"-elements (which hold the tag information and are commonly at the end of a Matroska file) are
+ * found using the "SeekHead"-element or by probing the end of the segment (see tailProbeSize()) so walking through
+ * the clusters is usually only required for files without tags.
  *
  * The default value is 50 MiB.
  *
@@ -128,6 +142,42 @@ inline void MatroskaContainer::setMaxFullParseSize(uint64 maxFullParseSize)
     m_maxFullParseSize = maxFullParseSize;
 }
 
+/*!
+ * \brief Discards the data buffered by readAhead().
+ * \remarks Must be called when the data of the file is modified.
+ */
+inline void MatroskaContainer::invalidateReadAhead()
+{
+    m_readAheadStream = nullptr;
+    m_readAheadSize = 0;
+}
+
+/*!
+ * \brief Returns the number of bytes read from the end of a segment to find trailing elements.
+ *
+ * The "Tags"-, "Chapters"- and "Attachments"-elements are commonly at the end of a segment. To find them even if
+ * they are not referenced by a "SeekHead"-element, the parser reads the specified number of bytes from the end of
+ * the segment and scans them for these elements. Elements starting before this range are not found this way.
+ *
+ * The default value is 256 KiB.
+ *
+ * \sa setTailProbeSize()
+ */
+inline uint64 MatroskaContainer::tailProbeSize()
+{
+    return m_tailProbeSize;
+}
+
+/*!
+ * \brief Sets the number of bytes read from the end of a segment to find trailing elements.
+ * \remarks Setting 0 disables probing the end of segments.
+ * \sa tailProbeSize()
+ */
+inline void MatroskaContainer::setTailProbeSize(uint64 tailProbeSize)
+{
+    m_tailProbeSize = tailProbeSize;
+}
+
 /*!
  * \brief Returns the edition entries.
  */
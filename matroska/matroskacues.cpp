@@ -3,6 +3,8 @@
 
 #include <c++utilities/conversion/binaryconversion.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace ConversionUtilities;
 
@@ -38,7 +40,7 @@ namespace Media {
 uint64 MatroskaCuePositionUpdater::totalSize() const
 {
     if(m_cuesElement) {
-        uint64 size = m_sizes.at(m_cuesElement);
+        const uint64 size = m_sizes.front().size;
         return 4 + EbmlElement::calculateSizeDenotationLength(size) + size;
     } else {
         return 0;
@@ -54,7 +56,10 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
     static const string context("parsing \"Cues\"-element");
     clear();
     uint64 cuesElementSize = 0, cuePointElementSize, cueTrackPositionsElementSize, cueReferenceElementSize, pos, relPos, statePos;
+    size_t cuePointIndex, cueTrackPositionsIndex, cueReferenceIndex;
     EbmlElement *cueRelativePositionElement, *cueClusterPositionElement;
+    // the size entries are stored in the order the elements are written by make()
+    const size_t cuesIndex = addSizeEntry(cuesElement, string::npos);
     for(EbmlElement *cuePointElement = cuesElement->firstChild(); cuePointElement; cuePointElement = cuePointElement->nextSibling()) {
         // parse childs of "Cues"-element which must be "CuePoint"-elements
         cuePointElement->parse();
@@ -64,6 +69,7 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
             break;
         case MatroskaIds::CuePoint:
             cuePointElementSize = 0;
+            cuePointIndex = addSizeEntry(cuePointElement, cuesIndex);
             for(EbmlElement *cuePointChild = cuePointElement->firstChild(); cuePointChild; cuePointChild = cuePointChild->nextSibling()) {
                 // parse childs of "CuePoint"-element
                 cuePointChild->parse();
@@ -77,10 +83,11 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
                     break;
                 case MatroskaIds::CueTrackPositions:
                     cueTrackPositionsElementSize = 0;
+                    cueTrackPositionsIndex = addSizeEntry(cuePointChild, cuePointIndex);
                     cueRelativePositionElement = cueClusterPositionElement = nullptr;
                     for(EbmlElement *cueTrackPositionsChild = cuePointChild->firstChild(); cueTrackPositionsChild; cueTrackPositionsChild = cueTrackPositionsChild->nextSibling()) {
                         // parse childs of "CueTrackPositions"-element
-                        cueTrackPositionsChild->parse();                        
+                        cueTrackPositionsChild->parse();
                         switch(cueTrackPositionsChild->id()) {
                         case MatroskaIds::CueTrack:
                         case MatroskaIds::CueDuration:
@@ -94,15 +101,16 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
                         case MatroskaIds::CueClusterPosition:
                             pos = (cueClusterPositionElement = cueTrackPositionsChild)->readUInteger();
                             cueTrackPositionsElementSize += 2 + EbmlElement::calculateUIntegerLength(pos);
-                            m_offsets.emplace(cueTrackPositionsChild, pos);
+                            m_offsets.emplace_back(OffsetEntry{cueTrackPositionsChild, cueTrackPositionsIndex, MatroskaOffsetStates(pos)});
                             break;
                         case MatroskaIds::CueCodecState:
                             statePos = cueTrackPositionsChild->readUInteger();
                             cueTrackPositionsElementSize += 2 + EbmlElement::calculateUIntegerLength(statePos);
-                            m_offsets.emplace(cueTrackPositionsChild, statePos);
+                            m_offsets.emplace_back(OffsetEntry{cueTrackPositionsChild, cueTrackPositionsIndex, MatroskaOffsetStates(statePos)});
                             break;
                         case MatroskaIds::CueReference:
                             cueReferenceElementSize = 0;
+                            cueReferenceIndex = addSizeEntry(cueTrackPositionsChild, cueTrackPositionsIndex);
                             for(EbmlElement *cueReferenceChild = cueTrackPositionsChild->firstChild(); cueReferenceChild; cueReferenceChild = cueReferenceChild->nextSibling()) {
                                 // parse childs of "CueReference"-element
                                 cueReferenceChild->parse();
@@ -119,14 +127,14 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
                                 case MatroskaIds::CueRefCodecState:
                                     statePos = cueReferenceChild->readUInteger();
                                     cueReferenceElementSize += 2 + EbmlElement::calculateUIntegerLength(statePos);
-                                    m_offsets.emplace(cueReferenceChild, statePos);
+                                    m_offsets.emplace_back(OffsetEntry{cueReferenceChild, cueReferenceIndex, MatroskaOffsetStates(statePos)});
                                     break;
                                 default:
                                     addNotification(NotificationType::Warning, "\"CueReference\"-element contains a element which is not known to the parser. It will be ignored.", context);
                                 }
                             }
                             cueTrackPositionsElementSize += 1 + EbmlElement::calculateSizeDenotationLength(cueReferenceElementSize) + cueReferenceElementSize;
-                            m_sizes.emplace(cueTrackPositionsChild, cueReferenceElementSize);
+                            m_sizes[cueReferenceIndex].size = cueReferenceElementSize;
                             break;
                         default:
                             addNotification(NotificationType::Warning, "\"CueTrackPositions\"-element contains a element which is not known to the parser. It will be ignored.", context);
@@ -136,23 +144,58 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
                         addNotification(NotificationType::Critical, "\"CueTrackPositions\"-element does not contain mandatory \"CueClusterPosition\"-element.", context);
                     } else if(cueRelativePositionElement) {
                         cueTrackPositionsElementSize += 2 + EbmlElement::calculateUIntegerLength(relPos);
-                        m_relativeOffsets.emplace(piecewise_construct, forward_as_tuple(cueRelativePositionElement), forward_as_tuple(pos, relPos));
+                        m_relativeOffsets.emplace_back(RelativeOffsetEntry{cueRelativePositionElement, cueTrackPositionsIndex, MatroskaReferenceOffsetPair(pos, relPos)});
                     }
                     cuePointElementSize += 1 + EbmlElement::calculateSizeDenotationLength(cueTrackPositionsElementSize) + cueTrackPositionsElementSize;
-                    m_sizes.emplace(cuePointChild, cueTrackPositionsElementSize);
+                    m_sizes[cueTrackPositionsIndex].size = cueTrackPositionsElementSize;
                     break;
                 default:
                     addNotification(NotificationType::Warning, "\"CuePoint\"-element contains a element which is not a \"CueTime\"- or a \"CueTrackPositions\"-element. It will be ignored.", context);
                 }
             }
             cuesElementSize += 1 + EbmlElement::calculateSizeDenotationLength(cuePointElementSize) + cuePointElementSize;
-            m_sizes.emplace(cuePointElement, cuePointElementSize);
+            m_sizes[cuePointIndex].size = cuePointElementSize;
             break;
         default:
             addNotification(NotificationType::Warning, "\"Cues\"-element contains a element which is not a \"CuePoint\"-element. It will be ignored.", context);
         }
     }
-    m_sizes.emplace(m_cuesElement = cuesElement, cuesElementSize);
+    m_sizes[cuesIndex].size = cuesElementSize;
+    buildIndexes();
+    m_cuesElement = cuesElement;
+}
+
+/*!
+ * \brief Adds a size entry for the specified \a element which is a child of the entry at the specified \a parent index.
+ * \returns Returns the index of the new entry.
+ */
+size_t MatroskaCuePositionUpdater::addSizeEntry(EbmlElement *element, size_t parent)
+{
+    m_sizes.emplace_back(SizeEntry{element, parent, 0});
+    return m_sizes.size() - 1;
+}
+
+/*!
+ * \brief Builds the indexes to look up offset entries by their initial values.
+ *
+ * This allows updateOffsets() and updateRelativeOffsets() to find the affected entries
+ * without walking through all entries which would be quadratic when called for each "Cluster".
+ */
+void MatroskaCuePositionUpdater::buildIndexes()
+{
+    m_offsetIndex.clear();
+    m_offsetIndex.reserve(m_offsets.size());
+    for(size_t index = 0, count = m_offsets.size(); index != count; ++index) {
+        m_offsetIndex.emplace_back(m_offsets[index].offset.initialValue(), index);
+    }
+    sort(m_offsetIndex.begin(), m_offsetIndex.end());
+    m_relativeOffsetIndex.clear();
+    m_relativeOffsetIndex.reserve(m_relativeOffsets.size());
+    for(size_t index = 0, count = m_relativeOffsets.size(); index != count; ++index) {
+        const MatroskaReferenceOffsetPair &offset = m_relativeOffsets[index].offset;
+        m_relativeOffsetIndex.emplace_back(make_pair(offset.referenceOffset(), offset.initialValue()), index);
+    }
+    sort(m_relativeOffsetIndex.begin(), m_relativeOffsetIndex.end());
 }
 
 /*!
@@ -162,10 +205,12 @@ void MatroskaCuePositionUpdater::parse(EbmlElement *cuesElement)
 bool MatroskaCuePositionUpdater::updateOffsets(uint64 originalOffset, uint64 newOffset)
 {
     bool updated = false;
-    for(auto &offset : m_offsets) {
-        if(offset.second.initialValue() == originalOffset && offset.second.currentValue() != newOffset) {
-            updated = updateSize(offset.first->parent(), static_cast<int>(EbmlElement::calculateUIntegerLength(newOffset)) - static_cast<int>(EbmlElement::calculateUIntegerLength(offset.second.currentValue()))) || updated;
-            offset.second.update(newOffset);
+    for(auto i = lower_bound(m_offsetIndex.cbegin(), m_offsetIndex.cend(), make_pair(originalOffset, static_cast<size_t>(0))), end = m_offsetIndex.cend();
+        i != end && i->first == originalOffset; ++i) {
+        OffsetEntry &entry = m_offsets[i->second];
+        if(entry.offset.currentValue() != newOffset) {
+            updated = updateSize(entry.parent, static_cast<int>(EbmlElement::calculateUIntegerLength(newOffset)) - static_cast<int>(EbmlElement::calculateUIntegerLength(entry.offset.currentValue()))) || updated;
+            entry.offset.update(newOffset);
         }
     }
     return updated;
@@ -178,44 +223,40 @@ bool MatroskaCuePositionUpdater::updateOffsets(uint64 originalOffset, uint64 new
 bool MatroskaCuePositionUpdater::updateRelativeOffsets(uint64 referenceOffset, uint64 originalRelativeOffset, uint64 newRelativeOffset)
 {
     bool updated = false;
-    for(auto &offset : m_relativeOffsets) {
-        if(offset.second.referenceOffset() == referenceOffset && offset.second.initialValue() == originalRelativeOffset && offset.second.currentValue() != newRelativeOffset) {
-            updated = updateSize(offset.first->parent(), static_cast<int>(EbmlElement::calculateUIntegerLength(newRelativeOffset)) - static_cast<int>(EbmlElement::calculateUIntegerLength(offset.second.currentValue()))) || updated;
-            offset.second.update(newRelativeOffset);
+    const auto key = make_pair(referenceOffset, originalRelativeOffset);
+    for(auto i = lower_bound(m_relativeOffsetIndex.cbegin(), m_relativeOffsetIndex.cend(), make_pair(key, static_cast<size_t>(0))), end = m_relativeOffsetIndex.cend();
+        i != end && i->first == key; ++i) {
+        RelativeOffsetEntry &entry = m_relativeOffsets[i->second];
+        if(entry.offset.currentValue() != newRelativeOffset) {
+            updated = updateSize(entry.parent, static_cast<int>(EbmlElement::calculateUIntegerLength(newRelativeOffset)) - static_cast<int>(EbmlElement::calculateUIntegerLength(entry.offset.currentValue()))) || updated;
+            entry.offset.update(newRelativeOffset);
         }
     }
     return updated;
 }
 
 /*!
- * \brief Updates the sizes for the specified \a element by adding the specified \a shift value.
+ * \brief Updates the sizes for the element at the specified \a index by adding the specified \a shift value.
  * \returns Returns whether the size of the "Cues"-element has been altered.
  */
-bool MatroskaCuePositionUpdater::updateSize(EbmlElement *element, int shift)
+bool MatroskaCuePositionUpdater::updateSize(size_t index, int shift)
 {
     if(!shift) {
         // shift is gone
         return false;
     }
-    if(!element) {
-        // there was no parent (shouldn't happen in a normal file structure since the Segment element should
-        // be parent of the Cues element)
-        return shift;
-    }
-    try {
-        // get size info
-        uint64 &size = m_sizes.at(element);
-        // calculate new size
-        uint64 newSize = shift > 0 ? size + static_cast<uint64>(shift) : size - static_cast<uint64>(-shift);
-        // shift parent
-        bool updated = updateSize(element->parent(), shift + static_cast<int>(EbmlElement::calculateSizeDenotationLength(newSize)) - static_cast<int>(EbmlElement::calculateSizeDenotationLength(size)));
-        // apply new size
-        size = newSize;
-        return updated;
-    } catch(const out_of_range &) {
-        // the element is out of the scope of the cue position updater (likely the Segment element)
-        return shift;
+    if(index == string::npos) {
+        // the element is out of the scope of the cue position updater (the parent of the Cues element)
+        return true;
     }
+    SizeEntry &entry = m_sizes[index];
+    // calculate new size
+    const uint64 newSize = shift > 0 ? entry.size + static_cast<uint64>(shift) : entry.size - static_cast<uint64>(-shift);
+    // shift parent
+    const bool updated = updateSize(entry.parent, shift + static_cast<int>(EbmlElement::calculateSizeDenotationLength(newSize)) - static_cast<int>(EbmlElement::calculateSizeDenotationLength(entry.size)));
+    // apply new size
+    entry.size = newSize;
+    return updated;
 }
 
 /*!
@@ -231,11 +272,27 @@ void MatroskaCuePositionUpdater::make(ostream &stream)
     // temporary variables
     char buff[8];
     byte len;
+    // the entries are consumed in the order they have been added by parse()
+    auto sizeEntry = m_sizes.cbegin();
+    auto offsetEntry = m_offsets.cbegin();
+    auto relativeOffsetEntry = m_relativeOffsets.cbegin();
+    const auto sizeOf = [this, &sizeEntry] (EbmlElement *element) {
+        if(sizeEntry == m_sizes.cend() || sizeEntry->element != element) {
+            throw out_of_range("no size entry");
+        }
+        return (sizeEntry++)->size;
+    };
+    const auto offsetOf = [this, &offsetEntry] (EbmlElement *element) {
+        if(offsetEntry == m_offsets.cend() || offsetEntry->element != element) {
+            throw out_of_range("no offset entry");
+        }
+        return (offsetEntry++)->offset.currentValue();
+    };
     // write "Cues"-element
     try {
         BE::getBytes(static_cast<uint32>(MatroskaIds::Cues), buff);
         stream.write(buff, 4);
-        len = EbmlElement::makeSizeDenotation(m_sizes[m_cuesElement], buff);
+        len = EbmlElement::makeSizeDenotation(sizeOf(m_cuesElement), buff);
         stream.write(buff, len);
         // loop through original elements and write (a updated version) of them
         for(EbmlElement *cuePointElement = m_cuesElement->firstChild(); cuePointElement; cuePointElement = cuePointElement->nextSibling()) {
@@ -247,7 +304,7 @@ void MatroskaCuePositionUpdater::make(ostream &stream)
             case MatroskaIds::CuePoint:
                 // write "CuePoint"-element
                 stream.put(MatroskaIds::CuePoint);
-                len = EbmlElement::makeSizeDenotation(m_sizes[cuePointElement], buff);
+                len = EbmlElement::makeSizeDenotation(sizeOf(cuePointElement), buff);
                 stream.write(buff, len);
                 for(EbmlElement *cuePointChild = cuePointElement->firstChild(); cuePointChild; cuePointChild = cuePointChild->nextSibling()) {
                     cuePointChild->parse();
@@ -264,7 +321,7 @@ void MatroskaCuePositionUpdater::make(ostream &stream)
                     case MatroskaIds::CueTrackPositions:
                         // write "CueTrackPositions"-element
                         stream.put(MatroskaIds::CueTrackPositions);
-                        len = EbmlElement::makeSizeDenotation(m_sizes[cuePointChild], buff);
+                        len = EbmlElement::makeSizeDenotation(sizeOf(cuePointChild), buff);
                         stream.write(buff, len);
                         for(EbmlElement *cueTrackPositionsChild = cuePointChild->firstChild(); cueTrackPositionsChild; cueTrackPositionsChild = cueTrackPositionsChild->nextSibling()) {
                             cueTrackPositionsChild->parse();
@@ -278,22 +335,21 @@ void MatroskaCuePositionUpdater::make(ostream &stream)
                                 //cueTrackPositionsChild->copyEntirely(stream);
                                 break;
                             case MatroskaIds::CueRelativePosition:
-                                try {
-                                    EbmlElement::makeSimpleElement(stream, cueTrackPositionsChild->id(), m_relativeOffsets.at(cueTrackPositionsChild).currentValue());
-                                } catch(const out_of_range &) {
-                                    // we were not able parse the relative offset because the absolute offset is missing
-                                    // continue anyways
+                                if(relativeOffsetEntry != m_relativeOffsets.cend() && relativeOffsetEntry->element == cueTrackPositionsChild) {
+                                    EbmlElement::makeSimpleElement(stream, cueTrackPositionsChild->id(), (relativeOffsetEntry++)->offset.currentValue());
                                 }
+                                // otherwise we were not able parse the relative offset because the absolute offset is missing
+                                // continue anyways
                                 break;
                             case MatroskaIds::CueClusterPosition:
                             case MatroskaIds::CueCodecState:
                                 // write "CueClusterPosition"/"CueCodecState"-element
-                                EbmlElement::makeSimpleElement(stream, cueTrackPositionsChild->id(), m_offsets.at(cueTrackPositionsChild).currentValue());
+                                EbmlElement::makeSimpleElement(stream, cueTrackPositionsChild->id(), offsetOf(cueTrackPositionsChild));
                                 break;
                             case MatroskaIds::CueReference:
                                 // write "CueReference"-element
-                                stream.put(MatroskaIds::CueRefTime);
-                                len = EbmlElement::makeSizeDenotation(m_sizes[cueTrackPositionsChild], buff);
+                                stream.put(MatroskaIds::CueReference);
+                                len = EbmlElement::makeSizeDenotation(sizeOf(cueTrackPositionsChild), buff);
                                 stream.write(buff, len);
                                 for(EbmlElement *cueReferenceChild = cueTrackPositionsChild->firstChild(); cueReferenceChild; cueReferenceChild = cueReferenceChild->nextSibling()) {
                                     cueReferenceChild->parse();
@@ -306,12 +362,11 @@ void MatroskaCuePositionUpdater::make(ostream &stream)
                                         // write unchanged childs of "CueReference"-element
                                         cueReferenceChild->copyBuffer(stream);
                                         cueReferenceChild->discardBuffer();
-                                        cueReferenceChild->copyEntirely(stream);
                                         break;
                                     case MatroskaIds::CueRefCluster:
                                     case MatroskaIds::CueRefCodecState:
                                         // write "CueRefCluster"/"CueRefCodecState"-element
-                                        EbmlElement::makeSimpleElement(stream, cueReferenceChild->id(), m_offsets.at(cueReferenceChild).currentValue());
+                                        EbmlElement::makeSimpleElement(stream, cueReferenceChild->id(), offsetOf(cueReferenceChild));
                                         break;
                                     default:
                                         addNotification(NotificationType::Warning, "\"CueReference\"-element contains a element which is not known to the parser. It will be ignored.", context);
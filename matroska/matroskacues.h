@@ -3,8 +3,8 @@
 
 #include "./ebmlelement.h"
 
-#include <map>
 #include <ostream>
+#include <vector>
 
 namespace Media {
 
@@ -74,12 +74,38 @@ public:
     void clear();
 
 private:
-    bool updateSize(EbmlElement *element, int shift);
+    /// \brief Holds the size of a master element within the "Cues"-element.
+    struct SizeEntry
+    {
+        EbmlElement *element;
+        std::size_t parent;
+        uint64 size;
+    };
+    /// \brief Holds an (absolute) offset within the "Cues"-element.
+    struct OffsetEntry
+    {
+        EbmlElement *element;
+        std::size_t parent;
+        MatroskaOffsetStates offset;
+    };
+    /// \brief Holds a relative offset within the "Cues"-element.
+    struct RelativeOffsetEntry
+    {
+        EbmlElement *element;
+        std::size_t parent;
+        MatroskaReferenceOffsetPair offset;
+    };
+
+    std::size_t addSizeEntry(EbmlElement *element, std::size_t parent);
+    bool updateSize(std::size_t index, int shift);
+    void buildIndexes();
 
     EbmlElement *m_cuesElement;
-    std::map<EbmlElement *, MatroskaOffsetStates> m_offsets;
-    std::map<EbmlElement *, MatroskaReferenceOffsetPair> m_relativeOffsets;
-    std::map<EbmlElement *, uint64> m_sizes;
+    std::vector<SizeEntry> m_sizes;
+    std::vector<OffsetEntry> m_offsets;
+    std::vector<RelativeOffsetEntry> m_relativeOffsets;
+    std::vector<std::pair<uint64, std::size_t> > m_offsetIndex;
+    std::vector<std::pair<std::pair<uint64, uint64>, std::size_t> > m_relativeOffsetIndex;
 };
 
 /*!
@@ -107,8 +133,11 @@ inline EbmlElement *MatroskaCuePositionUpdater::cuesElement() const
 inline void MatroskaCuePositionUpdater::clear()
 {
     m_cuesElement = nullptr;
-    m_offsets.clear();
     m_sizes.clear();
+    m_offsets.clear();
+    m_relativeOffsets.clear();
+    m_offsetIndex.clear();
+    m_relativeOffsetIndex.clear();
 }
 
 } // namespace Media
@@ -1,9 +1,10 @@
 #include "./matroskatag.h"
 #include "./ebmlelement.h"
 
-#include <map>
+#include "../lookuptable.h"
+#include "../tagfieldprojection.h"
+
 #include <initializer_list>
-#include <stdexcept>
 
 using namespace std;
 using namespace ConversionUtilities;
@@ -48,44 +49,64 @@ std::string MatroskaTag::fieldId(KnownField field) const
 KnownField MatroskaTag::knownField(const std::string &id) const
 {
     using namespace MatroskaTagIds;
-    static const map<string, KnownField> map({
-        {artist(), KnownField::Artist},
+    static constexpr LookupEntry<KnownField> knownFieldTable[] = {
+        {actor(), KnownField::Performers},
         {album(), KnownField::Album},
+        {artist(), KnownField::Artist},
+        {bpm(), KnownField::Bpm},
+        {bps(), KnownField::Bps},
         {comment(), KnownField::Comment},
+        {composer(), KnownField::Composer},
         {dateRecorded(), KnownField::RecordDate},
         {dateRelease(), KnownField::Year},
-        {title(), KnownField::Title},
-        {partNumber(), KnownField::PartNumber},
-        {totalParts(), KnownField::TotalParts},
+        {description(), KnownField::Description},
+        {duration(), KnownField::Length},
         {encoder(), KnownField::Encoder},
         {encoderSettings(), KnownField::EncoderSettings},
-        {bpm(), KnownField::Bpm},
-        {bps(), KnownField::Bps},
-        {rating(), KnownField::Rating},
-        {description(), KnownField::Description},
-        {lyrics(), KnownField::Lyrics},
+        {genre(), KnownField::Genre},
         {label(), KnownField::RecordLabel},
-        {actor(), KnownField::Performers},
-        {lyricist(), KnownField::Lyricist},
-        {composer(), KnownField::Composer},
-        {duration(), KnownField::Length},
         {language(), KnownField::Language},
-    });
-    try {
-        return map.at(id);
-    } catch(const out_of_range &) {
-        return KnownField::Invalid;
+        {lyricist(), KnownField::Lyricist},
+        {lyrics(), KnownField::Lyrics},
+        {partNumber(), KnownField::PartNumber},
+        {rating(), KnownField::Rating},
+        {title(), KnownField::Title},
+        {totalParts(), KnownField::TotalParts},
+    };
+    static_assert(isLookupTableSorted(knownFieldTable, false), "Matroska tag field table must be sorted");
+    return findInLookupTable(knownFieldTable, id, false, KnownField::Invalid);
+}
+
+namespace {
+
+/*!
+ * \brief Returns the name of the specified \a simpleTagElement without reading its value.
+ * \returns Returns an empty string if the element has no "TagName"-element.
+ */
+string simpleTagName(EbmlElement &simpleTagElement)
+{
+    for(EbmlElement *child = simpleTagElement.firstChild(); child; child = child->nextSibling()) {
+        child->parse();
+        if(child->id() == MatroskaIds::TagName) {
+            return child->readString();
+        }
     }
+    return string();
+}
+
 }
 
 /*!
  * \brief Parses tag information from the specified \a tagElement.
  *
+ * If a \a projection is specified, the values of "SimpleTag"-elements not included in it are not
+ * read. The elements are remembered so they can be parsed later using parseSkippedFields().
+ *
  * \throws Throws std::ios_base::failure when an IO error occurs.
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void MatroskaTag::parse(EbmlElement &tagElement)
+void MatroskaTag::parse(EbmlElement &tagElement, const TagFieldProjection *projection)
 {
     invalidateStatus();
     static const string context("parsing Matroska tag");
@@ -97,6 +118,13 @@ void MatroskaTag::parse(EbmlElement &tagElement)
         switch(child->id()) {
         case MatroskaIds::SimpleTag: {
             try {
+                if(projection) {
+                    const string name = simpleTagName(*child);
+                    if(!name.empty() && !projection->includes(*this, name)) {
+                        m_skippedSimpleTags.push_back(child);
+                        break;
+                    }
+                }
                 field.invalidateNotifications();
                 field.reparse(*child, true);
                 fields().insert(make_pair(field.id(), field));
@@ -111,6 +139,33 @@ void MatroskaTag::parse(EbmlElement &tagElement)
     }
 }
 
+/*!
+ * \brief Parses the "SimpleTag"-elements skipped when parsing the tag because they were not included in the projection.
+ * \remarks Fields with an ID the tag has already fields for are not added again (see Tag::parseSkippedFields()).
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void MatroskaTag::parseSkippedFields()
+{
+    if(m_skippedSimpleTags.empty()) {
+        return;
+    }
+    static const string context("parsing skipped Matroska tag fields");
+    vector<MatroskaTagField> skippedFields;
+    skippedFields.reserve(m_skippedSimpleTags.size());
+    MatroskaTagField field;
+    for(EbmlElement *simpleTag : m_skippedSimpleTags) {
+        try {
+            field.invalidateNotifications();
+            field.reparse(*simpleTag, true);
+            skippedFields.emplace_back(field);
+        } catch(const Failure &) {
+        }
+        addNotifications(context, field);
+    }
+    m_skippedSimpleTags.clear();
+    insertSkippedFields(skippedFields);
+}
+
 /*!
  * \brief Prepares making.
  * \returns Returns a MatroskaTagMaker object which can be used to actually make the tag.
@@ -10,6 +10,7 @@ namespace Media {
 
 class EbmlElement;
 class MatroskaTag;
+class TagFieldProjection;
 
 class TAG_PARSER_EXPORT MatroskaTagMaker
 {
@@ -64,12 +65,18 @@ public:
     std::string fieldId(KnownField field) const;
     KnownField knownField(const std::string &id) const;
 
-    void parse(EbmlElement &tagElement);
+    void removeAllFields();
+    bool hasSkippedFields() const;
+    void parseSkippedFields();
+
+    void parse(EbmlElement &tagElement, const TagFieldProjection *projection = nullptr);
     MatroskaTagMaker prepareMaking();
     void make(std::ostream &stream);
 
 private:
     void parseTargets(EbmlElement &targetsElement);
+
+    std::vector<EbmlElement *> m_skippedSimpleTags;
 };
 
 /*!
@@ -78,6 +85,23 @@ private:
 inline MatroskaTag::MatroskaTag()
 {}
 
+/*!
+ * \brief Removes all fields including the fields skipped when parsing the tag.
+ */
+inline void MatroskaTag::removeAllFields()
+{
+    FieldMapBasedTag<MatroskaTagField>::removeAllFields();
+    m_skippedSimpleTags.clear();
+}
+
+/*!
+ * \brief Returns whether fields have been skipped when parsing the tag.
+ */
+inline bool MatroskaTag::hasSkippedFields() const
+{
+    return !m_skippedSimpleTags.empty();
+}
+
 inline bool MatroskaTag::supportsTarget() const
 {
     return true;
@@ -468,9 +468,11 @@ void MatroskaTrack::internalParseHeader()
 
 /*!
  * \brief Prepares making the header for the specified \a track.
+ * \param stream Specifies the stream to read elements which need to be copied from; the stream of
+ *               the container is used if nullptr.
  * \sa See MatroskaTrack::prepareMakingHeader() for more information.
  */
-MatroskaTrackHeaderMaker::MatroskaTrackHeaderMaker(const MatroskaTrack &track) :
+MatroskaTrackHeaderMaker::MatroskaTrackHeaderMaker(const MatroskaTrack &track, istream *stream) :
     m_track(track),
     m_dataSize(0)
 {
@@ -500,7 +502,7 @@ MatroskaTrackHeaderMaker::MatroskaTrackHeaderMaker(const MatroskaTrack &track) :
             // skip recognized elements
             break;
         default:
-            trackInfoElement->makeBuffer();
+            stream ? trackInfoElement->makeBuffer(*stream) : trackInfoElement->makeBuffer();
             m_dataSize += trackInfoElement->totalSize();
         }
     }
@@ -19,7 +19,7 @@ public:
     uint64 requiredSize() const;
 
 private:
-    MatroskaTrackHeaderMaker(const MatroskaTrack &track);
+    MatroskaTrackHeaderMaker(const MatroskaTrack &track, std::istream *stream = nullptr);
 
     const MatroskaTrack &m_track;
     uint64 m_dataSize;
@@ -56,6 +56,7 @@ public:
 
     static MediaFormat codecIdToMediaFormat(const std::string &codecId);
     MatroskaTrackHeaderMaker prepareMakingHeader() const;
+    MatroskaTrackHeaderMaker prepareMakingHeader(std::istream &stream) const;
     void makeHeader(std::ostream &stream) const;
 
 protected:
@@ -83,6 +84,19 @@ inline MatroskaTrackHeaderMaker MatroskaTrack::prepareMakingHeader() const
     return MatroskaTrackHeaderMaker(*this);
 }
 
+/*!
+ * \brief Prepares making header information reading elements which need to be copied from the specified \a stream.
+ *
+ * The \a stream must provide the same data as the stream of the container. This allows preparing
+ * the headers of multiple tracks concurrently using an independent stream per thread.
+ *
+ * \sa prepareMakingHeader()
+ */
+inline MatroskaTrackHeaderMaker MatroskaTrack::prepareMakingHeader(std::istream &stream) const
+{
+    return MatroskaTrackHeaderMaker(*this, &stream);
+}
+
 /*!
  * \brief Writes header information to the specified \a stream (makes a "TrackEntry"-element).
  * \throws Throws std::ios_base::failure when an IO error occurs.
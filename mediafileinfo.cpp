@@ -1,6 +1,7 @@
 #include "./mediafileinfo.h"
 #include "./exceptions.h"
 #include "./tag.h"
+#include "./tagfieldprojection.h"
 #include "./signature.h"
 #include "./abstracttrack.h"
 #include "./backuphelper.h"
@@ -63,6 +64,12 @@ namespace Media {
 # define MEDIAINFO_CPP_FORCE_FULL_PARSE false
 #endif
 
+#ifdef FRAME_SCANNING_DEFAULT
+# define MEDIAINFO_CPP_FRAME_SCANNING true
+#else
+# define MEDIAINFO_CPP_FRAME_SCANNING false
+#endif
+
 /*!
  * \class Media::MediaFileInfo
  * \brief The MediaFileInfo class allows to read and write tag information providing
@@ -86,6 +93,9 @@ MediaFileInfo::MediaFileInfo() :
     m_chaptersParsingStatus(ParsingStatus::NotParsedYet),
     m_attachmentsParsingStatus(ParsingStatus::NotParsedYet),
     m_forceFullParse(MEDIAINFO_CPP_FORCE_FULL_PARSE),
+    m_lazyOggParsing(false),
+    m_lazyPictureLoading(false),
+    m_frameScanning(MEDIAINFO_CPP_FRAME_SCANNING),
     m_forceRewrite(true),
     m_minPadding(0),
     m_maxPadding(0),
@@ -112,6 +122,9 @@ MediaFileInfo::MediaFileInfo(const string &path) :
     m_chaptersParsingStatus(ParsingStatus::NotParsedYet),
     m_attachmentsParsingStatus(ParsingStatus::NotParsedYet),
     m_forceFullParse(MEDIAINFO_CPP_FORCE_FULL_PARSE),
+    m_lazyOggParsing(false),
+    m_lazyPictureLoading(false),
+    m_frameScanning(MEDIAINFO_CPP_FRAME_SCANNING),
     m_forceRewrite(true),
     m_minPadding(0),
     m_maxPadding(0),
@@ -152,6 +165,7 @@ void MediaFileInfo::parseContainerFormat()
 
     invalidateStatus();
     static const string context("parsing file header");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::ParsingContainerFormat);
     open(); // ensure the file is open
     m_containerFormat = ContainerFormat::Unknown;
 
@@ -250,6 +264,7 @@ startParsingSignature:
             // Ogg is handled using OggContainer instance
             m_container = make_unique<OggContainer>(*this, m_containerOffset);
             static_cast<OggContainer *>(m_container.get())->setChecksumValidationEnabled(m_forceFullParse);
+            static_cast<OggContainer *>(m_container.get())->setLazyParsingEnabled(m_lazyOggParsing && !m_forceFullParse);
             break;
         case ContainerFormat::Unknown:
             // container format is still unknown -> check for magic numbers at odd offsets
@@ -296,6 +311,7 @@ void MediaFileInfo::parseTracks()
         return;
     }
     static const string context("parsing tracks");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::ParsingTracks);
     try {
         if(m_container) {
             m_container->parseTracks();
@@ -316,6 +332,7 @@ void MediaFileInfo::parseTracks()
             default:
                 throw NotImplementedException();
             }
+            m_singleTrack->setFrameScanningEnabled(m_frameScanning);
             m_singleTrack->parseHeader();
 
             switch(m_containerFormat) {
@@ -357,6 +374,7 @@ void MediaFileInfo::parseTags()
         return;
     }
     static const string context("parsing tag");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::ParsingTags);
     // check for id3v1 tag
     if(size() >= 128) {
         m_id3v1Tag = make_unique<Id3v1Tag>();
@@ -376,7 +394,7 @@ void MediaFileInfo::parseTags()
         auto id3v2Tag = make_unique<Id3v2Tag>();
         stream().seekg(offset, ios_base::beg);
         try {
-            id3v2Tag->parse(stream(), size() - offset);
+            id3v2Tag->parse(stream(), size() - offset, m_lazyPictureLoading, m_tagFieldProjection.get());
             m_paddingSize += id3v2Tag->paddingSize();
         } catch(const NoDataFoundException &) {
             continue;
@@ -406,6 +424,37 @@ void MediaFileInfo::parseTags()
     }
 }
 
+/*!
+ * \brief Parses the tag(s) of the current file but only the fields included in the specified \a projection.
+ *
+ * Other fields are skipped by size. The tags remember the skipped fields and parse them when
+ * the file is modified so they are preserved (see Tag::parseSkippedFields()). This avoids reading
+ * and decoding big fields (eg. pictures and lyrics) when only a few fields are of interest.
+ *
+ * This is equivalent to calling setTagFieldProjection() before parseTags().
+ * \remarks The Vorbis comment of FLAC files is parsed when parsing the tracks. Hence setTagFieldProjection()
+ *          needs to be called before parseTracks() to apply the projection to FLAC files.
+ * \sa parseTags()
+ */
+void MediaFileInfo::parseTags(const TagFieldProjection &projection)
+{
+    setTagFieldProjection(&projection);
+    parseTags();
+}
+
+/*!
+ * \brief Sets the projection which specifies the tag fields to be parsed.
+ *
+ * The \a projection is copied. Specifying nullptr causes all fields to be parsed (the default).
+ *
+ * \remarks The setting is applied next time parsing. The current parsing results are not mutated.
+ * \sa tagFieldProjection(), parseTags(const TagFieldProjection &)
+ */
+void MediaFileInfo::setTagFieldProjection(const TagFieldProjection *projection)
+{
+    m_tagFieldProjection = projection ? make_unique<TagFieldProjection>(*projection) : nullptr;
+}
+
 /*!
  * \brief Parses the chapters of the current file.
  *
@@ -423,6 +472,7 @@ void MediaFileInfo::parseChapters()
         return;
     }
     static const string context("parsing chapters");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::ParsingChapters);
     try {
         if(m_container) {
             m_container->parseChapters();
@@ -456,6 +506,7 @@ void MediaFileInfo::parseAttachments()
         return;
     }
     static const string context("parsing attachments");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::ParsingAttachments);
     try {
         if(m_container) {
             m_container->parseAttachments();
@@ -566,6 +617,7 @@ bool MediaFileInfo::createAppropriateTags(bool treatUnknownFilesAsMp3Files, TagU
                     if(id3InitOnCreate) {
                         for(const auto &id3v2Tag : id3v2Tags()) {
                             // overwrite existing values to ensure default ID3v1 genre "Blues" is updated as well
+                            id3v2Tag->parseSkippedFields();
                             id3v1Tag->insertValues(*id3v2Tag, true);
                             // ID3v1 does not support all text encodings which might be used in ID3v2
                             id3v1Tag->ensureTextValuesAreProperlyEncoded();
@@ -602,6 +654,7 @@ bool MediaFileInfo::createAppropriateTags(bool treatUnknownFilesAsMp3Files, TagU
             if(id3TransferValuesOnRemoval && hasId3v1Tag()) {
                 // transfer tags to ID3v1 tag before removing
                 for(const auto &tag : id3v2Tags()) {
+                    tag->parseSkippedFields();
                     id3v1Tag()->insertValues(*tag, false);
                 }
             }
@@ -644,6 +697,7 @@ bool MediaFileInfo::createAppropriateTags(bool treatUnknownFilesAsMp3Files, TagU
 void MediaFileInfo::applyChanges()
 {   
     const string context("making file");
+    MetricsScope metricsScope(m_metrics, ProcessingPhase::MakingFile);
     addNotification(NotificationType::Information, "Changes are about to be applied.", context);
     bool previousParsingSuccessful = true;
     switch(tagsParsingStatus()) {
@@ -665,6 +719,15 @@ void MediaFileInfo::applyChanges()
     if(!previousParsingSuccessful) {
         throw InvalidDataException();
     }
+    // parse skipped fields and load lazily loaded pictures because they refer to the file which is about to be modified
+    for(Tag *tag : tags()) {
+        tag->parseSkippedFields();
+        for(const TagValue *value : tag->values(KnownField::Cover)) {
+            value->loadData();
+        }
+    }
+    // release memory mapping because the file might be truncated or replaced
+    unmapFile();
     if(m_container) { // container object takes care
         // ID3 tags can not be applied in this case -> add warnings if ID3 tags have been assigned
         if(hasId3v1Tag()) {
@@ -694,6 +757,10 @@ void MediaFileInfo::applyChanges()
         }
     }
     clearParsingResults();
+    // map the modified file again if memory mapping is enabled
+    if(isMemoryMappingEnabled()) {
+        mapFile();
+    }
 }
 
 /*!
@@ -1310,7 +1377,10 @@ void MediaFileInfo::mergeId3v2Tags()
         Id3v2Tag &first = **begin;
         auto isecond = begin + 1;
         if(isecond != end) {
+            // skipped fields are only preserved when making the tag they belong to
+            first.parseSkippedFields();
             for(auto i = isecond; i != end; ++i) {
+                (*i)->parseSkippedFields();
                 first.insertFields(**i, false);
             }
             m_id3v2Tags.erase(isecond, end - 1);
@@ -1542,14 +1612,17 @@ void MediaFileInfo::makeMp3File()
         vector<Id3v2TagMaker> makers;
         makers.reserve(m_id3v2Tags.size());
         uint32 tagsSize = 0;
-        for(auto &tag : m_id3v2Tags) {
-            try {
-                makers.emplace_back(tag->prepareMaking());
-                tagsSize += makers.back().requiredSize();
-            } catch(const Failure &) {
-                // nothing to do: notifications added anyways
+        {
+            MetricsScope preparingScope(m_metrics, ProcessingPhase::PreparingMaking);
+            for(auto &tag : m_id3v2Tags) {
+                try {
+                    makers.emplace_back(tag->prepareMaking());
+                    tagsSize += makers.back().requiredSize();
+                } catch(const Failure &) {
+                    // nothing to do: notifications added anyways
+                }
+                addNotifications(*tag);
             }
-            addNotifications(*tag);
         }
 
         // check whether it is a raw FLAC stream
@@ -1703,9 +1776,13 @@ void MediaFileInfo::makeMp3File()
                 default:
                     updateStatus("Writing frames ...");
                 }
+                MetricsScope writingScope(m_metrics, ProcessingPhase::WritingMediaData);
                 backupStream.seekg(streamOffset);
                 CopyHelper<0x4000> copyHelper;
                 copyHelper.callbackCopy(backupStream, stream(), mediaDataSize, bind(&StatusProvider::isAborted, this), bind(&StatusProvider::updatePercentage, this, _1));
+                IoCounters::countSeek();
+                IoCounters::countRead(mediaDataSize);
+                IoCounters::countWrite(mediaDataSize);
                 updatePercentage(100.0);
             } else {
                 // just skip actual stream data
@@ -5,6 +5,7 @@
 #include "./statusprovider.h"
 #include "./basicfileinfo.h"
 #include "./abstractcontainer.h"
+#include "./metrics.h"
 
 #include <vector>
 #include <memory>
@@ -23,6 +24,7 @@ class EbmlElement;
 class MatroskaTag;
 class AbstractTrack;
 class VorbisComment;
+class TagFieldProjection;
 
 enum class MediaType;
 DECLARE_ENUM_CLASS(TagType, unsigned int);
@@ -63,6 +65,7 @@ public:
     void parseContainerFormat();
     void parseTracks();
     void parseTags();
+    void parseTags(const TagFieldProjection &projection);
     void parseChapters();
     void parseAttachments();
     void parseEverything();
@@ -134,11 +137,23 @@ public:
     NotificationList gatherRelatedNotifications() const;
     void clearParsingResults();
 
+    // methods to get metrics
+    const Metrics &metrics() const;
+    Metrics &metrics();
+
     // methods to get, set object behaviour
     const std::string &saveFilePath() const;
     void setSaveFilePath(const std::string &saveFilePath);
     bool isForcingFullParse() const;
     void setForceFullParse(bool forceFullParse);
+    bool isLazyOggParsingEnabled() const;
+    void setLazyOggParsingEnabled(bool lazyOggParsing);
+    bool isLazyPictureLoadingEnabled() const;
+    void setLazyPictureLoadingEnabled(bool lazyPictureLoading);
+    const TagFieldProjection *tagFieldProjection() const;
+    void setTagFieldProjection(const TagFieldProjection *projection);
+    bool isFrameScanningEnabled() const;
+    void setFrameScanningEnabled(bool frameScanning);
     bool isForcingRewrite() const;
     void setForceRewrite(bool forceRewrite);
     size_t minPadding() const;
@@ -187,9 +202,16 @@ private:
     ParsingStatus m_chaptersParsingStatus;
     ParsingStatus m_attachmentsParsingStatus;
 
+    // fields related to metrics
+    Metrics m_metrics;
+
     // fields specifying object behaviour
     std::string m_saveFilePath;
     bool m_forceFullParse;
+    bool m_lazyOggParsing;
+    bool m_lazyPictureLoading;
+    std::unique_ptr<TagFieldProjection> m_tagFieldProjection;
+    bool m_frameScanning;
     bool m_forceRewrite;
     size_t m_minPadding;
     size_t m_maxPadding;
@@ -350,6 +372,28 @@ inline const std::vector<std::unique_ptr<Id3v2Tag> > &MediaFileInfo::id3v2Tags()
     return m_id3v2Tags;
 }
 
+/*!
+ * \brief Returns the metrics recorded when parsing the file and applying changes.
+ *
+ * The wall time and the I/O are recorded per ProcessingPhase. The metrics are accumulated
+ * until reset using Metrics::reset(); they are not cleared by clearParsingResults().
+ *
+ * \remarks No I/O is recorded if the library has been compiled with DISABLE_METRICS.
+ */
+inline const Metrics &MediaFileInfo::metrics() const
+{
+    return m_metrics;
+}
+
+/*!
+ * \brief Returns the metrics recorded when parsing the file and applying changes.
+ * \sa metrics() const
+ */
+inline Metrics &MediaFileInfo::metrics()
+{
+    return m_metrics;
+}
+
 /*!
  * \brief Returns the "save file path" which has been set using setSaveFilePath().
  * \sa setSaveFilePath()
@@ -416,6 +460,93 @@ inline void MediaFileInfo::setForceFullParse(bool forceFullParse)
     m_forceFullParse = forceFullParse;
 }
 
+/*!
+ * \brief Returns whether OGG files are parsed lazily.
+ *
+ * If enabled, only the pages containing the stream headers are read instead of walking
+ * through the entire file (see OggContainer::isLazyParsingEnabled()). Has no effect when
+ * forcing a full parse.
+ *
+ * \sa setLazyOggParsingEnabled()
+ */
+inline bool MediaFileInfo::isLazyOggParsingEnabled() const
+{
+    return m_lazyOggParsing;
+}
+
+/*!
+ * \brief Sets whether OGG files are parsed lazily.
+ * \remarks The setting is applied next time parsing. The current parsing results are not mutated.
+ * \sa isLazyOggParsingEnabled()
+ */
+inline void MediaFileInfo::setLazyOggParsingEnabled(bool lazyOggParsing)
+{
+    m_lazyOggParsing = lazyOggParsing;
+}
+
+/*!
+ * \brief Returns whether pictures (eg. cover art) are loaded lazily.
+ *
+ * If enabled, parseTags() only records where the picture data of ID3v2 "APIC" frames, MP4 "covr"
+ * atoms and FLAC "METADATA_BLOCK_PICTURE" blocks is located instead of reading it. The data is
+ * read when accessed (see TagValue::assignDataFromStream()) so scanning the text fields of
+ * files with big pictures does not read the pictures.
+ *
+ * \remarks
+ * - The file must remain open until the pictures have been accessed.
+ * - applyChanges() loads the pictures before modifying the file.
+ *
+ * \sa setLazyPictureLoadingEnabled()
+ */
+inline bool MediaFileInfo::isLazyPictureLoadingEnabled() const
+{
+    return m_lazyPictureLoading;
+}
+
+/*!
+ * \brief Sets whether pictures (eg. cover art) are loaded lazily.
+ * \remarks The setting is applied next time parsing. The current parsing results are not mutated.
+ * \sa isLazyPictureLoadingEnabled()
+ */
+inline void MediaFileInfo::setLazyPictureLoadingEnabled(bool lazyPictureLoading)
+{
+    m_lazyPictureLoading = lazyPictureLoading;
+}
+
+/*!
+ * \brief Returns the projection which specifies the tag fields to be parsed or nullptr if all fields are parsed.
+ * \sa setTagFieldProjection(), parseTags(const TagFieldProjection &)
+ */
+inline const TagFieldProjection *MediaFileInfo::tagFieldProjection() const
+{
+    return m_tagFieldProjection.get();
+}
+
+/*!
+ * \brief Returns whether all frames of raw frame streams (eg. MP3 files) are walked through.
+ *
+ * If enabled, the exact duration and bitrate are determined and a seek table is built
+ * (see AbstractTrack::isFrameScanningEnabled()). Otherwise these values are estimated
+ * from the first frame.
+ *
+ * \remarks Enabled by default if the library has been compiled with FRAME_SCANNING_DEFAULT.
+ * \sa setFrameScanningEnabled()
+ */
+inline bool MediaFileInfo::isFrameScanningEnabled() const
+{
+    return m_frameScanning;
+}
+
+/*!
+ * \brief Sets whether all frames of raw frame streams are walked through.
+ * \remarks The setting is applied next time parsing. The current parsing results are not mutated.
+ * \sa isFrameScanningEnabled()
+ */
+inline void MediaFileInfo::setFrameScanningEnabled(bool frameScanning)
+{
+    m_frameScanning = frameScanning;
+}
+
 /*!
  * \brief Returns whether forcing rewriting (when applying changes) is enabled.
  */
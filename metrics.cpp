@@ -0,0 +1,147 @@
+#include "./metrics.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace Media {
+
+/*!
+ * \brief Returns the name of the specified \a phase.
+ */
+const char *processingPhaseName(ProcessingPhase phase)
+{
+    switch(phase) {
+    case ProcessingPhase::ParsingContainerFormat: return "parsing container format";
+    case ProcessingPhase::ParsingTracks: return "parsing tracks";
+    case ProcessingPhase::ParsingTags: return "parsing tags";
+    case ProcessingPhase::ParsingChapters: return "parsing chapters";
+    case ProcessingPhase::ParsingAttachments: return "parsing attachments";
+    case ProcessingPhase::MakingFile: return "making file";
+    case ProcessingPhase::PreparingMaking: return "preparing making";
+    case ProcessingPhase::WritingMediaData: return "writing media data";
+    default: return nullptr;
+    }
+}
+
+/*!
+ * \struct Media::IoCounters
+ * \brief The IoCounters struct holds counters for the I/O done by the parser.
+ *
+ * The counters are incremented on the hot paths of the library (parsing elements, buffering
+ * and copying data, reading sample tables, ...) using the static count functions. Each thread
+ * has its own counters (see current()) so counting requires no synchronization. MetricsScope
+ * attributes the counters to the phases of a particular file.
+ *
+ * \remarks
+ * - The counters are not exact; small reads of individual fields are not counted.
+ * - Counting can be disabled at compile time by defining DISABLE_METRICS when building the library.
+ */
+
+/*!
+ * \brief Adds the counters of \a other.
+ */
+IoCounters &IoCounters::operator +=(const IoCounters &other)
+{
+    bytesRead += other.bytesRead;
+    bytesWritten += other.bytesWritten;
+    seekCount += other.seekCount;
+    elementCount += other.elementCount;
+    allocationCount += other.allocationCount;
+    return *this;
+}
+
+/*!
+ * \brief Returns the difference between the counters and the counters of \a other.
+ */
+IoCounters IoCounters::operator -(const IoCounters &other) const
+{
+    IoCounters difference;
+    difference.bytesRead = bytesRead - other.bytesRead;
+    difference.bytesWritten = bytesWritten - other.bytesWritten;
+    difference.seekCount = seekCount - other.seekCount;
+    difference.elementCount = elementCount - other.elementCount;
+    difference.allocationCount = allocationCount - other.allocationCount;
+    return difference;
+}
+
+namespace {
+thread_local IoCounters threadCounters;
+thread_local unsigned int threadScopeDepth = 0;
+}
+
+/*!
+ * \brief Returns the counters of the current thread.
+ */
+IoCounters &IoCounters::current()
+{
+    return threadCounters;
+}
+
+/*!
+ * \struct Media::Metrics
+ * \brief The Metrics struct holds the wall time and the I/O counters per ProcessingPhase.
+ *
+ * An instance is attached to each MediaFileInfo (see MediaFileInfo::metrics()). It can be copied
+ * to export it, eg. to attribute slow files to particular containers and phases.
+ *
+ * \remarks Work done by worker threads (eg. when reading the chunk tables of MP4 tracks concurrently)
+ *          is included in the wall time but not in the counters.
+ */
+
+/*!
+ * \class Media::MetricsScope
+ * \brief The MetricsScope class records the wall time and I/O of a ProcessingPhase from its
+ *        construction until its destruction.
+ *
+ * Scopes might be nested (eg. PreparingMaking within MakingFile). The counters of nested scopes
+ * are attributed to each phase but only once to the totals.
+ */
+
+/*!
+ * \brief Starts recording the specified \a phase to the specified \a metrics.
+ */
+MetricsScope::MetricsScope(Metrics &metrics, ProcessingPhase phase) :
+    m_metrics(metrics),
+    m_phase(phase),
+    m_active(true),
+    m_outermost(false)
+{
+#ifndef DISABLE_METRICS
+    m_outermost = !threadScopeDepth++;
+    m_startCounters = threadCounters;
+    m_startTime = steady_clock::now();
+#endif
+}
+
+/*!
+ * \brief Stops recording if not stopped yet.
+ */
+MetricsScope::~MetricsScope()
+{
+    stop();
+}
+
+/*!
+ * \brief Stops recording and adds the recorded values to the metrics.
+ * \remarks Does nothing if already stopped; useful to end a phase before the end of the enclosing block.
+ */
+void MetricsScope::stop()
+{
+    if(!m_active) {
+        return;
+    }
+    m_active = false;
+#ifndef DISABLE_METRICS
+    PhaseMetrics &phase = m_metrics.phase(m_phase);
+    const IoCounters counters = threadCounters - m_startCounters;
+    phase.duration += duration_cast<nanoseconds>(steady_clock::now() - m_startTime);
+    ++phase.invocations;
+    phase.counters += counters;
+    if(m_outermost) {
+        m_metrics.counters += counters;
+    }
+    --threadScopeDepth;
+#endif
+}
+
+}
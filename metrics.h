@@ -0,0 +1,179 @@
+#ifndef MEDIA_METRICS_H
+#define MEDIA_METRICS_H
+
+#include "./global.h"
+
+#include <c++utilities/conversion/types.h>
+
+#include <chrono>
+
+namespace Media {
+
+/*!
+ * \brief Specifies the phases for which metrics are recorded.
+ */
+enum class ProcessingPhase : byte
+{
+    ParsingContainerFormat, /**< MediaFileInfo::parseContainerFormat() */
+    ParsingTracks, /**< MediaFileInfo::parseTracks() */
+    ParsingTags, /**< MediaFileInfo::parseTags() */
+    ParsingChapters, /**< MediaFileInfo::parseChapters() */
+    ParsingAttachments, /**< MediaFileInfo::parseAttachments() */
+    MakingFile, /**< MediaFileInfo::applyChanges() */
+    PreparingMaking, /**< calculating the new file layout when making a file (part of MakingFile) */
+    WritingMediaData /**< copying the media data when making a file (part of MakingFile) */
+};
+
+/*!
+ * \brief Specifies the number of values of ProcessingPhase.
+ */
+constexpr std::size_t processingPhaseCount = 8;
+
+TAG_PARSER_EXPORT const char *processingPhaseName(ProcessingPhase phase);
+
+struct TAG_PARSER_EXPORT IoCounters
+{
+    /// \brief The number of bytes read from input streams.
+    uint64 bytesRead = 0;
+    /// \brief The number of bytes written to output streams.
+    uint64 bytesWritten = 0;
+    /// \brief The number of seek operations.
+    uint64 seekCount = 0;
+    /// \brief The number of elements (atoms, EBML elements, ...) which have been parsed.
+    uint64 elementCount = 0;
+    /// \brief The number of heap allocations made for elements and buffered data.
+    uint64 allocationCount = 0;
+
+    IoCounters &operator +=(const IoCounters &other);
+    IoCounters operator -(const IoCounters &other) const;
+
+    static IoCounters &current();
+    static void countRead(uint64 bytes);
+    static void countWrite(uint64 bytes);
+    static void countSeek();
+    static void countElement();
+    static void countAllocation();
+};
+
+struct TAG_PARSER_EXPORT PhaseMetrics
+{
+    /// \brief The accumulated wall time spent in the phase.
+    std::chrono::nanoseconds duration = std::chrono::nanoseconds::zero();
+    /// \brief The number of times the phase has been entered.
+    uint64 invocations = 0;
+    /// \brief The I/O done while being in the phase.
+    IoCounters counters;
+};
+
+struct TAG_PARSER_EXPORT Metrics
+{
+    /// \brief The metrics for each phase; use phase() to access them.
+    PhaseMetrics phases[processingPhaseCount];
+    /// \brief The I/O done in all phases (nested phases are only counted once).
+    IoCounters counters;
+
+    PhaseMetrics &phase(ProcessingPhase phase);
+    const PhaseMetrics &phase(ProcessingPhase phase) const;
+    void reset();
+};
+
+class TAG_PARSER_EXPORT MetricsScope
+{
+public:
+    MetricsScope(Metrics &metrics, ProcessingPhase phase);
+    MetricsScope(const MetricsScope &) = delete;
+    MetricsScope &operator =(const MetricsScope &) = delete;
+    ~MetricsScope();
+
+    void stop();
+
+private:
+    Metrics &m_metrics;
+    ProcessingPhase m_phase;
+    bool m_active;
+    bool m_outermost;
+    IoCounters m_startCounters;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+/*!
+ * \brief Counts \a bytes read by the current thread.
+ */
+inline void IoCounters::countRead(uint64 bytes)
+{
+#ifndef DISABLE_METRICS
+    current().bytesRead += bytes;
+#else
+    VAR_UNUSED(bytes)
+#endif
+}
+
+/*!
+ * \brief Counts \a bytes written by the current thread.
+ */
+inline void IoCounters::countWrite(uint64 bytes)
+{
+#ifndef DISABLE_METRICS
+    current().bytesWritten += bytes;
+#else
+    VAR_UNUSED(bytes)
+#endif
+}
+
+/*!
+ * \brief Counts a seek operation done by the current thread.
+ */
+inline void IoCounters::countSeek()
+{
+#ifndef DISABLE_METRICS
+    ++current().seekCount;
+#endif
+}
+
+/*!
+ * \brief Counts an element parsed by the current thread.
+ */
+inline void IoCounters::countElement()
+{
+#ifndef DISABLE_METRICS
+    ++current().elementCount;
+#endif
+}
+
+/*!
+ * \brief Counts an allocation made by the current thread.
+ */
+inline void IoCounters::countAllocation()
+{
+#ifndef DISABLE_METRICS
+    ++current().allocationCount;
+#endif
+}
+
+/*!
+ * \brief Returns the metrics for the specified \a phase.
+ */
+inline PhaseMetrics &Metrics::phase(ProcessingPhase phase)
+{
+    return phases[static_cast<std::size_t>(phase)];
+}
+
+/*!
+ * \brief Returns the metrics for the specified \a phase.
+ */
+inline const PhaseMetrics &Metrics::phase(ProcessingPhase phase) const
+{
+    return phases[static_cast<std::size_t>(phase)];
+}
+
+/*!
+ * \brief Resets all metrics to zero.
+ */
+inline void Metrics::reset()
+{
+    *this = Metrics();
+}
+
+}
+
+#endif // MEDIA_METRICS_H
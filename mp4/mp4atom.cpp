@@ -4,8 +4,10 @@
 #include "./mp4ids.h"
 #include "./mp4container.h"
 
+#include "../mediafileinfo.h"
 #include "../exceptions.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/binaryreader.h>
 #include <c++utilities/io/binarywriter.h>
@@ -63,8 +65,16 @@ void Mp4Atom::internalParse()
         addNotification(NotificationType::Critical, "Atom is smaller than 8 byte and hence invalid. The remaining size within the parent atom is " % numberToString(maxTotalSize()) + ".", context);
         throw TruncatedDataException();
     }
-    stream().seekg(startOffset());
-    m_dataSize = reader().readUInt32BE();
+    // decode header directly from memory if the file is mapped; otherwise read from stream
+    const char *const mapped = mappedData(startOffset(), minimumElementSize());
+    if(mapped) {
+        m_dataSize = BE::toUInt32(mapped);
+    } else {
+        stream().seekg(startOffset());
+        m_dataSize = reader().readUInt32BE();
+        IoCounters::countSeek();
+        IoCounters::countRead(minimumElementSize());
+    }
     if(m_dataSize == 0) {
         // atom size extends to rest of the file/enclosing container
         m_dataSize = maxTotalSize();
@@ -77,10 +87,17 @@ void Mp4Atom::internalParse()
         addNotification(NotificationType::Critical, "Atom is smaller than 8 byte and hence invalid.", context);
         throw TruncatedDataException();
     }
-    m_id = reader().readUInt32BE();
+    m_id = mapped ? BE::toUInt32(mapped + 4) : reader().readUInt32BE();
     m_idLength = 4;
     if(m_dataSize == 1) { // atom denotes 64-bit size
-        m_dataSize = reader().readUInt64BE();
+        if(const char *const mappedLongSize = mappedData(startOffset() + 8, 8)) {
+            m_dataSize = BE::toUInt64(mappedLongSize);
+        } else {
+            stream().seekg(startOffset() + 8);
+            m_dataSize = reader().readUInt64BE();
+            IoCounters::countSeek();
+            IoCounters::countRead(8);
+        }
         m_sizeLength = 12; // 4 bytes indicate long size denotation + 8 bytes for actual size denotation
         if(dataSize() < 16 && m_dataSize != 1) {
             addNotification(NotificationType::Critical, "Atom denoting 64-bit size is smaller than 16 byte and hence invalid.", parsingContext());
@@ -95,22 +112,22 @@ void Mp4Atom::internalParse()
     }
     // currently m_dataSize holds data size plus header size!
     m_dataSize -= headerSize();
-    Mp4Atom *child = nullptr;
+    elementPointerType child;
     if(uint64 firstChildOffset = this->firstChildOffset()) {
         if(firstChildOffset + minimumElementSize() <= totalSize()) {
-            child = new Mp4Atom(static_cast<Mp4Atom &>(*this), startOffset() + firstChildOffset);
+            child = createElement(static_cast<Mp4Atom &>(*this), startOffset() + firstChildOffset);
         }
     }
-    m_firstChild.reset(child);
-    Mp4Atom *sibling = nullptr;
+    m_firstChild = move(child);
+    elementPointerType sibling;
     if(totalSize() < maxTotalSize()) {
         if(parent()) {
-            sibling = new Mp4Atom(*(parent()), startOffset() + totalSize());
+            sibling = createElement(*(parent()), startOffset() + totalSize());
         } else {
-            sibling = new Mp4Atom(container(), startOffset() + totalSize(), maxTotalSize() - totalSize());
+            sibling = createElement(container(), startOffset() + totalSize(), maxTotalSize() - totalSize());
         }
     }
-    m_nextSibling.reset(sibling);
+    m_nextSibling = move(sibling);
 }
 
 /*!
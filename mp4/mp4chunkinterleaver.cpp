@@ -0,0 +1,189 @@
+#include "./mp4chunkinterleaver.h"
+
+#include "../metrics.h"
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <numeric>
+
+using namespace std;
+
+namespace Media {
+
+/*!
+ * \class Media::Mp4ChunkInterleaver
+ * \brief The Mp4ChunkInterleaver class writes the chunks of several tracks interleaved to a stream.
+ *
+ * The chunks are written round-robin (first chunk of each track, then the second chunk of each
+ * track, ...) which is the order Mp4Container::internalMakeFile() uses when writing chunk-by-chunk.
+ *
+ * The output order and the new chunk offsets are determined before anything is written. The
+ * chunks are then processed in batches of approximately batchSize() bytes. The chunks of a batch
+ * are read in the order of their offsets within the source stream and chunks which are adjacent
+ * (or only separated by a small gap) are read using a single read operation. While a batch is
+ * written, the next batch is already read by a background thread.
+ */
+
+/*!
+ * \brief Adds a track.
+ *
+ * The chunks are read from \a input using the specified \a chunkOffsets and \a chunkSizes.
+ * The offsets in \a chunkOffsets are replaced with the offsets within the output stream when
+ * calling write(). If the tables have a different size, excess entries are ignored.
+ *
+ * \remarks The tables must stay valid until write() has been called.
+ */
+void Mp4ChunkInterleaver::addTrack(istream &input, vector<uint64> &chunkOffsets, const vector<uint64> &chunkSizes)
+{
+    m_tracks.emplace_back(Track{&input, &chunkOffsets, &chunkSizes});
+}
+
+/*!
+ * \brief Returns the number of chunks which will be written.
+ */
+uint64 Mp4ChunkInterleaver::chunkCount() const
+{
+    uint64 count = 0;
+    for(const Track &track : m_tracks) {
+        count += min(track.chunkOffsets->size(), track.chunkSizes->size());
+    }
+    return count;
+}
+
+/*!
+ * \brief Returns the number of bytes which will be written.
+ */
+uint64 Mp4ChunkInterleaver::totalSize() const
+{
+    uint64 size = 0;
+    for(const Track &track : m_tracks) {
+        const auto chunkSizes = track.chunkSizes->cbegin();
+        size += accumulate(chunkSizes, chunkSizes + static_cast<ptrdiff_t>(min(track.chunkOffsets->size(), track.chunkSizes->size())), static_cast<uint64>(0));
+    }
+    return size;
+}
+
+/*!
+ * \brief Writes the chunks of all tracks to the current position of \a output and updates the chunk offset tables.
+ *
+ * The writing is aborted when \a isAborted returns true. The progress (a value between 0 and 1)
+ * is reported via \a progress after each batch.
+ *
+ * \returns Returns whether all chunks have been written (false if aborted).
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ * \remarks The source streams are accessed by a background thread so they must not be used
+ *          until write() returns.
+ */
+bool Mp4ChunkInterleaver::write(ostream &output, const AbortCallback &isAborted, const ProgressCallback &progress)
+{
+    // determine the output order
+    vector<Chunk> chunks;
+    chunks.reserve(static_cast<size_t>(chunkCount()));
+    for(size_t index = 0, remainingTracks = m_tracks.size(); remainingTracks; ++index) {
+        remainingTracks = 0;
+        for(size_t trackIndex = 0; trackIndex < m_tracks.size(); ++trackIndex) {
+            const Track &track = m_tracks[trackIndex];
+            if(index < track.chunkOffsets->size() && index < track.chunkSizes->size()) {
+                chunks.emplace_back(Chunk{trackIndex, index, (*track.chunkOffsets)[index], (*track.chunkSizes)[index], 0});
+                ++remainingTracks;
+            }
+        }
+    }
+
+    // split chunks into batches
+    vector<size_t> batchBoundaries{0};
+    uint64 batchSize = 0;
+    for(size_t index = 0; index < chunks.size(); ++index) {
+        if(batchSize && batchSize + chunks[index].size > m_batchSize) {
+            batchBoundaries.push_back(index);
+            batchSize = 0;
+        }
+        batchSize += chunks[index].size;
+    }
+    batchBoundaries.push_back(chunks.size());
+    const size_t batchCount = batchBoundaries.size() - 1;
+
+    // read the next batch in the background while writing the current batch
+    // note: the reader only modifies the chunks of the batch it reads so no synchronization is required
+    vector<char> buffers[2];
+    const auto readBatchAsync = [this, &chunks, &batchBoundaries, &buffers] (size_t batchIndex) {
+        return async(launch::async, &Mp4ChunkInterleaver::readBatch, this, chunks.data() + batchBoundaries[batchIndex], chunks.data() + batchBoundaries[batchIndex + 1], ref(buffers[batchIndex % 2]));
+    };
+    future<void> pendingRead = readBatchAsync(0);
+    uint64 outputOffset = static_cast<uint64>(output.tellp());
+    const uint64 totalSize = this->totalSize();
+    uint64 bytesWritten = 0;
+    for(size_t batchIndex = 0; batchIndex < batchCount; ++batchIndex) {
+        pendingRead.get();
+        if(isAborted && isAborted()) {
+            return false;
+        }
+        if(batchIndex + 1 < batchCount) {
+            pendingRead = readBatchAsync(batchIndex + 1);
+        }
+
+        // write chunks of the current batch, update chunk offset tables
+        const vector<char> &buffer = buffers[batchIndex % 2];
+        for(auto chunk = chunks.cbegin() + static_cast<ptrdiff_t>(batchBoundaries[batchIndex]), end = chunks.cbegin() + static_cast<ptrdiff_t>(batchBoundaries[batchIndex + 1]); chunk != end; ++chunk) {
+            output.write(buffer.data() + chunk->bufferOffset, static_cast<streamsize>(chunk->size));
+            // count the read here as well because the batch has been read by a worker thread
+            IoCounters::countRead(chunk->size);
+            IoCounters::countWrite(chunk->size);
+            (*m_tracks[chunk->track].chunkOffsets)[chunk->index] = outputOffset;
+            outputOffset += chunk->size;
+            bytesWritten += chunk->size;
+        }
+        if(progress && totalSize) {
+            progress(static_cast<double>(bytesWritten) / totalSize);
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Reads the chunks in the range [\a begin, \a end) into \a buffer and assigns the offsets within the buffer.
+ */
+void Mp4ChunkInterleaver::readBatch(Chunk *begin, Chunk *end, vector<char> &buffer) const
+{
+    // sort the chunks by their position within the source streams
+    vector<Chunk *> sourceOrder;
+    sourceOrder.reserve(static_cast<size_t>(end - begin));
+    for(Chunk *chunk = begin; chunk != end; ++chunk) {
+        sourceOrder.push_back(chunk);
+    }
+    sort(sourceOrder.begin(), sourceOrder.end(), [this] (const Chunk *lhs, const Chunk *rhs) {
+        const istream *lhsInput = m_tracks[lhs->track].input, *rhsInput = m_tracks[rhs->track].input;
+        return lhsInput != rhsInput ? less<const istream *>()(lhsInput, rhsInput) : lhs->sourceOffset < rhs->sourceOffset;
+    });
+
+    // coalesce adjacent chunks into ranges which are read at once
+    struct Range
+    {
+        istream *input;
+        uint64 sourceOffset;
+        uint64 size;
+        size_t bufferOffset;
+    };
+    vector<Range> ranges;
+    size_t bufferSize = 0;
+    for(Chunk *chunk : sourceOrder) {
+        istream *input = m_tracks[chunk->track].input;
+        if(ranges.empty() || ranges.back().input != input || chunk->sourceOffset > ranges.back().sourceOffset + ranges.back().size + maxGapSize) {
+            ranges.emplace_back(Range{input, chunk->sourceOffset, 0, bufferSize});
+        }
+        Range &range = ranges.back();
+        range.size = max(range.size, chunk->sourceOffset + chunk->size - range.sourceOffset);
+        chunk->bufferOffset = range.bufferOffset + static_cast<size_t>(chunk->sourceOffset - range.sourceOffset);
+        bufferSize = range.bufferOffset + static_cast<size_t>(range.size);
+    }
+
+    // read the ranges
+    buffer.resize(bufferSize);
+    for(const Range &range : ranges) {
+        range.input->seekg(static_cast<streamoff>(range.sourceOffset));
+        range.input->read(buffer.data() + range.bufferOffset, static_cast<streamsize>(range.size));
+    }
+}
+
+}
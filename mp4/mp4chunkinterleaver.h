@@ -0,0 +1,83 @@
+#ifndef MEDIA_MP4CHUNKINTERLEAVER_H
+#define MEDIA_MP4CHUNKINTERLEAVER_H
+
+#include "../global.h"
+
+#include <c++utilities/conversion/types.h>
+
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+namespace Media {
+
+class TAG_PARSER_EXPORT Mp4ChunkInterleaver
+{
+public:
+    typedef std::function<bool (void)> AbortCallback;
+    typedef std::function<void (double percentage)> ProgressCallback;
+
+    Mp4ChunkInterleaver();
+
+    void addTrack(std::istream &input, std::vector<uint64> &chunkOffsets, const std::vector<uint64> &chunkSizes);
+    uint64 chunkCount() const;
+    uint64 totalSize() const;
+    std::size_t batchSize() const;
+    void setBatchSize(std::size_t batchSize);
+    bool write(std::ostream &output, const AbortCallback &isAborted = AbortCallback(), const ProgressCallback &progress = ProgressCallback());
+
+    static constexpr std::size_t defaultBatchSize = 0x800000;
+    static constexpr uint64 maxGapSize = 0x10000;
+
+private:
+    struct Track
+    {
+        std::istream *input;
+        std::vector<uint64> *chunkOffsets;
+        const std::vector<uint64> *chunkSizes;
+    };
+    struct Chunk
+    {
+        std::size_t track;
+        std::size_t index;
+        uint64 sourceOffset;
+        uint64 size;
+        std::size_t bufferOffset;
+    };
+
+    void readBatch(Chunk *begin, Chunk *end, std::vector<char> &buffer) const;
+
+    std::vector<Track> m_tracks;
+    std::size_t m_batchSize;
+};
+
+/*!
+ * \brief Constructs a new interleaver without any tracks.
+ */
+inline Mp4ChunkInterleaver::Mp4ChunkInterleaver() :
+    m_batchSize(defaultBatchSize)
+{}
+
+/*!
+ * \brief Returns the (approximate) number of bytes read from the source streams at once.
+ *
+ * Two batches are held in memory at the same time. Gaps between chunks of up to maxGapSize
+ * are read as well so the buffers might be slightly bigger.
+ */
+inline std::size_t Mp4ChunkInterleaver::batchSize() const
+{
+    return m_batchSize;
+}
+
+/*!
+ * \brief Sets the (approximate) number of bytes read from the source streams at once.
+ * \sa batchSize()
+ */
+inline void Mp4ChunkInterleaver::setBatchSize(std::size_t batchSize)
+{
+    m_batchSize = batchSize;
+}
+
+}
+
+#endif // MEDIA_MP4CHUNKINTERLEAVER_H
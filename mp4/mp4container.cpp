@@ -1,21 +1,23 @@
 #include "./mp4container.h"
 #include "./mp4ids.h"
+#include "./mp4chunkinterleaver.h"
 
 #include "../exceptions.h"
 #include "../mediafileinfo.h"
 #include "../backuphelper.h"
+#include "../copyengine.h"
+#include "../parallelfor.h"
 
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/binaryreader.h>
 #include <c++utilities/io/binarywriter.h>
-#include <c++utilities/io/copy.h>
 #include <c++utilities/io/catchiofailure.h>
 
 #include <unistd.h>
 
 #include <tuple>
-#include <numeric>
 #include <memory>
+#include <sstream>
 
 using namespace std;
 using namespace IoUtilities;
@@ -96,7 +98,7 @@ void Mp4Container::internalParseTags()
             metaAtom->parse();
             m_tags.emplace_back(make_unique<Mp4Tag>());
             try {
-                m_tags.back()->parse(*metaAtom);
+                m_tags.back()->parse(*metaAtom, fileInfo().tagFieldProjection());
             } catch(const NoDataFoundException &) {
                 m_tags.pop_back();
             }
@@ -351,6 +353,7 @@ void Mp4Container::internalMakeFile()
     }
 
     // calculate sizes
+    MetricsScope preparingScope(fileInfo().metrics(), ProcessingPhase::PreparingMaking);
     // -> size of tags
     vector<Mp4TagMaker> tagMaker;
     uint64 tagsSize = 0;
@@ -365,6 +368,11 @@ void Mp4Container::internalMakeFile()
         addNotifications(*tag);
     }
 
+    // try to update the tags in-place before considering the layout of the whole file
+    if(!rewriteRequired && fileInfo().saveFilePath().empty() && makeTagsInPlace(movieAtom, tagMaker, tagsSize)) {
+        return;
+    }
+
     // -> size of movie atom (contains track and tag information)
     movieAtomSize = userDataAtomSize = 0;
     try {
@@ -506,6 +514,8 @@ calculatePadding:
         throw OperationAbortedException();
     }
 
+    preparingScope.stop();
+
     // setup stream(s) for writing
     // -> update status
     updateStatus("Preparing streams ...");
@@ -514,6 +524,8 @@ calculatePadding:
     string backupPath;
     NativeFileStream &outputStream = fileInfo().stream();
     NativeFileStream backupStream; // create a stream to open the backup/original file for the case rewriting the file is required
+    CopyEngine *const assignedCopyEngine = copyEngine();
+    unique_ptr<FileCopyEngine> fileCopyEngine;
     BinaryWriter outputWriter(&outputStream);
 
     if(rewriteRequired) {
@@ -545,6 +557,12 @@ calculatePadding:
         // set backup stream as associated input stream since we need the original elements to write the new file
         setStream(backupStream);
 
+        // copy media data from the backup/original file to the new file within the kernel where possible
+        if(!copyEngine()) {
+            fileCopyEngine = make_unique<FileCopyEngine>(backupPath.empty() ? fileInfo().path() : backupPath, fileInfo().saveFilePath().empty() ? fileInfo().path() : fileInfo().saveFilePath());
+            setCopyEngine(fileCopyEngine.get());
+        }
+
         // TODO: reduce code duplication
 
     } else { // !rewriteRequired
@@ -658,13 +676,15 @@ calculatePadding:
                     }
 
                     // write zeroes
-                    for(; newPadding; --newPadding) {
-                        outputStream.put(0);
+                    static const char zeroes[0x1000] = {0};
+                    for(; newPadding; newPadding -= min<uint64>(newPadding, sizeof(zeroes))) {
+                        outputStream.write(zeroes, static_cast<streamsize>(min<uint64>(newPadding, sizeof(zeroes))));
                     }
                 }
 
                 // write media data
                 if(rewriteRequired) {
+                    MetricsScope writingScope(fileInfo().metrics(), ProcessingPhase::WritingMediaData);
                     for(level0Atom = firstMediaDataAtom; level0Atom; level0Atom = level0Atom->nextSibling()) {
                         level0Atom->parse();
                         switch(level0Atom->id()) {
@@ -694,70 +714,67 @@ calculatePadding:
                         // read chunk offset and chunk size table from the old file which are required to get chunks
                         updateStatus("Reading chunk offsets and sizes from the original file ...");
                         trackInfos.reserve(trackCount);
-                        uint64 totalChunkCount = 0;
-                        uint64 totalMediaDataSize = 0;
                         for(auto &track : tracks()) {
+                            trackInfos.emplace_back(&track->inputStream(), vector<uint64>(), vector<uint64>());
+                        }
+                        if(fileInfo().isForcingFullParse()) {
+                            // reading fragments requires parsing the atom tree which is not thread-safe
+                            for(size_t trackIndex = 0; trackIndex != trackCount; ++trackIndex) {
+                                if(isAborted()) {
+                                    throw OperationAbortedException();
+                                }
+                                auto &track = tracks()[trackIndex];
+                                get<1>(trackInfos[trackIndex]) = track->readChunkOffsetsSupportingFragments(true);
+                                get<2>(trackInfos[trackIndex]) = track->readChunkSizes();
+                            }
+                        } else {
+                            // read the tables of the tracks concurrently using an independent stream for each track
+                            const string &originalPath = backupPath.empty() ? fileInfo().path() : backupPath;
+                            parallelFor(trackCount, [this, &trackInfos, &originalPath] (size_t trackIndex) {
+                                if(isAborted()) {
+                                    return;
+                                }
+                                auto &track = tracks()[trackIndex];
+                                NativeFileStream trackStream;
+                                trackStream.exceptions(ios_base::badbit | ios_base::failbit);
+                                trackStream.open(originalPath, ios_base::in | ios_base::binary);
+                                track->setInputStream(trackStream);
+                                try {
+                                    get<1>(trackInfos[trackIndex]) = track->readChunkOffsets();
+                                    get<2>(trackInfos[trackIndex]) = track->readChunkSizes();
+                                } catch(...) {
+                                    track->setInputStream(*get<0>(trackInfos[trackIndex]));
+                                    throw;
+                                }
+                                track->setInputStream(*get<0>(trackInfos[trackIndex]));
+                            });
                             if(isAborted()) {
                                 throw OperationAbortedException();
                             }
-
-                            // emplace information
-                            trackInfos.emplace_back(&track->inputStream(), track->readChunkOffsetsSupportingFragments(fileInfo().isForcingFullParse()), track->readChunkSizes());
-
+                        }
+                        Mp4ChunkInterleaver interleaver;
+                        for(size_t trackIndex = 0; trackIndex != trackCount; ++trackIndex) {
+                            auto &track = tracks()[trackIndex];
                             // check whether the chunks could be parsed correctly
-                            const vector<uint64> &chunkOffsetTable = get<1>(trackInfos.back());
-                            const vector<uint64> &chunkSizesTable = get<2>(trackInfos.back());
+                            vector<uint64> &chunkOffsetTable = get<1>(trackInfos[trackIndex]);
+                            const vector<uint64> &chunkSizesTable = get<2>(trackInfos[trackIndex]);
                             if(track->chunkCount() != chunkOffsetTable.size() || track->chunkCount() != chunkSizesTable.size()) {
                                 addNotification(NotificationType::Critical, "Chunks of track " % numberToString<uint64, string>(track->id()) + " could not be parsed correctly.", context);
                             }
-
-                            // increase total chunk count and size
-                            totalChunkCount += track->chunkCount();
-                            totalMediaDataSize += accumulate(chunkSizesTable.cbegin(), chunkSizesTable.cend(), totalMediaDataSize);
+                            // note: trackInfos has been reserved so the tables are not moved anymore
+                            interleaver.addTrack(track->inputStream(), chunkOffsetTable, chunkSizesTable);
                         }
 
                         // write media data chunk-by-chunk
                         // -> write header of media data atom
+                        uint64 totalMediaDataSize = interleaver.totalSize();
                         Mp4Atom::addHeaderSize(totalMediaDataSize);
                         Mp4Atom::makeHeader(totalMediaDataSize, Mp4AtomIds::MediaData, outputWriter);
 
-                        // -> copy chunks
-                        CopyHelper<0x2000> copyHelper;
-                        uint64 chunkIndexWithinTrack = 0, totalChunksCopied = 0;
-                        bool anyChunksCopied;
-                        do {
-                            if(isAborted()) {
-                                throw OperationAbortedException();
-                            }
-
-                            // copy a chunk from each track
-                            anyChunksCopied = false;
-                            for(size_t trackIndex = 0; trackIndex < trackCount; ++trackIndex) {
-                                // get source stream and tables for current track
-                                auto &trackInfo = trackInfos[trackIndex];
-                                istream &sourceStream = *get<0>(trackInfo);
-                                vector<uint64> &chunkOffsetTable = get<1>(trackInfo);
-                                const vector<uint64> &chunkSizesTable = get<2>(trackInfo);
-
-                                // still chunks to be copied (of this track)?
-                                if(chunkIndexWithinTrack < chunkOffsetTable.size() && chunkIndexWithinTrack < chunkSizesTable.size()) {
-                                    // copy chunk, update entry in chunk offset table
-                                    sourceStream.seekg(chunkOffsetTable[chunkIndexWithinTrack]);
-                                    chunkOffsetTable[chunkIndexWithinTrack] = outputStream.tellp();
-                                    copyHelper.copy(sourceStream, outputStream, chunkSizesTable[chunkIndexWithinTrack]);
-
-                                    // update counter / status
-                                    anyChunksCopied = true;
-                                    ++totalChunksCopied;
-                                }
-                            }
-
-                            // incrase chunk index within track, update progress percentage
-                            if(!(++chunkIndexWithinTrack % 10)) {
-                                updatePercentage(static_cast<double>(totalChunksCopied) / totalChunkCount);
-                            }
-
-                        } while(anyChunksCopied);
+                        // -> copy chunks (updates entries in chunk offset tables)
+                        if(!interleaver.write(outputStream, [this] { return isAborted(); }, [this] (double percentage) { updatePercentage(percentage); })) {
+                            throw OperationAbortedException();
+                        }
                     }
 
                 } else {
@@ -781,6 +798,9 @@ calculatePadding:
             }
         }
 
+        // the file copy engine is only valid for the backup/original file
+        setCopyEngine(assignedCopyEngine);
+
         // reparse what is written so far
         updateStatus("Reparsing output file ...");
         if(rewriteRequired) {
@@ -859,9 +879,128 @@ calculatePadding:
         outputStream.flush();
 
         // handle errors (which might have been occured after renaming/creating backup file)
+    } catch(...) {
+        setCopyEngine(assignedCopyEngine);
+        BackupHelper::handleFailureAfterFileModified(fileInfo(), backupPath, outputStream, backupStream, context);
+    }
+}
+
+/*!
+ * \brief Writes the tags by overwriting the existing "meta"-atom and adjacent padding within the "udta"-atom.
+ *
+ * This is only possible if the file contains exactly one "moov"-atom with exactly one "udta"-atom and the
+ * new "meta"-atoms fit into the contiguous range of "meta"-, "free"- and "skip"-atoms containing the existing
+ * "meta"-atom(s). The remaining space is filled with a "free"-atom which must not fall below the minimum
+ * padding or exceed the maximum padding.
+ * Since the size of the range is not changed, no other atoms (especially not the chunk offset tables)
+ * need to be updated.
+ *
+ * \returns Returns whether the tags have been written; if false is returned the file has not been touched.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+bool Mp4Container::makeTagsInPlace(Mp4Atom *movieAtom, std::vector<Mp4TagMaker> &tagMaker, uint64 tagsSize)
+{
+    static const string context("making MP4 container");
+
+    // check whether the preferred tag/index position is already used
+    const ElementPosition currentTagPos = determineTagPosition();
+    if((fileInfo().tagPosition() != ElementPosition::Keep && fileInfo().tagPosition() != currentTagPos)
+            || (fileInfo().indexPosition() != ElementPosition::Keep && fileInfo().indexPosition() != currentTagPos)) {
+        return false;
+    }
+
+    // determine the range of meta/free/skip atoms within the user data atom which contains the meta atom
+    uint64 rangeStart = 0, rangeSize = 0;
+    try {
+        if(movieAtom->siblingById(Mp4AtomIds::Movie)) {
+            return false;
+        }
+        Mp4Atom *const userDataAtom = movieAtom->childById(Mp4AtomIds::UserData);
+        if(!userDataAtom || userDataAtom->siblingById(Mp4AtomIds::UserData)) {
+            return false;
+        }
+        bool rangeHasMeta = false, rangeComplete = false;
+        for(Mp4Atom *level2Atom = userDataAtom->firstChild(); level2Atom; level2Atom = level2Atom->nextSibling()) {
+            level2Atom->parse();
+            switch(level2Atom->id()) {
+            case Mp4AtomIds::Meta:
+                if(rangeComplete) {
+                    return false; // meta atoms are not contiguous
+                }
+                rangeHasMeta = true;
+                FALLTHROUGH;
+            case Mp4AtomIds::Free: case Mp4AtomIds::Skip:
+                if(rangeComplete) {
+                    break;
+                }
+                if(!rangeSize) {
+                    rangeStart = level2Atom->startOffset();
+                }
+                rangeSize += level2Atom->totalSize();
+                break;
+            default:
+                if(rangeHasMeta) {
+                    rangeComplete = true;
+                } else {
+                    rangeSize = 0;
+                }
+            }
+        }
+        if(!rangeHasMeta) {
+            return false;
+        }
+    } catch(const Failure &) {
+        return false;
+    }
+
+    // check whether the tags fit and the remaining space can be filled with a free atom
+    if(tagsSize > rangeSize) {
+        return false;
+    }
+    const uint64 padding = rangeSize - tagsSize;
+    if((padding > 0 && padding < 8) || padding < fileInfo().minPadding() || padding > fileInfo().maxPadding()) {
+        return false;
+    }
+
+    // make tags and padding into a buffer
+    updateStatus("Updating tags in-place ...");
+    stringstream buffer(ios_base::in | ios_base::out | ios_base::binary);
+    for(auto &maker : tagMaker) {
+        maker.make(buffer);
+    }
+    if(padding) {
+        BinaryWriter writer(&buffer);
+        writer.writeUInt32BE(static_cast<uint32>(padding));
+        writer.writeUInt32BE(Mp4AtomIds::Free);
+        buffer << string(padding - 8, '\0');
+    }
+    const string data(buffer.str());
+    if(data.size() != rangeSize) {
+        addNotification(NotificationType::Critical, "The size of the made tags does not match the computed size.", context);
+        throw InvalidDataException();
+    }
+
+    // overwrite the range with a single write
+    string backupPath;
+    NativeFileStream &outputStream = fileInfo().stream();
+    NativeFileStream backupStream;
+    try {
+        fileInfo().close();
+        outputStream.open(fileInfo().path(), ios_base::in | ios_base::out | ios_base::binary);
+    } catch(...) {
+        const char *what = catchIoFailure();
+        addNotification(NotificationType::Critical, "Opening the file with write permissions failed.", context);
+        throwIoFailure(what);
+    }
+    try {
+        outputStream.seekp(static_cast<streamoff>(rangeStart));
+        outputStream.write(data.data(), static_cast<streamsize>(data.size()));
+        outputStream.flush();
+        updatePercentage(100.0);
     } catch(...) {
         BackupHelper::handleFailureAfterFileModified(fileInfo(), backupPath, outputStream, backupStream, context);
     }
+    return true;
 }
 
 /*!
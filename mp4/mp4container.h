@@ -36,6 +36,7 @@ protected:
 
 private:
     void updateOffsets(const std::vector<int64> &oldMdatOffsets, const std::vector<int64> &newMdatOffsets);
+    bool makeTagsInPlace(Mp4Atom *movieAtom, std::vector<Mp4TagMaker> &tagMaker, uint64 tagsSize);
 
     bool m_fragmented;
 };
@@ -4,6 +4,7 @@
 #include "./mp4atom.h"
 
 #include "../exceptions.h"
+#include "../tagfieldprojection.h"
 
 #include <c++utilities/io/binarywriter.h>
 #include <c++utilities/conversion/stringconversion.h>
@@ -215,15 +216,16 @@ bool Mp4Tag::setValues(KnownField field, const std::vector<TagValue> &values)
                 ++valuesIterator;
             }
         }
+        for(; range.first != range.second; ++range.first) {
+            range.first->second.setValue(TagValue());
+        }
+        // note: inserting might invalidate the iterators of range
         for(; valuesIterator != values.cend(); ++valuesIterator) {
             Mp4TagField tagField(Mp4TagAtomIds::Extended, *valuesIterator);
             tagField.setMean(extendedId.mean);
             tagField.setName(extendedId.name);
             fields().insert(std::make_pair(Mp4TagAtomIds::Extended, move(tagField)));
         }
-        for(; range.first != range.second; ++range.first) {
-            range.first->second.setValue(TagValue());
-        }
     }
     return FieldMapBasedTag<fieldType>::setValues(field, values);
 }
@@ -270,11 +272,15 @@ bool Mp4Tag::hasField(KnownField field) const
 /*!
  * \brief Parses tag information from the specified \a metaAtom.
  *
+ * If a \a projection is specified, the data of atoms not included in it is not read. The atoms are
+ * remembered so they can be parsed later using parseSkippedFields(). Extended atoms ("----") are
+ * always parsed because their ID is only known after reading their data.
+ *
  * \throws Throws std::ios_base::failure when an IO error occurs.
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void Mp4Tag::parse(Mp4Atom &metaAtom)
+void Mp4Tag::parse(Mp4Atom &metaAtom, const TagFieldProjection *projection)
 {
     invalidateStatus();
     static const string context("parsing MP4 tag");
@@ -318,9 +324,15 @@ void Mp4Tag::parse(Mp4Atom &metaAtom)
         for(Mp4Atom *child : *subAtom) {
             try {
                 child->parse();
+                if(projection && child->id() != Mp4TagAtomIds::Extended && !projection->includes(*this, child->id())) {
+                    m_skippedAtoms.push_back(child);
+                    continue;
+                }
                 tagField.invalidateNotifications();
                 tagField.reparse(*child);
-                fields().insert(pair<fieldType::identifierType, fieldType>(child->id(), tagField));
+                // move the value because copying it would load lazily loaded pictures
+                TagValue value(move(tagField.value()));
+                fields().insert(pair<fieldType::identifierType, fieldType>(child->id(), tagField))->second.value() = move(value);
             } catch(const Failure &) {
             }
             addNotifications(context, *child);
@@ -332,6 +344,33 @@ void Mp4Tag::parse(Mp4Atom &metaAtom)
     }
 }
 
+/*!
+ * \brief Parses the atoms skipped when parsing the tag because they were not included in the projection.
+ * \remarks Atoms with an ID the tag has already fields for are not added again (see Tag::parseSkippedFields()).
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void Mp4Tag::parseSkippedFields()
+{
+    if(m_skippedAtoms.empty()) {
+        return;
+    }
+    static const string context("parsing skipped MP4 tag fields");
+    vector<Mp4TagField> skippedFields;
+    skippedFields.reserve(m_skippedAtoms.size());
+    Mp4TagField tagField;
+    for(Mp4Atom *atom : m_skippedAtoms) {
+        try {
+            tagField.invalidateNotifications();
+            tagField.reparse(*atom);
+            skippedFields.emplace_back(tagField);
+        } catch(const Failure &) {
+        }
+        addNotifications(context, tagField);
+    }
+    m_skippedAtoms.clear();
+    insertSkippedFields(skippedFields);
+}
+
 /*!
  * \brief Prepares making.
  * \returns Returns a Mp4TagMaker object which can be used to actually make the tag.
@@ -10,6 +10,7 @@ namespace Media
 
 class Mp4Atom;
 class Mp4Tag;
+class TagFieldProjection;
 
 struct TAG_PARSER_EXPORT Mp4ExtendedFieldId
 {
@@ -122,9 +123,16 @@ public:
     using FieldMapBasedTag<Mp4TagField>::hasField;
     bool hasField(KnownField value) const;
 
-    void parse(Mp4Atom &metaAtom);
+    void removeAllFields();
+    bool hasSkippedFields() const;
+    void parseSkippedFields();
+
+    void parse(Mp4Atom &metaAtom, const TagFieldProjection *projection = nullptr);
     Mp4TagMaker prepareMaking();
     void make(std::ostream &stream);
+
+private:
+    std::vector<Mp4Atom *> m_skippedAtoms;
 };
 
 /*!
@@ -133,6 +141,23 @@ public:
 inline Mp4Tag::Mp4Tag()
 {}
 
+/*!
+ * \brief Removes all fields including the fields skipped when parsing the tag.
+ */
+inline void Mp4Tag::removeAllFields()
+{
+    FieldMapBasedTag<Mp4TagField>::removeAllFields();
+    m_skippedAtoms.clear();
+}
+
+/*!
+ * \brief Returns whether fields have been skipped when parsing the tag.
+ */
+inline bool Mp4Tag::hasSkippedFields() const
+{
+    return !m_skippedAtoms.empty();
+}
+
 inline TagType Mp4Tag::type() const
 {
     return TagType::Mp4Tag;
@@ -4,6 +4,7 @@
 #include "./mp4ids.h"
 
 #include "../exceptions.h"
+#include "../mediafileinfo.h"
 
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/binaryreader.h>
@@ -82,6 +83,8 @@ void Mp4TagField::reparse(Mp4Atom &ilstChild)
     context = "parsing MP4 tag field " + ilstChild.idToString();
     iostream &stream = ilstChild.stream();
     BinaryReader &reader = ilstChild.container().reader();
+    Mp4Container *const container = &ilstChild.container();
+    const bool lazyPictureLoading = container->fileInfo().isLazyPictureLoadingEnabled();
     int dataAtomFound = 0, meanAtomFound = 0, nameAtomFound = 0;
     for(Mp4Atom *dataAtom = ilstChild.firstChild(); dataAtom; dataAtom = dataAtom->nextSibling()) {
         try {
@@ -135,6 +138,13 @@ void Mp4TagField::reparse(Mp4Atom &ilstChild)
                         ;
                     }
                     const streamsize coverSize = dataAtom->dataSize() - 8;
+                    if(lazyPictureLoading) {
+                        // reference the picture data instead of reading it
+                        value().assignDataFromStream([container] () -> istream & {
+                            return container->stream();
+                        }, dataAtom->dataOffset() + 8, coverSize, TagDataType::Picture);
+                        break;
+                    }
                     unique_ptr<char []> coverData = make_unique<char []>(coverSize);
                     stream.read(coverData.get(), coverSize);
                     value().assignData(move(coverData), coverSize, TagDataType::Picture);
@@ -553,7 +563,7 @@ void Mp4TagFieldMaker::make(ostream &stream)
             stream << m_convertedData.rdbuf();
         } else {
             // no conversion was needed, write data directly from tag value
-            stream.write(m_field.value().dataPointer(), m_field.value().dataSize());
+            m_field.value().copyDataTo(stream);
         }
     }
 }
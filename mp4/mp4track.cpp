@@ -11,7 +11,9 @@
 
 #include "../exceptions.h"
 #include "../mediaformat.h"
+#include "../metrics.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/binaryreader.h>
 #include <c++utilities/io/binarywriter.h>
@@ -20,6 +22,11 @@
 
 #include <locale>
 #include <cmath>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace IoUtilities;
@@ -31,6 +38,102 @@ namespace Media {
 /// \brief Dates within MP4 tracks are expressed as the number of seconds since this date.
 const DateTime startDate = DateTime::fromDate(1904, 1, 1);
 
+namespace {
+
+/*!
+ * \brief Swaps the byte order of the specified \a values (scalar implementation).
+ */
+template<typename T>
+void swapByteOrder(T *values, size_t count)
+{
+    for(T *end = values + count; values != end; ++values) {
+        *values = swapOrder(*values);
+    }
+}
+
+#if defined(CONVERSION_UTILITIES_BYTE_ORDER_LITTLE_ENDIAN) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MEDIA_MP4TRACK_SIMD_BYTE_SWAP
+
+/*!
+ * \brief Fills the specified \a mask with the pshufb indices for reversing the bytes of each element of type T.
+ * \remarks The indices only depend on the position within 16 byte lanes (as required by the AVX2 version).
+ */
+template<typename T, size_t size>
+void makeByteSwapMask(char (&mask)[size])
+{
+    for(size_t i = 0; i < size; ++i) {
+        mask[i] = static_cast<char>((i % 16) / sizeof(T) * sizeof(T) + sizeof(T) - 1 - i % sizeof(T));
+    }
+}
+
+/*!
+ * \brief Swaps the byte order of the specified \a values (SSSE3 implementation).
+ */
+template<typename T>
+__attribute__((target("ssse3"))) void swapByteOrderSsse3(T *values, size_t count)
+{
+    char maskBytes[16];
+    makeByteSwapMask<T>(maskBytes);
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(maskBytes));
+    constexpr size_t valuesPerVector = 16 / sizeof(T);
+    size_t i = 0;
+    for(; i + valuesPerVector <= count; i += valuesPerVector) {
+        __m128i *const vector = reinterpret_cast<__m128i *>(values + i);
+        _mm_storeu_si128(vector, _mm_shuffle_epi8(_mm_loadu_si128(vector), mask));
+    }
+    swapByteOrder(values + i, count - i);
+}
+
+/*!
+ * \brief Swaps the byte order of the specified \a values (AVX2 implementation).
+ */
+template<typename T>
+__attribute__((target("avx2"))) void swapByteOrderAvx2(T *values, size_t count)
+{
+    char maskBytes[32];
+    makeByteSwapMask<T>(maskBytes);
+    const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(maskBytes));
+    constexpr size_t valuesPerVector = 32 / sizeof(T);
+    size_t i = 0;
+    for(; i + valuesPerVector <= count; i += valuesPerVector) {
+        __m256i *const vector = reinterpret_cast<__m256i *>(values + i);
+        _mm256_storeu_si256(vector, _mm256_shuffle_epi8(_mm256_loadu_si256(vector), mask));
+    }
+    swapByteOrder(values + i, count - i);
+}
+
+#endif
+
+/*!
+ * \brief Reads \a count big-endian values from the current position of the specified \a stream into \a values.
+ *
+ * The whole table is read at once and converted to the host byte order afterwards using
+ * the best byte swapping implementation supported by the CPU.
+ *
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+template<typename T>
+void readBigEndianTable(istream &stream, T *values, size_t count)
+{
+    stream.read(reinterpret_cast<char *>(values), static_cast<streamsize>(count * sizeof(T)));
+    IoCounters::countRead(count * sizeof(T));
+#if defined(MEDIA_MP4TRACK_SIMD_BYTE_SWAP)
+    static const bool avx2Supported = __builtin_cpu_supports("avx2");
+    static const bool ssse3Supported = __builtin_cpu_supports("ssse3");
+    if(avx2Supported) {
+        swapByteOrderAvx2(values, count);
+    } else if(ssse3Supported) {
+        swapByteOrderSsse3(values, count);
+    } else {
+        swapByteOrder(values, count);
+    }
+#elif defined(CONVERSION_UTILITIES_BYTE_ORDER_LITTLE_ENDIAN)
+    swapByteOrder(values, count);
+#endif
+}
+
+}
+
 /*!
  * \class Mpeg4AudioSpecificConfig
  * \brief The Mpeg4AudioSpecificConfig class holds MPEG-4 audio specific config parsed using Mp4Track::parseAudioSpecificConfig().
@@ -171,18 +274,17 @@ std::vector<uint64> Mp4Track::readChunkOffsetsSupportingFragments(bool parseFrag
             actualChunkCount = floor(static_cast<double>(actualTableSize) / static_cast<double>(chunkOffsetSize()));
         }
         // read the table
-        offsets.reserve(actualChunkCount);
         m_istream->seekg(m_stcoAtom->dataOffset() + 8);
         switch(chunkOffsetSize()) {
-        case 4:
-            for(uint32 i = 0; i < actualChunkCount; ++i) {
-                offsets.push_back(reader().readUInt32BE());
-            }
+        case 4: {
+            vector<uint32> table(actualChunkCount);
+            readBigEndianTable(*m_istream, table.data(), table.size());
+            offsets.assign(table.cbegin(), table.cend());
             break;
+        }
         case 8:
-            for(uint32 i = 0; i < actualChunkCount; ++i) {
-                offsets.push_back(reader().readUInt64BE());
-            }
+            offsets.resize(actualChunkCount);
+            readBigEndianTable(*m_istream, offsets.data(), offsets.size());
             break;
         default:
             addNotification(NotificationType::Critical, "The determined chunk offset size is invalid.", context);
@@ -323,39 +425,36 @@ std::vector<uint64> Mp4Track::readChunkOffsetsSupportingFragments(bool parseFrag
 }
 
 /*!
- * \brief Accumulates \a count sample sizes from the specified \a sampleSizeTable starting at the specified \a sampleIndex.
- * \remarks This helper function is used by the addChunkSizeEntries() method.
+ * \brief Adds chunks size entries to the specified \a chunkSizeTable.
+ * \param chunkSizeTable Specifies the chunk size table. The chunks sizes will be added to this table.
+ * \param count Specifies the number of chunks to be added. The size of \a chunkSizeTable is increased this value.
+ * \param sampleIndex Specifies the index of the first sample; is increased by \a count * \a sampleCount.
+ * \param sampleCount Specifies the number of samples per chunk.
+ * \remarks
+ *  - This helper function is used by the readChunkSizes() method to process a "sample to chunk" run.
+ *  - The chunk sizes are computed in a single pass over the sample sizes of the run by keeping a running
+ *    sum and taking the difference at each chunk boundary.
  */
-uint64 Mp4Track::accumulateSampleSizes(size_t &sampleIndex, size_t count)
+void Mp4Track::addChunkSizeEntries(std::vector<uint64> &chunkSizeTable, size_t count, size_t &sampleIndex, uint32 sampleCount)
 {
-    if(sampleIndex + count <= m_sampleSizes.size()) {
-        uint64 sum = 0;
-        for(size_t end = sampleIndex + count; sampleIndex < end; ++sampleIndex) {
-            sum += m_sampleSizes[sampleIndex];
+    const uint64 runSampleCount = static_cast<uint64>(count) * sampleCount;
+    if(sampleIndex + runSampleCount <= m_sampleSizes.size()) {
+        const uint32 *sampleSize = m_sampleSizes.data() + sampleIndex;
+        uint64 sum = 0, chunkStart = 0;
+        for(size_t i = 0; i < count; ++i) {
+            for(const uint32 *chunkEnd = sampleSize + sampleCount; sampleSize != chunkEnd; ++sampleSize) {
+                sum += *sampleSize;
+            }
+            chunkSizeTable.push_back(sum - chunkStart);
+            chunkStart = sum;
         }
-        return sum;
     } else if(m_sampleSizes.size() == 1) {
-        sampleIndex += count;
-        return static_cast<uint64>(m_sampleSizes.front()) * count;
+        chunkSizeTable.insert(chunkSizeTable.end(), count, static_cast<uint64>(m_sampleSizes.front()) * sampleCount);
     } else {
         addNotification(NotificationType::Critical, "There are not as many sample size entries as samples.", "reading chunk sizes of MP4 track");
         throw InvalidDataException();
     }
-}
-
-/*!
- * \brief Adds chunks size entries to the specified \a chunkSizeTable.
- * \param chunkSizeTable Specifies the chunk size table. The chunks sizes will be added to this table.
- * \param count Specifies the number of chunks to be added. The size of \a chunkSizeTable is increased this value.
- * \param sampleIndex Specifies the index of the first sample in the \a sampleSizeTable; is increased by \a count * \a sampleCount.
- * \param sampleSizeTable Specifies the table holding the sample sizes.
- * \remarks This helper function is used by the readChunkSizes() method.
- */
-void Mp4Track::addChunkSizeEntries(std::vector<uint64> &chunkSizeTable, size_t count, size_t &sampleIndex, uint32 sampleCount)
-{
-    for(size_t i = 0; i < count; ++i) {
-        chunkSizeTable.push_back(accumulateSampleSizes(sampleIndex, sampleCount));
-    }
+    sampleIndex += runSampleCount;
 }
 
 /*!
@@ -392,12 +491,11 @@ vector<tuple<uint32, uint32, uint32> > Mp4Track::readSampleToChunkTable()
     vector<tuple<uint32, uint32, uint32> > sampleToChunkTable;
     sampleToChunkTable.reserve(actualSampleToChunkEntryCount);
     m_istream->seekg(m_stscAtom->dataOffset() + 8);
-    for(uint32 i = 0; i < actualSampleToChunkEntryCount; ++i) {
-        // read entry
-        uint32 firstChunk = reader().readUInt32BE();
-        uint32 samplesPerChunk = reader().readUInt32BE();
-        uint32 sampleDescriptionIndex = reader().readUInt32BE();
-        sampleToChunkTable.emplace_back(firstChunk, samplesPerChunk, sampleDescriptionIndex);
+    vector<uint32> entries(static_cast<size_t>(actualSampleToChunkEntryCount) * 3);
+    readBigEndianTable(*m_istream, entries.data(), entries.size());
+    for(auto entry = entries.cbegin(), end = entries.cend(); entry != end; entry += 3) {
+        // entry consists of first chunk, samples per chunk and sample description index
+        sampleToChunkTable.emplace_back(entry[0], entry[1], entry[2]);
     }
     return sampleToChunkTable;
 }
@@ -1639,42 +1737,38 @@ void Mp4Track::internalParseHeader()
                 addNotification(NotificationType::Critical, "The stsz atom is truncated. It stores less entries as denoted.", context);
                 actualSampleCount = floor(static_cast<double>(actualSampleSizeTableSize) / (0.125 * fieldSize));
             }
-            m_sampleSizes.reserve(actualSampleCount);
-            uint32 i = 1;
+            // read the whole table at once
             switch(fieldSize) {
-            case 4:
-                for(; i <= actualSampleCount; i += 2) {
-                    byte val = reader.readByte();
-                    m_sampleSizes.push_back(val >> 4);
-                    m_sampleSizes.push_back(val & 0xF0);
-                    m_size += (val >> 4) + (val & 0xF0);
-                }
-                if(i <= actualSampleCount + 1) {
-                    m_sampleSizes.push_back(reader.readByte() >> 4);
-                    m_size += m_sampleSizes.back();
+            case 4: {
+                vector<byte> table(static_cast<size_t>((actualSampleCount + 1) / 2));
+                m_istream->read(reinterpret_cast<char *>(table.data()), static_cast<streamsize>(table.size()));
+                m_sampleSizes.reserve(static_cast<size_t>(actualSampleCount));
+                for(uint64 i = 0; i < actualSampleCount; ++i) {
+                    const byte val = table[static_cast<size_t>(i / 2)];
+                    m_sampleSizes.push_back(i % 2 ? (val & 0x0F) : (val >> 4));
                 }
                 break;
-            case 8:
-                for(; i <= actualSampleCount; ++i) {
-                    m_sampleSizes.push_back(reader.readByte());
-                    m_size += m_sampleSizes.back();
-                }
+            }
+            case 8: {
+                vector<byte> table(static_cast<size_t>(actualSampleCount));
+                m_istream->read(reinterpret_cast<char *>(table.data()), static_cast<streamsize>(table.size()));
+                m_sampleSizes.assign(table.cbegin(), table.cend());
                 break;
-            case 16:
-                for(; i <= actualSampleCount; ++i) {
-                    m_sampleSizes.push_back(reader.readUInt16BE());
-                    m_size += m_sampleSizes.back();
-                }
+            }
+            case 16: {
+                vector<uint16> table(static_cast<size_t>(actualSampleCount));
+                readBigEndianTable(*m_istream, table.data(), table.size());
+                m_sampleSizes.assign(table.cbegin(), table.cend());
                 break;
+            }
             case 32:
-                for(; i <= actualSampleCount; ++i) {
-                    m_sampleSizes.push_back(reader.readUInt32BE());
-                    m_size += m_sampleSizes.back();
-                }
+                m_sampleSizes.resize(static_cast<size_t>(actualSampleCount));
+                readBigEndianTable(*m_istream, m_sampleSizes.data(), m_sampleSizes.size());
                 break;
             default:
                 addNotification(NotificationType::Critical, "The fieldsize used to store the sample sizes is not supported. The sample count and size of the track can not be determined.", context);
             }
+            m_size = accumulate(m_sampleSizes.cbegin(), m_sampleSizes.cend(), static_cast<uint64>(0));
         }
     }
 
@@ -164,7 +164,6 @@ protected:
 
 private:
     // private helper methods
-    uint64 accumulateSampleSizes(size_t &sampleIndex, size_t count);
     void addChunkSizeEntries(std::vector<uint64> &chunkSizeTable, size_t count, size_t &sampleIndex, uint32 sampleCount);
 
     Mp4Atom *m_trakAtom;
@@ -69,21 +69,23 @@ void Mpeg4Descriptor::internalParse()
         m_dataSize = (m_dataSize << 7) | ((tmp = reader().readByte()) & 0x7F);
         ++m_sizeLength;
     }
+    IoCounters::countSeek();
+    IoCounters::countRead(headerSize());
     // check whether the denoted data size exceeds the available data size
     if(maxTotalSize() < totalSize()) {
         addNotification(NotificationType::Warning, "The descriptor seems to be truncated; unable to parse siblings of that ", parsingContext());
         m_dataSize = maxTotalSize(); // using max size instead
     }
     m_firstChild.reset();
-    implementationType *sibling = nullptr;
+    elementPointerType sibling;
     if(totalSize() < maxTotalSize()) {
         if(parent()) {
-            sibling = new implementationType(*(parent()), startOffset() + totalSize());
+            sibling = createElement(*(parent()), startOffset() + totalSize());
         } else {
-            sibling = new implementationType(container(), startOffset() + totalSize(), maxTotalSize() - totalSize());
+            sibling = createElement(container(), startOffset() + totalSize(), maxTotalSize() - totalSize());
         }
     }
-    m_nextSibling.reset(sibling);
+    m_nextSibling = move(sibling);
 }
 
 }
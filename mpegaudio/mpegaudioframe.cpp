@@ -196,15 +196,20 @@ uint32 MpegAudioFrame::sampleCount() const
 
 /*!
  * \brief Returns the size if known; otherwise retruns 0.
+ * \remarks The size includes the header and the padding.
  */
 uint32 MpegAudioFrame::size() const
 {
+    const uint32 bitrate = this->bitrate(), samplingFrequency = this->samplingFrequency();
+    if(!bitrate || !samplingFrequency) {
+        return 0;
+    }
     switch (m_header & 0x60000u) {
     case 0x60000u:
-        return static_cast<uint32>(((static_cast<double>(bitrate()) * 1024.0 / 8.0) / static_cast<double>(samplingFrequency())) * static_cast<double>(sampleCount()) + static_cast<double>(paddingSize()));
+        return (12u * bitrate * 1000u / samplingFrequency) * 4u + paddingSize();
     case 0x40000u:
     case 0x20000u:
-        return static_cast<uint32>(((static_cast<double>(bitrate()) * 1024.0 / 8.0) / static_cast<double>(samplingFrequency())) * static_cast<double>(sampleCount()) + static_cast<double>(paddingSize()));
+        return sampleCount() / 8u * bitrate * 1000u / samplingFrequency + paddingSize();
     default:
         return 0;
     }
@@ -41,6 +41,7 @@ class TAG_PARSER_EXPORT MpegAudioFrame
 {
 public:
     MpegAudioFrame();
+    explicit MpegAudioFrame(uint32 header);
 
     void parseHeader(IoUtilities::BinaryReader &reader);
 
@@ -90,6 +91,20 @@ inline MpegAudioFrame::MpegAudioFrame() :
     m_xingQualityIndicator(0)
 {}
 
+/*!
+ * \brief Constructs a new frame from the specified raw \a header.
+ * \remarks The Xing header is not parsed; this is meant to walk quickly through
+ *          the headers of all frames of a stream.
+ */
+inline MpegAudioFrame::MpegAudioFrame(uint32 header) :
+    m_header(header),
+    m_xingHeader(0),
+    m_xingHeaderFlags(XingHeaderFlags::None),
+    m_xingFramefield(0),
+    m_xingBytesfield(0),
+    m_xingQualityIndicator(0)
+{}
+
 /*!
  * \brief Returns an indication whether the frame is valid.
  */
@@ -111,7 +126,8 @@ inline bool MpegAudioFrame::isProtectedByCrc() const
  */
 inline uint32 MpegAudioFrame::bitrate() const
 {
-    if(mpegVersion() > 0.0 && layer() > 0)
+    // bitrate index 0xF is invalid
+    if(mpegVersion() > 0.0 && layer() > 0 && (m_header & 0xf000u) != 0xf000u)
         return m_bitrateTable[mpegVersion() == 1.0 ? 0 : 1][layer() - 1][(m_header & 0xf000u) >> 12];
     else
         return 0;
@@ -123,7 +139,8 @@ inline uint32 MpegAudioFrame::bitrate() const
 inline uint32 MpegAudioFrame::paddingSize() const
 {
     if(isValid()) {
-        return (m_header & 0x60000u) == 0x60000u ? 4u : 1u * (m_header & 0x200u);
+        // the padding slot is 4 bytes for layer I and 1 byte for layer II and III
+        return (m_header & 0x200u) ? ((m_header & 0x60000u) == 0x60000u ? 4u : 1u) : 0u;
     } else {
         return 0;
     }
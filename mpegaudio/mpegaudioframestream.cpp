@@ -1,8 +1,11 @@
 #include "./mpegaudioframestream.h"
 
 #include "../exceptions.h"
+#include "../framescanner.h"
 #include "../mediaformat.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
+
 #include <sstream>
 
 using namespace std;
@@ -42,6 +45,7 @@ void MpegAudioFrameStream::internalParseHeader()
     } else {
         m_size = static_cast<uint64>(m_istream->tellg()) + 125u - m_startOffset;
     }
+    const uint64 endOffset = m_startOffset + m_size;
     m_istream->seekg(m_startOffset, ios_base::beg);
     // parse frame header
     m_frames.emplace_back();
@@ -59,6 +63,65 @@ void MpegAudioFrameStream::internalParseHeader()
             ? ((static_cast<double>(m_size) * 8.0) / (static_cast<double>(frame.xingFrameCount() * frame.sampleCount()) / static_cast<double>(frame.samplingFrequency())) / 1024.0)
             : frame.bitrate();
     m_duration = TimeSpan::fromSeconds(static_cast<double>(m_size) / (m_bytesPerSecond = m_bitrate * 125));
+    // determine exact values by walking through all frames if enabled
+    if(m_frameScanning) {
+        scanFrames(frame, endOffset);
+    }
+}
+
+/*!
+ * \brief Walks through the headers of all frames until the specified \a endOffset is reached.
+ *
+ * Determines the exact sample count, duration, bitrate and max. bitrate and populates the seek table
+ * (see frameOffsets()). The values determined from the \a firstFrame are kept if no frames could be found.
+ */
+void MpegAudioFrameStream::scanFrames(const MpegAudioFrame &firstFrame, uint64 endOffset)
+{
+    static const string context("scanning MPEG audio frames");
+    m_frameOffsets.clear();
+    if(const uint32 firstFrameSize = firstFrame.size()) {
+        m_frameOffsets.reserve(static_cast<size_t>((endOffset - m_startOffset) / firstFrameSize + 1));
+    }
+    FrameScanner scanner(*m_istream, m_startOffset, endOffset, 0xE0);
+    // the frame containing the Xing header contains no audio data
+    if(firstFrame.isXingHeaderAvailable() && firstFrame.size()) {
+        scanner.advance(firstFrame.size());
+    }
+    uint64 sampleCount = 0, audioSize = 0;
+    uint32 maxBitrate = 0;
+    bool syncLost = false;
+    while(const char *header = scanner.header(4)) {
+        const MpegAudioFrame frame(BE::toUInt32(header));
+        const uint32 frameSize = frame.size();
+        // treat frames not matching the first frame as garbage
+        if(!frame.isValid() || !frameSize || frame.layer() != firstFrame.layer() || frame.samplingFrequency() != firstFrame.samplingFrequency()) {
+            syncLost = true;
+            if(!scanner.resync()) {
+                break;
+            }
+            continue;
+        }
+        m_frameOffsets.push_back(scanner.offset());
+        sampleCount += frame.sampleCount();
+        audioSize += frameSize;
+        if(frame.bitrate() > maxBitrate) {
+            maxBitrate = frame.bitrate();
+        }
+        scanner.advance(frameSize);
+    }
+    if(syncLost) {
+        addNotification(NotificationType::Warning, "Data between MPEG audio frames has been skipped.", context);
+    }
+    if(!sampleCount || !m_samplingFrequency) {
+        addNotification(NotificationType::Critical, "No valid MPEG audio frames found.", context);
+        return;
+    }
+    const double seconds = static_cast<double>(sampleCount) / m_samplingFrequency;
+    m_sampleCount = sampleCount;
+    m_duration = TimeSpan::fromSeconds(seconds);
+    m_bitrate = static_cast<double>(audioSize) * 8.0 / seconds / 1000.0;
+    m_maxBitrate = maxBitrate;
+    m_bytesPerSecond = static_cast<uint32>(static_cast<double>(audioSize) / seconds);
 }
 
 }
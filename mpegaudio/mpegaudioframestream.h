@@ -24,6 +24,8 @@ protected:
     void internalParseHeader();
 
 private:
+    void scanFrames(const MpegAudioFrame &firstFrame, uint64 endOffset);
+
     std::list<MpegAudioFrame> m_frames;
 };
 
@@ -4,12 +4,14 @@
 
 #include "../mediafileinfo.h"
 #include "../backuphelper.h"
+#include "../copyengine.h"
 
 #include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/io/copy.h>
 #include <c++utilities/io/catchiofailure.h>
 
 #include <memory>
+#include <limits>
 
 using namespace std;
 using namespace IoUtilities;
@@ -47,7 +49,8 @@ const char *OggVorbisComment::typeName() const
 OggContainer::OggContainer(MediaFileInfo &fileInfo, uint64 startOffset) :
     GenericContainer<MediaFileInfo, OggVorbisComment, OggStream, OggPage>(fileInfo, startOffset),
     m_iterator(fileInfo.stream(), startOffset, fileInfo.size()),
-    m_validateChecksums(false)
+    m_validateChecksums(false),
+    m_lazyParsing(false)
 {}
 
 OggContainer::~OggContainer()
@@ -185,13 +188,21 @@ void OggContainer::removeAllTags()
 void OggContainer::internalParseHeader()
 {
     static const string context("parsing OGG bitstream header");
+    // decode page headers directly from memory if the file is mapped
+    m_iterator.setMappedData(fileInfo().mappedData(), fileInfo().mappedSize());
     // iterate through pages using OggIterator helper class
     try {
         // ensure iterator is setup properly
         for(m_iterator.removeFilter(), m_iterator.reset(); m_iterator; m_iterator.nextPage()) {
             const OggPage &page = m_iterator.currentPage();
+            if(m_lazyParsing && !page.isFirstpage() && !m_tracks.empty()) {
+                // all beginning of stream pages (which must precede all other pages) have been read
+                // -> further pages are fetched on demand when parsing the streams
+                break;
+            }
             if(m_validateChecksums) {
-                if(page.checksum() != OggPage::computeChecksum(stream(), page.startOffset())) {
+                const char *const pageData = fileInfo().mappedRange(page.startOffset(), page.totalSize());
+                if(page.checksum() != (pageData ? OggPage::computeChecksum(pageData, page.totalSize()) : OggPage::computeChecksum(stream(), page.startOffset()))) {
                     addNotification(NotificationType::Warning, "The denoted checksum of the OGG page at " % ConversionUtilities::numberToString(m_iterator.currentSegmentOffset()) + " does not match the computed checksum.", context);
                 }
             }
@@ -226,22 +237,23 @@ void OggContainer::internalParseTags()
 {
     // tracks needs to be parsed before because tags are stored at stream level
     parseTracks();
+    const TagFieldProjection *projection = fileInfo().tagFieldProjection();
     for(auto &comment : m_tags) {
         OggParameter &params = comment->oggParams();
         m_iterator.setPageIndex(params.firstPageIndex);
         m_iterator.setSegmentIndex(params.firstSegmentIndex);
         switch(params.streamFormat) {
         case GeneralMediaFormat::Vorbis:
-            comment->parse(m_iterator);
+            comment->parse(m_iterator, VorbisCommentFlags::None, projection);
             break;
         case GeneralMediaFormat::Opus:
             // skip header (has already been detected by OggStream)
             m_iterator.ignore(8);
-            comment->parse(m_iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+            comment->parse(m_iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte, projection);
             break;
         case GeneralMediaFormat::Flac:
             m_iterator.ignore(4);
-            comment->parse(m_iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+            comment->parse(m_iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte, projection);
             break;
         default:
             addNotification(NotificationType::Critical, "Stream format not supported.", "parsing tags from OGG streams");
@@ -251,6 +263,58 @@ void OggContainer::internalParseTags()
     }
 }
 
+/*!
+ * \brief Finds the granule position of the last page of the stream with the specified \a streamSerialNumber.
+ *
+ * Scans backwards from the end of the file for the capture pattern "OggS" until a page of the
+ * stream denoting a granule position has been found. Used to determine the duration when parsing lazily.
+ *
+ * \returns Returns whether such a page could be found.
+ */
+bool OggContainer::findLastGranulePosition(uint32 streamSerialNumber, uint64 &granulePosition)
+{
+    static constexpr uint64 blockSize = 0x10000;
+    const uint64 begin = m_iterator.startOffset(), end = m_iterator.streamSize();
+    unique_ptr<char[]> buffer; // allocated on the heap when needed (64 KiB are too much for the stack)
+    for(uint64 blockEnd = end; blockEnd > begin; ) {
+        // read block (overlapping 3 byte with the previous block to find capture patterns crossing the boundary)
+        const uint64 blockStart = blockEnd - begin > blockSize ? blockEnd - blockSize : begin;
+        const auto size = static_cast<size_t>(min(blockEnd + 3, end) - blockStart);
+        const char *block = fileInfo().mappedRange(blockStart, size);
+        if(!block) {
+            if(!buffer) {
+                buffer = make_unique<char[]>(blockSize + 3);
+            }
+            stream().seekg(static_cast<streamoff>(blockStart));
+            stream().read(buffer.get(), static_cast<streamsize>(size));
+            block = buffer.get();
+        }
+        // check pages starting within the block from back to front
+        for(size_t index = size >= 4 ? size - 4 + 1 : 0; index--; ) {
+            if(block[index] != 'O' || block[index + 1] != 'g' || block[index + 2] != 'g' || block[index + 3] != 'S') {
+                continue;
+            }
+            const uint64 pageOffset = blockStart + index;
+            OggPage page;
+            try {
+                if(const char *const pageData = fileInfo().mappedRange(pageOffset, 27)) {
+                    page.parseHeader(pageData, pageOffset, static_cast<int32>(min<uint64>(end - pageOffset, numeric_limits<int32>::max())));
+                } else {
+                    page.parseHeader(stream(), pageOffset, static_cast<int32>(min<uint64>(end - pageOffset, numeric_limits<int32>::max())));
+                }
+            } catch(const Failure &) {
+                continue; // capture pattern appeared within page data
+            }
+            if(page.matchesStreamSerialNumber(streamSerialNumber) && page.absoluteGranulePosition() != static_cast<uint64>(-1)) {
+                granulePosition = page.absoluteGranulePosition();
+                return true;
+            }
+        }
+        blockEnd = blockStart;
+    }
+    return false;
+}
+
 /*!
  * \brief Announces the existence of a Vorbis comment.
  *
@@ -329,9 +393,22 @@ void OggContainer::internalMakeFile()
 {
     const string context("making OGG file");
     updateStatus("Prepare for rewriting OGG file ...");
+    m_iterator.setMappedData(nullptr, 0); // the mapping is released before the file is modified
     parseTags(); // tags need to be parsed before the file can be rewritten
+    if(m_lazyParsing && !m_iterator.areAllPagesFetched()) {
+        // fetch the pages which have been skipped when parsing lazily
+        try {
+            m_iterator.fetchAllPages();
+        } catch(const TruncatedDataException &) {
+            addNotification(NotificationType::Critical, "The OGG file is truncated.", context);
+        } catch(const InvalidDataException &) {
+            addNotification(NotificationType::Critical, "Capture pattern \"OggS\" expected.", context);
+        }
+    }
     string backupPath;
     NativeFileStream backupStream;
+    CopyEngine *const assignedCopyEngine = copyEngine();
+    unique_ptr<FileCopyEngine> fileCopyEngine;
 
     if(fileInfo().saveFilePath().empty()) {
         // move current file to temp dir and reopen it as backupStream, recreate original file
@@ -358,6 +435,12 @@ void OggContainer::internalMakeFile()
         }
     }
 
+    // copy unchanged pages from the backup/original file to the new file within the kernel where possible
+    if(!assignedCopyEngine) {
+        fileCopyEngine = make_unique<FileCopyEngine>(backupPath.empty() ? fileInfo().path() : backupPath, fileInfo().saveFilePath().empty() ? fileInfo().path() : fileInfo().saveFilePath());
+    }
+    CopyEngine &pageCopyEngine = assignedCopyEngine ? *assignedCopyEngine : *fileCopyEngine;
+
     try {
         // prepare iterating comments
         OggVorbisComment *currentComment;
@@ -374,8 +457,21 @@ void OggContainer::internalMakeFile()
         CopyHelper<65307> copyHelper;
         vector<uint64> updatedPageOffsets;
         unordered_map<uint32, uint32> pageSequenceNumberBySerialNo;
+        // -> consecutive pages which are copied unchanged are copied at once
+        uint64 unchangedPagesOffset = 0, unchangedPagesSize = 0;
+        const auto copyUnchangedPages = [&] {
+            if(unchangedPagesSize) {
+                backupStream.seekg(unchangedPagesOffset);
+                pageCopyEngine.copy(backupStream, stream(), unchangedPagesSize);
+                IoCounters::countSeek();
+                IoCounters::countRead(unchangedPagesSize);
+                IoCounters::countWrite(unchangedPagesSize);
+                unchangedPagesSize = 0;
+            }
+        };
 
         // iterate through all pages of the original file
+        MetricsScope writingScope(fileInfo().metrics(), ProcessingPhase::WritingMediaData);
         for(m_iterator.setStream(backupStream), m_iterator.removeFilter(), m_iterator.reset(); m_iterator; m_iterator.nextPage()) {
             const OggPage &currentPage = m_iterator.currentPage();
             const auto pageSize = currentPage.totalSize();
@@ -386,6 +482,7 @@ void OggContainer::internalMakeFile()
                     && m_iterator.currentPageIndex() <= currentParams->lastPageIndex
                     && !currentPage.segmentSizes().empty()) {
                 // page needs to be rewritten (not just copied)
+                copyUnchangedPages();
                 // -> write segments to a buffer first
                 stringstream buffer(ios_base::in | ios_base::out | ios_base::binary);
                 vector<uint32> newSegmentSizes;
@@ -507,6 +604,7 @@ void OggContainer::internalMakeFile()
             } else {
                 if(pageSequenceNumber != m_iterator.currentPageIndex()) {
                     // just update page sequence number
+                    copyUnchangedPages();
                     backupStream.seekg(currentPage.startOffset());
                     updatedPageOffsets.push_back(stream().tellp()); // memorize offset to update checksum later
                     copyHelper.copy(backupStream, stream(), 27);
@@ -515,13 +613,17 @@ void OggContainer::internalMakeFile()
                     stream().seekp(5, ios_base::cur);
                     copyHelper.copy(backupStream, stream(), pageSize - 27);
                 } else {
-                    // copy page unchanged
-                    backupStream.seekg(currentPage.startOffset());
-                    copyHelper.copy(backupStream, stream(), pageSize);
+                    // copy page unchanged (deferred to copy consecutive pages at once)
+                    if(unchangedPagesOffset + unchangedPagesSize != currentPage.startOffset()) {
+                        copyUnchangedPages();
+                        unchangedPagesOffset = currentPage.startOffset();
+                    }
+                    unchangedPagesSize += pageSize;
                 }
                 ++pageSequenceNumber;
             }
         }
+        copyUnchangedPages();
 
         // report new size
         fileInfo().reportSizeChanged(stream().tellp());
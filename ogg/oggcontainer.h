@@ -134,6 +134,8 @@ public:
 
     bool isChecksumValidationEnabled() const;
     void setChecksumValidationEnabled(bool enabled);
+    bool isLazyParsingEnabled() const;
+    void setLazyParsingEnabled(bool enabled);
     void reset();
 
     OggVorbisComment *createTag(const TagTarget &target);
@@ -149,6 +151,7 @@ protected:
     void internalMakeFile();
 
 private:
+    bool findLastGranulePosition(uint32 streamSerialNumber, uint64 &granulePosition);
     void announceComment(std::size_t pageIndex, std::size_t segmentIndex, bool lastMetaDataBlock, GeneralMediaFormat mediaFormat = GeneralMediaFormat::Vorbis);
     void makeVorbisCommentSegment(std::stringstream &buffer, IoUtilities::CopyHelper<65307> &copyHelper, std::vector<uint32> &newSegmentSizes, VorbisComment *comment, OggParameter *params);
 
@@ -156,6 +159,7 @@ private:
 
     OggIterator m_iterator;
     bool m_validateChecksums;
+    bool m_lazyParsing;
 };
 
 /*!
@@ -180,6 +184,34 @@ inline void OggContainer::setChecksumValidationEnabled(bool enabled)
     m_validateChecksums = enabled;
 }
 
+/*!
+ * \brief Returns whether lazy parsing is enabled.
+ *
+ * If lazy parsing is enabled, the parser will only fetch the pages required to read the
+ * identification and comment headers instead of walking through the entire file. The duration
+ * of the streams is determined by scanning backwards from the end of the file for the last page.
+ * Remaining pages are fetched when required to rewrite the file.
+ *
+ * The stream sizes are only approximated in this mode. Checksums of the pages which are
+ * not fetched are not validated.
+ *
+ * \sa setLazyParsingEnabled()
+ */
+inline bool OggContainer::isLazyParsingEnabled() const
+{
+    return m_lazyParsing;
+}
+
+/*!
+ * \brief Sets whether lazy parsing is enabled.
+ * \remarks Must be set before the header is parsed.
+ * \sa isLazyParsingEnabled()
+ */
+inline void OggContainer::setLazyParsingEnabled(bool enabled)
+{
+    m_lazyParsing = enabled;
+}
+
 }
 
 #endif // MEDIA_OGGCONTAINER_H
@@ -1,8 +1,10 @@
 #include "./oggiterator.h"
 
 #include "../exceptions.h"
+#include "../metrics.h"
 
 #include <iostream>
+#include <cstring>
 
 using namespace std;
 
@@ -18,7 +20,7 @@ namespace Media {
  *
  * To go on call the appropriate methods. Parsing exceptions and IO exceptions might occur during iteration.
  *
- * The internal buffer of OGG pages might be accessed using the pages() method.
+ * The headers of the fetched OGG pages are stored in an OggPageTable which might be accessed using the pages() method.
  */
 
 /*!
@@ -28,9 +30,12 @@ namespace Media {
 void OggIterator::clear(istream &stream, uint64 startOffset, uint64 streamSize)
 {
     m_stream = &stream;
+    m_mappedData = nullptr;
+    m_mappedSize = 0;
     m_startOffset = startOffset;
     m_streamSize = streamSize;
     m_pages.clear();
+    m_currentPageIndex = static_cast<size_t>(-1);
 }
 
 /*!
@@ -42,10 +47,9 @@ void OggIterator::clear(istream &stream, uint64 startOffset, uint64 streamSize)
 void OggIterator::reset()
 {
     for(m_page = m_segment =  m_offset = 0; m_page < m_pages.size() || fetchNextPage(); ++m_page) {
-        const OggPage &page = m_pages[m_page];
-        if(!page.segmentSizes().empty() && matchesFilter(page)) {
+        if(m_pages.segmentCount(m_page) && matchesFilter(m_page)) {
             // page is not empty and matches ID filter if set
-            m_offset = page.startOffset() + page.headerSize();
+            m_offset = m_pages.startOffset(m_page) + m_pages.headerSize(m_page);
             break;
         }
     }
@@ -59,11 +63,10 @@ void OggIterator::reset()
 void OggIterator::nextPage()
 {
     while(++m_page < m_pages.size() || fetchNextPage()) {
-        const OggPage &page = m_pages[m_page];
-        if(!page.segmentSizes().empty() && matchesFilter(page)) {
+        if(m_pages.segmentCount(m_page) && matchesFilter(m_page)) {
             // page is not empty and matches ID filter if set
             m_segment = m_bytesRead = 0;
-            m_offset = page.startOffset() + page.headerSize();
+            m_offset = m_pages.startOffset(m_page) + m_pages.headerSize(m_page);
             return;
         }
     }
@@ -76,11 +79,10 @@ void OggIterator::nextPage()
  */
 void OggIterator::nextSegment()
 {
-    const OggPage &page = m_pages[m_page];
-    if(matchesFilter(page) && ++m_segment < page.segmentSizes().size()) {
+    if(matchesFilter(m_page) && ++m_segment < m_pages.segmentCount(m_page)) {
         // current page has next segment
         m_bytesRead = 0;
-        m_offset += page.segmentSizes()[m_segment - 1];
+        m_offset += m_pages.segmentSize(m_page, static_cast<uint32>(m_segment - 1));
     } else {
         // next (matching) page has next segment
         nextPage();
@@ -94,9 +96,8 @@ void OggIterator::nextSegment()
 void OggIterator::previousPage()
 {
     while(m_page) {
-        const OggPage &page = m_pages[--m_page];
-        if(matchesFilter(page)) {
-            m_offset = page.dataOffset(m_segment = page.segmentSizes().size() - 1);
+        if(matchesFilter(--m_page)) {
+            m_offset = m_pages.dataOffset(m_page, static_cast<uint32>(m_segment = m_pages.segmentCount(m_page) - 1));
             return;
         }
     }
@@ -108,9 +109,8 @@ void OggIterator::previousPage()
  */
 void OggIterator::previousSegment()
 {
-    const OggPage &page = m_pages[m_page];
-    if(m_segment && matchesFilter(page)) {
-        m_offset -= page.segmentSizes()[m_segment--];
+    if(m_segment && matchesFilter(m_page)) {
+        m_offset -= m_pages.segmentSize(m_page, static_cast<uint32>(m_segment--));
     } else {
         previousPage();
     }
@@ -132,13 +132,12 @@ void OggIterator::read(char *buffer, size_t count)
     size_t bytesRead = 0;
     while(*this && count) {
         const uint32 available = currentSegmentSize() - m_bytesRead;
-        stream().seekg(currentCharacterOffset());
         if(count <= available) {
-            stream().read(buffer + bytesRead, count);
+            readFromSource(buffer + bytesRead, count);
             m_bytesRead += count;
             return;
         } else {
-            stream().read(buffer + bytesRead, available);
+            readFromSource(buffer + bytesRead, available);
             nextSegment();
             bytesRead += available;
             count -= available;
@@ -165,13 +164,12 @@ size_t OggIterator::readAll(char *buffer, size_t max)
     size_t bytesRead = 0;
     while(*this && max) {
         const uint32 available = currentSegmentSize() - m_bytesRead;
-        stream().seekg(currentCharacterOffset());
         if(max <= available) {
-            stream().read(buffer + bytesRead, max);
+            readFromSource(buffer + bytesRead, max);
             m_bytesRead += max;
             return bytesRead + max;
         } else {
-            stream().read(buffer + bytesRead, available);
+            readFromSource(buffer + bytesRead, available);
             nextSegment();
             bytesRead += available;
             max -= available;
@@ -206,6 +204,43 @@ void OggIterator::ignore(size_t count)
     throw TruncatedDataException();
 }
 
+/*!
+ * \brief Reads \a count bytes at the currentCharacterOffset() into \a buffer.
+ *
+ * Copies the bytes from the mapped memory if available; otherwise reads from stream().
+ */
+void OggIterator::readFromSource(char *buffer, size_t count)
+{
+    const uint64 offset = currentCharacterOffset();
+    if(m_mappedData && offset <= m_mappedSize && count <= m_mappedSize - offset) {
+        memcpy(buffer, m_mappedData + offset, count);
+    } else {
+        stream().seekg(offset);
+        stream().read(buffer, count);
+        IoCounters::countSeek();
+        IoCounters::countRead(count);
+    }
+}
+
+/*!
+ * \brief Fetches all pages which have not been fetched yet.
+ * \remarks The current position of the iterator is not altered.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ * \throws Throws Failure when a parsing error occurs.
+ */
+void OggIterator::fetchAllPages()
+{
+    const auto page = m_page;
+    const auto segment = m_segment;
+    const auto offset = m_offset;
+    const auto bytesRead = m_bytesRead;
+    for(m_page = m_pages.size(); fetchNextPage(); ++m_page);
+    m_page = page;
+    m_segment = segment;
+    m_offset = offset;
+    m_bytesRead = bytesRead;
+}
+
 /*!
  * \brief Fetches the next page.
  *
@@ -219,9 +254,19 @@ void OggIterator::ignore(size_t count)
 bool OggIterator::fetchNextPage()
 {
     if(m_page == m_pages.size()) { // can only fetch the next page if the current page is the last page
-        m_offset = m_pages.empty() ? m_startOffset : m_pages.back().startOffset() + m_pages.back().totalSize();
+        m_offset = m_pages.empty() ? m_startOffset : m_pages.endOffset();
         if(m_offset < m_streamSize) {
-            m_pages.emplace_back(*m_stream, m_offset, static_cast<int32>(m_streamSize - m_offset));
+            const int32 maxSize = static_cast<int32>(m_streamSize - m_offset);
+            // parse the header using the instance returned by currentPage() to avoid allocations
+            m_currentPageIndex = static_cast<size_t>(-1);
+            if(m_mappedData && m_streamSize <= m_mappedSize) {
+                // decode header directly from memory
+                m_currentPage.parseHeader(m_mappedData + m_offset, m_offset, maxSize);
+            } else {
+                m_currentPage.parseHeader(*m_stream, m_offset, maxSize);
+            }
+            m_pages.append(m_currentPage);
+            m_currentPageIndex = m_page;
             return true;
         }
     }
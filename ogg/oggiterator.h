@@ -1,7 +1,7 @@
 #ifndef MEDIA_OGGITERATOR_H
 #define MEDIA_OGGITERATOR_H
 
-#include "./oggpage.h"
+#include "./oggpagetable.h"
 
 #include <iosfwd>
 #include <vector>
@@ -16,6 +16,8 @@ public:
     void clear(std::istream &stream, uint64 startOffset, uint64 streamSize);
     std::istream &stream();
     void setStream(std::istream &stream);
+    const char *mappedData() const;
+    void setMappedData(const char *data, uint64 size);
     uint64 startOffset() const;
     uint64 streamSize() const;
     void reset();
@@ -23,10 +25,11 @@ public:
     void nextSegment();
     void previousPage();
     void previousSegment();
-    const std::vector<OggPage> &pages() const;
+    const OggPageTable &pages() const;
+    OggPage page(std::size_t index) const;
     const OggPage &currentPage() const;
-    std::vector<OggPage>::size_type currentPageIndex() const;
-    void setPageIndex(std::vector<OggPage>::size_type index);
+    std::size_t currentPageIndex() const;
+    void setPageIndex(std::size_t index);
     void setSegmentIndex(std::vector<uint32>::size_type index);
     std::vector<uint32>::size_type currentSegmentIndex() const;
     uint64 currentSegmentOffset() const;
@@ -36,6 +39,7 @@ public:
     void setFilter(uint32 streamSerialId);
     void removeFilter();
     bool areAllPagesFetched() const;
+    void fetchAllPages();
     void read(char *buffer, std::size_t count);
     size_t readAll(char *buffer, std::size_t max);
     void ignore(std::size_t count = 1);
@@ -49,13 +53,18 @@ public:
 
 private:
     bool fetchNextPage();
-    bool matchesFilter(const OggPage &page);
+    void readFromSource(char *buffer, std::size_t count);
+    bool matchesFilter(std::size_t pageIndex) const;
 
     std::istream *m_stream;
+    const char *m_mappedData;
+    uint64 m_mappedSize;
     uint64 m_startOffset;
     uint64 m_streamSize;
-    std::vector<OggPage> m_pages;
-    std::vector<OggPage>::size_type m_page;
+    OggPageTable m_pages;
+    std::size_t m_page;
+    mutable OggPage m_currentPage;
+    mutable std::size_t m_currentPageIndex;
     std::vector<uint32>::size_type m_segment;
     uint64 m_offset;
     uint32 m_bytesRead;
@@ -68,9 +77,12 @@ private:
  */
 inline OggIterator::OggIterator(std::istream &stream, uint64 startOffset, uint64 streamSize) :
     m_stream(&stream),
+    m_mappedData(nullptr),
+    m_mappedSize(0),
     m_startOffset(startOffset),
     m_streamSize(streamSize),
     m_page(0),
+    m_currentPageIndex(static_cast<std::size_t>(-1)),
     m_segment(0),
     m_offset(0),
     m_bytesRead(0),
@@ -98,6 +110,30 @@ inline void OggIterator::setStream(std::istream &stream)
     m_stream = &stream;
 }
 
+/*!
+ * \brief Returns the memory the stream has been mapped to or nullptr if no mapping has been set.
+ * \sa setMappedData()
+ */
+inline const char *OggIterator::mappedData() const
+{
+    return m_mappedData;
+}
+
+/*!
+ * \brief Sets the memory the data of stream() has been mapped to.
+ *
+ * If set, page headers and segment data are read directly from \a data instead of the stream.
+ * The stream is still used for ranges which are not covered by the mapping. Pass nullptr to
+ * remove a previously set mapping.
+ *
+ * \remarks The mapping must reflect the data of stream() and must stay valid as long as it is set.
+ */
+inline void OggIterator::setMappedData(const char *data, uint64 size)
+{
+    m_mappedData = data;
+    m_mappedSize = data ? size : 0;
+}
+
 /*!
  * \brief Returns the start offset (which has been specified when constructing the iterator).
  */
@@ -115,20 +151,39 @@ inline uint64 OggIterator::streamSize() const
 }
 
 /*!
- * \brief Returns a vector of containing the OGG pages that have been fetched yet.
+ * \brief Returns the table of the OGG pages that have been fetched yet.
+ * \remarks Up to version 6.4.0 a std::vector<OggPage> has been returned. Use page() to get
+ *          a page which has been fetched yet as OggPage.
  */
-inline const std::vector<OggPage> &OggIterator::pages() const
+inline const OggPageTable &OggIterator::pages() const
 {
     return m_pages;
 }
 
+/*!
+ * \brief Returns the OGG page with the specified \a index which must have been fetched yet.
+ * \remarks The page is returned by value so it stays valid when the iterator is changed.
+ * \sa pages()
+ */
+inline OggPage OggIterator::page(std::size_t index) const
+{
+    return m_pages.page(index);
+}
+
 /*!
  * \brief Returns the current OGG page.
- * \remarks Calling this method when the iterator is invalid causes undefined behaviour.
+ * \remarks
+ * - Calling this method when the iterator is invalid causes undefined behaviour.
+ * - The returned instance is reused for all pages, so the reference must not be used anymore
+ *   after the current page has been changed (up to version 6.4.0 it remained valid as long as the
+ *   iterator was not cleared). Use page() to get a copy which remains valid.
  */
 inline const OggPage &OggIterator::currentPage() const
 {
-    return m_pages[m_page];
+    if(m_currentPageIndex != m_page) {
+        m_pages.page(m_currentPageIndex = m_page, m_currentPage);
+    }
+    return m_currentPage;
 }
 
 /*!
@@ -143,13 +198,13 @@ inline const OggPage &OggIterator::currentPage() const
  */
 inline OggIterator::operator bool() const
 {
-    return m_page < m_pages.size() && m_segment < m_pages[m_page].segmentSizes().size();
+    return m_page < m_pages.size() && m_segment < m_pages.segmentCount(m_page);
 }
 
 /*!
  * \brief Returns the index of the current page if the iterator is valid; otherwise an undefined index is returned.
  */
-inline std::vector<OggPage>::size_type OggIterator::currentPageIndex() const
+inline std::size_t OggIterator::currentPageIndex() const
 {
     return m_page;
 }
@@ -159,11 +214,10 @@ inline std::vector<OggPage>::size_type OggIterator::currentPageIndex() const
  *
  * This method should never be called with an \a index out of range (which is the defined by the number of fetched pages), since this causes undefined behaviour.
  */
-inline void OggIterator::setPageIndex(std::vector<OggPage>::size_type index)
+inline void OggIterator::setPageIndex(std::size_t index)
 {
-    const OggPage &page = m_pages[m_page = index];
     m_segment = 0;
-    m_offset = page.startOffset() + page.headerSize();
+    m_offset = m_pages.startOffset(m_page = index) + m_pages.headerSize(index);
 }
 
 /*!
@@ -173,8 +227,7 @@ inline void OggIterator::setPageIndex(std::vector<OggPage>::size_type index)
  */
 inline void OggIterator::setSegmentIndex(std::vector<uint32>::size_type index)
 {
-    const OggPage &page = m_pages[m_page];
-    m_offset = page.dataOffset(m_segment = index);
+    m_offset = m_pages.dataOffset(m_page, static_cast<uint32>(m_segment = index));
 }
 
 /*!
@@ -218,7 +271,7 @@ inline uint64 OggIterator::tellg() const
  */
 inline uint32 OggIterator::currentSegmentSize() const
 {
-    return m_pages[m_page].segmentSizes()[m_segment];
+    return m_pages.segmentSize(m_page, static_cast<uint32>(m_segment));
 }
 
 /*!
@@ -248,12 +301,12 @@ inline void OggIterator::removeFilter()
  * \brief Returns an indication whether all pages have been fetched.
  *
  * This means that for each page in the stream in the specified range (stream and range have been specified when
- * constructing the iterator) an OggPage instance has been created and pushed to pages(). This is independend from
+ * constructing the iterator) the page header has been parsed and added to pages(). This is independend from
  * the current iterator position. Fetched pages remain after resetting the iterator.
  */
 inline bool OggIterator::areAllPagesFetched() const
 {
-    return (m_pages.empty() ? m_startOffset : m_pages.back().startOffset() + m_pages.back().totalSize()) >= m_streamSize;
+    return (m_pages.empty() ? m_startOffset : m_pages.endOffset()) >= m_streamSize;
 }
 
 /*!
@@ -303,11 +356,11 @@ inline OggIterator OggIterator::operator--(int)
 }
 
 /*!
- * \brief Returns whether the specified \a page matches the current filter.
+ * \brief Returns whether the page with the specified \a pageIndex matches the current filter.
  */
-inline bool OggIterator::matchesFilter(const OggPage &page)
+inline bool OggIterator::matchesFilter(std::size_t pageIndex) const
 {
-    return !m_hasIdFilter || m_idFilter == page.streamSerialNumber();
+    return !m_hasIdFilter || m_pages.matchesStreamSerialNumber(pageIndex, m_idFilter);
 }
 
 }
@@ -1,10 +1,14 @@
 #include "./oggpage.h"
 
 #include "../exceptions.h"
+#include "../metrics.h"
 
 #include <c++utilities/io/binaryreader.h>
 #include <c++utilities/conversion/binaryconversion.h>
 
+#include <cstring>
+#include <memory>
+
 using namespace std;
 using namespace IoUtilities;
 using namespace ConversionUtilities;
@@ -66,40 +70,155 @@ void OggPage::parseHeader(istream &stream, uint64 startOffset, int32 maxSize)
             throw TruncatedDataException();
         }
     }
+    IoCounters::countElement();
+    IoCounters::countSeek();
+    IoCounters::countRead(27u + m_segmentCount);
+}
+
+/*!
+ * \brief Parses the header from the specified \a buffer which holds the page at the specified \a startOffset.
+ *
+ * This is the same as parseHeader(std::istream &, uint64, int32) but decodes the header directly
+ * from memory, eg. from a memory mapped file.
+ *
+ * \remarks The \a buffer must provide at least \a maxSize bytes or the entire page (whatever is less).
+ * \throws Throws InvalidDataException if the capture pattern is not present.
+ * \throws Throws TruncatedDataException if the header is truncated (according to \a maxSize).
+ */
+void OggPage::parseHeader(const char *buffer, uint64 startOffset, int32 maxSize)
+{
+    if(maxSize < 27) {
+        throw TruncatedDataException();
+    } else {
+        maxSize -= 27;
+    }
+    // read header values
+    if(LE::toUInt32(buffer) != 0x5367674f) {
+        throw InvalidDataException();
+    }
+    m_startOffset = startOffset;
+    m_streamStructureVersion = static_cast<byte>(buffer[4]);
+    m_headerTypeFlag = static_cast<byte>(buffer[5]);
+    m_absoluteGranulePosition = LE::toUInt64(buffer + 6);
+    m_streamSerialNumber = LE::toUInt32(buffer + 14);
+    m_sequenceNumber = LE::toUInt32(buffer + 18);
+    m_checksum = LE::toUInt32(buffer + 22);
+    m_segmentCount = static_cast<byte>(buffer[26]);
+    m_segmentSizes.clear();
+    if(m_segmentCount > 0) {
+        if(maxSize < m_segmentCount) {
+            throw TruncatedDataException();
+        } else {
+            maxSize -= m_segmentCount;
+        }
+        // read segment size tabe
+        const byte *segmentTable = reinterpret_cast<const byte *>(buffer + 27);
+        m_segmentSizes.push_back(0);
+        for(byte i = 0; i < m_segmentCount;) {
+            const byte entry = segmentTable[i];
+            maxSize -= entry;
+            m_segmentSizes.back() += entry;
+            if(++i < m_segmentCount && entry < 0xff) {
+                m_segmentSizes.push_back(0);
+            }
+        }
+        // check whether the maximum size is exceeded
+        if(maxSize < 0) {
+            throw TruncatedDataException();
+        }
+    }
+    IoCounters::countElement();
+}
+
+namespace {
+
+/*!
+ * \brief The Crc32Tables struct holds the lookup tables for the slicing-by-8 CRC-32 computation.
+ *
+ * The first table is BinaryReader::crc32Table (MSB-first, polynomial 0x04C11DB7 as used by OGG).
+ * Table k maps a byte to its CRC contribution when followed by k zero bytes.
+ */
+struct Crc32Tables
+{
+    Crc32Tables();
+    uint32 tables[8][0x100];
+};
+
+Crc32Tables::Crc32Tables()
+{
+    for(uint32 i = 0; i != 0x100; ++i) {
+        tables[0][i] = BinaryReader::crc32Table[i];
+    }
+    for(size_t k = 1; k != 8; ++k) {
+        for(uint32 i = 0; i != 0x100; ++i) {
+            const uint32 previous = tables[k - 1][i];
+            tables[k][i] = (previous << 8) ^ tables[0][previous >> 24];
+        }
+    }
+}
+
+/*!
+ * \brief Continues the CRC-32 computation for the specified \a crc with the specified \a data.
+ * \remarks Processes 8 bytes per iteration; the result is the same as processing each byte
+ *          with BinaryReader::crc32Table.
+ */
+uint32 updateCrc32(uint32 crc, const byte *data, size_t size)
+{
+    static const Crc32Tables crcTables;
+    const auto &t = crcTables.tables;
+    for(; size >= 8; data += 8, size -= 8) {
+        crc ^= BE::toUInt32(reinterpret_cast<const char *>(data));
+        crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xFF] ^ t[5][(crc >> 8) & 0xFF] ^ t[4][crc & 0xFF]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+    }
+    for(; size; ++data, --size) {
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *data];
+    }
+    return crc;
+}
+
 }
 
 /*!
  * \brief Computes the actual checksum of the page read from the specified \a stream
  *        at the specified \a startOffset.
+ * \remarks The whole page is read at once.
  */
 uint32 OggPage::computeChecksum(istream &stream, uint64 startOffset)
 {
+    // read header including segment table
+    char header[27 + 0xFF];
     stream.seekg(startOffset);
-    uint32 crc = 0x0;
-    byte value, segmentTableSize = 0, segmentTableIndex = 0;
-    for(uint32 i = 0, segmentLength = 27; i != segmentLength; ++i) {
-        switch(i) {
-        case 22:
-            // bytes 22, 23, 24, 25 hold denoted checksum and must be set to zero
-            stream.seekg(4, ios_base::cur);
-        case 23: case 24: case 25:
-            value = 0;
-            break;
-        case 26:
-            // byte 26 holds the number of segment sizes
-            segmentLength += (segmentTableSize = (value = stream.get()));
-            break;
-        default:
-            value = stream.get();
-            if(i > 26 && segmentTableIndex < segmentTableSize) {
-                // bytes 27 to (27 + segment size count) hold page size
-                segmentLength += value;
-                ++segmentTableIndex;
-            }
-        }
-        crc = (crc << 8) ^ BinaryReader::crc32Table[((crc >> 24) & 0xFF) ^ value];
+    stream.read(header, 27);
+    const byte segmentTableSize = static_cast<byte>(header[26]);
+    const uint32 headerSize = 27 + segmentTableSize;
+    stream.read(header + 27, segmentTableSize);
+    // read segments into a buffer of the actual page size (allocated on the heap because a page might be up to 65 KiB)
+    uint32 pageSize = headerSize;
+    for(const char *segmentSize = header + 27, *end = segmentSize + segmentTableSize; segmentSize != end; ++segmentSize) {
+        pageSize += static_cast<byte>(*segmentSize);
     }
-    return crc;
+    auto buffer = make_unique<char[]>(pageSize);
+    memcpy(buffer.get(), header, headerSize);
+    stream.read(buffer.get() + headerSize, pageSize - headerSize);
+    return computeChecksum(buffer.get(), pageSize);
+}
+
+/*!
+ * \brief Computes the actual checksum of the page with the specified \a pageSize stored at \a pageData.
+ * \remarks The bytes holding the denoted checksum are treated as zero as required by the specification.
+ */
+uint32 OggPage::computeChecksum(const char *pageData, uint32 pageSize)
+{
+    static const byte zeroChecksum[4] = {0};
+    const auto *data = reinterpret_cast<const byte *>(pageData);
+    if(pageSize < 26) {
+        return updateCrc32(0, data, pageSize);
+    }
+    // bytes 22, 23, 24, 25 hold denoted checksum and must be set to zero
+    uint32 crc = updateCrc32(0, data, 22);
+    crc = updateCrc32(crc, zeroChecksum, sizeof(zeroChecksum));
+    return updateCrc32(crc, data + 26, pageSize - 26);
 }
 
 /*!
@@ -13,12 +13,16 @@ namespace Media {
 
 class TAG_PARSER_EXPORT OggPage
 {
+    friend class OggPageTable;
+
 public:
     OggPage();
     OggPage(std::istream &stream, uint64 startOffset, int32 maxSize);
 
     void parseHeader(std::istream &stream, uint64 startOffset, int32 maxSize);
+    void parseHeader(const char *buffer, uint64 startOffset, int32 maxSize);
     static uint32 computeChecksum(std::istream &stream, uint64 startOffset);
+    static uint32 computeChecksum(const char *pageData, uint32 pageSize);
     static void updateChecksum(std::iostream &stream, uint64 startOffset);
 
     uint64 startOffset() const;
@@ -0,0 +1,106 @@
+#include "./oggpagetable.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace Media {
+
+/*!
+ * \class Media::OggPageTable
+ * \brief The OggPageTable class holds the headers of many OGG pages in a compact way.
+ *
+ * The header fields are stored in separate arrays (one element per page) and the segment sizes
+ * of all pages are stored in one flat array. This avoids a heap allocation per page and keeps
+ * the values accessed when scanning the pages (eg. the stream serial numbers) close together.
+ *
+ * The accessors correspond to the accessors of OggPage. An OggPage instance for a particular
+ * page can be obtained using page().
+ */
+
+/*!
+ * \brief Removes all pages.
+ */
+void OggPageTable::clear()
+{
+    m_startOffsets.clear();
+    m_absoluteGranulePositions.clear();
+    m_streamSerialNumbers.clear();
+    m_sequenceNumbers.clear();
+    m_checksums.clear();
+    m_dataSizes.clear();
+    m_firstSegments.resize(1);
+    m_streamStructureVersions.clear();
+    m_headerTypeFlags.clear();
+    m_segmentTableSizes.clear();
+    m_segmentSizes.clear();
+}
+
+/*!
+ * \brief Appends the specified \a page.
+ */
+void OggPageTable::append(const OggPage &page)
+{
+    m_startOffsets.push_back(page.startOffset());
+    m_absoluteGranulePositions.push_back(page.absoluteGranulePosition());
+    m_streamSerialNumbers.push_back(page.streamSerialNumber());
+    m_sequenceNumbers.push_back(page.sequenceNumber());
+    m_checksums.push_back(page.checksum());
+    m_dataSizes.push_back(page.totalSize() - page.headerSize());
+    m_streamStructureVersions.push_back(page.streamStructureVersion());
+    m_headerTypeFlags.push_back(page.headerTypeFlag());
+    m_segmentTableSizes.push_back(page.segmentTableSize());
+    m_segmentSizes.insert(m_segmentSizes.end(), page.segmentSizes().cbegin(), page.segmentSizes().cend());
+    m_firstSegments.push_back(static_cast<uint32>(m_segmentSizes.size()));
+}
+
+/*!
+ * \brief Returns the page with the specified \a index.
+ * \remarks Use page(size_type, OggPage &) to avoid allocating a new segment size vector for each page.
+ */
+OggPage OggPageTable::page(size_type index) const
+{
+    OggPage result;
+    page(index, result);
+    return result;
+}
+
+/*!
+ * \brief Assigns the values of the page with the specified \a index to the specified \a page.
+ * \remarks The segment size vector of \a page is reused so no allocation is necessary when
+ *          the same instance is used repeatedly.
+ */
+void OggPageTable::page(size_type index, OggPage &page) const
+{
+    page.m_startOffset = m_startOffsets[index];
+    page.m_streamStructureVersion = m_streamStructureVersions[index];
+    page.m_headerTypeFlag = m_headerTypeFlags[index];
+    page.m_absoluteGranulePosition = m_absoluteGranulePositions[index];
+    page.m_streamSerialNumber = m_streamSerialNumbers[index];
+    page.m_sequenceNumber = m_sequenceNumbers[index];
+    page.m_checksum = m_checksums[index];
+    page.m_segmentCount = m_segmentTableSizes[index];
+    page.m_segmentSizes.assign(m_segmentSizes.cbegin() + m_firstSegments[index], m_segmentSizes.cbegin() + m_firstSegments[index + 1]);
+}
+
+/*!
+ * \brief Returns the index of the last page with the specified \a streamSerialNumber or size() if there is no such page.
+ */
+OggPageTable::size_type OggPageTable::findLastPage(uint32 streamSerialNumber) const
+{
+    const auto page = find(m_streamSerialNumbers.crbegin(), m_streamSerialNumbers.crend(), streamSerialNumber);
+    return page != m_streamSerialNumbers.crend() ? static_cast<size_type>(m_streamSerialNumbers.crend() - page - 1) : size();
+}
+
+/*!
+ * \brief Returns the data offset of the segment with the specified \a segmentIndex of the page with the specified \a index.
+ * \sa OggPage::dataOffset()
+ */
+uint64 OggPageTable::dataOffset(size_type index, uint32 segmentIndex) const
+{
+    const auto firstSegment = m_segmentSizes.cbegin() + m_firstSegments[index];
+    return m_startOffsets[index] + headerSize(index) + accumulate(firstSegment, firstSegment + segmentIndex, 0u);
+}
+
+}
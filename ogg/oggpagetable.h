@@ -0,0 +1,214 @@
+#ifndef MEDIA_OGGPAGETABLE_H
+#define MEDIA_OGGPAGETABLE_H
+
+#include "./oggpage.h"
+
+#include <vector>
+
+namespace Media {
+
+class TAG_PARSER_EXPORT OggPageTable
+{
+public:
+    typedef std::vector<uint64>::size_type size_type;
+
+    OggPageTable();
+
+    size_type size() const;
+    bool empty() const;
+    void clear();
+    void append(const OggPage &page);
+    OggPage page(size_type index) const;
+    void page(size_type index, OggPage &page) const;
+    size_type findLastPage(uint32 streamSerialNumber) const;
+
+    uint64 startOffset(size_type index) const;
+    byte streamStructureVersion(size_type index) const;
+    byte headerTypeFlag(size_type index) const;
+    bool isFirstpage(size_type index) const;
+    uint64 absoluteGranulePosition(size_type index) const;
+    uint32 streamSerialNumber(size_type index) const;
+    bool matchesStreamSerialNumber(size_type index, uint32 streamSerialNumber) const;
+    uint32 sequenceNumber(size_type index) const;
+    uint32 checksum(size_type index) const;
+    byte segmentTableSize(size_type index) const;
+    uint32 segmentCount(size_type index) const;
+    uint32 segmentSize(size_type index, uint32 segmentIndex) const;
+    uint32 headerSize(size_type index) const;
+    uint32 totalSize(size_type index) const;
+    uint64 dataOffset(size_type index, uint32 segmentIndex = 0) const;
+    uint64 endOffset() const;
+
+private:
+    std::vector<uint64> m_startOffsets;
+    std::vector<uint64> m_absoluteGranulePositions;
+    std::vector<uint32> m_streamSerialNumbers;
+    std::vector<uint32> m_sequenceNumbers;
+    std::vector<uint32> m_checksums;
+    std::vector<uint32> m_dataSizes;
+    std::vector<uint32> m_firstSegments;
+    std::vector<byte> m_streamStructureVersions;
+    std::vector<byte> m_headerTypeFlags;
+    std::vector<byte> m_segmentTableSizes;
+    std::vector<uint32> m_segmentSizes;
+};
+
+/*!
+ * \brief Constructs a new, empty page table.
+ */
+inline OggPageTable::OggPageTable() :
+    m_firstSegments(1, 0)
+{}
+
+/*!
+ * \brief Returns the number of pages.
+ */
+inline OggPageTable::size_type OggPageTable::size() const
+{
+    return m_startOffsets.size();
+}
+
+/*!
+ * \brief Returns whether there are no pages.
+ */
+inline bool OggPageTable::empty() const
+{
+    return m_startOffsets.empty();
+}
+
+/*!
+ * \brief Returns the start offset of the page with the specified \a index.
+ * \sa OggPage::startOffset()
+ */
+inline uint64 OggPageTable::startOffset(size_type index) const
+{
+    return m_startOffsets[index];
+}
+
+/*!
+ * \brief Returns the stream structure version of the page with the specified \a index.
+ * \sa OggPage::streamStructureVersion()
+ */
+inline byte OggPageTable::streamStructureVersion(size_type index) const
+{
+    return m_streamStructureVersions[index];
+}
+
+/*!
+ * \brief Returns the header type flag of the page with the specified \a index.
+ * \sa OggPage::headerTypeFlag()
+ */
+inline byte OggPageTable::headerTypeFlag(size_type index) const
+{
+    return m_headerTypeFlags[index];
+}
+
+/*!
+ * \brief Returns whether the page with the specified \a index is the first page of the logical bitstream.
+ * \sa OggPage::isFirstpage()
+ */
+inline bool OggPageTable::isFirstpage(size_type index) const
+{
+    return m_headerTypeFlags[index] & 0x02;
+}
+
+/*!
+ * \brief Returns the absolute granule position of the page with the specified \a index.
+ * \sa OggPage::absoluteGranulePosition()
+ */
+inline uint64 OggPageTable::absoluteGranulePosition(size_type index) const
+{
+    return m_absoluteGranulePositions[index];
+}
+
+/*!
+ * \brief Returns the stream serial number of the page with the specified \a index.
+ * \sa OggPage::streamSerialNumber()
+ */
+inline uint32 OggPageTable::streamSerialNumber(size_type index) const
+{
+    return m_streamSerialNumbers[index];
+}
+
+/*!
+ * \brief Returns whether the stream serial number of the page with the specified \a index matches the specified one.
+ */
+inline bool OggPageTable::matchesStreamSerialNumber(size_type index, uint32 streamSerialNumber) const
+{
+    return m_streamSerialNumbers[index] == streamSerialNumber;
+}
+
+/*!
+ * \brief Returns the page sequence number of the page with the specified \a index.
+ * \sa OggPage::sequenceNumber()
+ */
+inline uint32 OggPageTable::sequenceNumber(size_type index) const
+{
+    return m_sequenceNumbers[index];
+}
+
+/*!
+ * \brief Returns the checksum denoted by the header of the page with the specified \a index.
+ * \sa OggPage::checksum()
+ */
+inline uint32 OggPageTable::checksum(size_type index) const
+{
+    return m_checksums[index];
+}
+
+/*!
+ * \brief Returns the size of the segment table of the page with the specified \a index.
+ * \sa OggPage::segmentTableSize()
+ */
+inline byte OggPageTable::segmentTableSize(size_type index) const
+{
+    return m_segmentTableSizes[index];
+}
+
+/*!
+ * \brief Returns the number of segments of the page with the specified \a index.
+ * \sa OggPage::segmentSizes()
+ */
+inline uint32 OggPageTable::segmentCount(size_type index) const
+{
+    return m_firstSegments[index + 1] - m_firstSegments[index];
+}
+
+/*!
+ * \brief Returns the size of the segment with the specified \a segmentIndex of the page with the specified \a index.
+ * \sa OggPage::segmentSizes()
+ */
+inline uint32 OggPageTable::segmentSize(size_type index, uint32 segmentIndex) const
+{
+    return m_segmentSizes[m_firstSegments[index] + segmentIndex];
+}
+
+/*!
+ * \brief Returns the header size of the page with the specified \a index in byte.
+ * \sa OggPage::headerSize()
+ */
+inline uint32 OggPageTable::headerSize(size_type index) const
+{
+    return 27 + m_segmentTableSizes[index];
+}
+
+/*!
+ * \brief Returns the total size of the page with the specified \a index in byte.
+ * \sa OggPage::totalSize()
+ */
+inline uint32 OggPageTable::totalSize(size_type index) const
+{
+    return headerSize(index) + m_dataSizes[index];
+}
+
+/*!
+ * \brief Returns the end offset of the last page or zero if there are no pages.
+ */
+inline uint64 OggPageTable::endOffset() const
+{
+    return empty() ? 0 : m_startOffsets.back() + totalSize(size() - 1);
+}
+
+}
+
+#endif // MEDIA_OGGPAGETABLE_H
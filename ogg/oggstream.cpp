@@ -12,13 +12,13 @@
 #include "../exceptions.h"
 #include "../mediaformat.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/chrono/timespan.h>
 
 #include <iostream>
-#include <functional>
 
 using namespace std;
-using namespace std::placeholders;
+using namespace ConversionUtilities;
 using namespace ChronoUtilities;
 
 namespace Media {
@@ -31,8 +31,8 @@ namespace Media {
 /*!
  * \brief Constructs a new track for the \a stream at the specified \a startOffset.
  */
-OggStream::OggStream(OggContainer &container, vector<OggPage>::size_type startPage) :
-    AbstractTrack(container.stream(), container.m_iterator.pages()[startPage].startOffset()),
+OggStream::OggStream(OggContainer &container, std::size_t startPage) :
+    AbstractTrack(container.stream(), container.m_iterator.pages().startOffset(startPage)),
     m_startPage(startPage),
     m_container(container),
     m_currentSequenceNumber(0)
@@ -50,27 +50,32 @@ void OggStream::internalParseHeader()
 
     // read basic information from first page
     OggIterator &iterator = m_container.m_iterator;
-    const OggPage &firstPage = iterator.pages()[m_startPage];
-    m_version = firstPage.streamStructureVersion();
-    m_id = firstPage.streamSerialNumber();
+    const OggPageTable &pages = iterator.pages();
+    m_version = pages.streamStructureVersion(m_startPage);
+    m_id = pages.streamSerialNumber(m_startPage);
+    const uint64 firstGranulePosition = pages.absoluteGranulePosition(m_startPage);
 
     // ensure iterator is setup properly
-    iterator.setFilter(firstPage.streamSerialNumber());
+    iterator.setFilter(pages.streamSerialNumber(m_startPage));
     iterator.setPageIndex(m_startPage);
 
-    // predicate for finding pages of this stream by its stream serial number
-    const auto pred = bind(&OggPage::matchesStreamSerialNumber, _1, firstPage.streamSerialNumber());
-
     // iterate through segments using OggIterator
-    // -> iterate through ALL segments to calculate the precise stream size (hence the out-commented part in the loop-condition)
-    for(bool hasIdentificationHeader = false, hasCommentHeader = false; iterator /* && (!hasIdentificationHeader && !hasCommentHeader) */; ++iterator) {
+    // -> iterate through ALL segments to calculate the precise stream size unless parsing lazily
+    const bool lazy = m_container.isLazyParsingEnabled();
+    uint64 lastGranulePosition;
+    for(bool hasIdentificationHeader = false, hasCommentHeader = false; iterator && (!lazy || !hasIdentificationHeader || !hasCommentHeader); ++iterator) {
         const uint32 currentSize = iterator.currentSegmentSize();
         m_size += currentSize;
 
         if(currentSize >= 8) {
             // determine stream format
-            inputStream().seekg(iterator.currentSegmentOffset());
-            const uint64 sig = reader().readUInt64BE();
+            uint64 sig;
+            if(const char *const mappedSig = m_container.fileInfo().mappedRange(iterator.currentSegmentOffset(), 8)) {
+                sig = BE::toUInt64(mappedSig);
+            } else {
+                inputStream().seekg(iterator.currentSegmentOffset());
+                sig = reader().readUInt64BE();
+            }
 
             if((sig & 0x00ffffffffffff00u) == 0x00766F7262697300u) {
                 // Vorbis header detected
@@ -105,15 +110,10 @@ void OggStream::internalParseHeader()
                         if(m_bitrate) {
                             m_bitrate = static_cast<double>(m_bitrate) / 1000.0;
                         }
-                        // determine sample count and duration if all pages have been fetched
-                        if(iterator.areAllPagesFetched()) {
-                            const auto &pages = iterator.pages();
-                            const auto firstPage = find_if(pages.cbegin(), pages.cend(), pred);
-                            const auto lastPage = find_if(pages.crbegin(), pages.crend(), pred);
-                            if(firstPage != pages.cend() && lastPage != pages.crend()) {
-                                m_sampleCount = lastPage->absoluteGranulePosition() - firstPage->absoluteGranulePosition();
-                                m_duration = TimeSpan::fromSeconds(static_cast<double>(m_sampleCount) / m_samplingFrequency);
-                            }
+                        // determine sample count and duration if the last page can be found
+                        if(findLastGranulePosition(lastGranulePosition)) {
+                            m_sampleCount = lastGranulePosition - firstGranulePosition;
+                            m_duration = TimeSpan::fromSeconds(static_cast<double>(m_sampleCount) / m_samplingFrequency);
                         }
                         hasIdentificationHeader = true;
                     } else {
@@ -156,21 +156,16 @@ void OggStream::internalParseHeader()
                     m_version = ind.version();
                     m_channelCount = ind.channels();
                     m_samplingFrequency = ind.sampleRate();
-                    // determine sample count and duration if all pages have been fetched
-                    if(iterator.areAllPagesFetched()) {
-                        const auto &pages = iterator.pages();
-                        const auto firstPage = find_if(pages.cbegin(), pages.cend(), pred);
-                        const auto lastPage = find_if(pages.crbegin(), pages.crend(), pred);
-                        if(firstPage != pages.cend() && lastPage != pages.crend()) {
-                            m_sampleCount = lastPage->absoluteGranulePosition() - firstPage->absoluteGranulePosition();
-                            // must apply "pre-skip" here do calculate effective sample count and duration?
-                            if(m_sampleCount > ind.preSkip()) {
-                                m_sampleCount -= ind.preSkip();
-                            } else {
-                                m_sampleCount = 0;
-                            }
-                            m_duration = TimeSpan::fromSeconds(static_cast<double>(m_sampleCount) / m_samplingFrequency);
+                    // determine sample count and duration if the last page can be found
+                    if(findLastGranulePosition(lastGranulePosition)) {
+                        m_sampleCount = lastGranulePosition - firstGranulePosition;
+                        // must apply "pre-skip" here do calculate effective sample count and duration?
+                        if(m_sampleCount > ind.preSkip()) {
+                            m_sampleCount -= ind.preSkip();
+                        } else {
+                            m_sampleCount = 0;
                         }
+                        m_duration = TimeSpan::fromSeconds(static_cast<double>(m_sampleCount) / m_samplingFrequency);
                     }
                     hasIdentificationHeader = true;
                 } else {
@@ -224,13 +219,8 @@ void OggStream::internalParseHeader()
                     m_channelCount = streamInfo.channelCount();
                     m_samplingFrequency = streamInfo.samplingFrequency();
                     m_sampleCount = streamInfo.totalSampleCount();
-                    if(!m_sampleCount && iterator.areAllPagesFetched()) {
-                        const auto &pages = iterator.pages();
-                        const auto firstPage = find_if(pages.cbegin(), pages.cend(), pred);
-                        const auto lastPage = find_if(pages.crbegin(), pages.crend(), pred);
-                        if(firstPage != pages.cend() && lastPage != pages.crend()) {
-                            m_sampleCount = lastPage->absoluteGranulePosition() - firstPage->absoluteGranulePosition();
-                        }
+                    if(!m_sampleCount && findLastGranulePosition(lastGranulePosition)) {
+                        m_sampleCount = lastGranulePosition - firstGranulePosition;
                     }
                     m_duration = TimeSpan::fromSeconds(static_cast<double>(m_sampleCount) / m_samplingFrequency);
                     hasIdentificationHeader = true;
@@ -282,6 +272,18 @@ void OggStream::internalParseHeader()
         // TODO: reduce code duplication
     }
 
+    if(lazy && iterator) {
+        // not all segments have been iterated
+        if(m_container.m_tracks.size() == 1) {
+            // approximate the stream size (including page headers)
+            m_size = iterator.streamSize() - startOffset();
+        } else {
+            // the size of a single stream is unknown if there are multiple (interleaved) streams
+            // note: this also prevents calculating the duration from the size below
+            m_size = 0;
+        }
+    }
+
     if(m_duration.isNull() && m_size && m_bitrate) {
         // calculate duration from stream size and bitrate, assuming 1 % overhead
         m_duration = TimeSpan::fromSeconds(static_cast<double>(m_size) / (m_bitrate * 125.0) * 1.1);
@@ -289,4 +291,27 @@ void OggStream::internalParseHeader()
     m_headerValid = true;
 }
 
+/*!
+ * \brief Determines the granule position of the last page of the stream.
+ *
+ * Uses the pages fetched by the iterator if all pages have been fetched. Otherwise the end of
+ * the file is scanned if lazy parsing is enabled.
+ *
+ * \returns Returns whether the granule position could be determined.
+ */
+bool OggStream::findLastGranulePosition(uint64 &granulePosition)
+{
+    const OggIterator &iterator = m_container.m_iterator;
+    if(iterator.areAllPagesFetched()) {
+        const OggPageTable &pages = iterator.pages();
+        const auto lastPage = pages.findLastPage(static_cast<uint32>(m_id));
+        if(lastPage != pages.size()) {
+            granulePosition = pages.absoluteGranulePosition(lastPage);
+            return true;
+        }
+        return false;
+    }
+    return m_container.isLazyParsingEnabled() && m_container.findLastGranulePosition(static_cast<uint32>(m_id), granulePosition);
+}
+
 }
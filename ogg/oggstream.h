@@ -15,7 +15,7 @@ class TAG_PARSER_EXPORT OggStream : public AbstractTrack
     friend class OggContainer;
 
 public:
-    OggStream(OggContainer &container, std::vector<OggPage>::size_type startPage);
+    OggStream(OggContainer &container, std::size_t startPage);
     ~OggStream();
 
     TrackType type() const;
@@ -25,6 +25,8 @@ protected:
     void internalParseHeader();
 
 private:
+    bool findLastGranulePosition(uint64 &granulePosition);
+
     std::size_t m_startPage;
     OggContainer &m_container;
     uint32 m_currentSequenceNumber;
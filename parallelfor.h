@@ -0,0 +1,67 @@
+#ifndef MEDIA_PARALLELFOR_H
+#define MEDIA_PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace Media {
+
+/*!
+ * \brief Invokes \a function for each index in [0, \a count) using a pool of worker threads.
+ *
+ * The number of workers is limited by the number of hardware threads and \a count. The current
+ * thread is used as the first worker. Indices are handed out one by one so jobs of different
+ * size are balanced across the workers.
+ *
+ * If \a function throws, no further indices are handed out and the first exception is rethrown
+ * after all workers have finished.
+ *
+ * \remarks The \a function must be safe to be called concurrently for different indices.
+ */
+template<typename Function> void parallelFor(std::size_t count, Function function)
+{
+    std::atomic<std::size_t> nextIndex(0);
+    const auto work = [count, &function, &nextIndex] {
+        try {
+            for(std::size_t index; (index = nextIndex++) < count; ) {
+                function(index);
+            }
+        } catch(...) {
+            nextIndex = count;
+            throw;
+        }
+    };
+
+    const std::size_t workerCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), count));
+    std::vector<std::future<void> > workers;
+    workers.reserve(workerCount - 1);
+    for(std::size_t i = 1; i < workerCount; ++i) {
+        workers.emplace_back(std::async(std::launch::async, work));
+    }
+    std::exception_ptr exception;
+    try {
+        work();
+    } catch(...) {
+        exception = std::current_exception();
+    }
+    for(auto &worker : workers) {
+        try {
+            worker.get();
+        } catch(...) {
+            if(!exception) {
+                exception = std::current_exception();
+            }
+        }
+    }
+    if(exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+}
+
+#endif // MEDIA_PARALLELFOR_H
@@ -0,0 +1,816 @@
+#include "./parsecache.h"
+#include "./mediafileinfo.h"
+#include "./abstractchapter.h"
+#include "./abstractattachment.h"
+#include "./exceptions.h"
+
+#include <c++utilities/io/binaryreader.h>
+#include <c++utilities/io/binarywriter.h>
+#include <c++utilities/io/catchiofailure.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#ifdef PLATFORM_UNIX
+# include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace IoUtilities;
+using namespace ChronoUtilities;
+
+namespace Media {
+
+namespace {
+
+/*!
+ * \brief Identifies the format of cache files ("TPPC").
+ */
+constexpr uint32 cacheMagic = 0x54505043;
+
+/*!
+ * \brief The version of the cache format; must be increased when the format changes.
+ * \remarks Caches using another version are discarded when loading.
+ */
+constexpr uint16 cacheVersion = 2;
+
+/*!
+ * \brief The CacheReader class reads cache files ensuring that sizes read from the file do not exceed the file.
+ * \remarks Cache files might be truncated or corrupted so sizes read from the file must be checked before
+ *          allocating memory for the denoted number of bytes or elements.
+ */
+class CacheReader : public BinaryReader
+{
+public:
+    CacheReader(istream *stream, uint64 endOffset);
+
+    size_t readSize(uint64 minElementSize = 1);
+    string readSizePrefixedString();
+
+private:
+    uint64 m_endOffset;
+};
+
+/*!
+ * \brief Constructs a new reader for the specified \a stream which ends at the specified \a endOffset.
+ */
+CacheReader::CacheReader(istream *stream, uint64 endOffset) :
+    BinaryReader(stream),
+    m_endOffset(endOffset)
+{}
+
+/*!
+ * \brief Reads the number of subsequent elements which take at least \a minElementSize bytes each.
+ * \throws Throws TruncatedDataException if the elements would exceed the end of the file.
+ */
+size_t CacheReader::readSize(uint64 minElementSize)
+{
+    const uint64 size = readUInt64LE();
+    const auto offset = static_cast<uint64>(stream()->tellg());
+    if(offset > m_endOffset || size > (m_endOffset - offset) / minElementSize) {
+        throw TruncatedDataException();
+    }
+    return static_cast<size_t>(size);
+}
+
+/*!
+ * \brief Reads a string written using writeSizePrefixedString().
+ * \throws Throws TruncatedDataException if the string would exceed the end of the file.
+ */
+string CacheReader::readSizePrefixedString()
+{
+    return readString(readSize());
+}
+
+void writeSizePrefixedString(BinaryWriter &writer, const string &value)
+{
+    writer.writeUInt64LE(value.size());
+    writer.writeString(value);
+}
+
+/*!
+ * \brief Returns a snapshot of the specified \a chapter and its nested chapters.
+ */
+ChapterSnapshot makeChapterSnapshot(const AbstractChapter &chapter)
+{
+    ChapterSnapshot snapshot;
+    snapshot.id = chapter.id();
+    snapshot.names = chapter.names();
+    snapshot.startTime = chapter.startTime();
+    snapshot.endTime = chapter.endTime();
+    snapshot.tracks = chapter.tracks();
+    snapshot.hidden = chapter.isHidden();
+    snapshot.enabled = chapter.isEnabled();
+    snapshot.nestedChapters.reserve(chapter.nestedChapterCount());
+    for(size_t i = 0, count = chapter.nestedChapterCount(); i < count; ++i) {
+        snapshot.nestedChapters.emplace_back(makeChapterSnapshot(*chapter.nestedChapter(i)));
+    }
+    return snapshot;
+}
+
+void writeIds(BinaryWriter &writer, const vector<uint64> &ids)
+{
+    writer.writeUInt64LE(ids.size());
+    for(uint64 id : ids) {
+        writer.writeUInt64LE(id);
+    }
+}
+
+void readIds(CacheReader &reader, vector<uint64> &ids)
+{
+    ids.resize(reader.readSize(8));
+    for(uint64 &id : ids) {
+        id = reader.readUInt64LE();
+    }
+}
+
+void writeStrings(BinaryWriter &writer, const vector<string> &strings)
+{
+    writer.writeUInt64LE(strings.size());
+    for(const string &string : strings) {
+        writeSizePrefixedString(writer, string);
+    }
+}
+
+void readStrings(CacheReader &reader, vector<string> &strings)
+{
+    strings.resize(reader.readSize(8));
+    for(string &string : strings) {
+        string = reader.readSizePrefixedString();
+    }
+}
+
+void writeTrack(BinaryWriter &writer, const TrackSnapshot &track)
+{
+    writer.writeUInt64LE(track.id);
+    writer.writeUInt32LE(track.trackNumber);
+    writer.writeUInt32LE(static_cast<uint32>(track.type));
+    writer.writeUInt32LE(static_cast<uint32>(track.format.general));
+    writer.writeByte(track.format.sub);
+    writer.writeByte(track.format.extension);
+    writeSizePrefixedString(writer, track.formatId);
+    writer.writeUInt32LE(static_cast<uint32>(track.mediaType));
+    writeSizePrefixedString(writer, track.name);
+    writeSizePrefixedString(writer, track.language);
+    writer.writeInt64LE(track.duration.totalTicks());
+    writer.writeUInt64LE(track.creationTime.totalTicks());
+    writer.writeUInt64LE(track.size);
+    writer.writeFloat64LE(track.bitrate);
+    writer.writeFloat64LE(track.maxBitrate);
+    writer.writeUInt32LE(track.samplingFrequency);
+    writer.writeUInt32LE(track.extensionSamplingFrequency);
+    writer.writeUInt16LE(track.bitsPerSample);
+    writer.writeUInt16LE(track.channelCount);
+    writer.writeByte(track.channelConfig);
+    writer.writeUInt64LE(track.sampleCount);
+    writer.writeUInt32LE(track.pixelSize.width());
+    writer.writeUInt32LE(track.pixelSize.height());
+    writer.writeUInt32LE(track.displaySize.width());
+    writer.writeUInt32LE(track.displaySize.height());
+    writer.writeUInt32LE(track.fps);
+    writer.writeByte(static_cast<byte>((track.enabled ? 0x1 : 0x0) | (track.isDefault ? 0x2 : 0x0) | (track.forced ? 0x4 : 0x0) | (track.encrypted ? 0x8 : 0x0)));
+}
+
+void readTrack(CacheReader &reader, TrackSnapshot &track)
+{
+    track.id = reader.readUInt64LE();
+    track.trackNumber = reader.readUInt32LE();
+    track.type = static_cast<TrackType>(reader.readUInt32LE());
+    track.format.general = static_cast<GeneralMediaFormat>(reader.readUInt32LE());
+    track.format.sub = reader.readByte();
+    track.format.extension = reader.readByte();
+    track.formatId = reader.readSizePrefixedString();
+    track.mediaType = static_cast<MediaType>(reader.readUInt32LE());
+    track.name = reader.readSizePrefixedString();
+    track.language = reader.readSizePrefixedString();
+    track.duration = TimeSpan(reader.readInt64LE());
+    track.creationTime = DateTime(reader.readUInt64LE());
+    track.size = reader.readUInt64LE();
+    track.bitrate = reader.readFloat64LE();
+    track.maxBitrate = reader.readFloat64LE();
+    track.samplingFrequency = reader.readUInt32LE();
+    track.extensionSamplingFrequency = reader.readUInt32LE();
+    track.bitsPerSample = reader.readUInt16LE();
+    track.channelCount = reader.readUInt16LE();
+    track.channelConfig = reader.readByte();
+    track.sampleCount = reader.readUInt64LE();
+    const uint32 pixelWidth = reader.readUInt32LE();
+    track.pixelSize = Size(pixelWidth, reader.readUInt32LE());
+    const uint32 displayWidth = reader.readUInt32LE();
+    track.displaySize = Size(displayWidth, reader.readUInt32LE());
+    track.fps = reader.readUInt32LE();
+    const byte flags = reader.readByte();
+    track.enabled = flags & 0x1;
+    track.isDefault = flags & 0x2;
+    track.forced = flags & 0x4;
+    track.encrypted = flags & 0x8;
+}
+
+void writeTagValue(BinaryWriter &writer, const TagValue &value)
+{
+    writer.writeUInt32LE(static_cast<uint32>(value.type()));
+    writer.writeUInt32LE(static_cast<uint32>(value.dataEncoding()));
+    writer.writeUInt64LE(value.dataSize());
+    writer.write(value.dataPointer(), static_cast<streamsize>(value.dataSize()));
+    writer.writeUInt32LE(static_cast<uint32>(value.descriptionEncoding()));
+    writeSizePrefixedString(writer, value.description());
+    writeSizePrefixedString(writer, value.mimeType());
+    writeSizePrefixedString(writer, value.language());
+    writer.writeBool(value.isLabeledAsReadonly());
+}
+
+void readTagValue(CacheReader &reader, TagValue &value)
+{
+    const auto type = static_cast<TagDataType>(reader.readUInt32LE());
+    const auto encoding = static_cast<TagTextEncoding>(reader.readUInt32LE());
+    const auto dataSize = reader.readSize();
+    auto data = make_unique<char[]>(dataSize);
+    reader.read(data.get(), static_cast<streamsize>(dataSize));
+    value.assignData(move(data), dataSize, type, encoding);
+    const auto descriptionEncoding = static_cast<TagTextEncoding>(reader.readUInt32LE());
+    value.setDescription(reader.readSizePrefixedString(), descriptionEncoding);
+    value.setMimeType(reader.readSizePrefixedString());
+    value.setLanguage(reader.readSizePrefixedString());
+    value.setReadonly(reader.readBool());
+}
+
+void writeTag(BinaryWriter &writer, const TagSnapshot &tag)
+{
+    writer.writeUInt32LE(static_cast<uint32>(tag.type));
+    writeSizePrefixedString(writer, tag.version);
+    writer.writeUInt64LE(tag.target.level());
+    writeSizePrefixedString(writer, tag.target.levelName());
+    writeIds(writer, tag.target.tracks());
+    writeIds(writer, tag.target.chapters());
+    writeIds(writer, tag.target.editions());
+    writeIds(writer, tag.target.attachments());
+    writer.writeUInt64LE(tag.fields.size());
+    for(const auto &field : tag.fields) {
+        writer.writeUInt32LE(static_cast<uint32>(field.first));
+        writeTagValue(writer, field.second);
+    }
+}
+
+void readTag(CacheReader &reader, TagSnapshot &tag)
+{
+    tag.type = static_cast<TagType>(reader.readUInt32LE());
+    tag.version = reader.readSizePrefixedString();
+    tag.target.setLevel(reader.readUInt64LE());
+    tag.target.setLevelName(reader.readSizePrefixedString());
+    readIds(reader, tag.target.tracks());
+    readIds(reader, tag.target.chapters());
+    readIds(reader, tag.target.editions());
+    readIds(reader, tag.target.attachments());
+    tag.fields.resize(reader.readSize(8));
+    for(auto &field : tag.fields) {
+        field.first = static_cast<KnownField>(reader.readUInt32LE());
+        readTagValue(reader, field.second);
+    }
+}
+
+void writeChapter(BinaryWriter &writer, const ChapterSnapshot &chapter)
+{
+    writer.writeUInt64LE(chapter.id);
+    writer.writeUInt64LE(chapter.names.size());
+    for(const LocaleAwareString &name : chapter.names) {
+        writeSizePrefixedString(writer, name);
+        writeStrings(writer, name.languages());
+        writeStrings(writer, name.countries());
+    }
+    writer.writeInt64LE(chapter.startTime.totalTicks());
+    writer.writeInt64LE(chapter.endTime.totalTicks());
+    writeIds(writer, chapter.tracks);
+    writer.writeBool(chapter.hidden);
+    writer.writeBool(chapter.enabled);
+    writer.writeUInt64LE(chapter.nestedChapters.size());
+    for(const ChapterSnapshot &nestedChapter : chapter.nestedChapters) {
+        writeChapter(writer, nestedChapter);
+    }
+}
+
+void readChapter(CacheReader &reader, ChapterSnapshot &chapter)
+{
+    chapter.id = reader.readUInt64LE();
+    chapter.names.resize(reader.readSize(8));
+    for(LocaleAwareString &name : chapter.names) {
+        name.assign(reader.readSizePrefixedString());
+        readStrings(reader, name.languages());
+        readStrings(reader, name.countries());
+    }
+    chapter.startTime = TimeSpan(reader.readInt64LE());
+    chapter.endTime = TimeSpan(reader.readInt64LE());
+    readIds(reader, chapter.tracks);
+    chapter.hidden = reader.readBool();
+    chapter.enabled = reader.readBool();
+    chapter.nestedChapters.resize(reader.readSize(8));
+    for(ChapterSnapshot &nestedChapter : chapter.nestedChapters) {
+        readChapter(reader, nestedChapter);
+    }
+}
+
+void writeAttachment(BinaryWriter &writer, const AttachmentSnapshot &attachment)
+{
+    writer.writeUInt64LE(attachment.id);
+    writeSizePrefixedString(writer, attachment.name);
+    writeSizePrefixedString(writer, attachment.mimeType);
+    writeSizePrefixedString(writer, attachment.description);
+    writer.writeUInt64LE(attachment.dataSize);
+}
+
+void readAttachment(CacheReader &reader, AttachmentSnapshot &attachment)
+{
+    attachment.id = reader.readUInt64LE();
+    attachment.name = reader.readSizePrefixedString();
+    attachment.mimeType = reader.readSizePrefixedString();
+    attachment.description = reader.readSizePrefixedString();
+    attachment.dataSize = reader.readUInt64LE();
+}
+
+void writeSnapshot(BinaryWriter &writer, const MediaFileSnapshot &snapshot)
+{
+    writer.writeUInt32LE(static_cast<uint32>(snapshot.containerFormat));
+    writer.writeInt64LE(snapshot.duration.totalTicks());
+    writer.writeUInt64LE(snapshot.tracks.size());
+    for(const TrackSnapshot &track : snapshot.tracks) {
+        writeTrack(writer, track);
+    }
+    writer.writeUInt64LE(snapshot.tags.size());
+    for(const TagSnapshot &tag : snapshot.tags) {
+        writeTag(writer, tag);
+    }
+    writer.writeUInt64LE(snapshot.chapters.size());
+    for(const ChapterSnapshot &chapter : snapshot.chapters) {
+        writeChapter(writer, chapter);
+    }
+    writer.writeUInt64LE(snapshot.attachments.size());
+    for(const AttachmentSnapshot &attachment : snapshot.attachments) {
+        writeAttachment(writer, attachment);
+    }
+}
+
+void readSnapshot(CacheReader &reader, MediaFileSnapshot &snapshot)
+{
+    snapshot.containerFormat = static_cast<ContainerFormat>(reader.readUInt32LE());
+    snapshot.duration = TimeSpan(reader.readInt64LE());
+    snapshot.tracks.resize(reader.readSize(8));
+    for(TrackSnapshot &track : snapshot.tracks) {
+        readTrack(reader, track);
+    }
+    snapshot.tags.resize(reader.readSize(8));
+    for(TagSnapshot &tag : snapshot.tags) {
+        readTag(reader, tag);
+    }
+    snapshot.chapters.resize(reader.readSize(8));
+    for(ChapterSnapshot &chapter : snapshot.chapters) {
+        readChapter(reader, chapter);
+    }
+    snapshot.attachments.resize(reader.readSize(8));
+    for(AttachmentSnapshot &attachment : snapshot.attachments) {
+        readAttachment(reader, attachment);
+    }
+}
+
+}
+
+/*!
+ * \class Media::TrackSnapshot
+ * \brief The TrackSnapshot class holds the information about a track stored by the ParseCache.
+ * \remarks The members correspond to the accessors of AbstractTrack.
+ */
+
+/*!
+ * \brief Constructs a new, empty track snapshot.
+ */
+TrackSnapshot::TrackSnapshot() :
+    id(0),
+    trackNumber(0),
+    type(TrackType::Unspecified),
+    mediaType(MediaType::Unknown),
+    size(0),
+    bitrate(0.0),
+    maxBitrate(0.0),
+    samplingFrequency(0),
+    extensionSamplingFrequency(0),
+    bitsPerSample(0),
+    channelCount(0),
+    channelConfig(0),
+    sampleCount(0),
+    fps(0),
+    enabled(true),
+    isDefault(false),
+    forced(false),
+    encrypted(false)
+{}
+
+/*!
+ * \class Media::TagSnapshot
+ * \brief The TagSnapshot class holds the fields of a tag stored by the ParseCache.
+ * \remarks Only fields which can be mapped to a KnownField are stored.
+ */
+
+/*!
+ * \brief Returns a snapshot of the specified \a track.
+ * \remarks The header of the \a track should have been parsed before.
+ */
+TrackSnapshot TrackSnapshot::fromTrack(const AbstractTrack &track)
+{
+    TrackSnapshot snapshot;
+    snapshot.id = track.id();
+    snapshot.trackNumber = track.trackNumber();
+    snapshot.type = track.type();
+    snapshot.format = track.format();
+    snapshot.formatId = track.formatId();
+    snapshot.mediaType = track.mediaType();
+    snapshot.name = track.name();
+    snapshot.language = track.language();
+    snapshot.duration = track.duration();
+    snapshot.creationTime = track.creationTime();
+    snapshot.size = track.size();
+    snapshot.bitrate = track.bitrate();
+    snapshot.maxBitrate = track.maxBitrate();
+    snapshot.samplingFrequency = track.samplingFrequency();
+    snapshot.extensionSamplingFrequency = track.extensionSamplingFrequency();
+    snapshot.bitsPerSample = track.bitsPerSample();
+    snapshot.channelCount = track.channelCount();
+    snapshot.channelConfig = track.channelConfig();
+    snapshot.sampleCount = track.sampleCount();
+    snapshot.pixelSize = track.pixelSize();
+    snapshot.displaySize = track.displaySize();
+    snapshot.fps = track.fps();
+    snapshot.enabled = track.isEnabled();
+    snapshot.isDefault = track.isDefault();
+    snapshot.forced = track.isForced();
+    snapshot.encrypted = track.isEncrypted();
+    return snapshot;
+}
+
+/*!
+ * \brief Constructs a new, empty tag snapshot.
+ */
+TagSnapshot::TagSnapshot() :
+    type(TagType::Unspecified)
+{}
+
+/*!
+ * \brief Returns a snapshot of the specified \a tag.
+ */
+TagSnapshot TagSnapshot::fromTag(const Tag &tag)
+{
+    TagSnapshot snapshot;
+    snapshot.type = tag.type();
+    snapshot.version = tag.version();
+    snapshot.target = tag.target();
+    for(KnownField field = firstKnownField; field != KnownField::Invalid; field = nextKnownField(field)) {
+        for(const TagValue *value : tag.values(field)) {
+            snapshot.fields.emplace_back(field, *value);
+        }
+    }
+    return snapshot;
+}
+
+/*!
+ * \class Media::ChapterSnapshot
+ * \brief The ChapterSnapshot class holds the information about a chapter stored by the ParseCache.
+ * \remarks The members correspond to the accessors of AbstractChapter.
+ */
+
+/*!
+ * \brief Constructs a new, empty chapter snapshot.
+ */
+ChapterSnapshot::ChapterSnapshot() :
+    id(0),
+    hidden(false),
+    enabled(true)
+{}
+
+/*!
+ * \class Media::AttachmentSnapshot
+ * \brief The AttachmentSnapshot class holds the descriptor of an attachment stored by the ParseCache.
+ * \remarks The attachment data itself is not stored, only its size.
+ */
+
+/*!
+ * \brief Constructs a new, empty attachment snapshot.
+ */
+AttachmentSnapshot::AttachmentSnapshot() :
+    id(0),
+    dataSize(0)
+{}
+
+/*!
+ * \class Media::MediaFileSnapshot
+ * \brief The MediaFileSnapshot class holds the parsing results of a MediaFileInfo stored by the ParseCache.
+ */
+
+/*!
+ * \brief Constructs a new, empty snapshot.
+ */
+MediaFileSnapshot::MediaFileSnapshot() :
+    containerFormat(ContainerFormat::Unknown)
+{}
+
+/*!
+ * \brief Returns a snapshot of the parsing results of the specified \a fileInfo.
+ * \remarks Only the parsing results which are currently available are considered. Hence
+ *          MediaFileInfo::parseEverything() should be called before.
+ */
+MediaFileSnapshot MediaFileSnapshot::fromFileInfo(const MediaFileInfo &fileInfo)
+{
+    MediaFileSnapshot snapshot;
+    snapshot.containerFormat = fileInfo.containerFormat();
+    snapshot.duration = fileInfo.duration();
+
+    const auto tracks = fileInfo.tracks();
+    snapshot.tracks.reserve(tracks.size());
+    for(const AbstractTrack *track : tracks) {
+        snapshot.tracks.emplace_back(TrackSnapshot::fromTrack(*track));
+    }
+
+    const auto tags = fileInfo.tags();
+    snapshot.tags.reserve(tags.size());
+    for(const Tag *tag : tags) {
+        snapshot.tags.emplace_back(TagSnapshot::fromTag(*tag));
+    }
+
+    const auto chapters = fileInfo.chapters();
+    snapshot.chapters.reserve(chapters.size());
+    for(const AbstractChapter *chapter : chapters) {
+        snapshot.chapters.emplace_back(makeChapterSnapshot(*chapter));
+    }
+
+    const auto attachments = fileInfo.attachments();
+    snapshot.attachments.reserve(attachments.size());
+    for(const AbstractAttachment *attachment : attachments) {
+        snapshot.attachments.emplace_back();
+        AttachmentSnapshot &attachmentSnapshot = snapshot.attachments.back();
+        attachmentSnapshot.id = attachment->id();
+        attachmentSnapshot.name = attachment->name();
+        attachmentSnapshot.mimeType = attachment->mimeType();
+        attachmentSnapshot.description = attachment->description();
+        attachmentSnapshot.dataSize = attachment->data() ? static_cast<uint64>(attachment->data()->size()) : 0;
+    }
+    return snapshot;
+}
+
+/*!
+ * \class Media::ParseCache
+ * \brief The ParseCache class caches the parsing results of media files on disk.
+ *
+ * The cache stores a MediaFileSnapshot for each file. An entry is only considered valid as long
+ * as the identity of the file (device and inode) as well as its size and modification time are
+ * unchanged. So parsing an unchanged file using parse() only requires a stat() call and a lookup.
+ *
+ * The cache is opt-in and is neither loaded nor saved automatically:
+ * \code
+ * ParseCache cache("/path/to/cache");
+ * cache.load();
+ * for(MediaFileInfo &fileInfo : files) {
+ *     const MediaFileSnapshot &snapshot = cache.parse(fileInfo);
+ *     ...
+ * }
+ * if(cache.isModified()) {
+ *     cache.save();
+ * }
+ * \endcode
+ *
+ * \remarks
+ * - Notifications which occurred when parsing a file are not cached.
+ * - File identities are only available under UNIX. On other platforms nothing is cached.
+ * - The cache is not thread-safe.
+ */
+
+/*!
+ * \brief Constructs a new, empty cache using the cache file with the specified \a path.
+ */
+ParseCache::ParseCache(const string &path) :
+    m_path(path),
+    m_modified(false)
+{}
+
+/*!
+ * \brief Loads the entries from the cache file.
+ *
+ * Entries which have been added before are discarded. If the cache file does not exist the cache
+ * is empty afterwards. If the cache file has been created using a different format version or is
+ * truncated or corrupted, all of its entries are discarded and the cache is considered modified so
+ * the file is replaced when calling save().
+ *
+ * \throws Throws InvalidDataException if the file is not a cache file.
+ */
+void ParseCache::load()
+{
+    clear();
+    m_modified = false;
+    ifstream file;
+    file.open(m_path, ios_base::in | ios_base::binary | ios_base::ate);
+    if(!file.is_open()) {
+        return;
+    }
+    CacheReader reader(&file, static_cast<uint64>(file.tellg()));
+    file.seekg(0);
+    uint32 magic = 0;
+    try {
+        file.exceptions(ios_base::failbit | ios_base::badbit);
+        magic = reader.readUInt32LE();
+        if(magic == cacheMagic && reader.readUInt16LE() == cacheVersion) {
+            for(uint64 entryCount = reader.readUInt64LE(); entryCount; --entryCount) {
+                string filePath = reader.readSizePrefixedString();
+                Entry &entry = m_entries[move(filePath)];
+                entry.identity.device = reader.readUInt64LE();
+                entry.identity.inode = reader.readUInt64LE();
+                entry.identity.size = reader.readUInt64LE();
+                entry.identity.modificationTime = reader.readInt64LE();
+                readSnapshot(reader, entry.snapshot);
+            }
+            return;
+        }
+    } catch(const Failure &) {
+        // a size denoted within the file exceeds the file
+    } catch(...) {
+        // the file is truncated or can not be read
+        catchIoFailure();
+    }
+    // discard all entries
+    m_entries.clear();
+    if(magic != cacheMagic) {
+        throw InvalidDataException();
+    }
+    m_modified = true;
+}
+
+/*!
+ * \brief Writes all entries to the cache file.
+ *
+ * The entries are written to a temporary file ("<path>.tmp") which replaces the cache file
+ * afterwards. So the cache file is not left truncated when an error occurs while writing.
+ *
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void ParseCache::save()
+{
+    const string tmpPath(m_path + ".tmp");
+    ofstream file;
+    try {
+        file.exceptions(ios_base::failbit | ios_base::badbit);
+        file.open(tmpPath, ios_base::out | ios_base::trunc | ios_base::binary);
+        BinaryWriter writer(&file);
+        writer.writeUInt32LE(cacheMagic);
+        writer.writeUInt16LE(cacheVersion);
+        writer.writeUInt64LE(m_entries.size());
+        for(const auto &entry : m_entries) {
+            writeSizePrefixedString(writer, entry.first);
+            writer.writeUInt64LE(entry.second.identity.device);
+            writer.writeUInt64LE(entry.second.identity.inode);
+            writer.writeUInt64LE(entry.second.identity.size);
+            writer.writeInt64LE(entry.second.identity.modificationTime);
+            writeSnapshot(writer, entry.second.snapshot);
+        }
+        file.close();
+    } catch(...) {
+        const char *what = catchIoFailure();
+        std::remove(tmpPath.data());
+        throwIoFailure(what);
+    }
+#ifndef PLATFORM_UNIX
+    // rename() does not replace existing files on all platforms
+    std::remove(m_path.data());
+#endif
+    if(std::rename(tmpPath.data(), m_path.data())) {
+        std::remove(tmpPath.data());
+        throwIoFailure("Unable to replace cache file.");
+    }
+    m_modified = false;
+}
+
+/*!
+ * \brief Removes all entries.
+ */
+void ParseCache::clear()
+{
+    if(!m_entries.empty()) {
+        m_entries.clear();
+        m_modified = true;
+    }
+}
+
+/*!
+ * \brief Returns the snapshot for the file with the specified \a filePath or nullptr if there is no valid entry.
+ * \remarks An entry is only considered valid if the file has not been changed since the entry has been stored.
+ */
+const MediaFileSnapshot *ParseCache::find(const string &filePath) const
+{
+    const auto entry = m_entries.find(filePath);
+    FileIdentity identity;
+    return entry != m_entries.cend() && identify(filePath, identity) && entry->second.identity == identity ? &entry->second.snapshot : nullptr;
+}
+
+/*!
+ * \brief Stores the (current) parsing results of the specified \a fileInfo.
+ * \remarks Does nothing if the identity of the file can not be determined.
+ */
+void ParseCache::store(const MediaFileInfo &fileInfo)
+{
+    FileIdentity identity;
+    if(identify(fileInfo.path(), identity)) {
+        store(fileInfo.path(), identity, fileInfo);
+    }
+}
+
+/*!
+ * \brief Removes the entry for the file with the specified \a filePath.
+ */
+void ParseCache::remove(const string &filePath)
+{
+    if(m_entries.erase(filePath)) {
+        m_modified = true;
+    }
+}
+
+/*!
+ * \brief Returns the snapshot for the specified \a fileInfo.
+ *
+ * If there is a valid entry for the file, the snapshot is returned without accessing the file.
+ * Otherwise MediaFileInfo::parseEverything() is called and the results are stored.
+ *
+ * \throws Throws the same exceptions as MediaFileInfo::parseEverything().
+ * \remarks The returned reference is invalidated when the cache is modified.
+ */
+const MediaFileSnapshot &ParseCache::parse(MediaFileInfo &fileInfo)
+{
+    // determine identity before parsing so a file modified meanwhile is not considered as unchanged
+    FileIdentity identity;
+    const bool identified = identify(fileInfo.path(), identity);
+    if(identified) {
+        const auto entry = m_entries.find(fileInfo.path());
+        if(entry != m_entries.cend() && entry->second.identity == identity) {
+            return entry->second.snapshot;
+        }
+    }
+    fileInfo.parseEverything();
+    if(!identified) {
+        // can not cache the results
+        m_uncachedSnapshot = MediaFileSnapshot::fromFileInfo(fileInfo);
+        return m_uncachedSnapshot;
+    }
+    return store(fileInfo.path(), identity, fileInfo);
+}
+
+/*!
+ * \brief Stores the parsing results of the specified \a fileInfo for the file with the specified \a filePath and \a identity.
+ */
+const MediaFileSnapshot &ParseCache::store(const string &filePath, const FileIdentity &identity, const MediaFileInfo &fileInfo)
+{
+    Entry &entry = m_entries[filePath];
+    entry.identity = identity;
+    entry.snapshot = MediaFileSnapshot::fromFileInfo(fileInfo);
+    m_modified = true;
+    return entry.snapshot;
+}
+
+/*!
+ * \brief Determines the \a identity of the file with the specified \a filePath.
+ * \returns Returns whether the identity could be determined.
+ */
+bool ParseCache::identify(const string &filePath, FileIdentity &identity)
+{
+#ifdef PLATFORM_UNIX
+    struct stat fileStat;
+    if(stat(filePath.data(), &fileStat)) {
+        return false;
+    }
+    identity.device = static_cast<uint64>(fileStat.st_dev);
+    identity.inode = static_cast<uint64>(fileStat.st_ino);
+    identity.size = static_cast<uint64>(fileStat.st_size);
+# ifdef PLATFORM_LINUX
+    identity.modificationTime = static_cast<int64>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+# else
+    identity.modificationTime = static_cast<int64>(fileStat.st_mtime) * 1000000000;
+# endif
+    return true;
+#else
+    VAR_UNUSED(filePath)
+    VAR_UNUSED(identity)
+    return false;
+#endif
+}
+
+/*!
+ * \brief Constructs an invalid identity.
+ */
+ParseCache::FileIdentity::FileIdentity() :
+    device(0),
+    inode(0),
+    size(0),
+    modificationTime(0)
+{}
+
+/*!
+ * \brief Returns whether the identity equals the \a other identity.
+ */
+bool ParseCache::FileIdentity::operator==(const FileIdentity &other) const
+{
+    return device == other.device && inode == other.inode && size == other.size && modificationTime == other.modificationTime;
+}
+
+}
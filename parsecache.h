@@ -0,0 +1,187 @@
+#ifndef MEDIA_PARSECACHE_H
+#define MEDIA_PARSECACHE_H
+
+#include "./signature.h"
+#include "./mediaformat.h"
+#include "./abstracttrack.h"
+#include "./localeawarestring.h"
+#include "./tag.h"
+
+#include <c++utilities/chrono/timespan.h>
+#include <c++utilities/chrono/datetime.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace Media {
+
+class MediaFileInfo;
+class AbstractChapter;
+
+class TAG_PARSER_EXPORT TrackSnapshot
+{
+public:
+    TrackSnapshot();
+    static TrackSnapshot fromTrack(const AbstractTrack &track);
+
+    uint64 id;
+    uint32 trackNumber;
+    TrackType type;
+    MediaFormat format;
+    std::string formatId;
+    MediaType mediaType;
+    std::string name;
+    std::string language;
+    ChronoUtilities::TimeSpan duration;
+    ChronoUtilities::DateTime creationTime;
+    uint64 size;
+    double bitrate;
+    double maxBitrate;
+    uint32 samplingFrequency;
+    uint32 extensionSamplingFrequency;
+    uint16 bitsPerSample;
+    uint16 channelCount;
+    byte channelConfig;
+    uint64 sampleCount;
+    Size pixelSize;
+    Size displaySize;
+    uint32 fps;
+    bool enabled;
+    bool isDefault;
+    bool forced;
+    bool encrypted;
+};
+
+class TAG_PARSER_EXPORT TagSnapshot
+{
+public:
+    TagSnapshot();
+    static TagSnapshot fromTag(const Tag &tag);
+
+    TagType type;
+    std::string version;
+    TagTarget target;
+    std::vector<std::pair<KnownField, TagValue> > fields;
+};
+
+class TAG_PARSER_EXPORT ChapterSnapshot
+{
+public:
+    ChapterSnapshot();
+
+    uint64 id;
+    std::vector<LocaleAwareString> names;
+    ChronoUtilities::TimeSpan startTime;
+    ChronoUtilities::TimeSpan endTime;
+    std::vector<uint64> tracks;
+    bool hidden;
+    bool enabled;
+    std::vector<ChapterSnapshot> nestedChapters;
+};
+
+class TAG_PARSER_EXPORT AttachmentSnapshot
+{
+public:
+    AttachmentSnapshot();
+
+    uint64 id;
+    std::string name;
+    std::string mimeType;
+    std::string description;
+    uint64 dataSize;
+};
+
+class TAG_PARSER_EXPORT MediaFileSnapshot
+{
+public:
+    MediaFileSnapshot();
+    static MediaFileSnapshot fromFileInfo(const MediaFileInfo &fileInfo);
+
+    ContainerFormat containerFormat;
+    ChronoUtilities::TimeSpan duration;
+    std::vector<TrackSnapshot> tracks;
+    std::vector<TagSnapshot> tags;
+    std::vector<ChapterSnapshot> chapters;
+    std::vector<AttachmentSnapshot> attachments;
+};
+
+class TAG_PARSER_EXPORT ParseCache
+{
+public:
+    ParseCache(const std::string &path = std::string());
+
+    const std::string &path() const;
+    void setPath(const std::string &path);
+    bool isModified() const;
+    std::size_t size() const;
+    void load();
+    void save();
+    void clear();
+    const MediaFileSnapshot *find(const std::string &filePath) const;
+    void store(const MediaFileInfo &fileInfo);
+    void remove(const std::string &filePath);
+    const MediaFileSnapshot &parse(MediaFileInfo &fileInfo);
+
+private:
+    struct FileIdentity
+    {
+        FileIdentity();
+        bool operator==(const FileIdentity &other) const;
+
+        uint64 device;
+        uint64 inode;
+        uint64 size;
+        int64 modificationTime;
+    };
+    struct Entry
+    {
+        FileIdentity identity;
+        MediaFileSnapshot snapshot;
+    };
+
+    static bool identify(const std::string &filePath, FileIdentity &identity);
+    const MediaFileSnapshot &store(const std::string &filePath, const FileIdentity &identity, const MediaFileInfo &fileInfo);
+
+    std::string m_path;
+    std::unordered_map<std::string, Entry> m_entries;
+    MediaFileSnapshot m_uncachedSnapshot;
+    bool m_modified;
+};
+
+/*!
+ * \brief Returns the path of the cache file.
+ */
+inline const std::string &ParseCache::path() const
+{
+    return m_path;
+}
+
+/*!
+ * \brief Sets the path of the cache file.
+ * \remarks The cache is not loaded or saved automatically. Use load() and save().
+ */
+inline void ParseCache::setPath(const std::string &path)
+{
+    m_path = path;
+}
+
+/*!
+ * \brief Returns whether entries have been added or removed since the cache has been loaded or saved.
+ */
+inline bool ParseCache::isModified() const
+{
+    return m_modified;
+}
+
+/*!
+ * \brief Returns the number of cached files.
+ */
+inline std::size_t ParseCache::size() const
+{
+    return m_entries.size();
+}
+
+}
+
+#endif // MEDIA_PARSECACHE_H
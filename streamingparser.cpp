@@ -0,0 +1,833 @@
+#include "./streamingparser.h"
+#include "./mediafileinfo.h"
+#include "./exceptions.h"
+#include "./signature.h"
+
+#include "./id3/id3v2tag.h"
+#include "./mpegaudio/mpegaudioframe.h"
+#include "./flac/flacmetadata.h"
+#include "./flac/flactooggmappingheader.h"
+#include "./ogg/oggiterator.h"
+#include "./ogg/oggpage.h"
+#include "./vorbis/vorbiscomment.h"
+#include "./vorbis/vorbiscommentfield.h"
+#include "./vorbis/vorbisidentificationheader.h"
+#include "./vorbis/vorbispackagetypes.h"
+#include "./opus/opusidentificationheader.h"
+#include "./matroska/ebmlelement.h"
+#include "./matroska/ebmlid.h"
+#include "./matroska/matroskaid.h"
+#include "./matroska/matroskacontainer.h"
+#include "./matroska/matroskaseekinfo.h"
+#include "./matroska/matroskatag.h"
+#include "./matroska/matroskatrack.h"
+
+#include <c++utilities/conversion/binaryconversion.h>
+#include <c++utilities/conversion/stringconversion.h>
+#include <c++utilities/conversion/stringbuilder.h>
+#include <c++utilities/io/binaryreader.h>
+#include <c++utilities/io/catchiofailure.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+using namespace std;
+using namespace IoUtilities;
+using namespace ConversionUtilities;
+using namespace ChronoUtilities;
+
+namespace Media {
+
+namespace {
+
+/*!
+ * \brief The number of bytes which are read ahead to parse the header of the first MPEG audio frame.
+ * \remarks Must be sufficient to cover the Xing header.
+ */
+constexpr size_t mpegAudioProbeSize = 0x400;
+
+/*!
+ * \brief Returns a stream for parsing the specified \a data using the regular (seeking) parsers.
+ */
+unique_ptr<stringstream> makeBufferStream(const string &data)
+{
+    auto stream = make_unique<stringstream>(ios_base::in | ios_base::out | ios_base::binary);
+    stream->exceptions(ios_base::failbit | ios_base::badbit);
+    stream->str(data);
+    return stream;
+}
+
+}
+
+/*!
+ * \class Media::StreamingParser
+ * \brief The StreamingParser class extracts tags and track information from a stream which is read
+ *        forward-only (eg. a pipe or a socket).
+ *
+ * In contrast to MediaFileInfo the input stream is never seeked, not even to determine its size.
+ * Instead, only the metadata located at the front of the stream is read and buffered so it can be
+ * parsed using the regular parsers (Id3v2Tag, VorbisComment, MatroskaTag, ...). The media data
+ * itself is not read.
+ *
+ * The following formats are supported:
+ * - MP3 (and other MPEG-1 audio layers) with ID3v2 tags
+ * - FLAC
+ * - OGG (Vorbis, Opus, FLAC and Theora streams)
+ * - Matroska/WebM if the relevant elements are placed in front of the first "Cluster"-element
+ *
+ * Information which requires data from the end of the file can not be determined. The affected
+ * values are left zero and denoted by unavailableInformation().
+ */
+
+/*!
+ * \brief Constructs a new parser reading from the specified \a input.
+ * \remarks The \a input is not read until parse() is called.
+ */
+StreamingParser::StreamingParser(istream &input) :
+    m_input(&input),
+    m_lookaheadOffset(0),
+    m_bytesRead(0),
+    m_maxMetadataSize(defaultMaxMetadataSize),
+    m_containerFormat(ContainerFormat::Unknown),
+    m_unavailableInformation(UnavailableInformation::None)
+{}
+
+/*!
+ * \brief Destroys the parser.
+ */
+StreamingParser::~StreamingParser()
+{}
+
+/*!
+ * \brief Parses the metadata at the front of the input stream in one pass.
+ *
+ * The input stream is read up to the beginning of the media data. Since the stream can
+ * not be rewound, this method should be called only once.
+ *
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ * \throws Throws Media::Failure or a derived exception when a parsing
+ *         error occurs. Media::NotImplementedException is thrown when the
+ *         format is not supported in streaming mode.
+ */
+void StreamingParser::parse()
+{
+    static const string context("parsing stream");
+    // an ID3v1 tag would be located at the end of the file
+    markUnavailable(UnavailableInformation::Id3v1Tag);
+    for(uint64 paddingSize = 0; ; ) {
+        size_t available = fill(16);
+
+        // skip zero bytes/padding
+        size_t bytesSkipped = 0;
+        for(const char *data = peek(); bytesSkipped < available && !data[bytesSkipped]; ++bytesSkipped);
+        if(bytesSkipped >= 4) {
+            consume(bytesSkipped);
+            // give up after 0x100 bytes
+            if((paddingSize += bytesSkipped) >= 0x100u) {
+                m_containerFormat = ContainerFormat::Unknown;
+                addNotification(NotificationType::Critical, "Too many zero-bytes at the beginning of the stream.", context);
+                throw NotImplementedException();
+            }
+            continue;
+        }
+        if(!available) {
+            if(m_tags.empty()) {
+                addNotification(NotificationType::Critical, "The stream is empty.", context);
+                throw NoDataFoundException();
+            }
+            // the stream consists of ID3v2 tags only
+            return;
+        }
+
+        // parse signature
+        switch(m_containerFormat = parseSignature(peek(), static_cast<int>(available))) {
+        case ContainerFormat::Id2v2Tag:
+            parseId3v2Tag();
+            continue;
+        case ContainerFormat::MpegAudioFrames:
+            parseMpegAudioFrames();
+            break;
+        case ContainerFormat::Flac:
+            parseFlac();
+            break;
+        case ContainerFormat::Ogg:
+            parseOgg();
+            break;
+        case ContainerFormat::Ebml:
+            parseMatroska();
+            break;
+        default:
+            addNotification(NotificationType::Critical, "The container format is not supported when parsing a stream forward-only.", context);
+            throw NotImplementedException();
+        }
+        return;
+    }
+}
+
+/*!
+ * \brief Returns a snapshot of the parsing results.
+ * \remarks The snapshot is compatible with the ParseCache; chapters and attachments are never present.
+ */
+MediaFileSnapshot StreamingParser::snapshot() const
+{
+    MediaFileSnapshot snapshot;
+    snapshot.containerFormat = m_containerFormat;
+    snapshot.duration = m_duration;
+    snapshot.tracks = m_tracks;
+    snapshot.tags.reserve(m_tags.size());
+    for(const auto &tag : m_tags) {
+        snapshot.tags.emplace_back(TagSnapshot::fromTag(*tag));
+    }
+    return snapshot;
+}
+
+/*!
+ * \brief Ensures at least \a count bytes are buffered if possible.
+ * \returns Returns the number of buffered bytes which might be less than \a count if the end of the stream has been reached.
+ */
+size_t StreamingParser::fill(size_t count)
+{
+    size_t available = m_lookahead.size() - m_lookaheadOffset;
+    if(available < count) {
+        m_lookahead.erase(0, m_lookaheadOffset);
+        m_lookaheadOffset = 0;
+        m_lookahead.resize(count);
+        m_input->read(&m_lookahead[available], static_cast<streamsize>(count - available));
+        available += static_cast<size_t>(m_input->gcount());
+        m_lookahead.resize(available);
+    }
+    return available;
+}
+
+/*!
+ * \brief Returns the buffered bytes.
+ * \remarks Use fill() to ensure the required number of bytes is buffered.
+ */
+const char *StreamingParser::peek() const
+{
+    return m_lookahead.data() + m_lookaheadOffset;
+}
+
+/*!
+ * \brief Consumes \a count buffered bytes.
+ */
+void StreamingParser::consume(size_t count)
+{
+    m_lookaheadOffset += count;
+    m_bytesRead += count;
+}
+
+/*!
+ * \brief Reads \a count bytes from the stream and appends them to the specified \a buffer.
+ * \throws Throws Media::TruncatedDataException if the end of the stream has been reached before.
+ */
+void StreamingParser::read(string &buffer, uint64 count)
+{
+    const size_t buffered = min(static_cast<size_t>(count), m_lookahead.size() - m_lookaheadOffset);
+    buffer.append(peek(), buffered);
+    consume(buffered);
+    if((count -= buffered)) {
+        const size_t bufferSize = buffer.size();
+        buffer.resize(bufferSize + static_cast<size_t>(count));
+        m_input->read(&buffer[bufferSize], static_cast<streamsize>(count));
+        const auto bytesRead = static_cast<uint64>(m_input->gcount());
+        m_bytesRead += bytesRead;
+        if(bytesRead < count) {
+            buffer.resize(bufferSize + static_cast<size_t>(bytesRead));
+            throw TruncatedDataException();
+        }
+    }
+}
+
+/*!
+ * \brief Skips \a count bytes.
+ * \throws Throws Media::TruncatedDataException if the end of the stream has been reached before.
+ */
+void StreamingParser::skip(uint64 count)
+{
+    const size_t buffered = min(static_cast<size_t>(count), m_lookahead.size() - m_lookaheadOffset);
+    consume(buffered);
+    for(count -= buffered; count; ) {
+        const auto chunkSize = static_cast<streamsize>(min<uint64>(count, static_cast<uint64>(numeric_limits<streamsize>::max())));
+        m_input->ignore(chunkSize);
+        const auto bytesSkipped = static_cast<uint64>(m_input->gcount());
+        m_bytesRead += bytesSkipped;
+        if(bytesSkipped < static_cast<uint64>(chunkSize)) {
+            throw TruncatedDataException();
+        }
+        count -= bytesSkipped;
+    }
+}
+
+/*!
+ * \brief Reads the ID and the size denotation of an EBML element and appends the header to the specified \a buffer.
+ * \returns Returns false if the end of the stream has been reached; otherwise true.
+ * \throws Throws Media::InvalidDataException if the header is invalid.
+ */
+bool StreamingParser::readEbmlElementHeader(string &buffer, uint32 &id, uint64 &dataSize, bool &unknownSize)
+{
+    const size_t available = fill(EbmlElement::maximumIdLengthSupported() + EbmlElement::maximumSizeLengthSupported());
+    if(!available) {
+        return false;
+    }
+    const byte *const header = reinterpret_cast<const byte *>(peek());
+    // determine length of ID
+    byte idLength = 1;
+    for(byte mask = 0x80; idLength <= EbmlElement::maximumIdLengthSupported() && !(header[0] & mask); ++idLength, mask >>= 1);
+    if(idLength > EbmlElement::maximumIdLengthSupported() || idLength >= available) {
+        throw InvalidDataException();
+    }
+    id = 0;
+    for(byte i = 0; i < idLength; ++i) {
+        id = (id << 8) | header[i];
+    }
+    // determine length of size denotation
+    byte sizeLength = 1;
+    for(byte mask = 0x80; sizeLength <= EbmlElement::maximumSizeLengthSupported() && !(header[idLength] & mask); ++sizeLength, mask >>= 1);
+    if(sizeLength > EbmlElement::maximumSizeLengthSupported() || idLength + sizeLength > available) {
+        throw InvalidDataException();
+    }
+    dataSize = header[idLength] & (0xFF >> sizeLength);
+    unknownSize = dataSize == static_cast<uint64>(0xFF >> sizeLength);
+    for(byte i = 1; i < sizeLength; ++i) {
+        dataSize = (dataSize << 8) | header[idLength + i];
+        unknownSize &= header[idLength + i] == 0xFF;
+    }
+    buffer.append(peek(), idLength + sizeLength);
+    consume(idLength + sizeLength);
+    return true;
+}
+
+/*!
+ * \brief Parses an ID3v2 tag.
+ */
+void StreamingParser::parseId3v2Tag()
+{
+    static const string context("parsing ID3v2 tag");
+    if(fill(10) < 10) {
+        addNotification(NotificationType::Critical, "ID3v2 header is truncated.", context);
+        throw TruncatedDataException();
+    }
+    uint64 size = toNormalInt(BE::toUInt32(peek() + 6)) + 10;
+    if(peek()[5] & 0x10) {
+        // footer present
+        size += 10;
+    }
+    if(size > m_maxMetadataSize) {
+        addNotification(NotificationType::Critical, "ID3v2 tag exceeds the maximum metadata size and will be skipped.", context);
+        skip(size);
+        return;
+    }
+    string data;
+    read(data, size);
+    const auto buffer = makeBufferStream(data);
+    auto tag = make_unique<Id3v2Tag>();
+    try {
+        tag->parse(*buffer, size);
+    } catch(const NoDataFoundException &) {
+        return;
+    } catch(const Failure &) {
+        addNotification(NotificationType::Critical, "Unable to parse ID3v2 tag.", context);
+    } catch(...) {
+        catchIoFailure();
+        addNotification(NotificationType::Critical, "ID3v2 tag is truncated.", context);
+    }
+    m_tags.emplace_back(move(tag));
+}
+
+/*!
+ * \brief Parses the header of the first MPEG audio frame.
+ */
+void StreamingParser::parseMpegAudioFrames()
+{
+    static const string context("parsing MPEG audio frame header");
+    // the frame is only read ahead; it is not required to consume the media data
+    const auto available = fill(mpegAudioProbeSize); // might move the look-ahead buffer so call before peek()
+    const auto buffer = makeBufferStream(string(peek(), available));
+    BinaryReader reader(buffer.get());
+    MpegAudioFrame frame;
+    try {
+        frame.parseHeader(reader);
+    } catch(const Failure &) {
+        addNotification(NotificationType::Critical, "Unable to parse MPEG audio frame header.", context);
+        throw;
+    } catch(...) {
+        catchIoFailure();
+        if(!frame.isValid()) {
+            addNotification(NotificationType::Critical, "MPEG audio frame header is truncated.", context);
+            throw TruncatedDataException();
+        }
+        // the stream is too short to contain a Xing header
+    }
+
+    m_tracks.emplace_back();
+    TrackSnapshot &track = m_tracks.back();
+    track.type = TrackType::MpegAudioFrameStream;
+    track.format = MediaFormat(GeneralMediaFormat::Mpeg1Audio, frame.layer());
+    track.mediaType = MediaType::Audio;
+    track.channelCount = frame.channelMode() == MpegChannelMode::SingleChannel ? 1 : 2;
+    track.channelConfig = static_cast<byte>(frame.channelMode());
+    track.samplingFrequency = frame.samplingFrequency();
+
+    // the duration and the size can only be determined using the Xing header
+    if(frame.isXingFramefieldPresent() && frame.samplingFrequency()) {
+        track.sampleCount = static_cast<uint64>(frame.xingFrameCount()) * frame.sampleCount();
+        track.duration = TimeSpan::fromSeconds(static_cast<double>(track.sampleCount) / frame.samplingFrequency());
+    } else {
+        markUnavailable(UnavailableInformation::Duration | UnavailableInformation::SampleCount);
+    }
+    if(frame.isXingBytesfieldPresent()) {
+        track.size = frame.xingBytesfield();
+    } else {
+        markUnavailable(UnavailableInformation::Size);
+    }
+    if(track.size && !track.duration.isNull()) {
+        track.bitrate = static_cast<double>(track.size) * 8.0 / track.duration.totalSeconds() / 1024.0;
+    } else {
+        // assume constant bitrate
+        track.bitrate = frame.bitrate();
+        markUnavailable(UnavailableInformation::Bitrate);
+    }
+    m_duration = track.duration;
+}
+
+/*!
+ * \brief Parses the meta data blocks of a raw FLAC stream.
+ */
+void StreamingParser::parseFlac()
+{
+    static const string context("parsing raw FLAC header");
+    // skip signature (already checked by parseSignature())
+    consume(4);
+
+    m_tracks.emplace_back();
+    TrackSnapshot &track = m_tracks.back();
+    track.type = TrackType::FlacStream;
+    track.format = GeneralMediaFormat::Flac;
+    track.mediaType = MediaType::Audio;
+    unique_ptr<VorbisComment> vorbisComment;
+
+    for(FlacMetaDataBlockHeader header; !header.isLast(); ) {
+        // parse block header
+        if(fill(4) < 4) {
+            addNotification(NotificationType::Critical, "Meta data block header is truncated.", context);
+            throw TruncatedDataException();
+        }
+        header.parseHeader(peek());
+        consume(4);
+
+        // skip irrelevant and oversized blocks
+        switch(static_cast<FlacMetaDataBlockType>(header.type())) {
+        case FlacMetaDataBlockType::StreamInfo:
+        case FlacMetaDataBlockType::VorbisComment:
+        case FlacMetaDataBlockType::Picture:
+            if(header.dataSize() <= m_maxMetadataSize) {
+                break;
+            }
+            addNotification(NotificationType::Critical, "Meta data block exceeds the maximum metadata size and will be skipped.", context);
+            FALLTHROUGH;
+        default:
+            skip(header.dataSize());
+            continue;
+        }
+
+        // parse relevant meta data
+        string data;
+        read(data, header.dataSize());
+        switch(static_cast<FlacMetaDataBlockType>(header.type())) {
+        case FlacMetaDataBlockType::StreamInfo:
+            if(data.size() >= 0x22) {
+                FlacMetaDataBlockStreamInfo streamInfo;
+                streamInfo.parse(data.data());
+                track.channelCount = streamInfo.channelCount();
+                track.samplingFrequency = streamInfo.samplingFrequency();
+                track.sampleCount = streamInfo.totalSampleCount();
+                track.bitsPerSample = streamInfo.bitsPerSample();
+            } else {
+                addNotification(NotificationType::Critical, "\"METADATA_BLOCK_STREAMINFO\" is truncated and will be ignored.", context);
+            }
+            break;
+
+        case FlacMetaDataBlockType::VorbisComment:
+            // if more than one comment exist, simply thread those comments as one
+            if(!vorbisComment) {
+                vorbisComment = make_unique<VorbisComment>();
+            }
+            try {
+                vorbisComment->parse(*makeBufferStream(data), header.dataSize(), VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+            } catch(const Failure &) {
+                // error is logged via notifications, just continue with the next metadata block
+            } catch(...) {
+                catchIoFailure();
+                addNotification(NotificationType::Critical, "\"METADATA_BLOCK_VORBIS_COMMENT\" is truncated.", context);
+            }
+            break;
+
+        default: // picture
+            if(!vorbisComment) {
+                vorbisComment = make_unique<VorbisComment>();
+            }
+            try {
+                VorbisCommentField coverField;
+                coverField.setId(vorbisComment->fieldId(KnownField::Cover));
+                FlacMetaDataBlockPicture picture(coverField.value());
+                picture.parse(*makeBufferStream(data), header.dataSize());
+                coverField.setTypeInfo(picture.pictureType());
+                if(coverField.value().isEmpty()) {
+                    addNotification(NotificationType::Warning, "\"METADATA_BLOCK_PICTURE\" contains no picture.", context);
+                } else {
+                    vorbisComment->fields().insert(make_pair(coverField.id(), move(coverField)));
+                }
+            } catch(const TruncatedDataException &) {
+                addNotification(NotificationType::Critical, "\"METADATA_BLOCK_PICTURE\" is truncated and will be ignored.", context);
+            } catch(...) {
+                catchIoFailure();
+                addNotification(NotificationType::Critical, "\"METADATA_BLOCK_PICTURE\" is truncated and will be ignored.", context);
+            }
+        }
+    }
+
+    if(track.sampleCount && track.samplingFrequency) {
+        m_duration = track.duration = TimeSpan::fromSeconds(static_cast<double>(track.sampleCount) / track.samplingFrequency);
+    } else {
+        markUnavailable(UnavailableInformation::Duration | UnavailableInformation::SampleCount);
+    }
+    markUnavailable(UnavailableInformation::Size | UnavailableInformation::Bitrate);
+    if(vorbisComment) {
+        m_tags.emplace_back(move(vorbisComment));
+    }
+}
+
+/*!
+ * \brief Parses the header pages of an OGG bitstream.
+ *
+ * All pages up to the first page containing media data (denoted by a granule position
+ * other than zero) are buffered. Then the identification and comment headers of the
+ * logical streams are parsed from the buffered pages using OggIterator.
+ */
+void StreamingParser::parseOgg()
+{
+    static const string context("parsing OGG bitstream header");
+
+    // buffer header pages
+    string pages;
+    vector<uint32> streamSerialNumbers;
+    try {
+        for(OggPage page; ; ) {
+            const size_t available = fill(27);
+            if(available < 27) {
+                if(available) {
+                    addNotification(NotificationType::Critical, "The OGG stream is truncated.", context);
+                }
+                break;
+            }
+            const size_t headerSize = 27 + static_cast<byte>(peek()[26]);
+            if(fill(headerSize) < headerSize) {
+                addNotification(NotificationType::Critical, "The OGG stream is truncated.", context);
+                break;
+            }
+            page.parseHeader(peek(), m_bytesRead, numeric_limits<int32>::max());
+            const uint64 granulePosition = page.absoluteGranulePosition();
+            if(!page.isFirstpage() && granulePosition && granulePosition != static_cast<uint64>(-1)) {
+                // all header packets (which must precede the media data) have been read
+                break;
+            }
+            if(pages.size() + page.totalSize() > m_maxMetadataSize) {
+                addNotification(NotificationType::Critical, "The header pages exceed the maximum metadata size; further pages will be ignored.", context);
+                break;
+            }
+            if(page.isFirstpage()) {
+                streamSerialNumbers.push_back(page.streamSerialNumber());
+            }
+            read(pages, page.totalSize());
+        }
+    } catch(const TruncatedDataException &) {
+        addNotification(NotificationType::Critical, "The OGG stream is truncated.", context);
+    } catch(const InvalidDataException &) {
+        addNotification(NotificationType::Critical, "Capture pattern \"OggS\" at " % numberToString(m_bytesRead) + " expected.", context);
+    }
+
+    // parse identification and comment headers of each logical stream
+    const auto buffer = makeBufferStream(pages);
+    OggIterator iterator(*buffer, 0, pages.size());
+    iterator.setMappedData(pages.data(), pages.size());
+    for(const uint32 serialNumber : streamSerialNumbers) {
+        m_tracks.emplace_back();
+        TrackSnapshot &track = m_tracks.back();
+        track.type = TrackType::OggStream;
+        track.id = serialNumber;
+        unique_ptr<VorbisComment> comment;
+        try {
+            iterator.setFilter(serialNumber);
+            for(iterator.reset(); iterator && (track.format == GeneralMediaFormat::Unknown || !comment); ++iterator) {
+                if(iterator.currentSegmentSize() < 8) {
+                    continue;
+                }
+                const uint64 sig = BE::toUInt64(pages.data() + iterator.currentSegmentOffset());
+                if((sig & 0x00ffffffffffff00u) == 0x00766F7262697300u) {
+                    // Vorbis header
+                    switch(sig >> 56) {
+                    case VorbisPackageTypes::Identification: {
+                        VorbisIdentificationHeader ind;
+                        ind.parseHeader(iterator);
+                        track.format = GeneralMediaFormat::Vorbis;
+                        track.mediaType = MediaType::Audio;
+                        track.channelCount = ind.channels();
+                        track.samplingFrequency = ind.sampleRate();
+                        if(ind.nominalBitrate()) {
+                            track.bitrate = ind.nominalBitrate() / 1000.0;
+                        } else if(ind.maxBitrate() == ind.minBitrate()) {
+                            track.bitrate = ind.maxBitrate() / 1000.0;
+                        }
+                        break;
+                    }
+                    case VorbisPackageTypes::Comments:
+                        comment = make_unique<VorbisComment>();
+                        comment->parse(iterator);
+                        break;
+                    default:
+                        ;
+                    }
+                } else if(sig == 0x4F70757348656164u) {
+                    // Opus identification header
+                    OpusIdentificationHeader ind;
+                    ind.parseHeader(iterator);
+                    track.format = GeneralMediaFormat::Opus;
+                    track.mediaType = MediaType::Audio;
+                    track.channelCount = ind.channels();
+                    track.samplingFrequency = ind.sampleRate();
+                } else if(sig == 0x4F70757354616773u) {
+                    // Opus comment
+                    iterator.ignore(8);
+                    comment = make_unique<VorbisComment>();
+                    comment->parse(iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+                } else if((sig & 0xFFFFFFFFFF000000u) == 0x7F464C4143000000u) {
+                    // FLAC-to-Ogg mapping header, followed by Vorbis comment
+                    FlacToOggMappingHeader mapping;
+                    mapping.parseHeader(iterator);
+                    const FlacMetaDataBlockStreamInfo &streamInfo = mapping.streamInfo();
+                    track.format = GeneralMediaFormat::Flac;
+                    track.mediaType = MediaType::Audio;
+                    track.bitsPerSample = streamInfo.bitsPerSample();
+                    track.channelCount = streamInfo.channelCount();
+                    track.samplingFrequency = streamInfo.samplingFrequency();
+                    track.sampleCount = streamInfo.totalSampleCount();
+                    if(track.sampleCount && track.samplingFrequency) {
+                        track.duration = TimeSpan::fromSeconds(static_cast<double>(track.sampleCount) / track.samplingFrequency);
+                    }
+                    if(++iterator) {
+                        char buff[4];
+                        iterator.read(buff, 4);
+                        FlacMetaDataBlockHeader header;
+                        header.parseHeader(buff);
+                        if(header.type() == FlacMetaDataBlockType::VorbisComment) {
+                            comment = make_unique<VorbisComment>();
+                            comment->parse(iterator, VorbisCommentFlags::NoSignature | VorbisCommentFlags::NoFramingByte);
+                        }
+                    }
+                    break;
+                } else if((sig & 0x00ffffffffffff00u) == 0x007468656F726100u) {
+                    // Theora header
+                    track.format = GeneralMediaFormat::Theora;
+                    track.mediaType = MediaType::Video;
+                }
+            }
+        } catch(const Failure &) {
+            addNotification(NotificationType::Critical, "Unable to parse the headers of stream " % numberToString(serialNumber) + ".", context);
+        } catch(...) {
+            catchIoFailure();
+            addNotification(NotificationType::Critical, "The headers of stream " % numberToString(serialNumber) + " are truncated.", context);
+        }
+        if(comment) {
+            m_tags.emplace_back(move(comment));
+        }
+        if(track.duration.isNull()) {
+            // the duration is determined from the granule position of the last page
+            markUnavailable(UnavailableInformation::Duration | UnavailableInformation::SampleCount);
+        } else if(m_duration < track.duration) {
+            m_duration = track.duration;
+        }
+        if(track.bitrate == 0.0) {
+            markUnavailable(UnavailableInformation::Bitrate);
+        }
+    }
+    markUnavailable(UnavailableInformation::Size);
+}
+
+/*!
+ * \brief Parses the EBML header and the "SegmentInfo"-, "Tracks"-, "Tags"- and "SeekHead"-elements
+ *        which precede the first "Cluster"-element of a Matroska stream.
+ *
+ * The relevant elements are buffered and parsed using a MatroskaContainer which is not
+ * associated with a file but with the buffer. Irrelevant elements are skipped.
+ */
+void StreamingParser::parseMatroska()
+{
+    static const string context("parsing header of Matroska container");
+
+    // buffer EBML header
+    string elements;
+    uint32 id;
+    uint64 dataSize;
+    bool unknownSize;
+    if(!readEbmlElementHeader(elements, id, dataSize, unknownSize) || id != EbmlIds::Header || unknownSize || dataSize > m_maxMetadataSize) {
+        addNotification(NotificationType::Critical, "EBML header is invalid.", context);
+        throw InvalidDataException();
+    }
+    read(elements, dataSize);
+
+    // read "Segment"-element header
+    string segmentHeader;
+    if(!readEbmlElementHeader(segmentHeader, id, dataSize, unknownSize) || id != MatroskaIds::Segment) {
+        addNotification(NotificationType::Critical, "\"Segment\"-element expected.", context);
+        throw InvalidDataException();
+    }
+    const uint64 segmentDataOffset = m_bytesRead;
+    const uint64 segmentEnd = unknownSize ? numeric_limits<uint64>::max() : segmentDataOffset + dataSize;
+
+    // buffer relevant level 1 elements until the first "Cluster"-element
+    struct BufferedElement
+    {
+        uint32 id;
+        size_t bufferOffset;
+        uint64 segmentOffset;
+    };
+    vector<BufferedElement> bufferedElements{BufferedElement{EbmlIds::Header, 0, 0}};
+    try {
+        for(bool clusterReached = false; !clusterReached && m_bytesRead < segmentEnd; ) {
+            const uint64 segmentOffset = m_bytesRead - segmentDataOffset;
+            const size_t bufferOffset = elements.size();
+            if(!readEbmlElementHeader(elements, id, dataSize, unknownSize)) {
+                break;
+            }
+            switch(id) {
+            case MatroskaIds::Cluster:
+                clusterReached = true;
+                elements.resize(bufferOffset);
+                continue;
+            case MatroskaIds::SegmentInfo:
+            case MatroskaIds::Tracks:
+            case MatroskaIds::Tags:
+            case MatroskaIds::SeekHead:
+                if(!unknownSize && elements.size() + dataSize <= m_maxMetadataSize) {
+                    read(elements, dataSize);
+                    bufferedElements.emplace_back(BufferedElement{id, bufferOffset, segmentOffset});
+                    continue;
+                }
+                addNotification(NotificationType::Critical, "The element at " % numberToString(m_bytesRead) + " exceeds the maximum metadata size and will be skipped.", context);
+                break;
+            default:
+                ;
+            }
+            elements.resize(bufferOffset);
+            if(unknownSize) {
+                addNotification(NotificationType::Critical, "The element at " % numberToString(m_bytesRead) + " has an unknown size and can not be skipped.", context);
+                break;
+            }
+            skip(dataSize);
+        }
+    } catch(const TruncatedDataException &) {
+        addNotification(NotificationType::Critical, "The Matroska stream is truncated.", context);
+    } catch(const InvalidDataException &) {
+        addNotification(NotificationType::Critical, "The Matroska stream contains an invalid element at " % numberToString(m_bytesRead) + ".", context);
+    }
+
+    // parse buffered elements
+    MediaFileInfo fileInfo; // not associated with a file, only required to construct the container
+    fileInfo.reportSizeChanged(elements.size()); // the container reads ahead up to the size of the "file"
+    MatroskaContainer container(fileInfo, 0);
+    const auto buffer = makeBufferStream(elements);
+    container.setStream(*buffer);
+    m_containerFormat = ContainerFormat::Matroska;
+    bool seekHeadFound = false, trailingTags = false;
+    for(const BufferedElement &bufferedElement : bufferedElements) {
+        EbmlElement element(container, bufferedElement.bufferOffset);
+        try {
+            element.parse();
+            switch(bufferedElement.id) {
+            case EbmlIds::Header:
+                if(EbmlElement *docTypeElement = element.childById(EbmlIds::DocType)) {
+                    if(docTypeElement->readString() == "webm") {
+                        m_containerFormat = ContainerFormat::Webm;
+                    }
+                }
+                break;
+            case MatroskaIds::SegmentInfo: {
+                float64 rawDuration = 0.0;
+                uint64 timeScale = 1000000;
+                for(EbmlElement *subElement = element.firstChild(); subElement; subElement = subElement->nextSibling()) {
+                    subElement->parse();
+                    switch(subElement->id()) {
+                    case MatroskaIds::Duration:
+                        rawDuration = subElement->readFloat();
+                        break;
+                    case MatroskaIds::TimeCodeScale:
+                        timeScale = subElement->readUInteger();
+                        break;
+                    }
+                }
+                if(rawDuration > 0.0 && timeScale > 0) {
+                    m_duration += TimeSpan::fromSeconds(rawDuration * timeScale / 1000000000);
+                }
+                break;
+            }
+            case MatroskaIds::Tracks:
+                for(EbmlElement *subElement = element.firstChild(); subElement; subElement = subElement->nextSibling()) {
+                    subElement->parse();
+                    if(subElement->id() == MatroskaIds::TrackEntry) {
+                        MatroskaTrack track(*subElement);
+                        try {
+                            track.parseHeader();
+                        } catch(const Failure &) {
+                            addNotification(NotificationType::Critical, "Unable to parse track.", context);
+                        }
+                        m_tracks.emplace_back(TrackSnapshot::fromTrack(track));
+                    }
+                }
+                break;
+            case MatroskaIds::Tags:
+                for(EbmlElement *subElement = element.firstChild(); subElement; subElement = subElement->nextSibling()) {
+                    subElement->parse();
+                    if(subElement->id() == MatroskaIds::Tag) {
+                        auto tag = make_unique<MatroskaTag>();
+                        tag->parse(*subElement);
+                        m_tags.emplace_back(move(tag));
+                    }
+                }
+                break;
+            case MatroskaIds::SeekHead: {
+                // check whether "Tags"-elements are referenced which have not been buffered
+                MatroskaSeekInfo seekInfo;
+                seekInfo.parse(&element);
+                seekHeadFound = true;
+                for(const auto &info : seekInfo.info()) {
+                    if(info.first == MatroskaIds::Tags && find_if(bufferedElements.cbegin(), bufferedElements.cend(), [&info] (const BufferedElement &candidate) {
+                        return candidate.id == MatroskaIds::Tags && candidate.segmentOffset == info.second;
+                    }) == bufferedElements.cend()) {
+                        trailingTags = true;
+                    }
+                }
+                break;
+            }
+            }
+        } catch(const Failure &) {
+            addNotification(NotificationType::Critical, "Unable to parse element " % element.idToString() + ".", context);
+        } catch(...) {
+            catchIoFailure();
+            addNotification(NotificationType::Critical, "Element " % element.idToString() + " is truncated.", context);
+        }
+    }
+    addNotifications(container);
+
+    // "Tags"-elements might be located after the media data if there is no seek information
+    if(trailingTags || !seekHeadFound) {
+        markUnavailable(UnavailableInformation::TrailingTags);
+    }
+    if(m_duration.isNull()) {
+        markUnavailable(UnavailableInformation::Duration);
+    }
+    markUnavailable(UnavailableInformation::Size | UnavailableInformation::Bitrate | UnavailableInformation::SampleCount);
+}
+
+}
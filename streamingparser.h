@@ -0,0 +1,181 @@
+#ifndef MEDIA_STREAMINGPARSER_H
+#define MEDIA_STREAMINGPARSER_H
+
+#include "./parsecache.h"
+#include "./statusprovider.h"
+
+#include <c++utilities/chrono/timespan.h>
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Media {
+
+/*!
+ * \brief Specifies information which can not be determined when parsing a stream forward-only
+ *        because it requires data from the end of the file.
+ */
+enum class UnavailableInformation : byte
+{
+    None = 0x0, /**< All information could be determined. */
+    Id3v1Tag = 0x1, /**< An ID3v1 tag would be located at the end of the file. */
+    TrailingTags = 0x2, /**< Tags might be located after the media data (eg. Matroska "Tags"-elements after the first "Cluster"-element). */
+    Duration = 0x4, /**< The duration of the file and its tracks. */
+    Size = 0x8, /**< The size of the tracks. */
+    Bitrate = 0x10, /**< The (average) bitrate of the tracks. */
+    SampleCount = 0x20 /**< The sample count of the tracks. */
+};
+
+inline bool operator &(UnavailableInformation lhs, UnavailableInformation rhs)
+{
+    return static_cast<byte>(lhs) & static_cast<byte>(rhs);
+}
+
+inline UnavailableInformation operator |(UnavailableInformation lhs, UnavailableInformation rhs)
+{
+    return static_cast<UnavailableInformation>(static_cast<byte>(lhs) | static_cast<byte>(rhs));
+}
+
+class TAG_PARSER_EXPORT StreamingParser : public StatusProvider
+{
+public:
+    StreamingParser(std::istream &input);
+    ~StreamingParser();
+
+    void parse();
+    std::istream &input();
+    uint64 bytesRead() const;
+    uint64 maxMetadataSize() const;
+    void setMaxMetadataSize(uint64 maxMetadataSize);
+    ContainerFormat containerFormat() const;
+    ChronoUtilities::TimeSpan duration() const;
+    const std::vector<TrackSnapshot> &tracks() const;
+    const std::vector<std::unique_ptr<Tag> > &tags() const;
+    UnavailableInformation unavailableInformation() const;
+    MediaFileSnapshot snapshot() const;
+
+    static constexpr uint64 defaultMaxMetadataSize = 0x1000000;
+
+private:
+    std::size_t fill(std::size_t count);
+    const char *peek() const;
+    void consume(std::size_t count);
+    void read(std::string &buffer, uint64 count);
+    void skip(uint64 count);
+    bool readEbmlElementHeader(std::string &buffer, uint32 &id, uint64 &dataSize, bool &unknownSize);
+    void markUnavailable(UnavailableInformation information);
+
+    void parseId3v2Tag();
+    void parseMpegAudioFrames();
+    void parseFlac();
+    void parseOgg();
+    void parseMatroska();
+
+    std::istream *m_input;
+    std::string m_lookahead;
+    std::size_t m_lookaheadOffset;
+    uint64 m_bytesRead;
+    uint64 m_maxMetadataSize;
+    ContainerFormat m_containerFormat;
+    ChronoUtilities::TimeSpan m_duration;
+    std::vector<TrackSnapshot> m_tracks;
+    std::vector<std::unique_ptr<Tag> > m_tags;
+    UnavailableInformation m_unavailableInformation;
+};
+
+/*!
+ * \brief Returns the input stream specified when constructing the parser.
+ */
+inline std::istream &StreamingParser::input()
+{
+    return *m_input;
+}
+
+/*!
+ * \brief Returns the number of bytes which have been consumed from the input stream.
+ * \remarks Bytes which have been read ahead to detect the format are not included.
+ */
+inline uint64 StreamingParser::bytesRead() const
+{
+    return m_bytesRead;
+}
+
+/*!
+ * \brief Returns the maximum number of bytes which are buffered to parse a single metadata
+ *        element (eg. an ID3v2 tag or the header pages of an OGG bitstream).
+ *
+ * Bigger elements are skipped. The default is defaultMaxMetadataSize which is sufficient
+ * for tags containing cover art.
+ */
+inline uint64 StreamingParser::maxMetadataSize() const
+{
+    return m_maxMetadataSize;
+}
+
+/*!
+ * \brief Sets the maximum number of bytes which are buffered to parse a single metadata element.
+ * \sa maxMetadataSize()
+ */
+inline void StreamingParser::setMaxMetadataSize(uint64 maxMetadataSize)
+{
+    m_maxMetadataSize = maxMetadataSize;
+}
+
+/*!
+ * \brief Returns the container format of the stream.
+ * \remarks parse() needs to be called before.
+ */
+inline ContainerFormat StreamingParser::containerFormat() const
+{
+    return m_containerFormat;
+}
+
+/*!
+ * \brief Returns the duration if it could be determined from the front of the stream.
+ * \sa unavailableInformation()
+ */
+inline ChronoUtilities::TimeSpan StreamingParser::duration() const
+{
+    return m_duration;
+}
+
+/*!
+ * \brief Returns the tracks found at the front of the stream.
+ * \remarks The track information lacks all values denoted by unavailableInformation().
+ */
+inline const std::vector<TrackSnapshot> &StreamingParser::tracks() const
+{
+    return m_tracks;
+}
+
+/*!
+ * \brief Returns the tags found at the front of the stream.
+ */
+inline const std::vector<std::unique_ptr<Tag> > &StreamingParser::tags() const
+{
+    return m_tags;
+}
+
+/*!
+ * \brief Returns which information could not be determined because it requires data from the end of the file.
+ *
+ * The corresponding values of tracks() and duration() are left zero.
+ */
+inline UnavailableInformation StreamingParser::unavailableInformation() const
+{
+    return m_unavailableInformation;
+}
+
+/*!
+ * \brief Marks the specified \a information as unavailable.
+ */
+inline void StreamingParser::markUnavailable(UnavailableInformation information)
+{
+    m_unavailableInformation = m_unavailableInformation | information;
+}
+
+}
+
+#endif // MEDIA_STREAMINGPARSER_H
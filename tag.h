@@ -127,6 +127,8 @@ public:
     virtual bool supportsMimeType(KnownField field) const;
     virtual unsigned int insertValues(const Tag &from, bool overwrite);
     virtual void ensureTextValuesAreProperlyEncoded() = 0;
+    virtual bool hasSkippedFields() const;
+    virtual void parseSkippedFields();
 //    Tag *parent() const;
 //    bool setParent(Tag *tag);
 //    Tag *nestedTag(size_t index) const;
@@ -362,6 +364,33 @@ inline bool Tag::supportsMimeType(KnownField ) const
     return false;
 }
 
+/*!
+ * \brief Returns whether fields have been skipped when parsing the tag because they were not
+ *        included in the TagFieldProjection.
+ *
+ * The default implementation returns false. This might be overwritten when subclassing.
+ * \sa parseSkippedFields()
+ */
+inline bool Tag::hasSkippedFields() const
+{
+    return false;
+}
+
+/*!
+ * \brief Parses the fields which have been skipped when parsing the tag so the tag can be written
+ *        without losing them.
+ *
+ * Skipped fields are only added if the tag has no fields with the same ID in the meantime so
+ * values assigned after parsing are not altered. The skipped fields are forgotten when calling
+ * removeAllFields().
+ *
+ * The default implementation does nothing. This might be overwritten when subclassing.
+ * \remarks The underlying stream must still be open (MediaFileInfo::applyChanges() calls this
+ *          method before modifying the file).
+ */
+inline void Tag::parseSkippedFields()
+{}
+
 ///*!
 // * \brief Returns the parent of the tag.
 // */
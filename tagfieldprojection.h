@@ -0,0 +1,105 @@
+#ifndef MEDIA_TAGFIELDPROJECTION_H
+#define MEDIA_TAGFIELDPROJECTION_H
+
+#include "./tag.h"
+#include "./caseinsensitivecomparer.h"
+
+#include <bitset>
+#include <initializer_list>
+#include <set>
+#include <string>
+
+namespace Media {
+
+/*!
+ * \class Media::TagFieldProjection
+ * \brief The TagFieldProjection class specifies which fields shall be parsed when parsing tags.
+ *
+ * Fields are selected by KnownField and additionally by their raw ID as returned by the
+ * fieldIdToString() method of the particular field class (eg. "TXXX" for ID3v2 or "ENCODER"
+ * for Vorbis comments). Raw IDs are compared case-insensitively.
+ *
+ * Fields which are not selected are skipped without decoding their data. The data of ID3v2 frames,
+ * MP4 atoms and Matroska "SimpleTag"-elements is not even read; Vorbis comment fields are read as
+ * a whole because the field ID is stored within the field data.
+ * The tags remember the skipped fields so they are still written when the file is modified
+ * (see Tag::parseSkippedFields() and MediaFileInfo::parseTags(const TagFieldProjection &)).
+ *
+ * \remarks Skipped fields are restored unless the tag has fields with the same ID at that time. Hence
+ *          removing a skipped field requires calling Tag::parseSkippedFields() before.
+ */
+class TAG_PARSER_EXPORT TagFieldProjection
+{
+public:
+    TagFieldProjection(std::initializer_list<KnownField> fields = {}, std::initializer_list<std::string> rawIds = {});
+
+    void addField(KnownField field);
+    void addRawId(const std::string &rawId);
+    bool includes(KnownField field) const;
+    bool includesRawId(const std::string &rawId) const;
+    template<class TagType>
+    bool includes(const TagType &tag, const typename TagType::fieldType::identifierType &id) const;
+
+private:
+    std::bitset<knownFieldArraySize> m_fields;
+    std::set<std::string, CaseInsensitiveStringComparer> m_rawIds;
+};
+
+/*!
+ * \brief Constructs a new projection selecting the specified \a fields and \a rawIds.
+ */
+inline TagFieldProjection::TagFieldProjection(std::initializer_list<KnownField> fields, std::initializer_list<std::string> rawIds) :
+    m_rawIds(rawIds)
+{
+    for(const KnownField field : fields) {
+        addField(field);
+    }
+}
+
+/*!
+ * \brief Selects the specified \a field.
+ */
+inline void TagFieldProjection::addField(KnownField field)
+{
+    if(field != KnownField::Invalid) {
+        m_fields.set(static_cast<std::size_t>(field));
+    }
+}
+
+/*!
+ * \brief Selects fields with the specified \a rawId.
+ */
+inline void TagFieldProjection::addRawId(const std::string &rawId)
+{
+    m_rawIds.insert(rawId);
+}
+
+/*!
+ * \brief Returns whether the specified \a field is selected.
+ */
+inline bool TagFieldProjection::includes(KnownField field) const
+{
+    return field != KnownField::Invalid && m_fields.test(static_cast<std::size_t>(field));
+}
+
+/*!
+ * \brief Returns whether fields with the specified \a rawId are selected.
+ */
+inline bool TagFieldProjection::includesRawId(const std::string &rawId) const
+{
+    return m_rawIds.find(rawId) != m_rawIds.cend();
+}
+
+/*!
+ * \brief Returns whether fields with the specified \a id are selected when parsing the specified \a tag.
+ * \remarks The \a tag is used to map \a id to the corresponding KnownField.
+ */
+template<class TagType>
+bool TagFieldProjection::includes(const TagType &tag, const typename TagType::fieldType::identifierType &id) const
+{
+    return includes(tag.knownField(id)) || (!m_rawIds.empty() && includesRawId(TagType::fieldType::fieldIdToString(id)));
+}
+
+}
+
+#endif // MEDIA_TAGFIELDPROJECTION_H
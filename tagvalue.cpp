@@ -1,11 +1,15 @@
 #include "./tagvalue.h"
 #include "./tag.h"
 
+#include "./metrics.h"
+
 #include "./id3/id3genres.h"
 
 #include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/conversion/stringconversion.h>
 #include <c++utilities/conversion/conversionexception.h>
+#include <c++utilities/io/catchiofailure.h>
+#include <c++utilities/io/copy.h>
 
 #include <algorithm>
 #include <utility>
@@ -22,52 +26,92 @@ namespace Media {
  * \brief The TagValue class wraps values of different types. It is meant to be assigned to a tag field.
  *
  * For a list of supported types see Media::TagDataType.
+ *
+ * Values not exceeding inlineCapacity bytes (eg. integers, positions and short texts) are stored
+ * within the instance itself; only bigger values are allocated on the heap. The rarely used meta
+ * data (description, MIME type and language) is stored in a separate block which is only allocated
+ * when assigned.
+ *
+ * Big values like pictures can also reference data within a stream which is only loaded when
+ * actually accessed (see assignDataFromStream()).
  */
 
+constexpr std::size_t TagValue::inlineCapacity;
+
 /*!
  * \brief Constructs a new TagValue holding a copy of the given TagValue instance.
  * \param other Specifies another TagValue instance.
+ * \remarks If the data of \a other has not been loaded yet, it is read from its source so the copy does
+ *          not depend on the stream (which might be closed before the copy is accessed). \a other is
+ *          not altered and keeps referencing the stream.
+ * \throws Throws std::ios_base::failure when loading the data of \a other fails.
  */
 TagValue::TagValue(const TagValue &other) :
-    m_size(other.m_size),
+    m_size(0),
     m_type(other.m_type),
-    m_desc(other.m_desc),
-    m_mimeType(other.m_mimeType),
-    m_lng(other.m_lng),
-    m_labeledAsReadonly(other.m_labeledAsReadonly),
     m_encoding(other.m_encoding),
-    m_descEncoding(other.m_descEncoding)
+    m_labeledAsReadonly(other.m_labeledAsReadonly),
+    m_metadata(other.m_metadata ? make_unique<Metadata>(*other.m_metadata) : nullptr)
 {
-    if(!other.isEmpty()) {
-        m_ptr = make_unique<char []>(m_size);
-        std::copy(other.m_ptr.get(), other.m_ptr.get() + other.m_size, m_ptr.get());
+    if(other.m_source) {
+        readSourceData(*other.m_source, other.m_size);
+        m_size = other.m_size;
+    } else {
+        std::copy(other.dataPointer(), other.dataPointer() + other.m_size, storage(other.m_size));
     }
 }
 
 /*!
  * \brief Assigns the value of another TagValue to the current instance.
+ * \remarks Data of \a other which has not been loaded yet is read from its source (see copy constructor).
+ * \throws Throws std::ios_base::failure when loading the data of \a other fails; the current instance
+ *         is left empty in this case.
  */
 TagValue &TagValue::operator=(const TagValue &other)
 {
     if(this != &other) {
-        m_size = other.m_size;
+        if(other.m_source) {
+            freeStorage();
+            readSourceData(*other.m_source, other.m_size);
+            m_size = other.m_size;
+        } else {
+            std::copy(other.dataPointer(), other.dataPointer() + other.m_size, storage(other.m_size));
+        }
         m_type = other.m_type;
-        m_desc = other.m_desc;
-        m_mimeType = other.m_mimeType;
-        m_lng = other.m_lng;
-        m_labeledAsReadonly = other.m_labeledAsReadonly;
         m_encoding = other.m_encoding;
-        m_descEncoding = other.m_descEncoding;
-        if(other.isEmpty()) {
-            m_ptr.reset();
+        m_labeledAsReadonly = other.m_labeledAsReadonly;
+        if(!other.m_metadata) {
+            m_metadata.reset();
+        } else if(m_metadata) {
+            *m_metadata = *other.m_metadata;
         } else {
-            m_ptr = make_unique<char[]>(m_size);
-            std::copy(other.m_ptr.get(), other.m_ptr.get() + other.m_size, m_ptr.get());
+            m_metadata = make_unique<Metadata>(*other.m_metadata);
         }
     }
     return *this;
 }
 
+/*!
+ * \brief Assigns the value and meta data of \a other to the current instance by moving it.
+ * \remarks Heap allocated data is taken over; \a other is left empty.
+ */
+TagValue &TagValue::operator=(TagValue &&other) noexcept
+{
+    if(this != &other) {
+        freeStorage();
+        // copies either the inline data or the pointer to the heap allocated data
+        memcpy(m_inline, other.m_inline, inlineCapacity);
+        m_size = other.m_size;
+        m_type = other.m_type;
+        m_encoding = other.m_encoding;
+        m_labeledAsReadonly = other.m_labeledAsReadonly;
+        m_metadata = move(other.m_metadata);
+        m_source = move(other.m_source);
+        other.m_size = 0;
+    }
+    return *this;
+}
+
 /*!
  * \brief Returns whether both instances are equal.
  *
@@ -78,8 +122,8 @@ TagValue &TagValue::operator=(const TagValue &other)
  */
 bool TagValue::operator==(const TagValue &other) const
 {
-    if(m_desc != other.m_desc || (!m_desc.empty() && m_descEncoding != other.m_descEncoding)
-            || m_mimeType != other.m_mimeType || m_lng != other.m_lng || m_labeledAsReadonly != other.m_labeledAsReadonly) {
+    if(description() != other.description() || (!description().empty() && descriptionEncoding() != other.descriptionEncoding())
+            || mimeType() != other.mimeType() || language() != other.language() || m_labeledAsReadonly != other.m_labeledAsReadonly) {
         return false;
     }
     if(m_type == other.m_type) {
@@ -89,7 +133,7 @@ bool TagValue::operator==(const TagValue &other) const
                 // don't consider differently encoded text values equal
                 return false;
             }
-            return strncmp(m_ptr.get(), other.m_ptr.get(), m_size) == 0;
+            return strncmp(dataPointer(), other.dataPointer(), m_size) == 0;
         case TagDataType::PositionInSet:
             return toPositionInSet() == other.toPositionInSet();
         case TagDataType::Integer:
@@ -106,7 +150,7 @@ bool TagValue::operator==(const TagValue &other) const
             if(m_size != other.m_size) {
                 return false;
             }
-            return strncmp(m_ptr.get(), other.m_ptr.get(), m_size) == 0;
+            return strncmp(dataPointer(), other.dataPointer(), m_size) == 0;
         default:
             return false;
         }
@@ -126,7 +170,9 @@ bool TagValue::operator==(const TagValue &other) const
  * \brief Destroys the TagValue.
  */
 TagValue::~TagValue()
-{}
+{
+    freeStorage();
+}
 
 /*!
  * \brief Wipes assigned meta data.
@@ -137,9 +183,7 @@ TagValue::~TagValue()
  */
 void TagValue::clearMetadata()
 {
-    m_desc.clear();
-    m_mimeType.clear();
-    m_lng.clear();
+    m_metadata.reset();
     m_labeledAsReadonly = false;
     m_encoding = TagTextEncoding::Latin1;
     m_type = TagDataType::Undefined;
@@ -170,10 +214,10 @@ int32 TagValue::toInteger() const
             case TagTextEncoding::Unspecified:
             case TagTextEncoding::Latin1:
             case TagTextEncoding::Utf8:
-                return ConversionUtilities::bufferToNumber<int32>(m_ptr.get(), m_size);
+                return ConversionUtilities::bufferToNumber<int32>(dataPointer(), m_size);
             case TagTextEncoding::Utf16LittleEndian:
             case TagTextEncoding::Utf16BigEndian:
-                u16string u16str(reinterpret_cast<char16_t *>(m_ptr.get()), m_size / 2);
+                u16string u16str(reinterpret_cast<char16_t *>(dataPointer()), m_size / 2);
                 ensureHostByteOrder(u16str, m_encoding);
                 return ConversionUtilities::stringToNumber<int32>(u16str);
             }
@@ -181,7 +225,7 @@ int32 TagValue::toInteger() const
         case TagDataType::PositionInSet:
         case TagDataType::StandardGenreIndex:
             if(m_size == sizeof(int32)) {
-                return *reinterpret_cast<int32 *>(m_ptr.get());
+                return *reinterpret_cast<int32 *>(dataPointer());
             } else {
                 throw ConversionException("Can not convert assigned data to integer because the data size is not appropriate.");
             }
@@ -218,7 +262,7 @@ int TagValue::toStandardGenreIndex() const
         } case TagDataType::StandardGenreIndex:
         case TagDataType::Integer:
             if(m_size == sizeof(int32)) {
-                index = static_cast<int>(*reinterpret_cast<int32 *>(m_ptr.get()));
+                index = static_cast<int>(*reinterpret_cast<int32 *>(dataPointer()));
             } else {
                 throw ConversionException("The assigned data is of unappropriate size.");
             }
@@ -249,10 +293,10 @@ PositionInSet TagValue::toPositionInSet() const
             case TagTextEncoding::Unspecified:
             case TagTextEncoding::Latin1:
             case TagTextEncoding::Utf8:
-                return PositionInSet(string(m_ptr.get(), m_size));
+                return PositionInSet(string(dataPointer(), m_size));
             case TagTextEncoding::Utf16LittleEndian:
             case TagTextEncoding::Utf16BigEndian:
-                u16string u16str(reinterpret_cast<char16_t *>(m_ptr.get()), m_size / 2);
+                u16string u16str(reinterpret_cast<char16_t *>(dataPointer()), m_size / 2);
                 ensureHostByteOrder(u16str, m_encoding);
                 return PositionInSet(u16str);
             }
@@ -260,9 +304,9 @@ PositionInSet TagValue::toPositionInSet() const
         case TagDataType::PositionInSet:
             switch(m_size) {
             case sizeof(int32):
-                return PositionInSet(*(reinterpret_cast<int32 *>(m_ptr.get())));
+                return PositionInSet(*(reinterpret_cast<int32 *>(dataPointer())));
             case 2 * sizeof(int32):
-                return PositionInSet(*(reinterpret_cast<int32 *>(m_ptr.get())), *(reinterpret_cast<int32 *>(m_ptr.get() + sizeof(int32))));
+                return PositionInSet(*(reinterpret_cast<int32 *>(dataPointer())), *(reinterpret_cast<int32 *>(dataPointer() + sizeof(int32))));
             default:
                 throw ConversionException("The size of the assigned data is not appropriate.");
             }
@@ -283,14 +327,14 @@ TimeSpan TagValue::toTimeSpan() const
     if(!isEmpty()) {
         switch(m_type) {
         case TagDataType::Text:
-            return TimeSpan::fromString(string(m_ptr.get(), m_size));
+            return TimeSpan::fromString(string(dataPointer(), m_size));
         case TagDataType::Integer:
         case TagDataType::TimeSpan:
             switch(m_size) {
             case sizeof(int32):
-                return TimeSpan(*(reinterpret_cast<int32 *>(m_ptr.get())));
+                return TimeSpan(*(reinterpret_cast<int32 *>(dataPointer())));
             case sizeof(int64):
-                return TimeSpan(*(reinterpret_cast<int64 *>(m_ptr.get())));
+                return TimeSpan(*(reinterpret_cast<int64 *>(dataPointer())));
             default:
                 throw ConversionException("The size of the assigned data is not appropriate.");
             }
@@ -311,13 +355,13 @@ DateTime TagValue::toDateTime() const
     if(!isEmpty()) {
         switch(m_type) {
         case TagDataType::Text:
-            return DateTime::fromString(string(m_ptr.get(), m_size));
+            return DateTime::fromString(string(dataPointer(), m_size));
         case TagDataType::Integer:
         case TagDataType::DateTime:
             if(m_size == sizeof(int32)) {
-                return DateTime(*(reinterpret_cast<int32 *>(m_ptr.get())));
+                return DateTime(*(reinterpret_cast<int32 *>(dataPointer())));
             } else if(m_size == sizeof(int64)) {
-                return DateTime(*(reinterpret_cast<int64 *>(m_ptr.get())));
+                return DateTime(*(reinterpret_cast<int64 *>(dataPointer())));
             } else {
                 throw ConversionException("The assigned data is of unappropriate size.");
             }
@@ -366,13 +410,13 @@ void TagValue::convertDataEncoding(TagTextEncoding encoding)
                 // use pre-defined methods when encoding to UTF-8
                 switch(dataEncoding()) {
                 case TagTextEncoding::Latin1:
-                    encodedData = convertLatin1ToUtf8(m_ptr.get(), m_size);
+                    encodedData = convertLatin1ToUtf8(dataPointer(), m_size);
                     break;
                 case TagTextEncoding::Utf16LittleEndian:
-                    encodedData = convertUtf16LEToUtf8(m_ptr.get(), m_size);
+                    encodedData = convertUtf16LEToUtf8(dataPointer(), m_size);
                     break;
                 case TagTextEncoding::Utf16BigEndian:
-                    encodedData = convertUtf16BEToUtf8(m_ptr.get(), m_size);
+                    encodedData = convertUtf16BEToUtf8(dataPointer(), m_size);
                     break;
                 default:
                     ;
@@ -382,12 +426,11 @@ void TagValue::convertDataEncoding(TagTextEncoding encoding)
                 // otherwise, determine input and output parameter to use general covertString method
                 const auto inputParameter = encodingParameter(dataEncoding());
                 const auto outputParameter = encodingParameter(encoding);
-                encodedData = convertString(inputParameter.first, outputParameter.first, m_ptr.get(), m_size, outputParameter.second / inputParameter.second);
+                encodedData = convertString(inputParameter.first, outputParameter.first, dataPointer(), m_size, outputParameter.second / inputParameter.second);
             }
             }
             // can't just move the encoded data because it needs to be deleted with free
-            m_ptr = make_unique<char []>(m_size = encodedData.second);
-            copy(encodedData.first.get(), encodedData.first.get() + encodedData.second, m_ptr.get());
+            copy(encodedData.first.get(), encodedData.first.get() + encodedData.second, storage(encodedData.second));
         }
         m_encoding = encoding;
     }
@@ -419,7 +462,7 @@ void TagValue::toString(string &result, TagTextEncoding encoding) const
         switch(m_type) {
         case TagDataType::Text:
             if(encoding == TagTextEncoding::Unspecified || dataEncoding() == TagTextEncoding::Unspecified || encoding == dataEncoding()) {
-                result.assign(m_ptr.get(), m_size);
+                result.assign(dataPointer(), m_size);
             } else {
                 StringData encodedData;
                 switch(encoding) {
@@ -427,13 +470,13 @@ void TagValue::toString(string &result, TagTextEncoding encoding) const
                     // use pre-defined methods when encoding to UTF-8
                     switch(dataEncoding()) {
                     case TagTextEncoding::Latin1:
-                        encodedData = convertLatin1ToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertLatin1ToUtf8(dataPointer(), m_size);
                         break;
                     case TagTextEncoding::Utf16LittleEndian:
-                        encodedData = convertUtf16LEToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertUtf16LEToUtf8(dataPointer(), m_size);
                         break;
                     case TagTextEncoding::Utf16BigEndian:
-                        encodedData = convertUtf16BEToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertUtf16BEToUtf8(dataPointer(), m_size);
                         break;
                     default:
                         ;
@@ -443,7 +486,7 @@ void TagValue::toString(string &result, TagTextEncoding encoding) const
                     // otherwise, determine input and output parameter to use general covertString method
                     const auto inputParameter = encodingParameter(dataEncoding());
                     const auto outputParameter = encodingParameter(encoding);
-                    encodedData = convertString(inputParameter.first, outputParameter.first, m_ptr.get(), m_size, outputParameter.second / inputParameter.second);
+                    encodedData = convertString(inputParameter.first, outputParameter.first, dataPointer(), m_size, outputParameter.second / inputParameter.second);
                 }
                 }
                 result.assign(encodedData.first.get(), encodedData.second);
@@ -496,7 +539,7 @@ void TagValue::toWString(std::u16string &result, TagTextEncoding encoding) const
         switch(m_type) {
         case TagDataType::Text:
             if(encoding == TagTextEncoding::Unspecified || encoding == dataEncoding()) {
-                result.assign(reinterpret_cast<const char16_t *>(m_ptr.get()), m_size / sizeof(char16_t));
+                result.assign(reinterpret_cast<const char16_t *>(dataPointer()), m_size / sizeof(char16_t));
             } else {
                 StringData encodedData;
                 switch(encoding) {
@@ -504,13 +547,13 @@ void TagValue::toWString(std::u16string &result, TagTextEncoding encoding) const
                     // use pre-defined methods when encoding to UTF-8
                     switch(dataEncoding()) {
                     case TagTextEncoding::Latin1:
-                        encodedData = convertLatin1ToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertLatin1ToUtf8(dataPointer(), m_size);
                         break;
                     case TagTextEncoding::Utf16LittleEndian:
-                        encodedData = convertUtf16LEToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertUtf16LEToUtf8(dataPointer(), m_size);
                         break;
                     case TagTextEncoding::Utf16BigEndian:
-                        encodedData = convertUtf16BEToUtf8(m_ptr.get(), m_size);
+                        encodedData = convertUtf16BEToUtf8(dataPointer(), m_size);
                         break;
                     default:
                         ;
@@ -520,7 +563,7 @@ void TagValue::toWString(std::u16string &result, TagTextEncoding encoding) const
                     // otherwise, determine input and output parameter to use general covertString method
                     const auto inputParameter = encodingParameter(dataEncoding());
                     const auto outputParameter = encodingParameter(encoding);
-                    encodedData = convertString(inputParameter.first, outputParameter.first, m_ptr.get(), m_size, outputParameter.second / inputParameter.second);
+                    encodedData = convertString(inputParameter.first, outputParameter.first, dataPointer(), m_size, outputParameter.second / inputParameter.second);
                 }
                 }
                 result.assign(reinterpret_cast<const char16_t *>(encodedData.first.get()), encodedData.second / sizeof(char16_t));
@@ -573,14 +616,12 @@ void TagValue::assignText(const char *text, std::size_t textSize, TagTextEncodin
 
     stripBom(text, textSize, textEncoding);
     if(!textSize) {
-        m_size = 0;
-        m_ptr.reset();
+        freeStorage();
         return;
     }
 
     if(convertTo == TagTextEncoding::Unspecified || textEncoding == convertTo) {
-        m_ptr = make_unique<char []>(m_size = textSize);
-        copy(text, text + textSize, m_ptr.get());
+        copy(text, text + textSize, storage(textSize));
     } else {
         StringData encodedData;
         switch(textEncoding) {
@@ -608,8 +649,7 @@ void TagValue::assignText(const char *text, std::size_t textSize, TagTextEncodin
         }
         }
         // can't just move the encoded data because it needs to be deleted with free
-        m_ptr = make_unique<char []>(m_size = encodedData.second);
-        copy(encodedData.first.get(), encodedData.first.get() + encodedData.second, m_ptr.get());
+        copy(encodedData.first.get(), encodedData.first.get() + encodedData.second, storage(encodedData.second));
     }
 }
 
@@ -619,9 +659,7 @@ void TagValue::assignText(const char *text, std::size_t textSize, TagTextEncodin
  */
 void TagValue::assignInteger(int value)
 {
-    m_size = sizeof(value);
-    m_ptr = make_unique<char []>(m_size);
-    std::copy(reinterpret_cast<const char *>(&value), reinterpret_cast<const char *>(&value) + m_size, m_ptr.get());
+    std::copy(reinterpret_cast<const char *>(&value), reinterpret_cast<const char *>(&value) + sizeof(value), storage(sizeof(value)));
     m_type = TagDataType::Integer;
     m_encoding = TagTextEncoding::Latin1;
 }
@@ -650,15 +688,7 @@ void TagValue::assignData(const char *data, size_t length, TagDataType type, Tag
     if(type == TagDataType::Text) {
         stripBom(data, length, encoding);
     }
-    if(length > m_size) {
-        m_ptr = make_unique<char[]>(length);
-    }
-    if(length) {
-        std::copy(data, data + length, m_ptr.get());
-    } else {
-        m_ptr.reset();
-    }
-    m_size = length;
+    std::copy(data, data + length, storage(length));
     m_type = type;
     m_encoding = encoding;
 }
@@ -677,10 +707,106 @@ void TagValue::assignData(const char *data, size_t length, TagDataType type, Tag
  */
 void TagValue::assignData(unique_ptr<char[]> &&data, size_t length, TagDataType type, TagTextEncoding encoding)
 {
-    m_size = length;
+    if(length > inlineCapacity) {
+        freeStorage();
+        m_ptr = data.release();
+        m_size = length;
+    } else {
+        std::copy(data.get(), data.get() + length, storage(length));
+    }
     m_type = type;
     m_encoding = encoding;
-    m_ptr = move(data);
+}
+
+/*!
+ * \brief Assigns \a length bytes of data from the specified \a stream at the specified \a offset.
+ *
+ * The data is not read until it is actually accessed (eg. via dataPointer() or toString()) or
+ * explicitly loaded via loadData(). This allows skipping big values like pictures when parsing tags.
+ *
+ * The \a stream must be provided as function returning a reference to the stream; see StreamDataBlock.
+ *
+ * \param stream Specifies a function returning the stream containing the data.
+ * \param offset Specifies the absolute offset of the data within the stream.
+ * \param length Specifies the length of the data.
+ * \param type Specifies the type of the data as TagDataType.
+ * \param encoding Specifies the encoding of the data as TagTextEncoding. The
+ *                 encoding will only be considered if a text is assigned.
+ * \remarks
+ * - The stream must remain valid and unchanged until the data has been loaded. Copies of the value
+ *   load the data when being created so they do not refer to the stream.
+ * - Does not strip the BOM so for consistency the caller must ensure there is no BOM present.
+ */
+void TagValue::assignDataFromStream(const std::function<istream & ()> &stream, uint64 offset, size_t length, TagDataType type, TagTextEncoding encoding)
+{
+    freeStorage();
+    if(length) {
+        m_source = make_unique<Source>(Source{stream, offset});
+        m_size = length;
+    }
+    m_type = type;
+    m_encoding = encoding;
+}
+
+/*!
+ * \brief Loads the data assigned via assignDataFromStream().
+ * \remarks Does nothing if the data has already been loaded.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void TagValue::loadData() const
+{
+    if(!m_source) {
+        return;
+    }
+    readSourceData(*m_source, m_size);
+    m_source.reset();
+}
+
+/*!
+ * \brief Reads \a size bytes from the specified \a source into the storage of the current instance.
+ * \remarks The storage must have been freed before; the caller is responsible for setting m_size accordingly.
+ * \throws Throws std::ios_base::failure when an IO error occurs; no storage is allocated in this case.
+ */
+void TagValue::readSourceData(const Source &source, std::size_t size) const
+{
+    istream &stream = source.stream();
+    stream.seekg(static_cast<istream::off_type>(source.offset), ios_base::beg);
+    IoCounters::countSeek();
+    unique_ptr<char[]> heapData;
+    if(size > inlineCapacity) {
+        heapData = make_unique<char[]>(size);
+    } else {
+        std::fill(m_inline + size, m_inline + inlineCapacity, '\0');
+    }
+    char *const buffer = heapData ? heapData.get() : m_inline;
+    stream.read(buffer, static_cast<streamsize>(size));
+    IoCounters::countRead(size);
+    if(static_cast<size_t>(stream.gcount()) != size) {
+        IoUtilities::throwIoFailure("Unable to load the data of the tag value.");
+    }
+    if(heapData) {
+        m_ptr = heapData.release();
+    }
+}
+
+/*!
+ * \brief Writes the assigned data to the specified \a stream.
+ * \remarks If the data has not been loaded yet, it is copied from its source without being loaded.
+ * \throws Throws std::ios_base::failure when an IO error occurs.
+ */
+void TagValue::copyDataTo(ostream &stream) const
+{
+    if(m_source) {
+        istream &sourceStream = m_source->stream();
+        sourceStream.seekg(static_cast<istream::off_type>(m_source->offset), ios_base::beg);
+        IoCounters::countSeek();
+        IoUtilities::CopyHelper<0x2000> copyHelper;
+        copyHelper.copy(sourceStream, stream, m_size);
+        IoCounters::countRead(m_size);
+    } else {
+        stream.write(dataPointer(), static_cast<streamsize>(m_size));
+    }
+    IoCounters::countWrite(m_size);
 }
 
 /*!
@@ -733,6 +859,32 @@ void TagValue::ensureHostByteOrder(u16string &u16str, TagTextEncoding currentEnc
     }
 }
 
+/*!
+ * \brief Frees the assigned data and returns a buffer for \a size bytes of new data.
+ * \remarks The buffer is within the instance itself if \a size does not exceed inlineCapacity. In this case
+ *          the bytes following the buffer are zeroed so short data is null-terminated.
+ */
+char *TagValue::storage(std::size_t size)
+{
+    freeStorage();
+    if(size > inlineCapacity) {
+        m_ptr = new char[size];
+    } else {
+        std::fill(m_inline + size, m_inline + inlineCapacity, '\0');
+    }
+    m_size = size;
+    return size > inlineCapacity ? m_ptr : m_inline;
+}
+
+/*!
+ * \brief Returns an empty string; used when no meta data block is allocated.
+ */
+const string &TagValue::emptyString()
+{
+    static const string emptyString;
+    return emptyString;
+}
+
 /*!
  * \brief Returns an empty TagValue.
  */
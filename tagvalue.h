@@ -10,6 +10,8 @@
 #include <iosfwd>
 #include <string>
 #include <memory>
+#include <functional>
+#include <cstring>
 
 namespace Media {
 
@@ -75,12 +77,12 @@ public:
     TagValue(std::unique_ptr<char[]> &&data, size_t length, TagDataType type = TagDataType::Binary, TagTextEncoding encoding = TagTextEncoding::Latin1);
     TagValue(const PositionInSet &value);
     TagValue(const TagValue &other);
-    TagValue(TagValue &&other) = default;
+    TagValue(TagValue &&other) noexcept;
     ~TagValue();
 
     // operators
     TagValue &operator=(const TagValue &other);
-    TagValue &operator=(TagValue &&other) = default;
+    TagValue &operator=(TagValue &&other) noexcept;
     bool operator==(const TagValue &other) const;
     bool operator!=(const TagValue &other) const;
 
@@ -101,6 +103,9 @@ public:
     ChronoUtilities::DateTime toDateTime() const;
     size_t dataSize() const;
     char *dataPointer() const;
+    bool isDataLoaded() const;
+    void loadData() const;
+    void copyDataTo(std::ostream &stream) const;
     const std::string &description() const;
     void setDescription(const std::string &value, TagTextEncoding encoding = TagTextEncoding::Latin1);
     const std::string &mimeType() const;
@@ -121,24 +126,54 @@ public:
     void assignStandardGenreIndex(int index);
     void assignData(const char *data, size_t length, TagDataType type = TagDataType::Binary, TagTextEncoding encoding = TagTextEncoding::Latin1);
     void assignData(std::unique_ptr<char[]> &&data, size_t length, TagDataType type = TagDataType::Binary, TagTextEncoding encoding = TagTextEncoding::Latin1);
+    void assignDataFromStream(const std::function<std::istream & ()> &stream, uint64 offset, size_t length, TagDataType type = TagDataType::Binary, TagTextEncoding encoding = TagTextEncoding::Latin1);
     void assignPosition(PositionInSet value);
     void assignTimeSpan(ChronoUtilities::TimeSpan value);
     void assignDateTime(ChronoUtilities::DateTime value);
 
 
 private:
+    /*!
+     * \brief The Metadata struct holds the rarely used meta data. It is only allocated when assigned.
+     */
+    struct Metadata
+    {
+        std::string desc;
+        std::string mimeType;
+        std::string lng;
+        TagTextEncoding descEncoding = TagTextEncoding::Latin1;
+    };
+
+    /*!
+     * \brief The Source struct references data which has not been loaded yet (see assignDataFromStream()).
+     */
+    struct Source
+    {
+        std::function<std::istream & ()> stream;
+        uint64 offset;
+    };
+
+    /// \brief Values up to this size are stored within the instance instead of the heap.
+    static constexpr std::size_t inlineCapacity = 16;
+
     static void stripBom(const char *&text, size_t &length, TagTextEncoding encoding);
     static void ensureHostByteOrder(std::u16string &u16str, TagTextEncoding currentEncoding);
-
-    std::unique_ptr<char[]> m_ptr;
-    std::string::size_type m_size;
+    static const std::string &emptyString();
+    char *storage(std::size_t size);
+    void readSourceData(const Source &source, std::size_t size) const;
+    void freeStorage();
+    Metadata &metadata();
+
+    union {
+        mutable char *m_ptr;
+        alignas(int64) mutable char m_inline[inlineCapacity];
+    };
+    std::size_t m_size;
     TagDataType m_type;
-    std::string m_desc;
-    std::string m_mimeType;
-    std::string m_lng;
-    bool m_labeledAsReadonly;
     TagTextEncoding m_encoding;
-    TagTextEncoding m_descEncoding;
+    bool m_labeledAsReadonly;
+    std::unique_ptr<Metadata> m_metadata;
+    mutable std::unique_ptr<Source> m_source;
 };
 
 /*!
@@ -147,9 +182,8 @@ private:
 inline TagValue::TagValue() :
     m_size(0),
     m_type(TagDataType::Undefined),
-    m_labeledAsReadonly(false),
     m_encoding(TagTextEncoding::Latin1),
-    m_descEncoding(TagTextEncoding::Latin1)
+    m_labeledAsReadonly(false)
 {}
 
 /*!
@@ -163,8 +197,8 @@ inline TagValue::TagValue() :
  * \remarks Strips the BOM of the specified \a text.
  */
 inline TagValue::TagValue(const char *text, std::size_t textSize, TagTextEncoding textEncoding, TagTextEncoding convertTo) :
-    m_labeledAsReadonly(false),
-    m_descEncoding(TagTextEncoding::Latin1)
+    m_size(0),
+    m_labeledAsReadonly(false)
 {
     assignText(text, textSize, textEncoding, convertTo);
 }
@@ -179,8 +213,8 @@ inline TagValue::TagValue(const char *text, std::size_t textSize, TagTextEncodin
  * \remarks Strips the BOM of the specified \a text.
  */
 inline TagValue::TagValue(const std::string &text, TagTextEncoding textEncoding, TagTextEncoding convertTo) :
-    m_labeledAsReadonly(false),
-    m_descEncoding(TagTextEncoding::Latin1)
+    m_size(0),
+    m_labeledAsReadonly(false)
 {
     assignText(text, textEncoding, convertTo);
 }
@@ -203,19 +237,10 @@ inline TagValue::TagValue(int value) :
  * \remarks Strips the BOM of the specified \a data if \a type is TagDataType::Text.
  */
 inline TagValue::TagValue(const char *data, size_t length, TagDataType type, TagTextEncoding encoding) :
-    m_size(length),
-    m_type(type),
-    m_labeledAsReadonly(false),
-    m_encoding(encoding),
-    m_descEncoding(TagTextEncoding::Latin1)
-{
-    if(length) {
-        if(type == TagDataType::Text) {
-            stripBom(data, m_size, encoding);
-        }
-        m_ptr = std::make_unique<char []>(m_size);
-        std::copy(data, data + m_size, m_ptr.get());
-    }
+    m_size(0),
+    m_labeledAsReadonly(false)
+{
+    assignData(data, length, type, encoding);
 }
 
 /*!
@@ -231,15 +256,10 @@ inline TagValue::TagValue(const char *data, size_t length, TagDataType type, Tag
  * \remarks Does not strip the BOM so for consistency the caller must ensure there is no BOM present.
  */
 inline TagValue::TagValue(std::unique_ptr<char[]> &&data, size_t length, TagDataType type, TagTextEncoding encoding) :
-    m_size(length),
-    m_type(type),
-    m_labeledAsReadonly(false),
-    m_encoding(encoding),
-    m_descEncoding(TagTextEncoding::Latin1)
-{
-    if(length) {
-        m_ptr = move(data);
-    }
+    m_size(0),
+    m_labeledAsReadonly(false)
+{
+    assignData(std::move(data), length, type, encoding);
 }
 
 /*!
@@ -250,6 +270,23 @@ inline TagValue::TagValue(const PositionInSet &value) :
     TagValue(reinterpret_cast<const char *>(&value), sizeof(value), TagDataType::PositionInSet)
 {}
 
+/*!
+ * \brief Constructs a new TagValue by moving the value and meta data of \a other.
+ * \remarks Heap allocated data is taken over; \a other is left empty.
+ */
+inline TagValue::TagValue(TagValue &&other) noexcept :
+    m_size(other.m_size),
+    m_type(other.m_type),
+    m_encoding(other.m_encoding),
+    m_labeledAsReadonly(other.m_labeledAsReadonly),
+    m_metadata(std::move(other.m_metadata)),
+    m_source(std::move(other.m_source))
+{
+    // copies either the inline data or the pointer to the heap allocated data
+    std::memcpy(m_inline, other.m_inline, inlineCapacity);
+    other.m_size = 0;
+}
+
 /*!
  * \brief Returns whether both instances are not equal.
  * \remarks Simply the negation of operator==() so check there for details.
@@ -343,7 +380,7 @@ inline std::u16string TagValue::toWString(TagTextEncoding encoding) const
  */
 inline bool TagValue::isEmpty() const
 {
-    return m_ptr == nullptr || m_size == 0;
+    return m_size == 0;
 }
 
 /*!
@@ -354,8 +391,7 @@ inline bool TagValue::isEmpty() const
  */
 inline void TagValue::clearData()
 {
-    m_size = 0;
-    m_ptr.reset();
+    freeStorage();
 }
 
 /*!
@@ -372,10 +408,24 @@ inline size_t TagValue::dataSize() const
  * \remarks The instance keeps ownership over the data which will be invalidated when the
  *          it gets destroyed or an other value is assigned.
  * \remarks The raw data is not null terminated. See dataSize().
+ * \remarks Loads the data if it has not been loaded yet (see loadData()).
+ * \throws Throws std::ios_base::failure when loading the data fails.
  */
 inline char *TagValue::dataPointer() const
 {
-    return m_ptr.get();
+    if(m_source) {
+        loadData();
+    }
+    return m_size > inlineCapacity ? m_ptr : (m_size ? m_inline : nullptr);
+}
+
+/*!
+ * \brief Returns whether the assigned data has been loaded.
+ * \remarks Returns always true unless the data has been assigned using assignDataFromStream().
+ */
+inline bool TagValue::isDataLoaded() const
+{
+    return m_source == nullptr;
 }
 
 /*!
@@ -386,7 +436,7 @@ inline char *TagValue::dataPointer() const
  */
 inline const std::string &TagValue::description() const
 {
-    return m_desc;
+    return m_metadata ? m_metadata->desc : emptyString();
 }
 
 /*!
@@ -399,8 +449,11 @@ inline const std::string &TagValue::description() const
  */
 inline void TagValue::setDescription(const std::string &value, TagTextEncoding encoding)
 {
-    m_desc = value;
-    m_descEncoding = encoding;
+    if(m_metadata || !value.empty()) {
+        Metadata &metadata = this->metadata();
+        metadata.desc = value;
+        metadata.descEncoding = encoding;
+    }
 }
 
 /*!
@@ -410,7 +463,7 @@ inline void TagValue::setDescription(const std::string &value, TagTextEncoding e
  */
 inline const std::string &TagValue::mimeType() const
 {
-    return m_mimeType;
+    return m_metadata ? m_metadata->mimeType : emptyString();
 }
 
 /*!
@@ -421,7 +474,9 @@ inline const std::string &TagValue::mimeType() const
  */
 inline void TagValue::setMimeType(const std::string &value)
 {
-    m_mimeType = value;
+    if(m_metadata || !value.empty()) {
+        metadata().mimeType = value;
+    }
 }
 
 /*!
@@ -431,7 +486,7 @@ inline void TagValue::setMimeType(const std::string &value)
  */
 inline const std::string &TagValue::language() const
 {
-    return m_lng;
+    return m_metadata ? m_metadata->lng : emptyString();
 }
 
 /*!
@@ -442,7 +497,9 @@ inline const std::string &TagValue::language() const
  */
 inline void TagValue::setLanguage(const std::string &value)
 {
-    m_lng = value;
+    if(m_metadata || !value.empty()) {
+        metadata().lng = value;
+    }
 }
 
 /*!
@@ -488,7 +545,31 @@ inline TagTextEncoding TagValue::dataEncoding() const
  */
 inline TagTextEncoding TagValue::descriptionEncoding() const
 {
-    return m_descEncoding;
+    return m_metadata ? m_metadata->descEncoding : TagTextEncoding::Latin1;
+}
+
+/*!
+ * \brief Frees the assigned data.
+ */
+inline void TagValue::freeStorage()
+{
+    if(m_source) {
+        m_source.reset();
+    } else if(m_size > inlineCapacity) {
+        delete[] m_ptr;
+    }
+    m_size = 0;
+}
+
+/*!
+ * \brief Returns the meta data block, allocating it if not present yet.
+ */
+inline TagValue::Metadata &TagValue::metadata()
+{
+    if(!m_metadata) {
+        m_metadata = std::make_unique<Metadata>();
+    }
+    return *m_metadata;
 }
 
 }
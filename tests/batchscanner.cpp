@@ -0,0 +1,196 @@
+#include "../batchscanner.h"
+#include "../mediafileinfo.h"
+
+#include <c++utilities/tests/testutils.h>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace TestUtilities;
+using namespace TestUtilities::Literals;
+using namespace Media;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The BatchScannerTests class tests the BatchScanner class.
+ */
+class BatchScannerTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(BatchScannerTests);
+    CPPUNIT_TEST(testEveryFileReportedOnce);
+    CPPUNIT_TEST(testSerializedCallbacks);
+    CPPUNIT_TEST(testExceptionInCallback);
+    CPPUNIT_TEST(testExceptionInSetupCallback);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testEveryFileReportedOnce();
+    void testSerializedCallbacks();
+    void testExceptionInCallback();
+    void testExceptionInSetupCallback();
+
+private:
+    vector<string> m_paths;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BatchScannerTests);
+
+namespace {
+
+/// \brief The number of copies of each test file passed to BatchScanner::scan().
+constexpr size_t copyCount = 25;
+/// \brief The number of threads used to scan the files.
+constexpr unsigned int threadCount = 4;
+
+/*!
+ * \brief The test files and their container formats.
+ */
+const struct {
+    const char *path;
+    ContainerFormat format;
+} testFiles[] = {
+    {"mtx-test-data/mp3/id3-tag-and-xing-header.mp3", ContainerFormat::MpegAudioFrames},
+    {"matroska_wave1/test1.mkv", ContainerFormat::Matroska},
+    {"mtx-test-data/mp4/10-DanseMacabreOp.40.m4a", ContainerFormat::Mp4},
+    {"mtx-test-data/ogg/qt4dance_medium.ogg", ContainerFormat::Ogg},
+};
+constexpr size_t testFileCount = sizeof(testFiles) / sizeof(testFiles[0]);
+
+}
+
+/*!
+ * \brief Builds a list containing copyCount copies of the paths of the test files and a path which does not exist.
+ */
+void BatchScannerTests::setUp()
+{
+    m_paths.clear();
+    m_paths.reserve(copyCount * testFileCount + 1);
+    for(size_t copy = 0; copy != copyCount; ++copy) {
+        for(const auto &testFile : testFiles) {
+            m_paths.emplace_back(testFilePath(testFile.path));
+        }
+    }
+    m_paths.emplace_back(m_paths.front() + ".does-not-exist");
+}
+
+void BatchScannerTests::tearDown()
+{}
+
+/*!
+ * \brief Tests whether every file is reported exactly once with the correct parsing results.
+ */
+void BatchScannerTests::testEveryFileReportedOnce()
+{
+    BatchScanner scanner;
+    scanner.setThreadCount(threadCount);
+    scanner.setCallbacksSerialized(false);
+    vector<atomic<unsigned int> > reportCounts(m_paths.size());
+    for(auto &count : reportCounts) {
+        count.store(0);
+    }
+    atomic<unsigned int> wrongResults(0);
+    scanner.scan(m_paths, [&] (BatchScanResult &result) {
+        if(result.index >= m_paths.size()) {
+            ++wrongResults;
+            return;
+        }
+        ++reportCounts[result.index];
+        if(result.path != m_paths[result.index] || result.fileInfo.path() != result.path) {
+            ++wrongResults;
+        } else if(result.index + 1 == m_paths.size()) {
+            // the file which does not exist
+            if(result.ioError.empty()) {
+                ++wrongResults;
+            }
+        } else if(result.parsingFailed || !result.ioError.empty()
+                  || result.fileInfo.containerFormat() != testFiles[result.index % testFileCount].format) {
+            ++wrongResults;
+        }
+    });
+    CPPUNIT_ASSERT(!scanner.isAborted());
+    CPPUNIT_ASSERT_EQUAL(0u, wrongResults.load());
+    for(const auto &count : reportCounts) {
+        CPPUNIT_ASSERT_EQUAL(1u, count.load());
+    }
+}
+
+/*!
+ * \brief Tests whether the result callback is never invoked concurrently if serialized callbacks are requested.
+ */
+void BatchScannerTests::testSerializedCallbacks()
+{
+    BatchScanner scanner;
+    scanner.setThreadCount(threadCount);
+    CPPUNIT_ASSERT(scanner.areCallbacksSerialized());
+    atomic<unsigned int> runningCallbacks(0), maxRunningCallbacks(0);
+    size_t callbackCount = 0; // not atomic on purpose; only modified from serialized callbacks
+    scanner.scan(m_paths, [&] (BatchScanResult &) {
+        const unsigned int running = ++runningCallbacks;
+        for(unsigned int maxRunning = maxRunningCallbacks.load(); running > maxRunning && !maxRunningCallbacks.compare_exchange_weak(maxRunning, running);) {
+        }
+        ++callbackCount;
+        // give other workers the chance to invoke the callback concurrently
+        this_thread::sleep_for(chrono::microseconds(200));
+        --runningCallbacks;
+    });
+    CPPUNIT_ASSERT_EQUAL(m_paths.size(), callbackCount);
+    CPPUNIT_ASSERT_EQUAL(1u, maxRunningCallbacks.load());
+}
+
+/*!
+ * \brief Tests whether an exception thrown by the result callback aborts the scan and is rethrown by BatchScanner::scan().
+ */
+void BatchScannerTests::testExceptionInCallback()
+{
+    BatchScanner scanner;
+    scanner.setThreadCount(threadCount);
+    atomic<size_t> callbackCount(0);
+    try {
+        scanner.scan(m_paths, [&] (BatchScanResult &) {
+            if(++callbackCount == 10) {
+                throw runtime_error("callback failed");
+            }
+        });
+        CPPUNIT_FAIL("exception from callback not rethrown");
+    } catch(const runtime_error &error) {
+        CPPUNIT_ASSERT_EQUAL(string("callback failed"), string(error.what()));
+    }
+    CPPUNIT_ASSERT(scanner.isAborted());
+    // files currently processed by other workers are finished; remaining files are skipped
+    CPPUNIT_ASSERT(callbackCount.load() < m_paths.size());
+
+    // a subsequent scan is not affected
+    callbackCount = 0;
+    scanner.scan(m_paths, [&] (BatchScanResult &) {
+        ++callbackCount;
+    });
+    CPPUNIT_ASSERT(!scanner.isAborted());
+    CPPUNIT_ASSERT_EQUAL(m_paths.size(), callbackCount.load());
+}
+
+/*!
+ * \brief Tests whether an exception thrown by the setup callback aborts the scan and is rethrown by BatchScanner::scan().
+ */
+void BatchScannerTests::testExceptionInSetupCallback()
+{
+    BatchScanner scanner;
+    scanner.setThreadCount(threadCount);
+    scanner.setSetupCallback([] (MediaFileInfo &) {
+        throw logic_error("setup failed");
+    });
+    atomic<size_t> callbackCount(0);
+    CPPUNIT_ASSERT_THROW(scanner.scan(m_paths, [&] (BatchScanResult &) {
+        ++callbackCount;
+    }), logic_error);
+    CPPUNIT_ASSERT(scanner.isAborted());
+    CPPUNIT_ASSERT_EQUAL(0_st, callbackCount.load());
+}
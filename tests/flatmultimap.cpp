@@ -0,0 +1,268 @@
+#include "../flatmultimap.h"
+#include "../vorbis/vorbiscomment.h"
+
+#include <c++utilities/tests/testutils.h>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <map>
+
+using namespace std;
+using namespace Media;
+using namespace TestUtilities::Literals;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The FlatMultiMapTests class tests the FlatMultiMap class which is used to store the fields of tags.
+ */
+class FlatMultiMapTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(FlatMultiMapTests);
+    CPPUNIT_TEST(testLookupWithDuplicateKeys);
+    CPPUNIT_TEST(testInsertionOrder);
+    CPPUNIT_TEST(testErase);
+    CPPUNIT_TEST(testCaseInsensitiveLookup);
+    CPPUNIT_TEST(testVorbisCommentFields);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testLookupWithDuplicateKeys();
+    void testInsertionOrder();
+    void testErase();
+    void testCaseInsensitiveLookup();
+    void testVorbisCommentFields();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FlatMultiMapTests);
+
+namespace {
+
+/*!
+ * \brief Returns the values of the specified \a range.
+ */
+template <class Iterator>
+vector<int> valuesOf(pair<Iterator, Iterator> range)
+{
+    vector<int> values;
+    for(; range.first != range.second; ++range.first) {
+        values.emplace_back(range.first->second);
+    }
+    return values;
+}
+
+/*!
+ * \brief Returns whether the entries of \a flatMap equal the entries of \a multiMap (including their order).
+ */
+template <class Key, class Compare>
+bool haveSameEntries(const FlatMultiMap<Key, int, Compare> &flatMap, const multimap<Key, int, Compare> &multiMap)
+{
+    const auto isEqual = [] (const pair<Key, int> &flatEntry, const pair<const Key, int> &entry) {
+        return flatEntry.first == entry.first && flatEntry.second == entry.second;
+    };
+    return flatMap.size() == multiMap.size() && equal(flatMap.cbegin(), flatMap.cend(), multiMap.cbegin(), isEqual);
+}
+
+/*!
+ * \brief Returns a UTF-8 encoded text value for the specified \a text.
+ */
+TagValue textValue(const char *text)
+{
+    return TagValue(string(text), TagTextEncoding::Utf8);
+}
+
+}
+
+void FlatMultiMapTests::setUp()
+{}
+
+void FlatMultiMapTests::tearDown()
+{}
+
+/*!
+ * \brief Tests find(), count(), lower_bound(), upper_bound() and equal_range() when there are several entries with the same key.
+ */
+void FlatMultiMapTests::testLookupWithDuplicateKeys()
+{
+    FlatMultiMap<int, int> map;
+    CPPUNIT_ASSERT(map.find(1) == map.end());
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count(1));
+    CPPUNIT_ASSERT(map.equal_range(1).first == map.end());
+    CPPUNIT_ASSERT(map.equal_range(1).second == map.end());
+
+    for(const auto &entry : {make_pair(3, 30), make_pair(1, 10), make_pair(2, 20), make_pair(1, 11), make_pair(3, 31), make_pair(1, 12)}) {
+        map.insert(entry);
+    }
+    const auto &constMap = map;
+    CPPUNIT_ASSERT_EQUAL(6_st, map.size());
+    CPPUNIT_ASSERT_EQUAL(3_st, map.count(1));
+    CPPUNIT_ASSERT_EQUAL(1_st, map.count(2));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.count(3));
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count(0));
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count(4));
+
+    // find() returns the first entry with the key
+    CPPUNIT_ASSERT(map.find(1) == map.begin());
+    CPPUNIT_ASSERT_EQUAL(10, map.find(1)->second);
+    CPPUNIT_ASSERT_EQUAL(30, constMap.find(3)->second);
+    CPPUNIT_ASSERT(map.find(0) == map.end());
+    CPPUNIT_ASSERT(constMap.find(4) == constMap.cend());
+
+    // equal_range() covers all entries with the key
+    CPPUNIT_ASSERT(valuesOf(map.equal_range(1)) == vector<int>({10, 11, 12}));
+    CPPUNIT_ASSERT(valuesOf(map.equal_range(2)) == vector<int>({20}));
+    CPPUNIT_ASSERT(valuesOf(constMap.equal_range(3)) == vector<int>({30, 31}));
+    CPPUNIT_ASSERT(map.equal_range(1).first == map.lower_bound(1));
+    CPPUNIT_ASSERT(map.equal_range(1).second == map.upper_bound(1));
+    CPPUNIT_ASSERT(constMap.equal_range(3).second == constMap.cend());
+
+    // missing keys yield an empty range at the position where the key would be inserted
+    CPPUNIT_ASSERT(map.equal_range(0).first == map.begin());
+    CPPUNIT_ASSERT(map.equal_range(0).second == map.begin());
+    CPPUNIT_ASSERT(map.lower_bound(4) == map.end());
+    CPPUNIT_ASSERT(map.upper_bound(4) == map.end());
+    CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(map.upper_bound(1) - map.begin()));
+    CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(constMap.upper_bound(2) - constMap.cbegin()));
+}
+
+/*!
+ * \brief Tests whether entries are sorted by their keys and whether entries with equal keys keep their insertion order.
+ * \remarks The order is expected to equal the order of std::multimap.
+ */
+void FlatMultiMapTests::testInsertionOrder()
+{
+    FlatMultiMap<int, int> map;
+    multimap<int, int> referenceMap;
+    unsigned int seed = 42;
+    for(int value = 0; value != 500; ++value) {
+        seed = seed * 1103515245 + 12345;
+        const int key = static_cast<int>((seed >> 16) % 17);
+        const auto entry = make_pair(key, value);
+        const auto inserted = value % 2 ? map.insert(entry) : map.insert(make_pair(key, value));
+        referenceMap.insert(make_pair(key, value));
+        // the returned iterator points to the new entry which is placed after all entries with an equal key
+        CPPUNIT_ASSERT_EQUAL(value, inserted->second);
+        CPPUNIT_ASSERT(inserted + 1 == map.upper_bound(key));
+    }
+    CPPUNIT_ASSERT(haveSameEntries(map, referenceMap));
+
+    map.clear();
+    CPPUNIT_ASSERT(map.empty());
+    CPPUNIT_ASSERT(map.begin() == map.end());
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count(1));
+}
+
+/*!
+ * \brief Tests erasing entries by key and by position when there are several entries with the same key.
+ */
+void FlatMultiMapTests::testErase()
+{
+    FlatMultiMap<int, int> map;
+    for(const auto &entry : {make_pair(2, 20), make_pair(1, 10), make_pair(2, 21), make_pair(3, 30), make_pair(2, 22), make_pair(2, 23)}) {
+        map.insert(entry);
+    }
+
+    // erase single entries with duplicate key by position
+    auto next = map.erase(map.find(2) + 1);
+    CPPUNIT_ASSERT_EQUAL(22, next->second);
+    CPPUNIT_ASSERT(valuesOf(map.equal_range(2)) == vector<int>({20, 22, 23}));
+    next = map.erase(map.upper_bound(2) - 1);
+    CPPUNIT_ASSERT(next == map.find(3));
+    CPPUNIT_ASSERT(valuesOf(map.equal_range(2)) == vector<int>({20, 22}));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.count(2));
+
+    // erase all entries with a key
+    CPPUNIT_ASSERT_EQUAL(0_st, map.erase(4));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.erase(2));
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count(2));
+    CPPUNIT_ASSERT(map.find(2) == map.end());
+    CPPUNIT_ASSERT_EQUAL(2_st, map.size());
+    CPPUNIT_ASSERT_EQUAL(10, map.find(1)->second);
+    CPPUNIT_ASSERT_EQUAL(30, map.find(3)->second);
+    CPPUNIT_ASSERT_EQUAL(1_st, map.erase(1));
+    next = map.erase(map.begin());
+    CPPUNIT_ASSERT(next == map.end());
+    CPPUNIT_ASSERT(map.empty());
+}
+
+/*!
+ * \brief Tests lookups with case-insensitive string keys which use the case-folded keys stored by FlatMultiMapKeys.
+ */
+void FlatMultiMapTests::testCaseInsensitiveLookup()
+{
+    typedef FlatMultiMap<string, int, CaseInsensitiveStringComparer> MapType;
+    MapType map;
+    multimap<string, int, CaseInsensitiveStringComparer> referenceMap;
+    // note: '_' and '[' are placed between upper and lower case letters so folding must be consistent with the comparer
+    const char *const keys[] = {"ARTIST", "title", "Artist", "A_B", "aB", "TITLE", "a[", "artist", "Ab", "ALBUM", "album", "a_b"};
+    int value = 0;
+    for(const char *key : keys) {
+        map.insert(make_pair(string(key), value));
+        referenceMap.insert(make_pair(string(key), value));
+        ++value;
+    }
+    CPPUNIT_ASSERT(haveSameEntries(map, referenceMap));
+
+    // keys are matched case-insensitively but the original spelling is kept
+    CPPUNIT_ASSERT_EQUAL(3_st, map.count("artist"));
+    CPPUNIT_ASSERT_EQUAL(3_st, map.count("aRtIsT"));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.count("Title"));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.count("AB"));
+    CPPUNIT_ASSERT_EQUAL(2_st, map.count("A_b"));
+    CPPUNIT_ASSERT_EQUAL(1_st, map.count("A["));
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count("artists"));
+    CPPUNIT_ASSERT_EQUAL(0_st, map.count("artis"));
+    CPPUNIT_ASSERT_EQUAL(string("ARTIST"), map.find("Artist")->first);
+    CPPUNIT_ASSERT(valuesOf(map.equal_range("ARTIST")) == vector<int>({0, 2, 7}));
+    CPPUNIT_ASSERT(valuesOf(static_cast<const MapType &>(map).equal_range("title")) == vector<int>({1, 5}));
+
+    // the folded keys must be kept in sync when erasing entries
+    CPPUNIT_ASSERT_EQUAL(2_st, map.erase("aB"));
+    referenceMap.erase("aB");
+    map.erase(map.find("Album"));
+    referenceMap.erase(referenceMap.find("Album"));
+    CPPUNIT_ASSERT(haveSameEntries(map, referenceMap));
+    CPPUNIT_ASSERT(valuesOf(map.equal_range("aLbUm")) == vector<int>({10}));
+    CPPUNIT_ASSERT(valuesOf(map.equal_range("artist")) == vector<int>({0, 2, 7}));
+    CPPUNIT_ASSERT(map.find("ab") == map.end());
+    map.insert(make_pair(string("ab"), 12));
+    referenceMap.insert(make_pair(string("ab"), 12));
+    CPPUNIT_ASSERT(valuesOf(map.equal_range("AB")) == vector<int>({12}));
+    for(const char *key : keys) {
+        CPPUNIT_ASSERT_EQUAL(referenceMap.count(key), map.count(key));
+        CPPUNIT_ASSERT(valuesOf(referenceMap.equal_range(key)) == valuesOf(map.equal_range(key)));
+    }
+}
+
+/*!
+ * \brief Tests whether the fields of Vorbis comments are looked up case-insensitively.
+ */
+void FlatMultiMapTests::testVorbisCommentFields()
+{
+    VorbisComment vorbisComment;
+    // access the methods taking field IDs which are hidden by the overloads taking KnownField
+    FieldMapBasedTag<VorbisCommentField, CaseInsensitiveStringComparer> &comment = vorbisComment;
+    comment.setValues("ARTIST", {textValue("artist 1"), textValue("artist 2")});
+    comment.fields().insert(make_pair(string("Artist"), VorbisCommentField("Artist", textValue("artist 3"))));
+    comment.setValue("title", textValue("title"));
+
+    CPPUNIT_ASSERT_EQUAL(4u, comment.fieldCount());
+    CPPUNIT_ASSERT(comment.hasField("artist"));
+    CPPUNIT_ASSERT(comment.hasField(KnownField::Title));
+    CPPUNIT_ASSERT_EQUAL(string("title"), comment.value("TITLE").toString());
+    CPPUNIT_ASSERT_EQUAL(string("artist 1"), comment.value(KnownField::Artist).toString());
+    const auto artists = comment.values("aRtIsT");
+    CPPUNIT_ASSERT_EQUAL(3_st, artists.size());
+    CPPUNIT_ASSERT_EQUAL(string("artist 1"), artists[0]->toString());
+    CPPUNIT_ASSERT_EQUAL(string("artist 2"), artists[1]->toString());
+    CPPUNIT_ASSERT_EQUAL(string("artist 3"), artists[2]->toString());
+
+    // setValue() alters only the first field with an equal key regardless of the case
+    comment.setValue("artist", textValue("new artist"));
+    CPPUNIT_ASSERT_EQUAL(4u, comment.fieldCount());
+    CPPUNIT_ASSERT_EQUAL(string("new artist"), comment.values(KnownField::Artist).front()->toString());
+    CPPUNIT_ASSERT_EQUAL(string("ARTIST"), comment.fields().find("artist")->first);
+}
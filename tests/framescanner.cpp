@@ -0,0 +1,141 @@
+#include "../framescanner.h"
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace Media;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The FrameScannerTests class tests findSyncWord() and the FrameScanner class.
+ */
+class FrameScannerTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(FrameScannerTests);
+    CPPUNIT_TEST(testFindSyncWord);
+    CPPUNIT_TEST(testFindSyncWordWithDecoys);
+    CPPUNIT_TEST(testResync);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testFindSyncWord();
+    void testFindSyncWordWithDecoys();
+    void testResync();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameScannerTests);
+
+namespace {
+
+/*!
+ * \brief Returns the first sync word within [\a begin, \a end) using a plain byte-wise search.
+ */
+const char *findSyncWordNaively(const char *begin, const char *end, byte secondByteMask)
+{
+    for(const char *i = begin; i + 1 < end; ++i) {
+        if(static_cast<byte>(i[0]) == 0xFF && (static_cast<byte>(i[1]) & secondByteMask) == secondByteMask) {
+            return i;
+        }
+    }
+    return end;
+}
+
+}
+
+void FrameScannerTests::setUp()
+{}
+
+void FrameScannerTests::tearDown()
+{}
+
+/*!
+ * \brief Tests findSyncWord() with a sync word at every position of buffers of various sizes.
+ * \remarks The sizes cover the boundary between the 16 byte blocks checked via SSE2 and the
+ *          remaining bytes checked one by one, including a sync word spanning that boundary.
+ */
+void FrameScannerTests::testFindSyncWord()
+{
+    for(size_t size = 0; size <= 40; ++size) {
+        string buffer(size, '\0');
+        const char *const begin = buffer.data(), *const end = begin + size;
+        CPPUNIT_ASSERT(findSyncWord(begin, end, 0xE0) == end);
+        for(size_t pos = 0; pos + 1 < size; ++pos) {
+            buffer.assign(size, '\0');
+            buffer[pos] = static_cast<char>(0xFF);
+            buffer[pos + 1] = static_cast<char>(0xF1);
+            CPPUNIT_ASSERT_EQUAL(pos, static_cast<size_t>(findSyncWord(begin, end, 0xE0) - begin));
+            CPPUNIT_ASSERT_EQUAL(pos, static_cast<size_t>(findSyncWord(begin, end, 0xF0) - begin));
+            // the search starts at the specified begin
+            if(pos) {
+                CPPUNIT_ASSERT_EQUAL(pos, static_cast<size_t>(findSyncWord(begin + 1, end, 0xE0) - begin));
+            }
+        }
+        // a 0xFF byte at the end is no sync word because the second byte is missing
+        if(size) {
+            buffer.assign(size, '\0');
+            buffer[size - 1] = static_cast<char>(0xFF);
+            CPPUNIT_ASSERT(findSyncWord(begin, end, 0xE0) == end);
+        }
+    }
+}
+
+/*!
+ * \brief Tests findSyncWord() with 0xFF bytes which are not followed by a matching second byte.
+ */
+void FrameScannerTests::testFindSyncWordWithDecoys()
+{
+    for(size_t size = 2; size <= 40; ++size) {
+        for(size_t pos = 0; pos + 1 < size; ++pos) {
+            // 0xFF bytes followed by 0xEF (no ADTS sync word) everywhere except at pos
+            string buffer;
+            for(size_t i = 0; i < size; ++i) {
+                buffer += static_cast<char>(i % 2 ? 0xEF : 0xFF);
+            }
+            buffer[pos] = static_cast<char>(0xFF);
+            buffer[pos + 1] = static_cast<char>(0xF9);
+            const char *const begin = buffer.data(), *const end = begin + size;
+            CPPUNIT_ASSERT(findSyncWordNaively(begin, end, 0xF0) == findSyncWord(begin, end, 0xF0));
+            CPPUNIT_ASSERT(findSyncWordNaively(begin, end, 0xE0) == findSyncWord(begin, end, 0xE0));
+        }
+    }
+    // a second byte of 0xFF is a valid second byte as well
+    const string ones(33, static_cast<char>(0xFF));
+    CPPUNIT_ASSERT(findSyncWord(ones.data() + 15, ones.data() + ones.size(), 0xE0) == ones.data() + 15);
+}
+
+/*!
+ * \brief Tests FrameScanner::resync() with sync words near and across the boundary of the blocks read from the stream.
+ */
+void FrameScannerTests::testResync()
+{
+    for(const size_t pos : {size_t(5), FrameScanner::blockSize - 2, FrameScanner::blockSize - 1, FrameScanner::blockSize, FrameScanner::blockSize + 7}) {
+        string data(FrameScanner::blockSize + 16, '\0');
+        data[pos] = static_cast<char>(0xFF);
+        data[pos + 1] = static_cast<char>(0xF1);
+        stringstream stream(data);
+        FrameScanner scanner(stream, 0, data.size(), 0xF0);
+        CPPUNIT_ASSERT(scanner.header(2));
+        CPPUNIT_ASSERT(scanner.resync());
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(pos), scanner.offset());
+        const char *const header = scanner.header(2);
+        CPPUNIT_ASSERT(header);
+        CPPUNIT_ASSERT_EQUAL(static_cast<byte>(0xFF), static_cast<byte>(header[0]));
+        CPPUNIT_ASSERT_EQUAL(static_cast<byte>(0xF1), static_cast<byte>(header[1]));
+        // no further sync word
+        CPPUNIT_ASSERT(!scanner.resync());
+    }
+    // the end offset is respected
+    string data(64, '\0');
+    data[40] = static_cast<char>(0xFF);
+    data[41] = static_cast<char>(0xF1);
+    stringstream stream(data);
+    FrameScanner scanner(stream, 0, 41, 0xF0);
+    CPPUNIT_ASSERT(!scanner.resync());
+}
@@ -0,0 +1,172 @@
+#include "../lookuptable.h"
+#include "../matroska/matroskatag.h"
+#include "../vorbis/vorbiscomment.h"
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cctype>
+
+using namespace std;
+using namespace Media;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The LookupTableTests class tests the lookup tables used to map field IDs to known fields.
+ */
+class LookupTableTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(LookupTableTests);
+    CPPUNIT_TEST(testSortedness);
+    CPPUNIT_TEST(testLookup);
+    CPPUNIT_TEST(testMatroskaTagFields);
+    CPPUNIT_TEST(testVorbisCommentFields);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testSortedness();
+    void testLookup();
+    void testMatroskaTagFields();
+    void testVorbisCommentFields();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LookupTableTests);
+
+namespace {
+
+constexpr LookupEntry<int> sortedTable[] = {
+    {"A", 1}, {"AB", 2}, {"B", 3}, {"Ba", 4}, {"a", 5}, {"b", 6},
+};
+constexpr LookupEntry<int> caseInsensitiveSortedTable[] = {
+    {"A", 1}, {"ab", 2}, {"B", 3}, {"ba", 4}, {"C_", 5}, {"cB", 6},
+};
+constexpr LookupEntry<int> unsortedTable[] = {
+    {"A", 1}, {"C", 2}, {"B", 3},
+};
+constexpr LookupEntry<int> duplicateKeyTable[] = {
+    {"A", 1}, {"B", 2}, {"B", 3},
+};
+constexpr LookupEntry<int> caseInsensitiveDuplicateKeyTable[] = {
+    {"A", 1}, {"B", 2}, {"b", 3},
+};
+
+static_assert(isLookupTableSorted(sortedTable, false), "sorted table must be recognized as sorted");
+static_assert(!isLookupTableSorted(sortedTable, true), "case-sensitively sorted table is not sorted case-insensitively");
+static_assert(isLookupTableSorted(caseInsensitiveSortedTable, true), "sorted table must be recognized as sorted");
+static_assert(!isLookupTableSorted(caseInsensitiveSortedTable, false), "case-insensitively sorted table is not sorted case-sensitively");
+
+/*!
+ * \brief Checks whether knownField(fieldId(field)) == field for every known field supported by the specified \a tag.
+ * \returns Returns the number of supported fields.
+ */
+template <class TagType>
+unsigned int checkFieldIdRoundTrip(const TagType &tag)
+{
+    unsigned int supportedFields = 0;
+    for(KnownField field = firstKnownField; field != KnownField::Invalid; field = nextKnownField(field)) {
+        const auto id = tag.fieldId(field);
+        if(id.empty()) {
+            continue;
+        }
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(id, static_cast<unsigned int>(field), static_cast<unsigned int>(tag.knownField(id)));
+        ++supportedFields;
+    }
+    return supportedFields;
+}
+
+}
+
+void LookupTableTests::setUp()
+{}
+
+void LookupTableTests::tearDown()
+{}
+
+/*!
+ * \brief Tests isLookupTableSorted().
+ * \remarks The tables used by the tag implementations are checked at compile time via static_assert().
+ */
+void LookupTableTests::testSortedness()
+{
+    CPPUNIT_ASSERT(isLookupTableSorted(sortedTable, false));
+    CPPUNIT_ASSERT(!isLookupTableSorted(sortedTable, true));
+    CPPUNIT_ASSERT(isLookupTableSorted(caseInsensitiveSortedTable, true));
+    CPPUNIT_ASSERT(!isLookupTableSorted(unsortedTable, false));
+    CPPUNIT_ASSERT(!isLookupTableSorted(unsortedTable, true));
+    CPPUNIT_ASSERT(!isLookupTableSorted(duplicateKeyTable, false));
+    CPPUNIT_ASSERT(isLookupTableSorted(caseInsensitiveDuplicateKeyTable, false));
+    CPPUNIT_ASSERT(!isLookupTableSorted(caseInsensitiveDuplicateKeyTable, true));
+
+    CPPUNIT_ASSERT(compareLookupKeys("A", "AB", 1, false) == 0);
+    CPPUNIT_ASSERT(compareLookupKeys("A", "AB", 2, false) < 0);
+    CPPUNIT_ASSERT(compareLookupKeys("AB", "A", 1, false) > 0);
+    CPPUNIT_ASSERT(compareLookupKeys("", "", 0, false) == 0);
+    CPPUNIT_ASSERT(compareLookupKeys("a", "B", 1, false) > 0);
+    CPPUNIT_ASSERT(compareLookupKeys("a", "B", 1, true) < 0);
+    CPPUNIT_ASSERT(compareLookupKeys("ab", "AB", 2, true) == 0);
+}
+
+/*!
+ * \brief Tests findInLookupTable() with every key of a table, with prefixes of keys and with keys which are not present.
+ */
+void LookupTableTests::testLookup()
+{
+    for(const auto &entry : sortedTable) {
+        CPPUNIT_ASSERT_EQUAL(entry.value, findInLookupTable(sortedTable, entry.key, false, -1));
+    }
+    for(const auto &entry : caseInsensitiveSortedTable) {
+        CPPUNIT_ASSERT_EQUAL(entry.value, findInLookupTable(caseInsensitiveSortedTable, entry.key, true, -1));
+    }
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, string(), false, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, "C", false, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, "ABC", false, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, "0", false, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, "c", false, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, "ab", false, -1));
+    CPPUNIT_ASSERT_EQUAL(2, findInLookupTable(caseInsensitiveSortedTable, "AB", true, -1));
+    CPPUNIT_ASSERT_EQUAL(5, findInLookupTable(caseInsensitiveSortedTable, "c_", true, -1));
+    CPPUNIT_ASSERT_EQUAL(6, findInLookupTable(caseInsensitiveSortedTable, "CB", true, -1));
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(caseInsensitiveSortedTable, "C", true, -1));
+    // keys containing null characters must not match shorter keys
+    CPPUNIT_ASSERT_EQUAL(-1, findInLookupTable(sortedTable, string("A\0", 2), false, -1));
+}
+
+/*!
+ * \brief Tests the mapping between field IDs and known fields of Matroska tags.
+ */
+void LookupTableTests::testMatroskaTagFields()
+{
+    const MatroskaTag tag;
+    CPPUNIT_ASSERT(checkFieldIdRoundTrip(tag) > 0);
+    CPPUNIT_ASSERT(tag.knownField(string()) == KnownField::Invalid);
+    CPPUNIT_ASSERT(tag.knownField("FOO") == KnownField::Invalid);
+    // Matroska tag names are case-sensitive
+    CPPUNIT_ASSERT(tag.knownField("TITLE") == KnownField::Title);
+    CPPUNIT_ASSERT(tag.knownField("title") == KnownField::Invalid);
+    CPPUNIT_ASSERT(tag.knownField("TITLES") == KnownField::Invalid);
+    CPPUNIT_ASSERT(tag.knownField("TITL") == KnownField::Invalid);
+}
+
+/*!
+ * \brief Tests the mapping between field IDs and known fields of Vorbis comments.
+ */
+void LookupTableTests::testVorbisCommentFields()
+{
+    const VorbisComment comment;
+    CPPUNIT_ASSERT(checkFieldIdRoundTrip(comment) > 0);
+    CPPUNIT_ASSERT(comment.knownField(string()) == KnownField::Invalid);
+    CPPUNIT_ASSERT(comment.knownField("FOO") == KnownField::Invalid);
+    // Vorbis comment field names are case-insensitive
+    for(KnownField field = firstKnownField; field != KnownField::Invalid; field = nextKnownField(field)) {
+        string id = comment.fieldId(field);
+        for(char &c : id) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        CPPUNIT_ASSERT(id.empty() || comment.knownField(id) == field);
+    }
+    CPPUNIT_ASSERT(comment.knownField("Title") == KnownField::Title);
+    CPPUNIT_ASSERT(comment.knownField("TITLES") == KnownField::Invalid);
+}
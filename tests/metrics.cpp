@@ -0,0 +1,230 @@
+#include "../metrics.h"
+#include "../mediafileinfo.h"
+#include "../tag.h"
+
+#include <c++utilities/tests/testutils.h>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cstdio>
+
+using namespace std;
+using namespace TestUtilities;
+using namespace Media;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The MetricsTests class tests recording metrics via MetricsScope and MediaFileInfo::metrics().
+ * \remarks The tests are skipped if metrics are disabled at compile time.
+ */
+class MetricsTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(MetricsTests);
+#ifndef DISABLE_METRICS
+    CPPUNIT_TEST(testNestedScopes);
+    CPPUNIT_TEST(testParsingPhases);
+#ifdef PLATFORM_UNIX
+    CPPUNIT_TEST(testMakingPhases);
+#endif
+#endif
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testNestedScopes();
+    void testParsingPhases();
+#ifdef PLATFORM_UNIX
+    void testMakingPhases();
+#endif
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MetricsTests);
+
+namespace {
+
+constexpr ProcessingPhase parsingPhases[] = {
+    ProcessingPhase::ParsingContainerFormat, ProcessingPhase::ParsingTracks, ProcessingPhase::ParsingTags,
+    ProcessingPhase::ParsingChapters, ProcessingPhase::ParsingAttachments,
+};
+constexpr ProcessingPhase makingPhases[] = {
+    ProcessingPhase::MakingFile, ProcessingPhase::PreparingMaking, ProcessingPhase::WritingMediaData,
+};
+
+/*!
+ * \brief Asserts that the specified counters are equal.
+ */
+void assertCountersEqual(const IoCounters &expected, const IoCounters &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.bytesRead, actual.bytesRead);
+    CPPUNIT_ASSERT_EQUAL(expected.bytesWritten, actual.bytesWritten);
+    CPPUNIT_ASSERT_EQUAL(expected.seekCount, actual.seekCount);
+    CPPUNIT_ASSERT_EQUAL(expected.elementCount, actual.elementCount);
+    CPPUNIT_ASSERT_EQUAL(expected.allocationCount, actual.allocationCount);
+}
+
+}
+
+void MetricsTests::setUp()
+{}
+
+void MetricsTests::tearDown()
+{}
+
+/*!
+ * \brief Tests whether the counters of nested scopes are attributed to each phase but only once to the totals.
+ */
+void MetricsTests::testNestedScopes()
+{
+    Metrics metrics;
+    {
+        MetricsScope outerScope(metrics, ProcessingPhase::MakingFile);
+        IoCounters::countRead(10);
+        {
+            MetricsScope innerScope(metrics, ProcessingPhase::PreparingMaking);
+            IoCounters::countRead(5);
+            IoCounters::countElement();
+            innerScope.stop();
+            // stopping again has no effect; counting after stopping is only attributed to the outer scope
+            innerScope.stop();
+            IoCounters::countSeek();
+        }
+        {
+            MetricsScope innerScope(metrics, ProcessingPhase::WritingMediaData);
+            IoCounters::countRead(100);
+            IoCounters::countWrite(100);
+        }
+        IoCounters::countWrite(1);
+    }
+
+    const PhaseMetrics &making = metrics.phase(ProcessingPhase::MakingFile);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), making.invocations);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(115), making.counters.bytesRead);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(101), making.counters.bytesWritten);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), making.counters.seekCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), making.counters.elementCount);
+
+    const PhaseMetrics &preparing = metrics.phase(ProcessingPhase::PreparingMaking);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), preparing.invocations);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(5), preparing.counters.bytesRead);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(0), preparing.counters.seekCount);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), preparing.counters.elementCount);
+
+    const PhaseMetrics &writing = metrics.phase(ProcessingPhase::WritingMediaData);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), writing.invocations);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(100), writing.counters.bytesRead);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(100), writing.counters.bytesWritten);
+
+    // the totals only contain the counters of the outermost scope
+    assertCountersEqual(making.counters, metrics.counters);
+
+    // another outermost scope adds to the totals
+    {
+        MetricsScope scope(metrics, ProcessingPhase::ParsingTags);
+        IoCounters::countRead(7);
+    }
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(122), metrics.counters.bytesRead);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(7), metrics.phase(ProcessingPhase::ParsingTags).counters.bytesRead);
+
+    metrics.reset();
+    assertCountersEqual(IoCounters(), metrics.counters);
+    for(const PhaseMetrics &phase : metrics.phases) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(0), phase.invocations);
+        assertCountersEqual(IoCounters(), phase.counters);
+    }
+}
+
+/*!
+ * \brief Tests the metrics recorded when parsing files via MediaFileInfo.
+ */
+void MetricsTests::testParsingPhases()
+{
+    for(const char *testFile : {"matroska_wave1/test1.mkv", "mtx-test-data/mp4/10-DanseMacabreOp.40.m4a"}) {
+        MediaFileInfo fileInfo(testFilePath(testFile));
+        fileInfo.open(true);
+        fileInfo.parseEverything();
+        const Metrics &metrics = fileInfo.metrics();
+
+        // all parsing phases have been entered exactly once
+        IoCounters sum;
+        for(const ProcessingPhase phase : parsingPhases) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), metrics.phase(phase).invocations);
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(0), metrics.phase(phase).counters.bytesWritten);
+            sum += metrics.phase(phase).counters;
+        }
+        for(const ProcessingPhase phase : makingPhases) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(0), metrics.phase(phase).invocations);
+        }
+
+        // the elements are read when parsing the container format and the tracks
+        const IoCounters &containerFormat = metrics.phase(ProcessingPhase::ParsingContainerFormat).counters;
+        CPPUNIT_ASSERT(containerFormat.bytesRead > 0);
+        CPPUNIT_ASSERT(containerFormat.elementCount > 0);
+        const IoCounters &tracks = metrics.phase(ProcessingPhase::ParsingTracks).counters;
+        CPPUNIT_ASSERT(tracks.bytesRead > 0 || tracks.elementCount > 0);
+
+        // the parsing phases are not nested so the totals are the sum of the phases
+        assertCountersEqual(sum, metrics.counters);
+        CPPUNIT_ASSERT(metrics.counters.bytesRead > 0);
+        CPPUNIT_ASSERT(metrics.counters.elementCount > 0);
+
+        // parsing again does nothing and hence records nothing
+        const Metrics previousMetrics = metrics;
+        fileInfo.parseEverything();
+        for(const ProcessingPhase phase : parsingPhases) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), metrics.phase(phase).invocations);
+        }
+        assertCountersEqual(previousMetrics.counters, metrics.counters);
+    }
+}
+
+#ifdef PLATFORM_UNIX
+/*!
+ * \brief Tests the metrics recorded when applying changes via MediaFileInfo.
+ * \remarks The phases PreparingMaking and WritingMediaData are nested within MakingFile.
+ */
+void MetricsTests::testMakingPhases()
+{
+    for(const char *testFile : {"matroska_wave1/test1.mkv", "mtx-test-data/mp4/10-DanseMacabreOp.40.m4a"}) {
+        const string path(workingCopyPath(testFile));
+        MediaFileInfo fileInfo(path);
+        fileInfo.open();
+        fileInfo.parseEverything();
+        fileInfo.metrics().reset();
+        fileInfo.setForceRewrite(true);
+        fileInfo.createAppropriateTags();
+        for(Tag *tag : fileInfo.tags()) {
+            tag->setValue(KnownField::Title, TagValue(string("some title")));
+        }
+        fileInfo.applyChanges();
+        const Metrics &metrics = fileInfo.metrics();
+
+        const PhaseMetrics &making = metrics.phase(ProcessingPhase::MakingFile);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(1), making.invocations);
+        CPPUNIT_ASSERT(making.counters.bytesRead > 0);
+        CPPUNIT_ASSERT(making.counters.bytesWritten > 0);
+        for(const ProcessingPhase phase : {ProcessingPhase::PreparingMaking, ProcessingPhase::WritingMediaData}) {
+            const PhaseMetrics &nested = metrics.phase(phase);
+            CPPUNIT_ASSERT(nested.invocations > 0);
+            CPPUNIT_ASSERT(nested.counters.bytesRead <= making.counters.bytesRead);
+            CPPUNIT_ASSERT(nested.counters.bytesWritten <= making.counters.bytesWritten);
+            CPPUNIT_ASSERT(nested.duration <= making.duration);
+        }
+        CPPUNIT_ASSERT(metrics.phase(ProcessingPhase::WritingMediaData).counters.bytesWritten > 0);
+
+        // the nested phases are not counted twice
+        IoCounters sum;
+        for(const ProcessingPhase phase : parsingPhases) {
+            sum += metrics.phase(phase).counters;
+        }
+        sum += making.counters;
+        assertCountersEqual(sum, metrics.counters);
+
+        fileInfo.close();
+        remove(path.c_str());
+        remove((path + ".bak").c_str());
+    }
+}
+#endif
@@ -44,17 +44,33 @@ class OverallTests : public TestFixture
 {
     CPPUNIT_TEST_SUITE(OverallTests);
     CPPUNIT_TEST(testMp4Parsing);
+    CPPUNIT_TEST(testMp4CompactSampleSizes);
     CPPUNIT_TEST(testMp3Parsing);
+    CPPUNIT_TEST(testMp3ParsingWithFrameScanning);
     CPPUNIT_TEST(testOggParsing);
+    CPPUNIT_TEST(testOggParsingLazily);
     CPPUNIT_TEST(testFlacParsing);
+    CPPUNIT_TEST(testAdtsParsing);
     CPPUNIT_TEST(testMkvParsing);
+    CPPUNIT_TEST(testParsingWithMemoryMapping);
+    CPPUNIT_TEST(testParsingTruncatedFilesWithMemoryMapping);
 #ifdef PLATFORM_UNIX
     CPPUNIT_TEST(testMp4Making);
+    CPPUNIT_TEST(testMp4MakingWithProjection);
+    CPPUNIT_TEST(testMp4MakingWithLazyPictures);
     CPPUNIT_TEST(testMp3Making);
+    CPPUNIT_TEST(testMp3MakingWithProjection);
+    CPPUNIT_TEST(testMp3MakingWithLazyPictures);
     CPPUNIT_TEST(testOggMaking);
+    CPPUNIT_TEST(testOggMakingWithProjection);
+    CPPUNIT_TEST(testOggMakingLazily);
     CPPUNIT_TEST(testFlacMaking);
+    CPPUNIT_TEST(testFlacMakingWithLazyPictures);
     CPPUNIT_TEST(testMkvMakingWithDifferentSettings);
     CPPUNIT_TEST(testMkvMakingNestedTags);
+    CPPUNIT_TEST(testMkvMakingCueReferences);
+    CPPUNIT_TEST(testMkvMakingWithProjection);
+    CPPUNIT_TEST(testMkvStreaming);
 #endif
     CPPUNIT_TEST_SUITE_END();
 
@@ -65,6 +81,8 @@ public:
 private:
     void parseFile(const string &path, void (OverallTests::* checkRoutine)(void));
     void makeFile(const string &path, void (OverallTests::* modifyRoutine)(void), void (OverallTests::* checkRoutine)(void));
+    void makeFileWithProjection(const string &testFile);
+    void makeFileWithLazyPictures(const string &testFile);
 
     void checkMkvTestfile1();
     void checkMkvTestfile2();
@@ -89,6 +107,7 @@ private:
     void checkMp4Constraints();
 
     void checkMp3Testfile1();
+    void checkMp3FrameScanning();
     void checkMp3TestMetaData();
     void checkMp3PaddingConstraints();
 
@@ -99,6 +118,8 @@ private:
     void checkFlacTestfile1();
     void checkFlacTestfile2();
 
+    void checkAdtsWithGarbage();
+
     void setMkvTestMetaData();
     void setMp4TestMetaData();
     void setMp3TestMetaData();
@@ -106,22 +127,40 @@ private:
     void removeAllTags();
     void noop();
     void createMkvWithNestedTags();
+    void createMkvWithCueReferences();
+    void createAdtsWithGarbage();
     void alterMp4Tracks();
     void removeSecondTrack();
 
 public:
     void testMkvParsing();
     void testMp4Parsing();
+    void testMp4CompactSampleSizes();
     void testMp3Parsing();
+    void testMp3ParsingWithFrameScanning();
     void testOggParsing();
+    void testOggParsingLazily();
     void testFlacParsing();
+    void testAdtsParsing();
+    void testParsingWithMemoryMapping();
+    void testParsingTruncatedFilesWithMemoryMapping();
 #ifdef PLATFORM_UNIX
     void testMkvMakingWithDifferentSettings();
     void testMkvMakingNestedTags();
+    void testMkvMakingCueReferences();
+    void testMkvMakingWithProjection();
+    void testMkvStreaming();
     void testMp4Making();
+    void testMp4MakingWithProjection();
+    void testMp4MakingWithLazyPictures();
     void testMp3Making();
+    void testMp3MakingWithProjection();
+    void testMp3MakingWithLazyPictures();
     void testOggMaking();
+    void testOggMakingWithProjection();
+    void testOggMakingLazily();
     void testFlacMaking();
+    void testFlacMakingWithLazyPictures();
 #endif
 
 private:
@@ -136,8 +175,10 @@ private:
     string m_testCover;
     queue<TagValue> m_preservedMetaData;
     string m_nestedTagsMkvPath;
+    string m_cueReferencesMkvPath;
     string m_rawFlacPath;
     string m_flacInOggPath;
+    string m_adtsPath;
     TagStatus m_tagStatus;
     uint16 m_mode;
     ElementPosition m_expectedTagPos;
@@ -0,0 +1,121 @@
+#include "./helper.h"
+#include "./overall.h"
+
+#include "../abstracttrack.h"
+#include "../mp4/mp4ids.h"
+
+#include <fstream>
+
+namespace {
+
+constexpr size_t adtsFrameCount = 40;
+constexpr size_t adtsGarbageIndex = 21;
+
+/*!
+ * \brief Returns an ADTS frame of the specified \a size (including the header) containing one
+ *        raw data block of AAC LC audio with 44.1 kHz and two channels.
+ */
+string makeAdtsFrame(uint16 size)
+{
+    string frame(size, '\0');
+    frame[0] = static_cast<char>(0xFF);
+    frame[1] = static_cast<char>(0xF1); // MPEG-4, protection absent
+    frame[2] = static_cast<char>((1 << 6) | (4 << 2)); // AAC LC, sampling frequency index 4 (44.1 kHz)
+    frame[3] = static_cast<char>((2 << 6) | ((size >> 11) & 0x3)); // channel config 2
+    frame[4] = static_cast<char>((size >> 3) & 0xFF);
+    frame[5] = static_cast<char>(((size & 0x7) << 5) | 0x1F); // buffer fullness 0x7FF
+    frame[6] = static_cast<char>(0xFC); // one raw data block
+    return frame;
+}
+
+}
+
+/*!
+ * \brief Creates an ADTS file which contains garbage between the frames.
+ *
+ * The file contains adtsFrameCount frames alternating between 256 and 384 bytes. The garbage is
+ * inserted before frame adtsGarbageIndex and contains a 0xFF byte not followed by a sync word as
+ * well as a sync word not followed by a valid header.
+ */
+void OverallTests::createAdtsWithGarbage()
+{
+    m_adtsPath = workingCopyPathMode("adts/garbage.aac", WorkingCopyMode::NoCopy);
+    cerr << "\n\n- Create testfile \"" << m_adtsPath << "\"" << endl;
+    string data;
+    for(size_t index = 0; index != adtsFrameCount; ++index) {
+        if(index == adtsGarbageIndex) {
+            string garbage(100, '\0');
+            garbage[10] = static_cast<char>(0xFF);
+            garbage[50] = static_cast<char>(0xFF);
+            garbage[51] = static_cast<char>(0xF1);
+            data += garbage;
+        }
+        data += makeAdtsFrame(index % 2 ? 384 : 256);
+    }
+    ofstream file;
+    file.exceptions(ios_base::failbit | ios_base::badbit);
+    file.open(m_adtsPath, ios_base::out | ios_base::trunc | ios_base::binary);
+    file.write(data.data(), static_cast<streamsize>(data.size()));
+}
+
+/*!
+ * \brief Checks the ADTS file created via createAdtsWithGarbage().
+ */
+void OverallTests::checkAdtsWithGarbage()
+{
+    CPPUNIT_ASSERT(m_fileInfo.containerFormat() == ContainerFormat::Adts);
+    const auto tracks = m_fileInfo.tracks();
+    CPPUNIT_ASSERT_EQUAL(1_st, tracks.size());
+    const AbstractTrack &track = *tracks.front();
+    CPPUNIT_ASSERT(track.mediaType() == MediaType::Audio);
+    CPPUNIT_ASSERT(track.format() == GeneralMediaFormat::Aac);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint32>(44100), track.samplingFrequency());
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint16>(2), track.channelCount());
+
+    // each frame contains 1024 samples; the garbage is skipped
+    const double seconds = adtsFrameCount * 1024 / 44100.0;
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(adtsFrameCount * 1024), track.sampleCount());
+    CPPUNIT_ASSERT_EQUAL(ChronoUtilities::TimeSpan::fromSeconds(seconds).totalTicks(), track.duration().totalTicks());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(adtsFrameCount / 2 * (256 + 384) * 8.0 / seconds / 1000.0, track.bitrate(), 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(384 * 8.0 * 44100.0 / 1024.0 / 1000.0, track.maxBitrate(), 0.001);
+
+    // skipping the garbage is reported
+    bool garbageReported = false;
+    for(const Notification &notification : track.notifications()) {
+        CPPUNIT_ASSERT(notification.type() != NotificationType::Critical);
+        garbageReported |= notification.type() == NotificationType::Warning;
+    }
+    CPPUNIT_ASSERT(garbageReported);
+
+    // frame offsets are only recorded if frame scanning is enabled
+    if(!m_fileInfo.isFrameScanningEnabled()) {
+        CPPUNIT_ASSERT(track.frameOffsets().empty());
+        return;
+    }
+    const auto &offsets = track.frameOffsets();
+    CPPUNIT_ASSERT_EQUAL(adtsFrameCount, offsets.size());
+    uint64 expectedOffset = 0;
+    for(size_t index = 0; index != adtsFrameCount; ++index) {
+        if(index == adtsGarbageIndex) {
+            expectedOffset += 100;
+        }
+        CPPUNIT_ASSERT_EQUAL(expectedOffset, offsets[index]);
+        expectedOffset += index % 2 ? 384 : 256;
+    }
+}
+
+/*!
+ * \brief Tests the ADTS parser via MediaFileInfo.
+ * \remarks Checks duration, sample count and bitrate determined by walking through the frames.
+ */
+void OverallTests::testAdtsParsing()
+{
+    cerr << endl << "ADTS parser" << endl;
+    createAdtsWithGarbage();
+    m_fileInfo.setForceFullParse(false);
+    for(const bool frameScanning : {false, true}) {
+        m_fileInfo.setFrameScanningEnabled(frameScanning);
+        parseFile(m_adtsPath, &OverallTests::checkAdtsWithGarbage);
+    }
+    m_fileInfo.setFrameScanningEnabled(false);
+}
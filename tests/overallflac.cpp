@@ -119,4 +119,13 @@ void OverallTests::testFlacMaking()
         makeFile(TestUtilities::workingCopyPath("flac/test.ogg"), modifyRoutine, &OverallTests::checkFlacTestfile2);
     }
 }
+
+/*!
+ * \brief Tests the FLAC maker via MediaFileInfo when the pictures are loaded lazily.
+ */
+void OverallTests::testFlacMakingWithLazyPictures()
+{
+    cerr << endl << "FLAC maker - pictures loaded lazily" << endl;
+    makeFileWithLazyPictures("flac/test.flac");
+}
 #endif
@@ -1,5 +1,16 @@
 #include "./overall.h"
 
+#include "../abstracttrack.h"
+#include "../parsecache.h"
+#include "../tagfieldprojection.h"
+
+#include <c++utilities/io/catchiofailure.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
 CPPUNIT_TEST_SUITE_REGISTRATION(OverallTests);
 
 /*!
@@ -18,7 +29,7 @@ void OverallTests::setUp()
 
 void OverallTests::tearDown()
 {
-    for(const string &file : {m_nestedTagsMkvPath, m_rawFlacPath, m_flacInOggPath}) {
+    for(const string &file : {m_nestedTagsMkvPath, m_cueReferencesMkvPath, m_rawFlacPath, m_flacInOggPath, m_adtsPath}) {
         if(!file.empty()) {
             remove(file.data());
         }
@@ -118,6 +129,190 @@ void OverallTests::makeFile(const string &path, void (OverallTests::*modifyRouti
     remove((path + ".bak").c_str());
 }
 
+/*!
+ * \brief Parses the tags of a working copy of the specified test file using a projection which only includes the title,
+ *        modifies the title and checks whether all other fields are still present after applying the changes.
+ *
+ * The test is done with and without forcing a rewrite so the skipped fields are tested to be preserved when
+ * updating the tags in-place as well as when rewriting the file.
+ */
+void OverallTests::makeFileWithProjection(const string &testFile)
+{
+    for(const bool forceRewrite : {false, true}) {
+        const string path(workingCopyPath(testFile));
+        cerr << "- testing " << path << (forceRewrite ? " (forcing rewrite)" : "") << endl;
+        m_fileInfo.setForceRewrite(forceRewrite);
+        m_fileInfo.setTagPosition(ElementPosition::Keep);
+        m_fileInfo.setIndexPosition(ElementPosition::Keep);
+        m_fileInfo.setForceTagPosition(false);
+        m_fileInfo.setForceIndexPosition(false);
+        m_fileInfo.setMinPadding(0);
+        m_fileInfo.setMaxPadding(static_cast<size_t>(-1));
+
+        // gather all fields of the original file
+        m_fileInfo.setPath(path);
+        m_fileInfo.reopen(true);
+        m_fileInfo.setTagFieldProjection(nullptr);
+        m_fileInfo.parseEverything();
+        vector<TagSnapshot> originalTags;
+        for(const Tag *tag : m_fileInfo.tags()) {
+            originalTags.emplace_back(TagSnapshot::fromTag(*tag));
+        }
+        CPPUNIT_ASSERT(!originalTags.empty());
+
+        // parse the tags using the projection and modify the title
+        m_fileInfo.clearParsingResults();
+        const TagFieldProjection projection{KnownField::Title};
+        m_fileInfo.setTagFieldProjection(&projection);
+        m_fileInfo.parseEverything();
+        bool fieldsSkipped = false;
+        for(Tag *tag : m_fileInfo.tags()) {
+            fieldsSkipped |= tag->hasSkippedFields();
+            tag->setValue(KnownField::Title, m_testTitle);
+        }
+        CPPUNIT_ASSERT_MESSAGE("fields not included in projection skipped", fieldsSkipped);
+        m_fileInfo.applyChanges();
+
+        // reparse the file and check whether only the title has been changed
+        m_fileInfo.clearParsingResults();
+        m_fileInfo.setTagFieldProjection(nullptr);
+        m_fileInfo.parseEverything();
+        const auto tags = m_fileInfo.tags();
+        CPPUNIT_ASSERT_EQUAL(originalTags.size(), tags.size());
+        for(size_t tagIndex = 0; tagIndex != tags.size(); ++tagIndex) {
+            CPPUNIT_ASSERT_EQUAL(m_testTitle.toString(), tags[tagIndex]->value(KnownField::Title).toString(TagTextEncoding::Utf8));
+            auto expectedFields = move(originalTags[tagIndex].fields);
+            auto actualFields = TagSnapshot::fromTag(*tags[tagIndex]).fields;
+            const auto isTitle = [] (const pair<KnownField, TagValue> &field) {
+                return field.first == KnownField::Title;
+            };
+            expectedFields.erase(remove_if(expectedFields.begin(), expectedFields.end(), isTitle), expectedFields.end());
+            actualFields.erase(remove_if(actualFields.begin(), actualFields.end(), isTitle), actualFields.end());
+            CPPUNIT_ASSERT_EQUAL(expectedFields.size(), actualFields.size());
+            for(size_t fieldIndex = 0; fieldIndex != expectedFields.size(); ++fieldIndex) {
+                CPPUNIT_ASSERT(expectedFields[fieldIndex].first == actualFields[fieldIndex].first);
+                CPPUNIT_ASSERT_EQUAL(expectedFields[fieldIndex].second, actualFields[fieldIndex].second);
+            }
+        }
+
+        // close and remove file and backup files
+        m_fileInfo.close();
+        remove(path.c_str());
+        remove((path + ".bak").c_str());
+    }
+    m_fileInfo.setForceRewrite(false);
+}
+
+/*!
+ * \brief Tests loading pictures lazily by parsing and rewriting the specified \a testFile with
+ *        setLazyPictureLoadingEnabled(true).
+ * \remarks The file is provided with a cover first which is big enough to be loaded lazily.
+ */
+void OverallTests::makeFileWithLazyPictures(const string &testFile)
+{
+    const string path(workingCopyPath(testFile));
+    cerr << "- testing " << path << endl;
+    m_fileInfo.setTagPosition(ElementPosition::Keep);
+    m_fileInfo.setIndexPosition(ElementPosition::Keep);
+    m_fileInfo.setForceTagPosition(false);
+    m_fileInfo.setForceIndexPosition(false);
+    m_fileInfo.setMinPadding(0);
+    m_fileInfo.setMaxPadding(static_cast<size_t>(-1));
+    m_fileInfo.setLazyPictureLoadingEnabled(false);
+
+    // assign a cover to all tags
+    string coverData("\x89PNG\r\n\x1A\n", 8);
+    for(size_t i = 0; coverData.size() < 0x4000; ++i) {
+        coverData.push_back(static_cast<char>(i * 7));
+    }
+    TagValue cover(coverData.data(), coverData.size(), TagDataType::Picture);
+    cover.setMimeType("image/png");
+    m_fileInfo.setPath(path);
+    m_fileInfo.reopen(true);
+    m_fileInfo.parseEverything();
+    for(Tag *tag : m_fileInfo.tags()) {
+        if(tag->supportsField(KnownField::Cover)) {
+            tag->setValue(KnownField::Cover, cover);
+        }
+    }
+    m_fileInfo.applyChanges();
+
+    // gather the covers when parsing eagerly
+    m_fileInfo.clearParsingResults();
+    m_fileInfo.parseEverything();
+    vector<TagValue> eagerCovers;
+    for(const Tag *tag : m_fileInfo.tags()) {
+        const TagValue &value = tag->value(KnownField::Cover);
+        if(!value.isEmpty()) {
+            CPPUNIT_ASSERT(value.isDataLoaded());
+            CPPUNIT_ASSERT_EQUAL(coverData, string(value.dataPointer(), value.dataSize()));
+            eagerCovers.emplace_back(value);
+        }
+    }
+    CPPUNIT_ASSERT(!eagerCovers.empty());
+
+    // parse lazily and check whether the covers are only loaded on demand
+    m_fileInfo.clearParsingResults();
+    m_fileInfo.setLazyPictureLoadingEnabled(true);
+    m_fileInfo.parseEverything();
+    vector<TagValue> copiedCovers;
+    for(const Tag *tag : m_fileInfo.tags()) {
+        const TagValue &value = tag->value(KnownField::Cover);
+        if(value.isEmpty()) {
+            continue;
+        }
+        CPPUNIT_ASSERT(!value.isDataLoaded());
+        CPPUNIT_ASSERT_EQUAL(coverData.size(), value.dataSize());
+        stringstream copiedData(ios_base::in | ios_base::out | ios_base::binary);
+        value.copyDataTo(copiedData);
+        CPPUNIT_ASSERT_EQUAL(coverData, copiedData.str());
+        CPPUNIT_ASSERT(!value.isDataLoaded());
+        // copies must not refer to the file which is closed below
+        copiedCovers.emplace_back(value);
+        CPPUNIT_ASSERT(copiedCovers.back().isDataLoaded());
+        CPPUNIT_ASSERT(!value.isDataLoaded());
+    }
+    m_fileInfo.close();
+    CPPUNIT_ASSERT_EQUAL(eagerCovers.size(), copiedCovers.size());
+    for(size_t i = 0; i != copiedCovers.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(eagerCovers[i], copiedCovers[i]);
+    }
+
+    // apply changes with pending lazy covers
+    for(const bool forceRewrite : {false, true}) {
+        m_fileInfo.setForceRewrite(forceRewrite);
+        m_fileInfo.clearParsingResults();
+        m_fileInfo.setLazyPictureLoadingEnabled(true);
+        m_fileInfo.reopen(true);
+        m_fileInfo.parseEverything();
+        for(Tag *tag : m_fileInfo.tags()) {
+            tag->setValue(KnownField::Title, m_testTitle);
+        }
+        m_fileInfo.applyChanges();
+
+        m_fileInfo.clearParsingResults();
+        m_fileInfo.setLazyPictureLoadingEnabled(false);
+        m_fileInfo.parseEverything();
+        vector<TagValue> covers;
+        for(const Tag *tag : m_fileInfo.tags()) {
+            const TagValue &value = tag->value(KnownField::Cover);
+            if(!value.isEmpty()) {
+                covers.emplace_back(value);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(eagerCovers.size(), covers.size());
+        for(size_t i = 0; i != covers.size(); ++i) {
+            CPPUNIT_ASSERT_EQUAL(eagerCovers[i], covers[i]);
+        }
+    }
+
+    // close and remove file and backup files
+    m_fileInfo.setForceRewrite(false);
+    m_fileInfo.close();
+    remove(path.c_str());
+    remove((path + ".bak").c_str());
+}
+
 /*!
  * \brief Removes all tags.
  */
@@ -143,3 +338,102 @@ void OverallTests::removeSecondTrack()
     CPPUNIT_ASSERT(m_fileInfo.container()->trackCount() >= 2);
     m_fileInfo.container()->removeTrack(m_fileInfo.container()->track(1));
 }
+
+namespace {
+
+/*!
+ * \brief Returns a textual summary of the parsing results of the specified \a fileInfo.
+ * \remarks Parses everything if not done yet. IO errors are included in the summary.
+ */
+string summarizeParsingResults(MediaFileInfo &fileInfo)
+{
+    stringstream summary;
+    try {
+        fileInfo.parseEverything();
+    } catch(...) {
+        summary << "IO error: " << IoUtilities::catchIoFailure() << '\n';
+    }
+    summary << "container format: " << static_cast<unsigned int>(fileInfo.containerFormat()) << '\n';
+    for(const AbstractTrack *track : fileInfo.tracks()) {
+        summary << "track " << track->id() << ": " << track->formatName() << ", " << track->duration().totalTicks()
+                << ", " << track->sampleCount() << ", " << track->size() << '\n';
+    }
+    summary << "tags: " << fileInfo.tags().size() << ", chapters: " << fileInfo.chapters().size()
+            << ", attachments: " << fileInfo.attachments().size() << '\n';
+    NotificationList notifications;
+    fileInfo.gatherRelatedNotifications(notifications);
+    for(const Notification &notification : notifications) {
+        summary << static_cast<unsigned int>(notification.type()) << ' ' << notification.context() << ": " << notification.message() << '\n';
+    }
+    return summary.str();
+}
+
+}
+
+/*!
+ * \brief Runs the parser tests again with memory mapping enabled.
+ * \remarks Ensures parsing element headers from the mapped memory (see BasicFileInfo::mappedRange())
+ *          leads to the same results as parsing them via the stream.
+ */
+void OverallTests::testParsingWithMemoryMapping()
+{
+    cerr << endl << "Parsers with memory mapping" << endl;
+    m_fileInfo.setMemoryMappingEnabled(true);
+#ifdef PLATFORM_UNIX
+    m_fileInfo.setPath(TestUtilities::testFilePath("matroska_wave1/test1.mkv"));
+    m_fileInfo.reopen(true);
+    CPPUNIT_ASSERT(m_fileInfo.isMapped());
+    m_fileInfo.close();
+    CPPUNIT_ASSERT(!m_fileInfo.isMapped());
+#endif
+    testMkvParsing();
+    testMp4Parsing();
+    testMp3Parsing();
+    testOggParsing();
+    testFlacParsing();
+    m_fileInfo.setMemoryMappingEnabled(false);
+}
+
+/*!
+ * \brief Tests parsing truncated files with and without memory mapping.
+ * \remarks The results must be equal. Element headers at the end of the truncated files are only partially
+ *          mapped so the bounds checks of BasicFileInfo::mappedRange() must make the parsers fall back to the stream.
+ */
+void OverallTests::testParsingTruncatedFilesWithMemoryMapping()
+{
+    cerr << endl << "Parsers with memory mapping - truncated files" << endl;
+    m_fileInfo.setForceFullParse(false);
+    for(const char *testFile : {"matroska_wave1/test1.mkv", "mtx-test-data/mp4/10-DanseMacabreOp.40.m4a",
+                                "mtx-test-data/ogg/qt4dance_medium.ogg", "mtx-test-data/mp3/id3-tag-and-xing-header.mp3"}) {
+        ifstream originalFile;
+        originalFile.exceptions(ios_base::failbit | ios_base::badbit);
+        originalFile.open(TestUtilities::testFilePath(testFile), ios_base::in | ios_base::binary);
+        const string data((istreambuf_iterator<char>(originalFile)), istreambuf_iterator<char>());
+        originalFile.close();
+        const string path(workingCopyPathMode(string(testFile) + ".truncated", WorkingCopyMode::NoCopy));
+        for(const size_t size : {data.size() / 8, data.size() / 2, data.size() - data.size() / 8, data.size() - 1}) {
+            cerr << "- testing " << testFile << " truncated to " << size << " bytes" << endl;
+            {
+                ofstream truncatedFile;
+                truncatedFile.exceptions(ios_base::failbit | ios_base::badbit);
+                truncatedFile.open(path, ios_base::out | ios_base::trunc | ios_base::binary);
+                truncatedFile.write(data.data(), static_cast<streamsize>(size));
+            }
+            m_fileInfo.setPath(path);
+            string summaries[2];
+            for(const bool memoryMapping : {false, true}) {
+                m_fileInfo.setMemoryMappingEnabled(memoryMapping);
+                m_fileInfo.clearParsingResults();
+                m_fileInfo.reopen(true);
+#ifdef PLATFORM_UNIX
+                CPPUNIT_ASSERT_EQUAL(memoryMapping, m_fileInfo.isMapped());
+#endif
+                summaries[memoryMapping] = summarizeParsingResults(m_fileInfo);
+                m_fileInfo.close();
+            }
+            CPPUNIT_ASSERT_EQUAL(summaries[false], summaries[true]);
+        }
+        remove(path.c_str());
+    }
+    m_fileInfo.setMemoryMappingEnabled(false);
+}
@@ -4,12 +4,14 @@
 #include "../mpegaudio/mpegaudioframe.h"
 #include "../mp4/mp4ids.h"
 #include "../matroska/matroskacontainer.h"
+#include "../streamingparser.h"
 
 #include <c++utilities/conversion/binaryconversion.h>
 #include <c++utilities/io/misc.h>
 
 #include <fstream>
 #include <cstring>
+#include <algorithm>
 
 namespace MkvTestFlags {
 enum TestFlag
@@ -26,6 +28,85 @@ enum TestFlag
 };
 }
 
+namespace {
+
+/*!
+ * \brief Returns an EBML element with the specified \a id and \a data.
+ */
+string makeEbmlElement(EbmlElement::identifierType id, const string &data)
+{
+    char buff[8];
+    string element(buff, EbmlElement::makeId(id, buff));
+    element.append(buff, EbmlElement::makeSizeDenotation(data.size(), buff));
+    return element + data;
+}
+
+/*!
+ * \brief Returns an EBML element with the specified \a id containing the specified unsigned integer \a value.
+ */
+string makeEbmlUInt(EbmlElement::identifierType id, uint64 value)
+{
+    char buff[8];
+    return makeEbmlElement(id, string(buff, EbmlElement::makeUInteger(value, buff)));
+}
+
+/*!
+ * \brief The CueReferenceInfo struct describes a "CueReference"-element using the indexes of the referenced clusters.
+ */
+struct CueReferenceInfo
+{
+    uint64 cueTime;
+    size_t clusterIndex;
+    uint64 refTime;
+    size_t refClusterIndex;
+
+    bool operator ==(const CueReferenceInfo &other) const
+    {
+        return cueTime == other.cueTime && clusterIndex == other.clusterIndex && refTime == other.refTime && refClusterIndex == other.refClusterIndex;
+    }
+};
+
+/*!
+ * \brief Gathers the "CueReference"-elements of the first segment of the specified \a fileInfo.
+ * \remarks Positions which do not point to a "Cluster"-element are mapped to std::string::npos.
+ */
+vector<CueReferenceInfo> gatherCueReferences(MediaFileInfo &fileInfo)
+{
+    CPPUNIT_ASSERT_EQUAL(ContainerFormat::Matroska, fileInfo.containerFormat());
+    EbmlElement *const segment = static_cast<MatroskaContainer *>(fileInfo.container())->firstElement()->siblingById(MatroskaIds::Segment, true);
+    CPPUNIT_ASSERT(segment);
+    vector<uint64> clusterPositions;
+    for(EbmlElement *child = segment->firstChild(); child; child = child->nextSibling()) {
+        child->parse();
+        if(child->id() == MatroskaIds::Cluster) {
+            clusterPositions.push_back(child->startOffset() - segment->dataOffset());
+        }
+    }
+    const auto clusterIndex = [&clusterPositions] (uint64 position) -> size_t {
+        const auto i = find(clusterPositions.cbegin(), clusterPositions.cend(), position);
+        return i != clusterPositions.cend() ? static_cast<size_t>(i - clusterPositions.cbegin()) : string::npos;
+    };
+    EbmlElement *const cues = segment->childById(MatroskaIds::Cues);
+    CPPUNIT_ASSERT(cues);
+    vector<CueReferenceInfo> references;
+    for(EbmlElement *cuePoint = cues->childById(MatroskaIds::CuePoint); cuePoint; cuePoint = cuePoint->siblingById(MatroskaIds::CuePoint)) {
+        EbmlElement *const cueTime = cuePoint->childById(MatroskaIds::CueTime);
+        EbmlElement *const cueTrackPositions = cuePoint->childById(MatroskaIds::CueTrackPositions);
+        CPPUNIT_ASSERT(cueTime && cueTrackPositions);
+        EbmlElement *const cueClusterPosition = cueTrackPositions->childById(MatroskaIds::CueClusterPosition);
+        CPPUNIT_ASSERT(cueClusterPosition);
+        for(EbmlElement *cueReference = cueTrackPositions->childById(MatroskaIds::CueReference); cueReference; cueReference = cueReference->siblingById(MatroskaIds::CueReference)) {
+            EbmlElement *const refTime = cueReference->childById(MatroskaIds::CueRefTime);
+            EbmlElement *const refCluster = cueReference->childById(MatroskaIds::CueRefCluster);
+            CPPUNIT_ASSERT(refTime && refCluster);
+            references.emplace_back(CueReferenceInfo{cueTime->readUInteger(), clusterIndex(cueClusterPosition->readUInteger()), refTime->readUInteger(), clusterIndex(refCluster->readUInteger())});
+        }
+    }
+    return references;
+}
+
+}
+
 /*!
  * \brief Checks "matroska_wave1/test1.mkv".
  */
@@ -735,5 +816,159 @@ void OverallTests::testMkvMakingNestedTags()
         makeFile(m_nestedTagsMkvPath, &OverallTests::noop, &OverallTests::checkMkvTestfileNestedTags);
     }
 }
-#endif
 
+/*!
+ * \brief Tests the Matroska maker via MediaFileInfo when the "SimpleTag"-elements have only partially been parsed.
+ * \remarks Relies on the parser to check results.
+ */
+void OverallTests::testMkvMakingWithProjection()
+{
+    cerr << endl << "Matroska maker - tags parsed using projection" << endl;
+    makeFileWithProjection("matroska_wave1/test1.mkv");
+}
+
+/*!
+ * \brief Tests the Matroska parser via StreamingParser.
+ *
+ * The tag of "matroska_wave1/test1.mkv" is moved before the media data first because tags located
+ * after the first "Cluster"-element can not be read when parsing forward-only.
+ */
+void OverallTests::testMkvStreaming()
+{
+    cerr << endl << "Matroska streaming parser" << endl;
+    const string path(workingCopyPath("matroska_wave1/test1.mkv"));
+    cerr << "- testing " << path << endl;
+    MediaFileInfo fileInfo(path);
+    fileInfo.open();
+    fileInfo.parseEverything();
+    fileInfo.setTagPosition(ElementPosition::BeforeData);
+    fileInfo.setForceTagPosition(true);
+    fileInfo.applyChanges();
+    fileInfo.close();
+
+    ifstream file;
+    file.exceptions(ios_base::failbit | ios_base::badbit);
+    file.open(path, ios_base::in | ios_base::binary);
+    StreamingParser parser(file);
+    parser.parse();
+    CPPUNIT_ASSERT_EQUAL(ContainerFormat::Matroska, parser.containerFormat());
+    const auto &tracks = parser.tracks();
+    CPPUNIT_ASSERT_EQUAL(2_st, tracks.size());
+    for(const auto &track : tracks) {
+        switch(track.id) {
+        case 2422994868:
+            CPPUNIT_ASSERT_EQUAL(MediaType::Video, track.mediaType);
+            CPPUNIT_ASSERT_EQUAL(GeneralMediaFormat::MicrosoftMpeg4, track.format.general);
+            break;
+        case 3653291187:
+            CPPUNIT_ASSERT_EQUAL(MediaType::Audio, track.mediaType);
+            CPPUNIT_ASSERT_EQUAL(GeneralMediaFormat::Mpeg1Audio, track.format.general);
+            CPPUNIT_ASSERT_EQUAL(48000u, track.samplingFrequency);
+            break;
+        default:
+            CPPUNIT_FAIL("unknown track ID");
+        }
+    }
+    CPPUNIT_ASSERT(!(parser.unavailableInformation() & UnavailableInformation::TrailingTags));
+    const auto &tags = parser.tags();
+    CPPUNIT_ASSERT_EQUAL(1_st, tags.size());
+    CPPUNIT_ASSERT_EQUAL("Big Buck Bunny - test 1"s, tags.front()->value(KnownField::Title).toString());
+    CPPUNIT_ASSERT_EQUAL("Matroska Validation File1, basic MPEG4.2 and MP3 with only SimpleBlock"s, tags.front()->value(KnownField::Comment).toString());
+    file.close();
+    remove(path.data());
+}
+
+/*!
+ * \brief Creates a Matroska test file with "CueReference"-elements.
+ *
+ * The file contains a single audio track and some clusters. The "CuePoint"-element for each cluster except the first one
+ * contains a "CueReference"-element referring to the previous cluster. The "Cues"-element is located after the clusters.
+ */
+void OverallTests::createMkvWithCueReferences()
+{
+    constexpr uint32 clusterCount = 4, blocksPerCluster = 2;
+    m_cueReferencesMkvPath = workingCopyPathMode("mtx-test-data/mkv/cue-references.mkv", WorkingCopyMode::NoCopy);
+    cerr << "\n\n- Create testfile \"" << m_cueReferencesMkvPath << "\"" << endl;
+    const string header = makeEbmlElement(EbmlIds::Header,
+                                          makeEbmlUInt(EbmlIds::Version, 1) + makeEbmlUInt(EbmlIds::ReadVersion, 1)
+                                          + makeEbmlUInt(EbmlIds::MaxIdLength, 4) + makeEbmlUInt(EbmlIds::MaxSizeLength, 8)
+                                          + makeEbmlElement(EbmlIds::DocType, "matroska")
+                                          + makeEbmlUInt(EbmlIds::DocTypeVersion, 4) + makeEbmlUInt(EbmlIds::DocTypeReadVersion, 2));
+    const string info = makeEbmlElement(MatroskaIds::SegmentInfo, makeEbmlUInt(MatroskaIds::TimeCodeScale, 1000000));
+    const string tracks = makeEbmlElement(MatroskaIds::Tracks, makeEbmlElement(MatroskaIds::TrackEntry,
+                                          makeEbmlUInt(MatroskaIds::TrackNumber, 1) + makeEbmlUInt(MatroskaIds::TrackUID, 0x1234)
+                                          + makeEbmlUInt(MatroskaIds::TrackType, 2) + makeEbmlElement(MatroskaIds::CodecID, "A_PCM/INT/LIT")
+                                          + makeEbmlElement(MatroskaIds::TrackAudio, makeEbmlUInt(MatroskaIds::Channels, 2))));
+    string clusters, cuePoints;
+    uint64 previousClusterPosition = 0;
+    for(uint32 index = 0; index != clusterCount; ++index) {
+        const uint64 clusterPosition = info.size() + tracks.size() + clusters.size();
+        string cluster = makeEbmlUInt(MatroskaIds::Timecode, index * 1000u);
+        for(uint32 blockIndex = 0; blockIndex != blocksPerCluster; ++blockIndex) {
+            string block("\x81\x00\x00\x80", 4); // track number, relative timecode, flags (keyframe)
+            block.append(0x100, static_cast<char>(index));
+            cluster += makeEbmlElement(MatroskaIds::SimpleBlock, block);
+        }
+        clusters += makeEbmlElement(MatroskaIds::Cluster, cluster);
+        string cueTrackPositions = makeEbmlUInt(MatroskaIds::CueTrack, 1) + makeEbmlUInt(MatroskaIds::CueClusterPosition, clusterPosition);
+        if(index) {
+            cueTrackPositions += makeEbmlElement(MatroskaIds::CueReference,
+                                                 makeEbmlUInt(MatroskaIds::CueRefTime, (index - 1) * 1000u)
+                                                 + makeEbmlUInt(MatroskaIds::CueRefCluster, previousClusterPosition));
+        }
+        cuePoints += makeEbmlElement(MatroskaIds::CuePoint, makeEbmlUInt(MatroskaIds::CueTime, index * 1000u) + makeEbmlElement(MatroskaIds::CueTrackPositions, cueTrackPositions));
+        previousClusterPosition = clusterPosition;
+    }
+    ofstream file;
+    file.exceptions(ios_base::failbit | ios_base::badbit);
+    file.open(m_cueReferencesMkvPath, ios_base::out | ios_base::trunc | ios_base::binary);
+    file << header << makeEbmlElement(MatroskaIds::Segment, info + tracks + clusters + makeEbmlElement(MatroskaIds::Cues, cuePoints));
+}
+
+/*!
+ * \brief Tests the Matroska maker via MediaFileInfo when the "Cues"-element contains "CueReference"-elements.
+ * \remarks The "CueRefCluster"-elements must still refer to the same clusters after the file has been rewritten.
+ */
+void OverallTests::testMkvMakingCueReferences()
+{
+    cerr << endl << "Matroska maker - rewrite file with cue references" << endl;
+    for(const ElementPosition indexPosition : {ElementPosition::BeforeData, ElementPosition::AfterData}) {
+        createMkvWithCueReferences();
+        m_fileInfo.setPath(m_cueReferencesMkvPath);
+        m_fileInfo.reopen(true);
+        m_fileInfo.parseEverything();
+        const auto originalReferences = gatherCueReferences(m_fileInfo);
+        CPPUNIT_ASSERT_EQUAL(3_st, originalReferences.size());
+        for(const CueReferenceInfo &reference : originalReferences) {
+            CPPUNIT_ASSERT_EQUAL(reference.clusterIndex - 1, reference.refClusterIndex);
+        }
+
+        // add a tag before the clusters so the positions of the clusters change
+        m_fileInfo.setForceRewrite(true);
+        m_fileInfo.setTagPosition(ElementPosition::BeforeData);
+        m_fileInfo.setForceTagPosition(true);
+        m_fileInfo.setIndexPosition(indexPosition);
+        m_fileInfo.setForceIndexPosition(true);
+        m_fileInfo.createAppropriateTags();
+        CPPUNIT_ASSERT(!m_fileInfo.tags().empty());
+        m_fileInfo.tags().front()->setValue(KnownField::Title, m_testTitle);
+        m_fileInfo.applyChanges();
+        CPPUNIT_ASSERT(m_fileInfo.worstNotificationTypeIncludingRelatedObjects() != NotificationType::Critical);
+
+        // reparse the file and check whether the references still refer to the same clusters
+        m_fileInfo.clearParsingResults();
+        m_fileInfo.parseEverything();
+        CPPUNIT_ASSERT_EQUAL(1_st, m_fileInfo.tags().size());
+        const auto references = gatherCueReferences(m_fileInfo);
+        CPPUNIT_ASSERT(originalReferences == references);
+
+        m_fileInfo.close();
+        remove((m_cueReferencesMkvPath + ".bak").data());
+    }
+    m_fileInfo.setForceRewrite(false);
+    m_fileInfo.setTagPosition(ElementPosition::Keep);
+    m_fileInfo.setForceTagPosition(false);
+    m_fileInfo.setIndexPosition(ElementPosition::Keep);
+    m_fileInfo.setForceIndexPosition(false);
+}
+#endif
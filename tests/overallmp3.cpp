@@ -6,6 +6,9 @@
 #include "../id3/id3v1tag.h"
 #include "../id3/id3v2tag.h"
 
+#include <c++utilities/conversion/binaryconversion.h>
+#include <c++utilities/io/binaryreader.h>
+
 namespace Mp3TestFlags {
 enum TestFlag
 {
@@ -82,6 +85,39 @@ void OverallTests::checkMp3Testfile1()
 
 }
 
+/*!
+ * \brief Checks the results of scanning the frames of "mtx-test-data/mp3/id3-tag-and-xing-header.mp3".
+ */
+void OverallTests::checkMp3FrameScanning()
+{
+    checkMp3Testfile1();
+    const auto tracks = m_fileInfo.tracks();
+    const AbstractTrack &track = *tracks.front();
+    const auto &offsets = track.frameOffsets();
+    CPPUNIT_ASSERT(offsets.size() > 2);
+    // each MPEG-1 layer 3 frame contains 1152 samples; the frame containing the Xing header is skipped
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(offsets.size()) * 1152, track.sampleCount());
+    CPPUNIT_ASSERT_EQUAL(ChronoUtilities::TimeSpan::fromSeconds(static_cast<double>(track.sampleCount()) / 44100.0).totalTicks(), track.duration().totalTicks());
+    CPPUNIT_ASSERT(track.bitrate() > 0.0);
+    CPPUNIT_ASSERT(track.maxBitrate() > 0.0);
+
+    // the first audio frame follows the frame containing the Xing header
+    BinaryReader reader(&m_fileInfo.stream());
+    m_fileInfo.stream().seekg(static_cast<streamoff>(track.startOffset()));
+    MpegAudioFrame xingFrame;
+    xingFrame.parseHeader(reader);
+    CPPUNIT_ASSERT(xingFrame.isXingHeaderAvailable());
+    CPPUNIT_ASSERT_EQUAL(track.startOffset() + xingFrame.size(), offsets.front());
+
+    // subsequent frames directly follow each other
+    for(size_t i = 0, count = min<size_t>(offsets.size() - 1, 10); i != count; ++i) {
+        m_fileInfo.stream().seekg(static_cast<streamoff>(offsets[i]));
+        const MpegAudioFrame frame(reader.readUInt32BE());
+        CPPUNIT_ASSERT(frame.isValid());
+        CPPUNIT_ASSERT_EQUAL(offsets[i] + frame.size(), offsets[i + 1]);
+    }
+}
+
 /*!
  * \brief Checks whether test meta data for MP3 files has been applied correctly.
  */
@@ -215,6 +251,19 @@ void OverallTests::testMp3Parsing()
     parseFile(TestUtilities::testFilePath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"), &OverallTests::checkMp3Testfile1);
 }
 
+/*!
+ * \brief Tests the MP3 parser via MediaFileInfo with frame scanning enabled.
+ */
+void OverallTests::testMp3ParsingWithFrameScanning()
+{
+    cerr << endl << "MP3 parser (scanning frames)" << endl;
+    m_fileInfo.setForceFullParse(false);
+    m_fileInfo.setFrameScanningEnabled(true);
+    m_tagStatus = TagStatus::Original;
+    parseFile(TestUtilities::testFilePath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"), &OverallTests::checkMp3FrameScanning);
+    m_fileInfo.setFrameScanningEnabled(false);
+}
+
 #ifdef PLATFORM_UNIX
 /*!
  * \brief Tests the MP3 maker via MediaFileInfo.
@@ -274,4 +323,23 @@ void OverallTests::testMp3Making()
         makeFile(TestUtilities::workingCopyPath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"), modifyRoutine, &OverallTests::checkMp3Testfile1);
     }
 }
+
+/*!
+ * \brief Tests the MP3 maker via MediaFileInfo when the ID3v2 frames have only partially been parsed.
+ * \remarks Relies on the parser to check results.
+ */
+void OverallTests::testMp3MakingWithProjection()
+{
+    cerr << endl << "MP3 maker - tags parsed using projection" << endl;
+    makeFileWithProjection("mtx-test-data/mp3/id3-tag-and-xing-header.mp3");
+}
+
+/*!
+ * \brief Tests the MP3 maker via MediaFileInfo when the ID3v2 pictures are loaded lazily.
+ */
+void OverallTests::testMp3MakingWithLazyPictures()
+{
+    cerr << endl << "MP3 maker - pictures loaded lazily" << endl;
+    makeFileWithLazyPictures("mtx-test-data/mp3/id3-tag-and-xing-header.mp3");
+}
 #endif
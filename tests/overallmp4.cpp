@@ -6,6 +6,8 @@
 #include "../mp4/mp4tag.h"
 #include "../mp4/mp4container.h"
 
+#include <fstream>
+
 namespace Mp4TestFlags {
 enum TestFlag
 {
@@ -433,6 +435,70 @@ void OverallTests::testMp4Parsing()
     parseFile(TestUtilities::testFilePath("mtx-test-data/aac/he-aacv2-ps.m4a"), &OverallTests::checkMp4Testfile5);
 }
 
+/*!
+ * \brief Tests parsing a compact sample size table ("stz2" atom) using 4-bit fields.
+ * \remarks The "stsz" atom of a working copy of "mtx-test-data/mp4/10-DanseMacabreOp.40.m4a" is replaced by
+ *          a "stz2" atom of the same size storing an odd number of entries.
+ */
+void OverallTests::testMp4CompactSampleSizes()
+{
+    cerr << endl << "MP4 parser - compact sample size table" << endl;
+    const string path(TestUtilities::workingCopyPath("mtx-test-data/mp4/10-DanseMacabreOp.40.m4a"));
+
+    // determine the position of the sample size table of the first track
+    m_fileInfo.setPath(path);
+    m_fileInfo.reopen(true);
+    m_fileInfo.parseEverything();
+    const auto tracks = m_fileInfo.tracks();
+    CPPUNIT_ASSERT(!tracks.empty());
+    CPPUNIT_ASSERT_EQUAL(TrackType::Mp4Track, tracks[0]->type());
+    auto *track = static_cast<Mp4Track *>(tracks[0]);
+    const Mp4Atom *const stszAtom = track->trakAtom().subelementByPath({Mp4AtomIds::Track, Mp4AtomIds::Media, Mp4AtomIds::MediaInformation, Mp4AtomIds::SampleTable, Mp4AtomIds::SampleSize});
+    CPPUNIT_ASSERT(stszAtom);
+    CPPUNIT_ASSERT_EQUAL(8u, stszAtom->headerSize());
+    const uint64 atomOffset = stszAtom->startOffset();
+    const auto atomSize = static_cast<uint32>(stszAtom->totalSize());
+    CPPUNIT_ASSERT(atomSize > 20);
+    m_fileInfo.close();
+    m_fileInfo.clearParsingResults();
+
+    // replace it with a "stz2" atom
+    const uint32 sampleCount = (atomSize - 20) * 2 - 1;
+    string atom(atomSize, '\0');
+    BE::getBytes(atomSize, &atom[0]);
+    BE::getBytes(static_cast<uint32>(Mp4AtomIds::CompactSampleSize), &atom[4]);
+    atom[15] = 4; // field size
+    BE::getBytes(sampleCount, &atom[16]);
+    vector<uint32> expectedSampleSizes;
+    uint64 expectedSize = 0;
+    for(uint32 i = 0; i != sampleCount; ++i) {
+        const uint32 sampleSize = (i * 7 + 3) & 0x0F;
+        expectedSampleSizes.push_back(sampleSize);
+        expectedSize += sampleSize;
+        atom[20 + i / 2] |= static_cast<char>(i % 2 ? sampleSize : sampleSize << 4);
+    }
+    {
+        fstream file(path, ios_base::in | ios_base::out | ios_base::binary);
+        file.seekp(static_cast<streamoff>(atomOffset));
+        file.write(atom.data(), static_cast<streamsize>(atom.size()));
+        CPPUNIT_ASSERT(file.good());
+    }
+
+    // parse the file again and check the sample sizes
+    m_fileInfo.reopen(true);
+    m_fileInfo.parseEverything();
+    const auto reparsedTracks = m_fileInfo.tracks();
+    CPPUNIT_ASSERT(!reparsedTracks.empty());
+    track = static_cast<Mp4Track *>(reparsedTracks[0]);
+    CPPUNIT_ASSERT_EQUAL(static_cast<uint64>(sampleCount), track->sampleCount());
+    CPPUNIT_ASSERT(expectedSampleSizes == track->sampleSizes());
+    CPPUNIT_ASSERT_EQUAL(expectedSize, track->size());
+
+    m_fileInfo.close();
+    m_fileInfo.clearParsingResults();
+    remove(path.c_str());
+}
+
 #ifdef PLATFORM_UNIX
 /*!
  * \brief Tests the MP4 maker via MediaFileInfo.
@@ -501,4 +567,23 @@ void OverallTests::testMp4Making()
         makeFile(TestUtilities::workingCopyPath("mtx-test-data/mp4/1080p-DTS-HD-7.1.mp4"), modifyRoutine, &OverallTests::checkMp4Testfile6);
     }
 }
+
+/*!
+ * \brief Tests the MP4 maker via MediaFileInfo when the tag atoms have only partially been parsed.
+ * \remarks Relies on the parser to check results.
+ */
+void OverallTests::testMp4MakingWithProjection()
+{
+    cerr << endl << "MP4 maker - tags parsed using projection" << endl;
+    makeFileWithProjection("mtx-test-data/mp4/10-DanseMacabreOp.40.m4a");
+}
+
+/*!
+ * \brief Tests the MP4 maker via MediaFileInfo when the covers are loaded lazily.
+ */
+void OverallTests::testMp4MakingWithLazyPictures()
+{
+    cerr << endl << "MP4 maker - pictures loaded lazily" << endl;
+    makeFileWithLazyPictures("mtx-test-data/mp4/10-DanseMacabreOp.40.m4a");
+}
 #endif
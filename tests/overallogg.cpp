@@ -5,6 +5,8 @@
 #include "../abstracttrack.h"
 #include "../vorbis/vorbiscomment.h"
 
+#include <tuple>
+
 /*!
  * \brief Checks "mtx-test-data/ogg/qt4dance_medium.ogg"
  */
@@ -131,6 +133,51 @@ void OverallTests::testOggParsing()
     parseFile(TestUtilities::testFilePath("mtx-test-data/opus/v-opus.ogg"), &OverallTests::checkOggTestfile2);
 }
 
+/*!
+ * \brief Tests the Ogg parser via MediaFileInfo with lazy parsing enabled.
+ * \remarks The duration and the sample count of the tracks are compared with the results of a full parse. The
+ *          size of the streams is only approximated if there is just one stream.
+ */
+void OverallTests::testOggParsingLazily()
+{
+    cerr << endl << "OGG parser - lazy parsing" << endl;
+    m_fileInfo.setForceFullParse(false);
+    for(const char *testFile : {"mtx-test-data/ogg/qt4dance_medium.ogg", "mtx-test-data/opus/v-opus.ogg"}) {
+        const string path(TestUtilities::testFilePath(testFile));
+        cerr << "- testing " << path << endl;
+        m_fileInfo.setPath(path);
+        m_fileInfo.reopen(true);
+        m_fileInfo.setLazyOggParsingEnabled(false);
+        m_fileInfo.parseEverything();
+        const auto fullyParsedTracks = m_fileInfo.tracks();
+        vector<tuple<ChronoUtilities::TimeSpan, uint64, uint64> > expectedResults;
+        for(const AbstractTrack *track : fullyParsedTracks) {
+            expectedResults.emplace_back(track->duration(), track->sampleCount(), track->size());
+        }
+        const ChronoUtilities::TimeSpan expectedDuration = m_fileInfo.duration();
+
+        m_fileInfo.clearParsingResults();
+        m_fileInfo.setLazyOggParsingEnabled(true);
+        m_fileInfo.parseEverything();
+        const auto tracks = m_fileInfo.tracks();
+        CPPUNIT_ASSERT_EQUAL(expectedResults.size(), tracks.size());
+        for(size_t i = 0; i != tracks.size(); ++i) {
+            CPPUNIT_ASSERT_EQUAL(get<0>(expectedResults[i]).totalTicks(), tracks[i]->duration().totalTicks());
+            CPPUNIT_ASSERT_EQUAL(get<1>(expectedResults[i]), tracks[i]->sampleCount());
+            if(tracks.size() == 1) {
+                CPPUNIT_ASSERT(tracks[i]->size() > 0);
+            } else {
+                // the size is unknown unless all pages of the stream have been iterated
+                CPPUNIT_ASSERT(tracks[i]->size() == 0 || tracks[i]->size() == get<2>(expectedResults[i]));
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(expectedDuration.totalTicks(), m_fileInfo.duration().totalTicks());
+        m_fileInfo.close();
+        m_fileInfo.clearParsingResults();
+    }
+    m_fileInfo.setLazyOggParsingEnabled(false);
+}
+
 #ifdef PLATFORM_UNIX
 /*!
  * \brief Tests the Ogg maker via MediaFileInfo.
@@ -166,4 +213,30 @@ void OverallTests::testOggMaking()
         makeFile(TestUtilities::workingCopyPath("mtx-test-data/opus/v-opus.ogg"), modifyRoutine, &OverallTests::checkOggTestfile2);
     }
 }
+
+/*!
+ * \brief Tests the OGG maker via MediaFileInfo when the Vorbis comment fields have only partially been parsed.
+ * \remarks Relies on the parser to check results.
+ */
+void OverallTests::testOggMakingWithProjection()
+{
+    cerr << endl << "OGG maker - tags parsed using projection" << endl;
+    makeFileWithProjection("mtx-test-data/ogg/qt4dance_medium.ogg");
+}
+
+/*!
+ * \brief Tests the OGG maker via MediaFileInfo when the file has been parsed lazily.
+ * \remarks Relies on the parser to check results. The maker needs to fetch all pages not
+ *          considered by the lazy parser.
+ */
+void OverallTests::testOggMakingLazily()
+{
+    cerr << endl << "OGG maker - lazy parsing" << endl;
+    m_fileInfo.setForceFullParse(false);
+    m_fileInfo.setLazyOggParsingEnabled(true);
+    m_tagStatus = TagStatus::TestMetaDataPresent;
+    makeFile(TestUtilities::workingCopyPath("mtx-test-data/ogg/qt4dance_medium.ogg"), &OverallTests::setOggTestMetaData, &OverallTests::checkOggTestfile1);
+    makeFile(TestUtilities::workingCopyPath("mtx-test-data/opus/v-opus.ogg"), &OverallTests::setOggTestMetaData, &OverallTests::checkOggTestfile2);
+    m_fileInfo.setLazyOggParsingEnabled(false);
+}
 #endif
@@ -0,0 +1,400 @@
+#include "./helper.h"
+
+#include "../parsecache.h"
+#include "../mediafileinfo.h"
+#include "../abstractcontainer.h"
+#include "../abstractattachment.h"
+#include "../exceptions.h"
+
+#include <c++utilities/tests/testutils.h>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#ifdef PLATFORM_UNIX
+# include <utime.h>
+#endif
+
+using namespace std;
+using namespace TestUtilities;
+using namespace TestUtilities::Literals;
+using namespace Media;
+
+using namespace CPPUNIT_NS;
+
+/*!
+ * \brief The ParseCacheTests class tests the ParseCache class and the snapshot classes.
+ */
+class ParseCacheTests : public TestFixture {
+    CPPUNIT_TEST_SUITE(ParseCacheTests);
+#ifdef PLATFORM_UNIX
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testInvalidation);
+    CPPUNIT_TEST(testCorruptedCacheFile);
+#endif
+    CPPUNIT_TEST(testForeignFile);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+#ifdef PLATFORM_UNIX
+    void testRoundTrip();
+    void testInvalidation();
+    void testCorruptedCacheFile();
+#endif
+    void testForeignFile();
+
+private:
+    string makeMkvWithAttachment();
+
+    vector<string> m_workingCopies;
+    string m_cachePath;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ParseCacheTests);
+
+namespace {
+
+void checkTracks(const vector<TrackSnapshot> &expected, const vector<TrackSnapshot> &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for(auto e = expected.cbegin(), a = actual.cbegin(); e != expected.cend(); ++e, ++a) {
+        CPPUNIT_ASSERT_EQUAL(e->id, a->id);
+        CPPUNIT_ASSERT_EQUAL(e->trackNumber, a->trackNumber);
+        CPPUNIT_ASSERT(e->type == a->type);
+        CPPUNIT_ASSERT(e->format.general == a->format.general);
+        CPPUNIT_ASSERT_EQUAL(e->format.sub, a->format.sub);
+        CPPUNIT_ASSERT_EQUAL(e->format.extension, a->format.extension);
+        CPPUNIT_ASSERT_EQUAL(e->formatId, a->formatId);
+        CPPUNIT_ASSERT(e->mediaType == a->mediaType);
+        CPPUNIT_ASSERT_EQUAL(e->name, a->name);
+        CPPUNIT_ASSERT_EQUAL(e->language, a->language);
+        CPPUNIT_ASSERT_EQUAL(e->duration.totalTicks(), a->duration.totalTicks());
+        CPPUNIT_ASSERT_EQUAL(e->creationTime.totalTicks(), a->creationTime.totalTicks());
+        CPPUNIT_ASSERT_EQUAL(e->size, a->size);
+        CPPUNIT_ASSERT_EQUAL(e->bitrate, a->bitrate);
+        CPPUNIT_ASSERT_EQUAL(e->maxBitrate, a->maxBitrate);
+        CPPUNIT_ASSERT_EQUAL(e->samplingFrequency, a->samplingFrequency);
+        CPPUNIT_ASSERT_EQUAL(e->extensionSamplingFrequency, a->extensionSamplingFrequency);
+        CPPUNIT_ASSERT_EQUAL(e->bitsPerSample, a->bitsPerSample);
+        CPPUNIT_ASSERT_EQUAL(e->channelCount, a->channelCount);
+        CPPUNIT_ASSERT_EQUAL(e->channelConfig, a->channelConfig);
+        CPPUNIT_ASSERT_EQUAL(e->sampleCount, a->sampleCount);
+        CPPUNIT_ASSERT(e->pixelSize == a->pixelSize);
+        CPPUNIT_ASSERT(e->displaySize == a->displaySize);
+        CPPUNIT_ASSERT_EQUAL(e->fps, a->fps);
+        CPPUNIT_ASSERT_EQUAL(e->enabled, a->enabled);
+        CPPUNIT_ASSERT_EQUAL(e->isDefault, a->isDefault);
+        CPPUNIT_ASSERT_EQUAL(e->forced, a->forced);
+        CPPUNIT_ASSERT_EQUAL(e->encrypted, a->encrypted);
+    }
+}
+
+void checkTags(const vector<TagSnapshot> &expected, const vector<TagSnapshot> &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for(auto e = expected.cbegin(), a = actual.cbegin(); e != expected.cend(); ++e, ++a) {
+        CPPUNIT_ASSERT(e->type == a->type);
+        CPPUNIT_ASSERT_EQUAL(e->version, a->version);
+        CPPUNIT_ASSERT(e->target == a->target);
+        CPPUNIT_ASSERT_EQUAL(e->fields.size(), a->fields.size());
+        for(auto ef = e->fields.cbegin(), af = a->fields.cbegin(); ef != e->fields.cend(); ++ef, ++af) {
+            CPPUNIT_ASSERT(ef->first == af->first);
+            CPPUNIT_ASSERT_EQUAL(ef->second, af->second);
+            CPPUNIT_ASSERT_EQUAL(ef->second.mimeType(), af->second.mimeType());
+            CPPUNIT_ASSERT_EQUAL(ef->second.description(), af->second.description());
+        }
+    }
+}
+
+void checkChapters(const vector<ChapterSnapshot> &expected, const vector<ChapterSnapshot> &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for(auto e = expected.cbegin(), a = actual.cbegin(); e != expected.cend(); ++e, ++a) {
+        CPPUNIT_ASSERT_EQUAL(e->id, a->id);
+        CPPUNIT_ASSERT_EQUAL(e->names.size(), a->names.size());
+        for(auto en = e->names.cbegin(), an = a->names.cbegin(); en != e->names.cend(); ++en, ++an) {
+            CPPUNIT_ASSERT_EQUAL(static_cast<const string &>(*en), static_cast<const string &>(*an));
+            CPPUNIT_ASSERT(en->languages() == an->languages());
+            CPPUNIT_ASSERT(en->countries() == an->countries());
+        }
+        CPPUNIT_ASSERT_EQUAL(e->startTime.totalTicks(), a->startTime.totalTicks());
+        CPPUNIT_ASSERT_EQUAL(e->endTime.totalTicks(), a->endTime.totalTicks());
+        CPPUNIT_ASSERT(e->tracks == a->tracks);
+        CPPUNIT_ASSERT_EQUAL(e->hidden, a->hidden);
+        CPPUNIT_ASSERT_EQUAL(e->enabled, a->enabled);
+        checkChapters(e->nestedChapters, a->nestedChapters);
+    }
+}
+
+void checkAttachments(const vector<AttachmentSnapshot> &expected, const vector<AttachmentSnapshot> &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for(auto e = expected.cbegin(), a = actual.cbegin(); e != expected.cend(); ++e, ++a) {
+        CPPUNIT_ASSERT_EQUAL(e->id, a->id);
+        CPPUNIT_ASSERT_EQUAL(e->name, a->name);
+        CPPUNIT_ASSERT_EQUAL(e->mimeType, a->mimeType);
+        CPPUNIT_ASSERT_EQUAL(e->description, a->description);
+        CPPUNIT_ASSERT_EQUAL(e->dataSize, a->dataSize);
+    }
+}
+
+/*!
+ * \brief Asserts that the \a actual snapshot equals the \a expected snapshot.
+ */
+void checkSnapshot(const MediaFileSnapshot &expected, const MediaFileSnapshot &actual)
+{
+    CPPUNIT_ASSERT(expected.containerFormat == actual.containerFormat);
+    CPPUNIT_ASSERT_EQUAL(expected.duration.totalTicks(), actual.duration.totalTicks());
+    checkTracks(expected.tracks, actual.tracks);
+    checkTags(expected.tags, actual.tags);
+    checkChapters(expected.chapters, actual.chapters);
+    checkAttachments(expected.attachments, actual.attachments);
+}
+
+/*!
+ * \brief Returns the contents of the file with the specified \a path.
+ */
+string readFile(const string &path)
+{
+    ifstream file(path, ios_base::in | ios_base::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+/*!
+ * \brief Replaces the contents of the file with the specified \a path with \a data.
+ */
+void writeFile(const string &path, const string &data)
+{
+    ofstream file(path, ios_base::out | ios_base::trunc | ios_base::binary);
+    file.write(data.data(), static_cast<streamsize>(data.size()));
+}
+
+}
+
+void ParseCacheTests::setUp()
+{}
+
+void ParseCacheTests::tearDown()
+{
+    for(const string &path : m_workingCopies) {
+        remove(path.data());
+        remove((path + ".bak").data());
+    }
+    m_workingCopies.clear();
+    if(!m_cachePath.empty()) {
+        remove(m_cachePath.data());
+        remove((m_cachePath + ".tmp").data());
+        m_cachePath.clear();
+    }
+}
+
+/*!
+ * \brief Returns a working copy of a Matroska file with an attachment.
+ */
+string ParseCacheTests::makeMkvWithAttachment()
+{
+    const string path(workingCopyPath("matroska_wave1/test1.mkv"));
+    m_workingCopies.emplace_back(path);
+    MediaFileInfo fileInfo(path);
+    fileInfo.open();
+    fileInfo.parseEverything();
+    AbstractAttachment *const attachment = fileInfo.container()->createAttachment();
+    CPPUNIT_ASSERT_MESSAGE("create attachment", attachment);
+    attachment->setFile(testFilePath("matroska_wave1/logo3_256x256.png"));
+    attachment->setMimeType("image/png");
+    attachment->setName("cover.jpg");
+    fileInfo.applyChanges();
+    return path;
+}
+
+#ifdef PLATFORM_UNIX
+/*!
+ * \brief Tests whether parsing results survive saving and loading the cache.
+ */
+void ParseCacheTests::testRoundTrip()
+{
+    vector<string> paths{
+        workingCopyPath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"),
+        workingCopyPath("mtx-test-data/alac/othertest-itunes.m4a"),
+        workingCopyPath("mtx-test-data/mkv/handbrake-chapters-2.mkv"),
+        workingCopyPath("mtx-test-data/ogg/qt4dance_medium.ogg"),
+    };
+    m_workingCopies.insert(m_workingCopies.end(), paths.cbegin(), paths.cend());
+    paths.emplace_back(makeMkvWithAttachment());
+    m_cachePath = paths.front() + ".cache";
+
+    // parse all files using the cache
+    ParseCache cache(m_cachePath);
+    cache.load();
+    CPPUNIT_ASSERT(!cache.isModified());
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+    vector<MediaFileSnapshot> snapshots;
+    bool tagsPresent = false, chaptersPresent = false, attachmentsPresent = false;
+    for(const string &path : paths) {
+        MediaFileInfo fileInfo(path);
+        fileInfo.open(true);
+        snapshots.emplace_back(cache.parse(fileInfo));
+        const MediaFileSnapshot &snapshot = snapshots.back();
+        CPPUNIT_ASSERT(snapshot.containerFormat == fileInfo.containerFormat());
+        CPPUNIT_ASSERT(!snapshot.tracks.empty());
+        tagsPresent |= !snapshot.tags.empty();
+        chaptersPresent |= !snapshot.chapters.empty();
+        attachmentsPresent |= !snapshot.attachments.empty();
+    }
+    CPPUNIT_ASSERT(tagsPresent);
+    CPPUNIT_ASSERT(chaptersPresent);
+    CPPUNIT_ASSERT(attachmentsPresent);
+    CPPUNIT_ASSERT(cache.isModified());
+    CPPUNIT_ASSERT_EQUAL(paths.size(), cache.size());
+    cache.save();
+    CPPUNIT_ASSERT(!cache.isModified());
+
+    // load the cache and compare the entries with the original parsing results
+    ParseCache loadedCache(m_cachePath);
+    loadedCache.load();
+    CPPUNIT_ASSERT(!loadedCache.isModified());
+    CPPUNIT_ASSERT_EQUAL(paths.size(), loadedCache.size());
+    for(size_t i = 0; i != paths.size(); ++i) {
+        const MediaFileSnapshot *const snapshot = loadedCache.find(paths[i]);
+        CPPUNIT_ASSERT_MESSAGE(paths[i], snapshot);
+        checkSnapshot(snapshots[i], *snapshot);
+
+        // parse() must not access the file for cached entries
+        MediaFileInfo fileInfo(paths[i]);
+        checkSnapshot(snapshots[i], loadedCache.parse(fileInfo));
+        CPPUNIT_ASSERT(!fileInfo.isOpen());
+        CPPUNIT_ASSERT(fileInfo.containerParsingStatus() == ParsingStatus::NotParsedYet);
+    }
+    CPPUNIT_ASSERT(!loadedCache.isModified());
+}
+
+/*!
+ * \brief Tests whether entries are invalidated when the file is modified.
+ */
+void ParseCacheTests::testInvalidation()
+{
+    const string path(workingCopyPath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"));
+    m_workingCopies.emplace_back(path);
+    m_cachePath = path + ".cache";
+    ParseCache cache(m_cachePath);
+    MediaFileInfo fileInfo(path);
+    fileInfo.open(true);
+    cache.parse(fileInfo);
+    fileInfo.close();
+    CPPUNIT_ASSERT(cache.find(path));
+    CPPUNIT_ASSERT(!cache.find(path + ".nonexistent"));
+    cache.save();
+
+    // change the modification time
+    struct utimbuf times;
+    times.actime = 1000000000;
+    times.modtime = 1000000000;
+    CPPUNIT_ASSERT_EQUAL(0, utime(path.data(), &times));
+    CPPUNIT_ASSERT(!cache.find(path));
+
+    // the entry is updated when parsing the file again
+    fileInfo.clearParsingResults();
+    fileInfo.reopen(true);
+    cache.parse(fileInfo);
+    fileInfo.close();
+    CPPUNIT_ASSERT(cache.isModified());
+    CPPUNIT_ASSERT(cache.find(path));
+    CPPUNIT_ASSERT_EQUAL(1_st, cache.size());
+    cache.save();
+
+    // change the size but keep the modification time
+    {
+        ofstream file(path, ios_base::out | ios_base::app | ios_base::binary);
+        file.put('\0');
+    }
+    CPPUNIT_ASSERT_EQUAL(0, utime(path.data(), &times));
+    CPPUNIT_ASSERT(!cache.find(path));
+
+    // entries loaded from the cache file are invalidated as well
+    ParseCache loadedCache(m_cachePath);
+    loadedCache.load();
+    CPPUNIT_ASSERT_EQUAL(1_st, loadedCache.size());
+    CPPUNIT_ASSERT(!loadedCache.find(path));
+
+    // removing entries
+    cache.remove(path);
+    CPPUNIT_ASSERT(cache.isModified());
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+}
+
+/*!
+ * \brief Tests whether truncated or corrupted cache files are discarded.
+ */
+void ParseCacheTests::testCorruptedCacheFile()
+{
+    const string path(workingCopyPath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"));
+    m_workingCopies.emplace_back(path);
+    m_cachePath = path + ".cache";
+    ParseCache cache(m_cachePath);
+    MediaFileInfo fileInfo(path);
+    fileInfo.open(true);
+    cache.parse(fileInfo);
+    cache.save();
+    const string validData(readFile(m_cachePath));
+    // magic (4 byte), version (2 byte), entry count (8 byte), size of the first path (8 byte), ...
+    CPPUNIT_ASSERT(validData.size() > 22);
+
+    // truncated files
+    for(const size_t size : {validData.size() - 1, validData.size() / 2, static_cast<size_t>(22), static_cast<size_t>(5)}) {
+        writeFile(m_cachePath, validData.substr(0, size));
+        cache.load();
+        CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+        CPPUNIT_ASSERT(cache.isModified());
+    }
+
+    // sizes exceeding the file
+    string corruptedData(validData);
+    corruptedData[21] = '\x7F';
+    writeFile(m_cachePath, corruptedData);
+    cache.load();
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+    CPPUNIT_ASSERT(cache.isModified());
+
+    // other version
+    corruptedData = validData;
+    ++corruptedData[4];
+    writeFile(m_cachePath, corruptedData);
+    cache.load();
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+    CPPUNIT_ASSERT(cache.isModified());
+
+    // saving replaces the corrupted file
+    cache.save();
+    cache.load();
+    CPPUNIT_ASSERT(!cache.isModified());
+    writeFile(m_cachePath, validData);
+    cache.load();
+    CPPUNIT_ASSERT(!cache.isModified());
+    CPPUNIT_ASSERT_EQUAL(1_st, cache.size());
+    CPPUNIT_ASSERT(cache.find(path));
+}
+#endif
+
+/*!
+ * \brief Tests whether loading a file which is not a cache file throws an exception.
+ */
+void ParseCacheTests::testForeignFile()
+{
+    ParseCache cache(testFilePath("mtx-test-data/mp3/id3-tag-and-xing-header.mp3"));
+    CPPUNIT_ASSERT_THROW(cache.load(), InvalidDataException);
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+    CPPUNIT_ASSERT(!cache.isModified());
+
+    // non-existing files are not considered an error
+    cache.setPath(cache.path() + ".nonexistent");
+    cache.load();
+    CPPUNIT_ASSERT_EQUAL(0_st, cache.size());
+    CPPUNIT_ASSERT(!cache.isModified());
+}
@@ -4,7 +4,9 @@
 #include "../id3/id3genres.h"
 
 #include <c++utilities/conversion/conversionexception.h>
+#include <c++utilities/conversion/stringbuilder.h>
 #include <c++utilities/chrono/format.h>
+#include <c++utilities/tests/testutils.h>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -13,6 +15,7 @@ using namespace std;
 using namespace Media;
 using namespace ConversionUtilities;
 using namespace ChronoUtilities;
+using namespace TestUtilities::Literals;
 
 using namespace CPPUNIT_NS;
 
@@ -26,6 +29,8 @@ class TagValueTests : public TestFixture {
     CPPUNIT_TEST(testDateTime);
     CPPUNIT_TEST(testString);
     CPPUNIT_TEST(testEqualityOperator);
+    CPPUNIT_TEST(testInlineStorage);
+    CPPUNIT_TEST(testCopyAndMove);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -40,10 +45,42 @@ public:
     void testDateTime();
     void testString();
     void testEqualityOperator();
+    void testInlineStorage();
+    void testCopyAndMove();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(TagValueTests);
 
+namespace {
+
+/*!
+ * \brief The number of bytes stored within a TagValue instance itself (TagValue::inlineCapacity).
+ */
+constexpr size_t inlineCapacity = 16;
+
+/*!
+ * \brief Returns binary test data of the specified \a size.
+ */
+string makeTestData(size_t size)
+{
+    string data;
+    for(size_t i = 0; i != size; ++i) {
+        data += static_cast<char>('a' + i);
+    }
+    return data;
+}
+
+/*!
+ * \brief Returns whether the data of the specified \a value is stored within the instance itself.
+ */
+bool isStoredInline(const TagValue &value)
+{
+    const char *const data = value.dataPointer();
+    return data >= reinterpret_cast<const char *>(&value) && data < reinterpret_cast<const char *>(&value + 1);
+}
+
+}
+
 void TagValueTests::setUp()
 {
 }
@@ -195,4 +232,106 @@ void TagValueTests::testEqualityOperator()
     CPPUNIT_ASSERT(withDescription != withDescription2);
     withDescription.setMimeType(withDescription2.mimeType());
     CPPUNIT_ASSERT_EQUAL(withDescription, withDescription2);
+
+    // meta-data block allocated but all meta-data empty
+    TagValue withEmptyDescription(15);
+    withEmptyDescription.setDescription("test");
+    withEmptyDescription.setDescription(string());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("empty meta-data equals absent meta-data"s, TagValue(15), withEmptyDescription);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("empty meta-data equals absent meta-data"s, withEmptyDescription, TagValue(15));
+    CPPUNIT_ASSERT_MESSAGE("meta-data must be equal if only one side has meta-data"s, TagValue(15) != withDescription);
+}
+
+void TagValueTests::testInlineStorage()
+{
+    for(const size_t size : {15_st, 16_st, 17_st}) {
+        const string data(makeTestData(size));
+        const TagValue value(data.data(), size, TagDataType::Binary);
+        CPPUNIT_ASSERT_EQUAL(size, value.dataSize());
+        CPPUNIT_ASSERT_EQUAL(data, string(value.dataPointer(), value.dataSize()));
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(argsToString("storage of ", size, " bytes"), size <= inlineCapacity, isStoredInline(value));
+
+        // assignment taking ownership
+        auto buffer = make_unique<char[]>(size);
+        copy(data.cbegin(), data.cend(), buffer.get());
+        const char *const heapData = buffer.get();
+        TagValue assigned;
+        assigned.assignData(move(buffer), size, TagDataType::Binary);
+        CPPUNIT_ASSERT_EQUAL(size, assigned.dataSize());
+        CPPUNIT_ASSERT_EQUAL(data, string(assigned.dataPointer(), assigned.dataSize()));
+        if(size <= inlineCapacity) {
+            CPPUNIT_ASSERT_MESSAGE("small data copied into instance", isStoredInline(assigned));
+        } else {
+            CPPUNIT_ASSERT_MESSAGE("big data taken over", assigned.dataPointer() == heapData);
+        }
+    }
+
+    // heap allocated data replaced by inline data and vice versa
+    TagValue value(makeTestData(17).data(), 17, TagDataType::Binary);
+    value.assignData(makeTestData(3).data(), 3, TagDataType::Binary);
+    CPPUNIT_ASSERT(isStoredInline(value));
+    CPPUNIT_ASSERT_EQUAL(makeTestData(3), string(value.dataPointer(), value.dataSize()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("short inline data null-terminated", makeTestData(3), string(value.dataPointer()));
+    value.assignData(makeTestData(32).data(), 32, TagDataType::Binary);
+    CPPUNIT_ASSERT(!isStoredInline(value));
+    CPPUNIT_ASSERT_EQUAL(makeTestData(32), string(value.dataPointer(), value.dataSize()));
+    value.clearData();
+    CPPUNIT_ASSERT(value.isEmpty());
+    CPPUNIT_ASSERT(!value.dataPointer());
+}
+
+void TagValueTests::testCopyAndMove()
+{
+    for(const size_t size : {15_st, 16_st, 17_st}) {
+        const string data(makeTestData(size));
+        TagValue value(data.data(), size, TagDataType::Binary);
+        value.setDescription("description");
+
+        // copy and move construction
+        TagValue copy(value);
+        CPPUNIT_ASSERT_EQUAL(value, copy);
+        CPPUNIT_ASSERT(copy.dataPointer() != value.dataPointer());
+        CPPUNIT_ASSERT_EQUAL(data, string(copy.dataPointer(), copy.dataSize()));
+        TagValue moved(move(copy));
+        CPPUNIT_ASSERT_EQUAL(value, moved);
+        CPPUNIT_ASSERT_EQUAL(data, string(moved.dataPointer(), moved.dataSize()));
+        CPPUNIT_ASSERT_EQUAL(size <= inlineCapacity, isStoredInline(moved));
+        CPPUNIT_ASSERT_MESSAGE("moved-from value is empty", copy.isEmpty());
+
+        // copy and move assignment from/to values of all sizes (crossing the inline/heap boundary in both directions)
+        for(const size_t otherSize : {0_st, 15_st, 16_st, 17_st, 32_st}) {
+            const string otherData(makeTestData(otherSize));
+            TagValue copyAssigned(otherData.data(), otherSize, TagDataType::Binary);
+            copyAssigned = value;
+            CPPUNIT_ASSERT_EQUAL(value, copyAssigned);
+            CPPUNIT_ASSERT_EQUAL(data, string(copyAssigned.dataPointer(), copyAssigned.dataSize()));
+            CPPUNIT_ASSERT_EQUAL(size <= inlineCapacity, isStoredInline(copyAssigned));
+
+            TagValue source(value);
+            TagValue moveAssigned(otherData.data(), otherSize, TagDataType::Binary);
+            moveAssigned = move(source);
+            CPPUNIT_ASSERT_EQUAL(value, moveAssigned);
+            CPPUNIT_ASSERT_EQUAL(data, string(moveAssigned.dataPointer(), moveAssigned.dataSize()));
+            CPPUNIT_ASSERT_EQUAL(size <= inlineCapacity, isStoredInline(moveAssigned));
+            CPPUNIT_ASSERT_MESSAGE("moved-from value is empty", source.isEmpty());
+
+            // assign the smaller/bigger value back
+            const TagValue other(otherData.data(), otherSize, TagDataType::Binary);
+            copyAssigned = other;
+            CPPUNIT_ASSERT_EQUAL(other, copyAssigned);
+            CPPUNIT_ASSERT_EQUAL(otherData, string(copyAssigned.dataPointer() ? copyAssigned.dataPointer() : "", copyAssigned.dataSize()));
+            moveAssigned = TagValue(other);
+            CPPUNIT_ASSERT_EQUAL(other, moveAssigned);
+            CPPUNIT_ASSERT_EQUAL(otherData, string(moveAssigned.dataPointer() ? moveAssigned.dataPointer() : "", moveAssigned.dataSize()));
+        }
+
+        // self-assignment
+        TagValue &self = value;
+        value = self;
+        CPPUNIT_ASSERT_EQUAL(data, string(value.dataPointer(), value.dataSize()));
+        CPPUNIT_ASSERT_EQUAL("description"s, value.description());
+        value = move(self);
+        CPPUNIT_ASSERT_EQUAL(data, string(value.dataPointer(), value.dataSize()));
+        CPPUNIT_ASSERT_EQUAL("description"s, value.description());
+    }
 }
@@ -4,6 +4,8 @@
 #include "../ogg/oggiterator.h"
 
 #include "../exceptions.h"
+#include "../lookuptable.h"
+#include "../tagfieldprojection.h"
 
 #include <c++utilities/io/binaryreader.h>
 #include <c++utilities/io/binarywriter.h>
@@ -11,6 +13,7 @@
 
 #include <map>
 #include <memory>
+#include <sstream>
 
 using namespace std;
 using namespace IoUtilities;
@@ -73,37 +76,57 @@ string VorbisComment::fieldId(KnownField field) const
 KnownField VorbisComment::knownField(const string &id) const
 {
     using namespace VorbisCommentIds;
-    static const map<string, KnownField> fieldMap({
+    static constexpr LookupEntry<KnownField> knownFieldTable[] = {
         {album(), KnownField::Album},
         {artist(), KnownField::Artist},
         {comment(), KnownField::Comment},
-        {cover(), KnownField::Cover},
+        {composer(), KnownField::Composer},
         {date(), KnownField::Year},
-        {title(), KnownField::Title},
-        {genre(), KnownField::Genre},
-        {trackNumber(), KnownField::TrackPosition},
+        {description(), KnownField::Description},
         {diskNumber(), KnownField::DiskPosition},
-        {partNumber(), KnownField::PartNumber},
-        {composer(), KnownField::Composer},
         {encoder(), KnownField::Encoder},
         {encoderSettings(), KnownField::EncoderSettings},
-        {description(), KnownField::Description},
+        {genre(), KnownField::Genre},
         {label(), KnownField::RecordLabel},
+        {language(), KnownField::Language},
+        {lyricist(), KnownField::Lyricist},
+        {cover(), KnownField::Cover},
+        {partNumber(), KnownField::PartNumber},
         {performer(), KnownField::Performers},
-        {lyricist(), KnownField::Lyricist}
-    });
-    try {
-        return fieldMap.at(id);
-    } catch(out_of_range &) {
-        return KnownField::Invalid;
-    }
+        {title(), KnownField::Title},
+        {trackNumber(), KnownField::TrackPosition},
+    };
+    static_assert(isLookupTableSorted(knownFieldTable, true), "Vorbis comment field table must be sorted");
+    // field names are case-insensitive according to the Vorbis comment specification
+    return findInLookupTable(knownFieldTable, id, true, KnownField::Invalid);
+}
+
+namespace {
+
+/*!
+ * \brief Parses the specified \a rawField (the field as stored in the Vorbis comment including the size denotation) into \a field.
+ */
+void parseRawField(VorbisCommentField &field, string &rawField)
+{
+    stringstream bufferStream(ios_base::in | ios_base::out | ios_base::binary);
+    bufferStream.exceptions(ios_base::failbit | ios_base::badbit);
+    bufferStream.rdbuf()->pubsetbuf(&rawField[0], static_cast<streamsize>(rawField.size()));
+    uint64 maxSize = rawField.size();
+    field.parse(bufferStream, maxSize);
+}
+
 }
 
 /*!
  * \brief Internal implementation for parsing.
+ *
+ * If a \a projection is specified, fields not included in it are not decoded. They are kept as
+ * read so they can be parsed later using parseSkippedFields(). Unlike the data of ID3v2 frames and
+ * MP4 atoms, the data of Vorbis comment fields is still read because the field ID is stored within
+ * the field data and the comment is usually read from Ogg packets which can not be seeked within.
  */
 template<class StreamType>
-void VorbisComment::internalParse(StreamType &stream, uint64 maxSize, VorbisCommentFlags flags)
+void VorbisComment::internalParse(StreamType &stream, uint64 maxSize, VorbisCommentFlags flags, const TagFieldProjection *projection)
 {
     // prepare parsing
     invalidateStatus();
@@ -144,7 +167,25 @@ void VorbisComment::internalParse(StreamType &stream, uint64 maxSize, VorbisComm
             for(uint32 i = 0; i < fieldCount; ++i) {
                 // read fields
                 try {
-                    field.parse(stream, maxSize);
+                    if(projection) {
+                        // read the field as is to check whether it is included in the projection before decoding it
+                        CHECK_MAX_SIZE(4);
+                        stream.read(sig, 4);
+                        const auto fieldSize = LE::toUInt32(sig);
+                        CHECK_MAX_SIZE(fieldSize);
+                        string rawField(sig, 4);
+                        rawField.resize(4 + fieldSize);
+                        stream.read(&rawField[4], fieldSize);
+                        const auto idEnd = rawField.find('=', 4);
+                        const string rawId(rawField, 4, idEnd == string::npos ? string::npos : idEnd - 4);
+                        if(!rawId.empty() && !projection->includes(*this, rawId)) {
+                            m_skippedFields.emplace_back(move(rawField));
+                            continue;
+                        }
+                        parseRawField(field, rawField);
+                    } else {
+                        field.parse(stream, maxSize);
+                    }
                     fields().insert(pair<fieldType::identifierType, fieldType>(fieldId, field));
                 } catch(const TruncatedDataException &) {
                     addNotifications(field);
@@ -177,9 +218,9 @@ void VorbisComment::internalParse(StreamType &stream, uint64 maxSize, VorbisComm
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void VorbisComment::parse(OggIterator &iterator, VorbisCommentFlags flags)
+void VorbisComment::parse(OggIterator &iterator, VorbisCommentFlags flags, const TagFieldProjection *projection)
 {
-    internalParse(iterator, iterator.streamSize(), flags);
+    internalParse(iterator, iterator.streamSize(), flags, projection);
 }
 
 /*!
@@ -189,9 +230,36 @@ void VorbisComment::parse(OggIterator &iterator, VorbisCommentFlags flags)
  * \throws Throws Media::Failure or a derived exception when a parsing
  *         error occurs.
  */
-void VorbisComment::parse(istream &stream, uint64 maxSize, VorbisCommentFlags flags)
+void VorbisComment::parse(istream &stream, uint64 maxSize, VorbisCommentFlags flags, const TagFieldProjection *projection)
 {
-    internalParse(stream, maxSize, flags);
+    internalParse(stream, maxSize, flags, projection);
+}
+
+/*!
+ * \brief Parses the fields skipped when parsing the tag because they were not included in the projection.
+ * \remarks Fields with an ID the tag has already fields for are not added again (see Tag::parseSkippedFields()).
+ */
+void VorbisComment::parseSkippedFields()
+{
+    if(m_skippedFields.empty()) {
+        return;
+    }
+    static const string context("parsing skipped Vorbis comment fields");
+    vector<VorbisCommentField> skippedFields;
+    skippedFields.reserve(m_skippedFields.size());
+    VorbisCommentField field;
+    for(string &rawField : m_skippedFields) {
+        try {
+            parseRawField(field, rawField);
+            skippedFields.emplace_back(field);
+        } catch(const Failure &) {
+            // nothing to do here since notifications will be added anyways
+        }
+        addNotifications(context, field);
+        field.invalidateNotifications();
+    }
+    m_skippedFields.clear();
+    insertSkippedFields(skippedFields);
 }
 
 /*!
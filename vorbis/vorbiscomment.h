@@ -11,6 +11,7 @@ namespace Media {
 
 class OggIterator;
 class VorbisComment;
+class TagFieldProjection;
 
 class TAG_PARSER_EXPORT VorbisComment : public FieldMapBasedTag<VorbisCommentField, CaseInsensitiveStringComparer>
 {
@@ -28,8 +29,12 @@ public:
     std::string fieldId(KnownField field) const;
     KnownField knownField(const std::string &id) const;
 
-    void parse(OggIterator &iterator, VorbisCommentFlags flags = VorbisCommentFlags::None);
-    void parse(std::istream &stream, uint64 maxSize, VorbisCommentFlags flags = VorbisCommentFlags::None);
+    void removeAllFields();
+    bool hasSkippedFields() const;
+    void parseSkippedFields();
+
+    void parse(OggIterator &iterator, VorbisCommentFlags flags = VorbisCommentFlags::None, const TagFieldProjection *projection = nullptr);
+    void parse(std::istream &stream, uint64 maxSize, VorbisCommentFlags flags = VorbisCommentFlags::None, const TagFieldProjection *projection = nullptr);
     void make(std::ostream &stream, VorbisCommentFlags flags = VorbisCommentFlags::None);
 
     const TagValue &vendor() const;
@@ -37,10 +42,11 @@ public:
 
 private:
     template<class StreamType>
-    void internalParse(StreamType &stream, uint64 maxSize, VorbisCommentFlags flags);
+    void internalParse(StreamType &stream, uint64 maxSize, VorbisCommentFlags flags, const TagFieldProjection *projection);
 
 private:
     TagValue m_vendor;
+    std::vector<std::string> m_skippedFields;
 };
 
 /*!
@@ -49,6 +55,23 @@ private:
 inline VorbisComment::VorbisComment()
 {}
 
+/*!
+ * \brief Removes all fields including the fields skipped when parsing the tag.
+ */
+inline void VorbisComment::removeAllFields()
+{
+    FieldMapBasedTag<VorbisCommentField, CaseInsensitiveStringComparer>::removeAllFields();
+    m_skippedFields.clear();
+}
+
+/*!
+ * \brief Returns whether fields have been skipped when parsing the tag.
+ */
+inline bool VorbisComment::hasSkippedFields() const
+{
+    return !m_skippedFields.empty();
+}
+
 inline TagType VorbisComment::type() const
 {
     return TagType::VorbisComment;